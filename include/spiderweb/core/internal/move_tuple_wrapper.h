@@ -12,16 +12,17 @@ struct MoveTupleWrapper {
   MoveTupleWrapper(std::tuple<Args...> &&tuple) : tuple_(std::move(tuple)) {
   }
 
-  MoveTupleWrapper(const MoveTupleWrapper &other) noexcept : tuple_(std::move(other.tuple_)) {
-  }
+  /**
+   * @brief move only, the wrapper is posted as a Task, which does not need copyable callables
+   */
+  MoveTupleWrapper(const MoveTupleWrapper &other) = delete;
 
   MoveTupleWrapper(MoveTupleWrapper &&other) noexcept : tuple_(std::move(other.tuple_)) {
   }
 
-  MoveTupleWrapper &operator=(const MoveTupleWrapper &other) {
-    if (this == &other) {
-      return *this;
-    }
+  MoveTupleWrapper &operator=(const MoveTupleWrapper &other) = delete;
+
+  MoveTupleWrapper &operator=(MoveTupleWrapper &&other) noexcept {
     tuple_ = std::move(other.tuple_);
     return *this;
   }
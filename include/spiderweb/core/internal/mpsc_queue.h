@@ -0,0 +1,165 @@
+#ifndef INTERNAL_MPSC_QUEUE_H
+#define INTERNAL_MPSC_QUEUE_H
+
+#include <atomic>
+#include <utility>
+
+namespace spiderweb {
+
+/**
+ * @brief a lock free, multi producer single consumer queue(Dmitry Vyukov's).
+ *
+ * the link is intrusive to the node, but the queue owns its nodes: values are moved into a node
+ * on Push(), and moved out of it on Pop(), so callers do not need to embed a hook in T.
+ *
+ * Push() can be called from any thread, and never blocks, Pop() must only be called from the
+ * consumer thread. Pop() may return false while a producer is in the middle of Push(), the
+ * producer is then responsible to wake the consumer again.
+ *
+ * popped nodes are not freed, but recycled: the consumer pushes them to a free list, and a
+ * producer takes the whole free list at once into a cache of its thread, so that in the steady
+ * state Push() does not allocate.
+ */
+template <typename T>
+class MpscQueue {
+  struct NodeBase {
+    std::atomic<NodeBase*> next{nullptr};
+  };
+
+  struct Node : NodeBase {
+    T     value;
+    Node* free_next = nullptr;
+  };
+
+  /**
+   * @brief nodes cached by a producer thread, shared by all queues of the same T on that thread.
+   *
+   * this is intended: the nodes of queues of the same T are interchangeable, a node taken from
+   * the free list of one queue may be pushed into another one, and is then recycled into that
+   * queue. the cache owns the nodes it holds, and frees them when the thread exits, so they do not
+   * depend on the lifetime of the queue they came from.
+   */
+  struct NodeCache {
+    ~NodeCache() {
+      FreeList(head);
+    }
+
+    Node* head = nullptr;
+  };
+
+ public:
+  MpscQueue() : head_(&stub_), tail_(&stub_) {
+  }
+
+  ~MpscQueue() {
+    while (auto* node = PopNode()) {
+      delete node;
+    }
+    FreeList(free_.load(std::memory_order_acquire));
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  void Push(T&& value) {
+    auto* node = AllocNode();
+    node->value = std::move(value);
+    PushNode(node);
+  }
+
+  bool Pop(T& output) {
+    auto* node = PopNode();
+    if (!node) {
+      return false;
+    }
+
+    output = std::move(node->value);
+    RecycleNode(node);
+    return true;
+  }
+
+ private:
+  static void FreeList(Node* node) {
+    while (node) {
+      auto* next = node->free_next;
+      delete node;
+      node = next;
+    }
+  }
+
+  Node* AllocNode() {
+    thread_local NodeCache cache;
+
+    if (!cache.head) {
+      /**
+       * @brief take them all, exchange is free of ABA, unlike popping a single node
+       */
+      cache.head = free_.exchange(nullptr, std::memory_order_acquire);
+    }
+    if (!cache.head) {
+      return new Node();
+    }
+
+    auto* node = cache.head;
+    cache.head = node->free_next;
+    return node;
+  }
+
+  void RecycleNode(Node* node) {
+    node->value = T();
+    node->free_next = free_.load(std::memory_order_relaxed);
+    while (!free_.compare_exchange_weak(node->free_next, node, std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+  }
+
+  void PushNode(NodeBase* node) {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    auto* prev = head_.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  Node* PopNode() {
+    auto* tail = tail_;
+    auto* next = tail->next.load(std::memory_order_acquire);
+
+    if (tail == &stub_) {
+      if (!next) {
+        return nullptr;
+      }
+      tail_ = next;
+      tail = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next) {
+      tail_ = next;
+      return static_cast<Node*>(tail);
+    }
+
+    /**
+     * @brief a producer has exchanged the head, but not linked it yet
+     */
+    if (tail != head_.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+
+    PushNode(&stub_);
+    next = tail->next.load(std::memory_order_acquire);
+    if (next) {
+      tail_ = next;
+      return static_cast<Node*>(tail);
+    }
+    return nullptr;
+  }
+
+  std::atomic<NodeBase*> head_;
+  NodeBase*              tail_;
+  NodeBase               stub_;
+  std::atomic<Node*>     free_{nullptr};
+};
+
+}  // namespace spiderweb
+
+#endif
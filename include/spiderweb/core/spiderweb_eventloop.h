@@ -1,6 +1,8 @@
 #ifndef SPIDERWEB_EVENTLOOP_H
 #define SPIDERWEB_EVENTLOOP_H
 
+#include <atomic>
+
 #include "spiderweb/core/spiderweb_notify.h"
 #include "spiderweb_object.h"
 
@@ -10,6 +12,9 @@
 #endif
 
 namespace spiderweb {
+class TimerWheel;
+class TimerPool;
+
 class EventLoop : public Object {
  public:
   explicit EventLoop(Object* parent = nullptr);
@@ -28,9 +33,45 @@ class EventLoop : public Object {
 
   NativeIoService IoService();
 
+  /**
+   * @brief number of objects currently living in this loop(the loop itself excluded).
+   *
+   * it can be read from any thread, and is used as the load of the loop by EventLoopGroup.
+   */
+  std::size_t ObjectCount() const;
+
  private:
+  /**
+   * @brief shared with the objects of the loop, because an object may be destroyed after its
+   *
+   * loop has gone.
+   */
+  using ObjectCounter = std::shared_ptr<std::atomic<std::size_t>>;
+
+  ObjectCounter Counter() const;
+
+  /**
+   * @brief push the task into the lock free task queue of the loop, used by Object::QueueTask.
+   *
+   * tasks are run in batches, with a single wakeup of the loop per batch.
+   */
+  void PostTask(Task&& f);
+
+  /**
+   * @brief the timer wheel of the loop, created on first use, used by TimerType::kCoarse.
+   */
+  TimerWheel& GetTimerWheel();
+
+  /**
+   * @brief the pooled timers of Object::RunAfter, created on first use.
+   */
+  TimerPool& GetTimerPool();
+
   class Private;
   std::unique_ptr<Private> d;
+
+  friend class Object;
+  friend class Timer;
 };
 
 inline EventLoop* GetLoop(Object* base) {
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace spiderweb {
+
+class EventLoop;
+
+/**
+ * @brief EventLoopGroup is a pool of event loop threads.
+ *
+ * It owns N `Thread`s, each of them runs its own EventLoop, and hands out these loops
+ * to the users, so that objects(e.g. accepted TcpSockets) can be spread over all cores.
+ *
+ * @example
+ *  spiderweb::EventLoopGroup group(4);
+ *  group.Start();
+ *
+ *  spiderweb::net::TcpServer server(8080);
+ *  server.SetEventLoopGroup(&group);
+ *  server.ListenAndServ();
+ *
+ * @note the group must outlive all objects placed on its loops.
+ */
+class EventLoopGroup {
+  class Private;
+
+ public:
+  enum class Policy : uint8_t {
+    /// hand out loops one after another
+    kRoundRobin,
+    /// hand out the loop with the fewest living objects, see EventLoop::ObjectCount
+    kLeastLoaded,
+  };
+
+  explicit EventLoopGroup(std::size_t size = std::thread::hardware_concurrency(),
+                          Policy      policy = Policy::kRoundRobin);
+
+  ~EventLoopGroup();
+
+  EventLoopGroup(const EventLoopGroup&) = delete;
+
+  EventLoopGroup& operator=(const EventLoopGroup& rh) = delete;
+
+  /**
+   * @brief start all loop threads, it returns after all loops are running
+   */
+  void Start();
+
+  void Quit();
+
+  bool IsRunning() const;
+
+  std::size_t Size() const;
+
+  Policy GetPolicy() const;
+
+  EventLoop* LoopAt(std::size_t index) const;
+
+  /**
+   * @brief pick a loop by the policy of the group.
+   *
+   * thread safe, it can be called from any thread.
+   */
+  EventLoop* NextLoop();
+
+ private:
+  std::unique_ptr<Private> d;
+};
+}  // namespace spiderweb
@@ -1,8 +1,14 @@
 #ifndef SPIDERWEB_NOTIFY_H
 #define SPIDERWEB_NOTIFY_H
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <functional>
+#include <memory>
+
+#include "absl/container/inlined_vector.h"
 
 namespace spiderweb {
 
@@ -25,28 +31,181 @@ namespace spiderweb {
 //   friend class Object;
 // };
 
+namespace detail {
+
+/**
+ * @brief the flag is shared by the slot, its Connection and the calls queued for it, so a queued
+ *
+ * call still runs after the sender has gone, unless the slot has been disconnected.
+ */
+using ConnectedFlag = std::shared_ptr<std::atomic<bool>>;
+
+inline bool IsConnected(const ConnectedFlag& connected) {
+  return !connected || connected->load(std::memory_order_acquire);
+}
+
+struct ConnectionBody {
+  ConnectedFlag connected = std::make_shared<std::atomic<bool>>(true);
+};
+
+template <typename... Args>
+struct Slot : public ConnectionBody {
+  std::function<void(Args...)> f;
+};
+}  // namespace detail
+
+/**
+ * @brief Connection is the handle of a connected slot, returned by Object::Connect.
+ *
+ * it does not own the slot, Disconnect() can be called from any thread, and also by the slot
+ * itself during the emission. after the Notify has gone, Connected() returns false.
+ */
+class Connection {
+ public:
+  Connection() = default;
+
+  explicit Connection(const std::shared_ptr<detail::ConnectionBody>& body)
+      : body_(body), connected_(body->connected) {
+  }
+
+  void Disconnect() {
+    if (connected_) {
+      connected_->store(false, std::memory_order_release);
+    }
+  }
+
+  bool Connected() const {
+    return !body_.expired() && connected_->load(std::memory_order_acquire);
+  }
+
+ private:
+  std::weak_ptr<detail::ConnectionBody> body_;
+  detail::ConnectedFlag                 connected_;
+};
+
+/**
+ * @brief disconnects the slot when it goes out of scope
+ */
+class ScopedConnection {
+ public:
+  ScopedConnection() = default;
+
+  ScopedConnection(Connection connection) : connection_(std::move(connection)) {  // NOLINT
+  }
+
+  ScopedConnection(ScopedConnection&& other) noexcept = default;
+
+  ScopedConnection& operator=(ScopedConnection&& other) noexcept {
+    if (this != &other) {
+      connection_.Disconnect();
+      connection_ = std::move(other.connection_);
+      other.connection_ = Connection();
+    }
+    return *this;
+  }
+
+  ScopedConnection(const ScopedConnection&) = delete;
+
+  ScopedConnection& operator=(const ScopedConnection&) = delete;
+
+  ~ScopedConnection() {
+    connection_.Disconnect();
+  }
+
+  Connection Release() {
+    auto connection = std::move(connection_);
+    connection_ = Connection();
+    return connection;
+  }
+
+ private:
+  Connection connection_;
+};
+
 template <typename... Args>
 class Notify;
 
+/**
+ * @brief Notify is the signal of an object, it calls the connected slots in connecting order.
+ *
+ * slots are kept in a small inline vector, so emitting does not allocate. slots disconnected
+ * during the emission are skipped, and removed after the emission.
+ */
 template <typename... Args>
 class Notify {
  public:
+  using Slot = detail::Slot<Args...>;
+  using SlotPtr = std::shared_ptr<Slot>;
+
+  static constexpr std::size_t kInlineSlots = 2;
+
+  Notify() = default;
+
+  Notify(const Notify&) = delete;
+
+  Notify& operator=(const Notify&) = delete;
+
   template <typename... Fargs>
-  void operator()(Fargs &&...args) const {
-    if (f_) {
-      f_(std::forward<Fargs>(args)...);
+  void operator()(Fargs&&... args) const {
+    const std::size_t n = slots_.size();
+    if (n == 0) {
+      return;
+    }
+
+    ++emitting_;
+    for (std::size_t i = 0; i < n; ++i) {
+      /**
+       * @brief a slot may connect a new one, which reallocates the vector, but not the slot
+       */
+      auto* slot = slots_[i].get();
+      if (!slot->connected->load(std::memory_order_acquire)) {
+        dirty_ = true;
+        continue;
+      }
+
+      if (i + 1 == n) {
+        slot->f(std::forward<Fargs>(args)...);
+      } else {
+        slot->f(args...);
+      }
+    }
+
+    if (--emitting_ == 0 && dirty_) {
+      Compact();
     }
   }
 
-  void append(std::function<void(Args...)> &&f) {
-    assert(!f_ && "Notify only support append once");
-    f_ = std::forward<decltype(f)>(f);
+  std::size_t SlotCount() const {
+    std::size_t count = 0;
+    for (const auto& slot : slots_) {
+      count += slot->connected->load(std::memory_order_acquire) ? 1 : 0;
+    }
+    return count;
   }
 
   friend class Object;
 
  private:
-  std::function<void(Args...)> f_{nullptr};
+  Connection append(SlotPtr slot) {
+    if (emitting_ == 0) {
+      Compact();
+    }
+    slots_.push_back(slot);
+    return Connection(std::move(slot));
+  }
+
+  void Compact() const {
+    slots_.erase(std::remove_if(slots_.begin(), slots_.end(),
+                                [](const SlotPtr& slot) {
+                                  return !slot->connected->load(std::memory_order_acquire);
+                                }),
+                 slots_.end());
+    dirty_ = false;
+  }
+
+  mutable absl::InlinedVector<SlotPtr, kInlineSlots> slots_;
+  mutable uint32_t                                    emitting_ = 0;
+  mutable bool                                        dirty_ = false;
 };
 }  // namespace spiderweb
 
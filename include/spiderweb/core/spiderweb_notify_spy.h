@@ -15,7 +15,7 @@ class NotifySpy : public Object {
 
   template <typename T, typename T2, typename... Args>
   explicit NotifySpy(T* instance, Notify<Args...> T2::* event) {
-    Object::Connect(instance, event, instance, [this](Args&&... args) {
+    connection_ = Object::Connect(instance, event, instance, [this](Args&&... args) {
       ++count_;
 
       results_.emplace_back(absl::any(std::tuple<decay_t<Args>...>(std::forward<Args>(args)...)));
@@ -50,6 +50,7 @@ class NotifySpy : public Object {
  private:
   uint64_t               count_ = 0;
   std::vector<absl::any> results_;
+  ScopedConnection       connection_;
 };
 }  // namespace spiderweb
 
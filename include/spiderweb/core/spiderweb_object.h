@@ -3,12 +3,16 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <type_traits>
 #include <utility>
 
+#include "absl/types/optional.h"
 #include "internal/move_tuple_wrapper.h"
 #include "spiderweb/core/spiderweb_notify.h"
+#include "spiderweb/core/spiderweb_task.h"
+#include "spiderweb/core/spiderweb_timer_handle.h"
 
 #define SPIDER_EMIT
 #ifndef SPIDERWEB_NO_EMIT
@@ -19,34 +23,140 @@ namespace spiderweb {
 
 using NativeIoService = void*;
 
+/**
+ * @brief `connected` is the flag of the slot, a queued call is dropped if the slot has been
+ *
+ * disconnected(e.g. the receiver is destroyed) before it runs, not if only the sender has gone.
+ */
 template <typename Type, typename... Args>
 static inline std::function<void(Args...)> create_class_member_functor(
-    Type* instance, void (Type::*method)(Args... args)) {
+    Type* instance, void (Type::*method)(Args... args), detail::ConnectedFlag connected = {}) {
   return [=](Args&&... args) mutable {
     if (std::this_thread::get_id() == instance->ThreadId()) {
       (instance->*method)(std::forward<Args>(args)...);
     } else {
       auto tuple = MoveTuple(std::forward<Args>(args)...);
 
-      instance->QueueTask([instance, method, tuple]() mutable { tuple.Apply(method, *instance); });
+      instance->QueueTask([instance, method, connected, tuple = std::move(tuple)]() mutable {
+        if (detail::IsConnected(connected)) {
+          tuple.Apply(method, *instance);
+        }
+      });
     }
   };
 }
 
 template <typename Reciver, typename... Args, typename F>
-static inline std::function<void(Args...)> create_none_class_member_functor(Reciver* reciver,
-                                                                            F&&      f) {
+static inline std::function<void(Args...)> create_none_class_member_functor(
+    Reciver* reciver, F&& f, detail::ConnectedFlag connected = {}) {
   return [=](Args&&... args) mutable {
     if (std::this_thread::get_id() == reciver->ThreadId()) {
       f(std::forward<Args>(args)...);
     } else {
       auto tuple = MoveTuple(std::forward<Args>(args)...);
 
-      reciver->QueueTask([tuple, f]() mutable { tuple.Apply(f); });
+      reciver->QueueTask([tuple = std::move(tuple), f, connected]() mutable {
+        if (detail::IsConnected(connected)) {
+          tuple.Apply(f);
+        }
+      });
     }
   };
 }
 
+/**
+ * @brief how a slot is called when the signal is emitted in another thread than the receiver's.
+ *
+ * in the thread of the receiver, the slot is always called directly.
+ */
+enum class ConnectionType : uint8_t {
+  /// one task is queued into the loop of the receiver per emission
+  kAuto,
+  /// emissions of a sender toward the same loop are collected in a batch, and the batch is run
+  /// by one queued task
+  kBatched,
+  /// latest value wins, emissions not yet delivered are replaced by the newer one, for state
+  /// like signals, e.g. Process::StateChanged
+  kLatest,
+};
+
+/**
+ * @brief emissions are appended to the batch of (`sender`, loop of `reciver`).
+ */
+template <typename Reciver, typename... Args, typename Sender, typename F>
+static inline std::function<void(Args...)> create_batched_functor(
+    const Sender* sender, Reciver* reciver, F&& f, detail::ConnectedFlag connected) {
+  return [=](Args&&... args) mutable {
+    if (std::this_thread::get_id() == reciver->ThreadId()) {
+      f(std::forward<Args>(args)...);
+    } else {
+      auto tuple = MoveTuple(std::forward<Args>(args)...);
+
+      sender->QueueTaskBatched(reciver->ownerEventLoop(),
+                               [tuple = std::move(tuple), f, connected]() mutable {
+                                 if (detail::IsConnected(connected)) {
+                                   tuple.Apply(f);
+                                 }
+                               });
+    }
+  };
+}
+
+/**
+ * @brief at most one call is queued, it delivers the arguments of the latest emission.
+ */
+template <typename Reciver, typename... Args, typename F>
+static inline std::function<void(Args...)> create_latest_functor(
+    Reciver* reciver, F&& f, detail::ConnectedFlag connected) {
+  using Tuple = MoveTupleWrapper<decay_t<Args>...>;
+
+  struct Latest {
+    std::mutex             mutex;
+    absl::optional<Tuple> value;
+  };
+
+  auto latest = std::make_shared<Latest>();
+  return [=](Args&&... args) mutable {
+    if (std::this_thread::get_id() == reciver->ThreadId()) {
+      f(std::forward<Args>(args)...);
+      return;
+    }
+
+    bool queued = false;
+    {
+      std::lock_guard<std::mutex> lock(latest->mutex);
+      queued = latest->value.has_value();
+      latest->value.emplace(MoveTuple(std::forward<Args>(args)...));
+    }
+    if (queued) {
+      return;
+    }
+
+    reciver->QueueTask([latest, f, connected]() mutable {
+      absl::optional<Tuple> value;
+      {
+        std::lock_guard<std::mutex> lock(latest->mutex);
+        value.emplace(std::move(*latest->value));
+        latest->value.reset();
+      }
+      if (detail::IsConnected(connected)) {
+        value->Apply(f);
+      }
+    });
+  };
+}
+
+/**
+ * @brief the backend of timers(Timer, Object::RunAfter)
+ */
+enum class TimerType : uint8_t {
+  /// an asio::steady_timer per timer, millisecond accurate
+  kPrecise,
+  /// the timer wheel of the loop, O(1) start and stop, shared by all timers of the loop, accurate
+  /// to a tick(10ms), for massive timeouts, e.g. idle or keepalive timers of connections
+  kCoarse,
+};
+
 class EventLoop;
 class Object {
  public:
@@ -58,24 +168,64 @@ class Object {
 
   Object& operator=(const Object& other) = delete;
 
+  /**
+   * @brief connect `signal` of `sender` to `method` of `reciver`, a signal can have many slots.
+   *
+   * the slot is called in the thread of `reciver`, directly if the signal is emitted in that
+   * thread, otherwise queued as `type` says. the slot is disconnected when `reciver` is
+   * destroyed, or by the returned Connection.
+   */
   template <typename Sender, typename SenderU, typename Reciver, typename... Args>
-  static void Connect(Sender* sender, Notify<Args...> SenderU::* signal, Reciver* reciver,
-                      void (Reciver::*method)(Args... args)) {
+  static Connection Connect(Sender* sender, Notify<Args...> SenderU::* signal, Reciver* reciver,
+                            void (Reciver::*method)(Args... args),
+                            ConnectionType type = ConnectionType::kAuto) {
     static_assert(std::is_base_of<Object, Reciver>::value, "Reciver must derived from Base");
 
     static_assert(std::is_base_of<Object, Sender>::value, "Sender must derived from Base");
 
-    (sender->*signal).append(create_class_member_functor(reciver, method));
+    if (type != ConnectionType::kAuto) {
+      return Connect(
+          sender, signal, reciver,
+          [reciver, method](Args... args) { (reciver->*method)(std::forward<Args>(args)...); },
+          type);
+    }
+
+    auto slot = std::make_shared<detail::Slot<Args...>>();
+    slot->f = create_class_member_functor(reciver, method, slot->connected);
+
+    auto connection = (sender->*signal).append(std::move(slot));
+    reciver->TrackConnection(connection);
+    return connection;
   }
 
   template <typename Sender, typename SenderU, typename Reciver, typename... Args, typename F>
-  static void Connect(Sender* sender, Notify<Args...> SenderU::* signal, Reciver* reciver, F&& f) {
+  static Connection Connect(Sender* sender, Notify<Args...> SenderU::* signal, Reciver* reciver,
+                            F&& f, ConnectionType type = ConnectionType::kAuto) {
     static_assert(std::is_base_of<Object, Reciver>::value, "Reciver must derived from Base");
 
     static_assert(std::is_base_of<Object, Sender>::value, "Sender must derived from Base");
 
-    (sender->*signal)
-        .append(create_none_class_member_functor<Reciver, Args...>(reciver, std::forward<F>(f)));
+    auto slot = std::make_shared<detail::Slot<Args...>>();
+    auto connected = slot->connected;
+    switch (type) {
+      case ConnectionType::kBatched:
+        slot->f = create_batched_functor<Reciver, Args...>(sender, reciver, std::forward<F>(f),
+                                                           std::move(connected));
+        break;
+      case ConnectionType::kLatest:
+        slot->f =
+            create_latest_functor<Reciver, Args...>(reciver, std::forward<F>(f), std::move(connected));
+        break;
+      case ConnectionType::kAuto:
+      default:
+        slot->f = create_none_class_member_functor<Reciver, Args...>(reciver, std::forward<F>(f),
+                                                                     std::move(connected));
+        break;
+    }
+
+    auto connection = (sender->*signal).append(std::move(slot));
+    reciver->TrackConnection(connection);
+    return connection;
   }
 
   template <typename Sender, typename SenderU, typename... Args>
@@ -89,9 +239,23 @@ class Object {
 
   EventLoop* ownerEventLoop() const;
 
-  void QueueTask(std::function<void()>&& f) const;
+  void QueueTask(Task&& f) const;
 
-  void RunAfter(uint64_t delay_ms, std::function<void()>&& f) const;
+  /**
+   * @brief queue `f` into `loop`, the tasks queued by this object into the same loop are
+   *
+   * collected, and run in order by a single queued task. used by ConnectionType::kBatched.
+   */
+  void QueueTaskBatched(EventLoop* loop, Task&& f) const;
+
+  /**
+   * @brief run `f` in the loop of this object after `delay_ms`.
+   *
+   * the returned handle can cancel or reschedule it, when called in the thread of the object.
+   * called from another thread, the task is queued into the loop first, and the handle returned
+   * is inactive.
+   */
+  TimerHandle RunAfter(uint64_t delay_ms, Task&& f, TimerType type = TimerType::kPrecise) const;
 
   std::thread::id ThreadId() const;
 
@@ -102,6 +266,13 @@ class Object {
  private:
   explicit Object(EventLoop* loop, Object* parent = nullptr);
 
+  /**
+   * @brief remember the connections whose receiver is this object, they are disconnected in
+   *
+   * the destructor.
+   */
+  void TrackConnection(const Connection& connection);
+
   class Private;
   std::unique_ptr<Private> d;
 
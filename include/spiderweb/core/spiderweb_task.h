@@ -0,0 +1,174 @@
+#ifndef SPIDERWEB_TASK_H
+#define SPIDERWEB_TASK_H
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace spiderweb {
+
+/**
+ * @brief Task is a move only `void()` callable, used by all the posting apis(QueueTask,
+ *
+ * RunAfter...).
+ *
+ * unlike std::function, the callable need not be copyable, and callables up to kInlineSize
+ * bytes are stored inline, so posting a lambda which captures e.g. a std::vector<uint8_t> or a
+ * std::unique_ptr neither allocates nor copies the payload. bigger callables are stored on heap.
+ *
+ * @example
+ *  std::vector<uint8_t> data(1024);
+ *  object->QueueTask([data = std::move(data)]() { Consume(data); });
+ */
+class Task {
+ public:
+  static constexpr std::size_t kInlineSize = 64;
+
+  Task() noexcept = default;
+
+  Task(std::nullptr_t) noexcept {  // NOLINT
+  }
+
+  template <typename F, typename Fn = typename std::decay<F>::type,
+            typename = typename std::enable_if<!std::is_same<Fn, Task>::value>::type>
+  Task(F&& f) {  // NOLINT
+    Init<Fn>(std::forward<F>(f), std::integral_constant<bool, IsInline<Fn>()>());
+  }
+
+  Task(Task&& other) noexcept {
+    MoveFrom(other);
+  }
+
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  Task& operator=(std::nullptr_t) noexcept {
+    Reset();
+    return *this;
+  }
+
+  Task(const Task&) = delete;
+
+  Task& operator=(const Task&) = delete;
+
+  ~Task() {
+    Reset();
+  }
+
+  void operator()() {
+    assert(ops_ && "call an empty Task");
+    ops_->invoke(&storage_);
+  }
+
+  explicit operator bool() const noexcept {
+    return ops_ != nullptr;
+  }
+
+  /**
+   * @brief whether a callable of type F is stored without heap allocation
+   */
+  template <typename F>
+  static constexpr bool IsInline() {
+    return sizeof(F) <= kInlineSize && alignof(F) <= alignof(std::max_align_t) &&
+           std::is_nothrow_move_constructible<F>::value;
+  }
+
+ private:
+  using Storage = typename std::aligned_storage<kInlineSize, alignof(std::max_align_t)>::type;
+
+  struct Ops {
+    void (*invoke)(Storage* self);
+    void (*move)(Storage* dst, Storage* src) noexcept;
+    void (*destroy)(Storage* self) noexcept;
+  };
+
+  template <typename F>
+  struct InlineOps {
+    static F* Get(Storage* s) {
+      return reinterpret_cast<F*>(s);
+    }
+
+    static void Invoke(Storage* self) {
+      (*Get(self))();
+    }
+
+    static void Move(Storage* dst, Storage* src) noexcept {
+      ::new (static_cast<void*>(dst)) F(std::move(*Get(src)));
+      Get(src)->~F();
+    }
+
+    static void Destroy(Storage* self) noexcept {
+      Get(self)->~F();
+    }
+
+    static constexpr Ops kOps{&Invoke, &Move, &Destroy};
+  };
+
+  template <typename F>
+  struct HeapOps {
+    static F*& Get(Storage* s) {
+      return *reinterpret_cast<F**>(s);
+    }
+
+    static void Invoke(Storage* self) {
+      (*Get(self))();
+    }
+
+    static void Move(Storage* dst, Storage* src) noexcept {
+      ::new (static_cast<void*>(dst)) F*(Get(src));
+    }
+
+    static void Destroy(Storage* self) noexcept {
+      delete Get(self);
+    }
+
+    static constexpr Ops kOps{&Invoke, &Move, &Destroy};
+  };
+
+  template <typename Fn, typename F>
+  void Init(F&& f, std::true_type /*inline*/) {
+    ::new (static_cast<void*>(&storage_)) Fn(std::forward<F>(f));
+    ops_ = &InlineOps<Fn>::kOps;
+  }
+
+  template <typename Fn, typename F>
+  void Init(F&& f, std::false_type /*inline*/) {
+    ::new (static_cast<void*>(&storage_)) Fn*(new Fn(std::forward<F>(f)));
+    ops_ = &HeapOps<Fn>::kOps;
+  }
+
+  void MoveFrom(Task& other) noexcept {
+    if (other.ops_) {
+      other.ops_->move(&storage_, &other.storage_);
+      ops_ = other.ops_;
+      other.ops_ = nullptr;
+    }
+  }
+
+  void Reset() noexcept {
+    if (ops_) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
+
+  Storage    storage_;
+  const Ops* ops_ = nullptr;
+};
+
+template <typename F>
+constexpr Task::Ops Task::InlineOps<F>::kOps;
+
+template <typename F>
+constexpr Task::Ops Task::HeapOps<F>::kOps;
+
+}  // namespace spiderweb
+
+#endif
@@ -4,8 +4,12 @@
 #include <memory>
 #include <thread>
 
+#include "spiderweb/core/spiderweb_task.h"
+
 namespace spiderweb {
 
+class EventLoop;
+
 /**
  * @brief Thread Is EventLoop Thread.
  * with this class, we can simple start a thread, that run an event loop.
@@ -54,12 +58,17 @@ class Thread {
 
   void Quit();
 
-  void QueueTask(std::function<void()>&& f);
+  void QueueTask(Task&& f);
 
   bool IsRunning() const;
 
   Id GetThreadId() const;
 
+  /**
+   * @brief the event loop running in this thread, nullptr if not started
+   */
+  EventLoop* GetEventLoop() const;
+
  private:
   std::unique_ptr<Private> d;
 };
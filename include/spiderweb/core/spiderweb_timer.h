@@ -48,6 +48,16 @@ class Timer : public Object {
    */
   void SetSingalShot(bool flag);
 
+  /**
+   * @brief kPrecise by default, with kCoarse the timer runs on the timer wheel of its loop,
+   *
+   * which makes Start/Stop/Reset O(1), the timeout is accurate to 10ms. change it only while the
+   * timer is stopped.
+   */
+  void SetTimerType(TimerType type);
+
+  TimerType GetTimerType() const;
+
   void Start();
 
   void Stop();
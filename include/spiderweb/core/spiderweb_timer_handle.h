@@ -0,0 +1,50 @@
+#ifndef SPIDERWEB_TIMER_HANDLE_H
+#define SPIDERWEB_TIMER_HANDLE_H
+
+#include <cstdint>
+
+namespace spiderweb {
+
+class TimerPool;
+
+/**
+ * @brief TimerHandle refers to a pending Object::RunAfter task.
+ *
+ * it is a plain value(a slot index and a generation), copying it is cheap, and it never keeps
+ * the task alive. after the task has run or been cancelled, the handle is inactive and all
+ * operations on it are no-ops, even if the slot is reused by another RunAfter.
+ *
+ * @note must be used in the thread of the loop that runs the task, and not after the loop is
+ * destroyed.
+ */
+class TimerHandle {
+ public:
+  TimerHandle() = default;
+
+  bool IsActive() const;
+
+  /**
+   * @brief the task will not run
+   */
+  void Cancel();
+
+  /**
+   * @brief run the task `delay_ms` from now instead, returns false if it is inactive
+   */
+  bool Reschedule(uint64_t delay_ms);
+
+ private:
+  TimerHandle(TimerPool* pool, uint32_t index, uint32_t generation)
+      : pool_(pool), index_(index), generation_(generation) {
+  }
+
+  TimerPool* pool_ = nullptr;
+  uint32_t   index_ = 0;
+  uint32_t   generation_ = 0;
+
+  friend class TimerPool;
+};
+
+}  // namespace spiderweb
+
+#endif
@@ -5,8 +5,11 @@
 
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "spiderweb/io/spiderweb_buffer_chain.h"
+
 namespace spiderweb {
 namespace io {
 class Buffer {
@@ -85,40 +88,46 @@ class Buffer {
 
 class BufferReader {
  public:
-  explicit BufferReader(Buffer& buffer) : buffer_(buffer) {
+  explicit BufferReader(Buffer& buffer) : buffer_(&buffer) {
+  }
+
+  /**
+   * @brief view a BufferChain, e.g. the receive buffer of the streams
+   */
+  explicit BufferReader(BufferChain& chain) : chain_(&chain) {
   }
 
   ~BufferReader() = default;
 
   // Read All
   inline size_t Read(std::vector<char>& p) const {
-    return buffer_.Read(p);
+    return buffer_ ? buffer_->Read(p) : chain_->Read(p);
   }
 
   // Read One Byte
   inline char ReadByte() const {
-    return buffer_.ReadByte();
+    return buffer_ ? buffer_->ReadByte() : chain_->ReadByte();
   }
 
   // Read N Bytes from buffer
   inline size_t ReadBytes(std::vector<char>& p, size_t n) const {
-    return buffer_.ReadBytes(p, n);
+    return buffer_ ? buffer_->ReadBytes(p, n) : chain_->ReadBytes(p, n);
   }
 
   inline size_t Read(char* buffer, size_t n) const {
-    return buffer_.Read(buffer, n);
+    return buffer_ ? buffer_->Read(buffer, n) : chain_->Read(buffer, n);
   }
 
   inline size_t ZeroCopyRead(char*& ptr, size_t n) const {
-    return buffer_.ZeroCopyRead(ptr, n);
+    return buffer_ ? buffer_->ZeroCopyRead(ptr, n) : chain_->ZeroCopyRead(ptr, n);
   }
 
   inline void Skip(uint32_t size) const {
-    buffer_.Skip(size);
+    buffer_ ? buffer_->Skip(size) : chain_->Skip(size);
   }
 
   inline size_t PointerAt(char*& ptr, size_t index, size_t size) const {
-    return buffer_.PointerAt(&ptr, index, size);
+    return buffer_ ? buffer_->PointerAt(&ptr, index, size) : chain_->PointerAt(&ptr, index, size);
   }
 
   inline absl::Span<uint8_t> SpanAt(size_t index, size_t size) const {
@@ -129,27 +138,46 @@ class BufferReader {
   }
 
   inline bool PeekAt(std::vector<char>& p, size_t index, size_t size) const {
-    return buffer_.PeekAt(p, index, size);
+    return buffer_ ? buffer_->PeekAt(p, index, size) : chain_->PeekAt(p, index, size);
   }
 
   inline size_t Len() const {
-    return buffer_.Len();
+    return buffer_ ? buffer_->Len() : chain_->Len();
+  }
+
+  /**
+   * @brief call `f(const char* data, size_t size)` for each contiguous piece of the unread data,
+   *
+   * in order, without copying or consuming anything.
+   */
+  template <typename F>
+  void ForEachSegment(F&& f) const {
+    if (chain_) {
+      chain_->ForEachSegment(std::forward<F>(f));
+      return;
+    }
+
+    char* data = nullptr;
+    if (buffer_->PointerAt(&data, 0, buffer_->Len())) {
+      f(static_cast<const char*>(data), buffer_->Len());
+    }
   }
 
   inline size_t Cap() const {
-    return buffer_.Cap();
+    return buffer_ ? buffer_->Cap() : chain_->Cap();
   }
 
   inline void UnReadByte(/*error*/) const {
-    buffer_.UnReadByte();
+    buffer_ ? buffer_->UnReadByte() : chain_->UnReadByte();
   }
 
   inline void UnReadBytes(size_t n) const {
-    buffer_.UnReadBytes(n);
+    buffer_ ? buffer_->UnReadBytes(n) : chain_->UnReadBytes(n);
   }
 
  private:
-  Buffer& buffer_;
+  Buffer*      buffer_ = nullptr;
+  BufferChain* chain_ = nullptr;
 };
 
 }  // namespace io
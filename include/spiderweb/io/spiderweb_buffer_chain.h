@@ -0,0 +1,185 @@
+#ifndef SPIDERWEB_IO_BUFFER_CHAIN_H
+#define SPIDERWEB_IO_BUFFER_CHAIN_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "spiderweb/io/spiderweb_shared_slice.h"
+
+namespace spiderweb {
+namespace io {
+
+namespace detail {
+struct BufferBlock;
+}
+
+/**
+ * @brief a chain of refcounted blocks, the counterpart of io::Buffer that never moves its data.
+ *
+ * bytes are written to the tail block, and read from the head, when a block is full a new one is
+ *
+ * chained, when a block is read out it is released. so append and consume are O(1), no matter how
+ *
+ * much data is buffered. blocks of kBlockSize are pooled per thread.
+ *
+ * blocks can be shared between chains(Split, Clone) or handed out as SharedSlice, without copying.
+ *
+ * the reading api is the same as io::Buffer, so that it can be viewed by a BufferReader. the only
+ *
+ * difference is that data is not contiguous: PointerAt and ZeroCopyRead of a range which spans
+ *
+ * blocks copy the range into one block first.
+ *
+ * as io::Buffer, pointers returned by the reading api are valid until the next PrepareWrite or
+ *
+ * Write, and read bytes can be unread until then.
+ *
+ * not thread safe, only the blocks(refcounted) may be shared between threads.
+ */
+class BufferChain {
+ public:
+  static constexpr std::size_t kBlockSize = 16 * 1024;
+
+  BufferChain() = default;
+
+  ~BufferChain();
+
+  BufferChain(BufferChain&& other) noexcept;
+
+  BufferChain& operator=(BufferChain&& other) noexcept;
+
+  BufferChain(const BufferChain&) = delete;
+
+  BufferChain& operator=(const BufferChain&) = delete;
+
+  // Read All
+  size_t Read(std::vector<char>& p);
+
+  // Read One Byte
+  char ReadByte();
+
+  // Read N Bytes from buffer
+  size_t ReadBytes(std::vector<char>& p, size_t n);
+
+  size_t Read(char* buffer, size_t n);
+
+  size_t ZeroCopyRead(char*& ptr, size_t n);
+
+  // write data into buffer
+  size_t Write(const char* d, size_t len);
+
+  size_t Write(const std::string& s);
+
+  size_t Write(const std::vector<char>& p);
+
+  /**
+   * @brief chain the blocks of `other` at the tail, without copying
+   */
+  void Append(BufferChain&& other);
+
+  void UnReadByte();
+
+  void UnReadBytes(size_t n);
+
+  // return unreaded data size
+  size_t Len() const {
+    return len_;
+  }
+
+  /**
+   * @brief bytes that can be held without allocating a block
+   */
+  size_t Cap() const;
+
+  void Reset();
+
+  void Skip(uint32_t size);
+
+  bool PeekAt(std::vector<char>& p, size_t index, size_t size);
+
+  bool PointerAt(char** p, size_t index, size_t size);
+
+  /**
+   * @brief make sure there are at least `n` bytes to write at beginWrite(), and release the blocks
+   *
+   * that have been read.
+   */
+  void PrepareWrite(std::size_t n);
+
+  void CommitWrite(std::size_t n);
+
+  char*  beginWrite();
+  size_t leftSpace() const;
+
+  /**
+   * @brief move the first `n` unread bytes into a new chain, the blocks are shared, not copied
+   */
+  BufferChain Split(std::size_t n);
+
+  /**
+   * @brief a chain sharing all the unread bytes of this one
+   */
+  BufferChain Clone() const;
+
+  /**
+   * @brief `size` bytes at `index` as a SharedSlice, which keeps its block alive
+   */
+  SharedSlice Share(std::size_t index, std::size_t size);
+
+  /**
+   * @brief call `f(const char* data, std::size_t size)` for the unread bytes of every block, in
+   *
+   * order, e.g. to build an iovec.
+   */
+  template <typename F>
+  void ForEachSegment(F&& f) const {
+    for (std::size_t i = head_; i < segments_.size(); ++i) {
+      const auto& seg = segments_[i];
+      if (seg.read < seg.end) {
+        f(static_cast<const char*>(seg.Data() + seg.read), seg.end - seg.read);
+      }
+    }
+  }
+
+  std::size_t SegmentCount() const {
+    return segments_.size() - head_;
+  }
+
+ private:
+  struct Segment {
+    char* Data() const;
+
+    detail::BufferBlock* block = nullptr;
+    uint32_t             begin = 0;
+    /// the read cursor, bytes in [begin, read) are read, but may be unread
+    uint32_t             read = 0;
+    uint32_t             end = 0;
+  };
+
+  void Consume(std::size_t n);
+
+  /**
+   * @brief pointer to `size` contiguous bytes at `index`, which is checked by the caller
+   */
+  char* Contiguous(std::size_t index, std::size_t size);
+
+  /**
+   * @brief release the segments that have been read, and the blocks retired by Contiguous
+   */
+  void Reclaim();
+
+  std::deque<Segment>               segments_;
+  /// the first segment with unread bytes, those before it are kept for UnReadBytes
+  std::size_t                       head_ = 0;
+  std::size_t                       len_ = 0;
+  std::vector<detail::BufferBlock*> retired_;
+  detail::BufferBlock*              write_block_ = nullptr;
+  uint32_t                          write_pos_ = 0;
+};
+
+}  // namespace io
+}  // namespace spiderweb
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef SPIDERWEB_IO_FLOW_CONTROL_H
+#define SPIDERWEB_IO_FLOW_CONTROL_H
+
+#include <cstddef>
+
+#include "spiderweb/core/spiderweb_object.h"
+
+namespace spiderweb {
+namespace io {
+
+/**
+ * @brief pause reading `reader` while the write buffer of `writer` is over its high watermark,
+ *
+ * and resume it when the buffer is drained, so a fast producer can not make `writer` buffer
+ * without limit. the streams are any of TcpSocket, UdsSocket, SerialPort, NamedPipe, ProcessFd.
+ *
+ * the connections are owned by `reader`, and are disconnected when it is destroyed.
+ *
+ * @example
+ *  upstream->SetWriteBufferWatermarks(1024 * 1024, 256 * 1024);
+ *  io::PauseReadingWhenFull(upstream, downstream);
+ *  Object::Connect(downstream, &TcpSocket::BytesRead, upstream,
+ *                  [upstream](const io::BufferReader& reader) { upstream->Write(...); });
+ */
+template <typename Writer, typename Reader>
+void PauseReadingWhenFull(Writer* writer, Reader* reader) {
+  Object::Connect(writer, &Writer::WriteBufferFull, reader,
+                  [reader](std::size_t /*size*/) { reader->PauseReading(); });
+  Object::Connect(writer, &Writer::WriteBufferDrained, reader,
+                  [reader]() { reader->ResumeReading(); });
+}
+
+}  // namespace io
+}  // namespace spiderweb
+
+#endif
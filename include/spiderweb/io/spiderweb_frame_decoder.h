@@ -0,0 +1,186 @@
+#ifndef SPIDERWEB_IO_FRAME_DECODER_H
+#define SPIDERWEB_IO_FRAME_DECODER_H
+
+#include <absl/types/span.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <system_error>
+
+#include "spiderweb/arch/spiderweb_arch.hpp"
+#include "spiderweb/core/spiderweb_error_code.h"
+#include "spiderweb/core/spiderweb_object.h"
+#include "spiderweb/io/spiderweb_buffer.h"
+
+namespace spiderweb {
+namespace io {
+
+/**
+ * @brief splits the bytes read by a stream into frames.
+ *
+ * each complete frame is emitted by FrameRead as a span into the receive buffer of the stream, so
+ *
+ * it is not copied, unless it spans two blocks of the buffer. the span is valid only in the slot.
+ *
+ * the bytes of a frame are consumed after FrameRead, an incomplete frame is left in the buffer.
+ *
+ * the decoder keeps how far it has scanned, so every byte is examined once, no matter in how many
+ *
+ * reads a frame arrives. so the decoder must be the only reader of the stream.
+ *
+ * @example
+ *  auto* decoder = new io::LengthFieldDecoder(0, 4, arch::ArchType::kBig, 0, 4, socket);
+ *  decoder->Attach(socket);
+ *  Object::Connect(decoder, &io::FrameDecoder::FrameRead, this,
+ *                  [](absl::Span<const uint8_t> frame) { Handle(frame); });
+ */
+class FrameDecoder : public Object {
+ public:
+  static constexpr std::size_t kDefaultMaxFrameSize = 16 * 1024 * 1024;
+
+  explicit FrameDecoder(Object* parent = nullptr);
+
+  ~FrameDecoder() override;
+
+  /**
+   * @brief decode what `stream` reads, any of TcpSocket, UdsSocket, SerialPort, NamedPipe...
+   */
+  template <typename Stream>
+  void Attach(Stream* stream) {
+    Object::Connect(stream, &Stream::BytesRead, this, &FrameDecoder::Decode);
+  }
+
+  /**
+   * @brief emit and consume all the complete frames in `reader`
+   */
+  void Decode(const BufferReader& reader);
+
+  /**
+   * @brief forget the scan state and a previous error, e.g. for a new connection
+   */
+  void Reset();
+
+  /**
+   * @brief a frame bigger than `size` is an error, kDefaultMaxFrameSize by default
+   */
+  void SetMaxFrameSize(std::size_t size);
+
+  std::size_t MaxFrameSize() const;
+
+  Notify<absl::Span<const uint8_t>> FrameRead;
+
+  /**
+   * @brief the stream can not be decoded(e.g. a frame is too big), decoding stops until Reset.
+   */
+  Notify<const std::error_code&> Error;
+
+ protected:
+  struct Frame {
+    /// the frame emitted is [offset, offset + size) of the unread bytes
+    std::size_t offset = 0;
+    std::size_t size = 0;
+    /// bytes consumed after the frame is emitted
+    std::size_t consumed = 0;
+  };
+
+  /**
+   * @brief find the first frame of `reader`, without consuming anything.
+   *
+   * @return false if there is no complete frame yet, or `ec` is set
+   */
+  virtual bool NextFrame(const BufferReader& reader, Frame* frame, ErrorCode* ec) = 0;
+
+  /**
+   * @brief forget the scan state, called after each frame and by Reset
+   */
+  virtual void ResetScan() = 0;
+
+  /**
+   * @brief copy `n` bytes at `index` of the unread bytes of `reader` to `out`
+   */
+  static bool CopyAt(const BufferReader& reader, std::size_t index, void* out, std::size_t n);
+
+ private:
+  std::size_t max_frame_size_ = kDefaultMaxFrameSize;
+  bool        broken_ = false;
+};
+
+/**
+ * @brief frames with a length field in a fixed size header.
+ *
+ * the length field is `length_size`(1, 2, 4 or 8) bytes at `length_offset`, in `endian` order.
+ *
+ * the frame is `length_offset + length_size + length + length_adjust` bytes, `length_adjust` is
+ *
+ * e.g. negative if the length counts the header too. the first `strip` bytes are not emitted.
+ *
+ * the header is parsed once per frame.
+ */
+class LengthFieldDecoder : public FrameDecoder {
+ public:
+  LengthFieldDecoder(std::size_t length_offset, std::size_t length_size,
+                     arch::ArchType endian = arch::ArchType::kBig, int64_t length_adjust = 0,
+                     std::size_t strip = 0, Object* parent = nullptr);
+
+ protected:
+  bool NextFrame(const BufferReader& reader, Frame* frame, ErrorCode* ec) override;
+
+  void ResetScan() override;
+
+ private:
+  uint64_t ReadLength(const BufferReader& reader) const;
+
+  std::size_t    length_offset_;
+  std::size_t    length_size_;
+  arch::ArchType endian_;
+  int64_t        length_adjust_;
+  std::size_t    strip_;
+  /// size of the frame whose header is parsed, 0 if none
+  std::size_t    frame_size_ = 0;
+};
+
+/**
+ * @brief frames which end with `delimiter`, e.g. "\r\n". the delimiter is not emitted if
+ *
+ * `strip_delimiter`. the first byte of the delimiter is searched with memchr.
+ */
+class DelimiterDecoder : public FrameDecoder {
+ public:
+  explicit DelimiterDecoder(std::string delimiter, bool strip_delimiter = true,
+                            Object* parent = nullptr);
+
+ protected:
+  bool NextFrame(const BufferReader& reader, Frame* frame, ErrorCode* ec) override;
+
+  void ResetScan() override;
+
+ private:
+  bool MatchAt(const BufferReader& reader, std::size_t index) const;
+
+  std::string delimiter_;
+  bool        strip_delimiter_;
+  /// the delimiter does not start before this index of the unread bytes
+  std::size_t scanned_ = 0;
+};
+
+/**
+ * @brief frames of `size` bytes
+ */
+class FixedSizeDecoder : public FrameDecoder {
+ public:
+  explicit FixedSizeDecoder(std::size_t size, Object* parent = nullptr);
+
+ protected:
+  bool NextFrame(const BufferReader& reader, Frame* frame, ErrorCode* ec) override;
+
+  void ResetScan() override;
+
+ private:
+  std::size_t size_;
+};
+
+}  // namespace io
+}  // namespace spiderweb
+
+#endif
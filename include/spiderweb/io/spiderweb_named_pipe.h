@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <system_error>
 
 #include "spiderweb/core/spiderweb_notify.h"
@@ -28,16 +29,104 @@ class NamedPipe : public Object {
 
   void Write(const std::vector<uint8_t>& data);
 
+  /**
+   * @brief WriteBufferFull is emitted when the bytes waiting to be written reach `high`, and
+   *
+   * WriteBufferDrained when they fall to `low` again. `high` 0 means no limit, the default.
+   *
+   * see io::PauseReadingWhenFull, to stop reading a partner stream meanwhile.
+   */
+  void SetWriteBufferWatermarks(std::size_t high, std::size_t low);
+
+  /**
+   * @brief bytes waiting to be written
+   */
+  std::size_t WriteBufferSize() const;
+
+  /**
+   * @brief stop reading until ResumeReading, calls are counted. a read which is in progress still
+   *
+   * completes, and its data is delivered by BytesRead.
+   */
+  void PauseReading();
+
+  /**
+   * @brief balances one PauseReading, reading restarts when every one of them is balanced.
+   */
+  void ResumeReading();
+
+  /**
+   * @brief restarts reading which stopped at the max read buffer size, once the user has read
+   *
+   * enough of the buffered data. the PauseReading calls are not touched, a paused stream stays
+   *
+   * paused.
+   */
+  void ContinueReading();
+
+  bool IsReadingPaused() const;
+
+  /**
+   * @brief stop reading while `size` bytes received are not read by the user yet, so the kernel
+   *
+   * socket buffer fills and the peer is slowed down, instead of our heap growing. call
+   *
+   * ContinueReading after reading from the buffer. 0 means no limit, the default.
+   */
+  void SetMaxReadBufferSize(std::size_t size);
+
+  /**
+   * @brief bytes received but not read by the user yet
+   */
+  std::size_t ReadBufferSize() const;
+
+  /**
+   * @brief after a read which filled the buffer, keep reading the pipe without blocking until it
+   *
+   * is empty, and emit BytesRead once for all of it. fewer, bigger BytesRead for bulk transfers.
+   *
+   * default false.
+   */
+  void SetDrainReads(bool flag);
+
   Notify<> OpenSuccess;
 
   Notify<const std::error_code&> OpenError;
 
+  /**
+   * @brief the native handle of the stream, e.g. for io::StreamForwarder
+   */
+  int NativeHandle() const;
+
+  /**
+   * @brief stop reading for good, `released` is called once no read is in progress, the bytes
+   *
+   * received and not read yet are delivered by BytesRead before. the native handle is then read
+   *
+   * by someone else, see io::StreamForwarder.
+   *
+   * the read in progress completes first, when the stream has data, ends or fails. its error is
+   *
+   * not reported by Error, but passed to `released`, its end is left to the new reader.
+   */
+  void ReleaseReading(std::function<void(const std::error_code&)> released);
+
   Notify<const std::error_code&> Error;
 
   Notify<const io::BufferReader&> BytesRead;
 
   Notify<std::size_t> BytesWritten;
 
+  /**
+   * @brief the bytes waiting to be written reached the high watermark
+   */
+  Notify<std::size_t> WriteBufferFull;
+
+  /**
+   * @brief the bytes waiting to be written fell to the low watermark
+   */
+  Notify<> WriteBufferDrained;
+
  private:
   std::shared_ptr<io::IoPrivate<Private>> d;
 };
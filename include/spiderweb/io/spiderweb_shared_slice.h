@@ -0,0 +1,84 @@
+#ifndef SPIDERWEB_IO_SHARED_SLICE_H
+#define SPIDERWEB_IO_SHARED_SLICE_H
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace spiderweb {
+namespace io {
+
+/**
+ * @brief a read only view of bytes, which keeps the memory it views alive.
+ *
+ * copying a slice only copies a shared_ptr, so one payload can be written to many streams, or a
+ *
+ * part of it, without copying the bytes.
+ *
+ * @example
+ *  auto frame = std::make_shared<const std::vector<uint8_t>>(BuildFrame());
+ *  for (auto* socket : sockets) {
+ *    socket->Write(io::SharedSlice(frame));
+ *  }
+ */
+class SharedSlice {
+ public:
+  SharedSlice() = default;
+
+  /**
+   * @brief takes the ownership of `data`, the bytes are not copied
+   */
+  explicit SharedSlice(std::vector<uint8_t>&& data)
+      : SharedSlice(std::make_shared<const std::vector<uint8_t>>(std::move(data))) {
+  }
+
+  explicit SharedSlice(std::shared_ptr<const std::vector<uint8_t>> data)
+      : data_(data ? data->data() : nullptr),
+        size_(data ? data->size() : 0),
+        owner_(std::move(data)) {
+  }
+
+  /**
+   * @brief `size` bytes at `data`, which are kept alive by `owner`
+   */
+  SharedSlice(std::shared_ptr<const void> owner, const uint8_t* data, std::size_t size)
+      : data_(data), size_(size), owner_(std::move(owner)) {
+  }
+
+  const uint8_t* data() const {
+    return data_;
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  /**
+   * @brief a slice of this slice, sharing the same owner
+   */
+  SharedSlice Slice(std::size_t offset, std::size_t size) const {
+    assert(offset + size <= size_);
+    return SharedSlice(owner_, data_ + offset, size);
+  }
+
+  void RemovePrefix(std::size_t n) {
+    assert(n <= size_);
+    data_ += n;
+    size_ -= n;
+  }
+
+ private:
+  const uint8_t*              data_ = nullptr;
+  std::size_t                 size_ = 0;
+  std::shared_ptr<const void> owner_;
+};
+
+}  // namespace io
+}  // namespace spiderweb
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef SPIDERWEB_IO_SHM_CHANNEL_H
+#define SPIDERWEB_IO_SHM_CHANNEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <system_error>
+#include <vector>
+
+#include "spiderweb/core/spiderweb_error_code.h"
+#include "spiderweb/core/spiderweb_notify.h"
+#include "spiderweb/core/spiderweb_object.h"
+#include "spiderweb/io/spiderweb_buffer.h"
+#include "spiderweb/io/spiderweb_shared_slice.h"
+
+namespace spiderweb {
+namespace io {
+
+/**
+ * @brief a byte stream between two processes of the same host, through shared memory(linux).
+ *
+ * the memory is a memfd of two single producer, single consumer rings, one per direction. a write
+ *
+ * copies the bytes into the ring, and the peer copies them out into its read buffer, no syscall
+ *
+ * moves them. the sides wake each other with an eventfd, only when the other one waits: for data,
+ *
+ * or for space in a full ring.
+ *
+ * one side creates the channel, and passes PeerFds to the other process, e.g. with
+ *
+ * net::UdsSocket::WriteWithFds, which attaches with them.
+ *
+ * the signals are the ones of the streams, BytesRead, BytesWritten and Error, so their handlers
+ *
+ * work unchanged. BytesWritten is emitted when bytes are in the ring. Close is seen by the peer as
+ *
+ * the end of the stream(eof). a peer which dies is not noticed, watch the socket which passed the
+ *
+ * descriptors for that.
+ *
+ * @example
+ *  io::ShmChannel channel;
+ *  channel.Create();
+ *  socket->WriteWithFds({'s'}, channel.PeerFds());
+ *
+ *  // the other process, in FdsReceived
+ *  channel.Attach(socket->TakeReceivedFds());
+ */
+class ShmChannel : public Object {
+ public:
+  class Private;
+
+  static constexpr std::size_t kDefaultRingSize = 4 * 1024 * 1024;
+
+  explicit ShmChannel(Object* parent = nullptr);
+
+  ~ShmChannel() override;
+
+  /**
+   * @brief create the shared memory and the eventfds, and open the channel. `ring_size` is the
+   *
+   * size of each direction, a power of two, at least 4096.
+   */
+  ErrorCode Create(std::size_t ring_size = kDefaultRingSize);
+
+  /**
+   * @brief the descriptors the peer attaches with, of a created channel. they are still owned by
+   *
+   * the channel, and valid until it is closed.
+   */
+  std::vector<int> PeerFds() const;
+
+  /**
+   * @brief open the channel created by the peer, with the descriptors of its PeerFds, in the same
+   *
+   * order. the channel takes the ownership of `fds`, also when it fails.
+   */
+  ErrorCode Attach(const std::vector<int>& fds);
+
+  /**
+   * @brief the bytes not in the ring yet are dropped, the peer reads to the end and gets eof.
+   */
+  void Close();
+
+  bool IsClosed() const;
+
+  /**
+   * @brief the bytes are queued, and copied into the ring from the loop, many writes at once.
+   *
+   * a full ring is written when the peer has read.
+   */
+  void Write(const uint8_t* data, std::size_t size);
+
+  void Write(const std::vector<uint8_t>& data);
+
+  void Write(std::vector<uint8_t>&& data);
+
+  void Write(io::SharedSlice slice);
+
+  /**
+   * @brief bytes waiting to be copied into the ring
+   */
+  std::size_t WriteBufferSize() const;
+
+  /**
+   * @brief bytes received but not read by the user yet
+   */
+  std::size_t ReadBufferSize() const;
+
+  /**
+   * @brief stop copying out of the ring while `size` bytes received are not read by the user yet,
+   *
+   * so the ring fills and the peer waits, instead of our heap growing. call ContinueReading after
+   *
+   * reading from the buffer. 0 means no limit, the default.
+   */
+  void SetMaxReadBufferSize(std::size_t size);
+
+  /**
+   * @brief restarts reading which stopped at the max read buffer size
+   */
+  void ContinueReading();
+
+  Notify<const io::BufferReader&> BytesRead;
+
+  Notify<std::size_t> BytesWritten;
+
+  /**
+   * @brief eof when the peer closed, the channel is closed then
+   */
+  Notify<const std::error_code&> Error;
+
+ private:
+  std::shared_ptr<Private> d;
+};
+
+}  // namespace io
+}  // namespace spiderweb
+
+#endif
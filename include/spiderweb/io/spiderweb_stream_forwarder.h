@@ -0,0 +1,211 @@
+#ifndef SPIDERWEB_IO_STREAM_FORWARDER_H
+#define SPIDERWEB_IO_STREAM_FORWARDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <system_error>
+
+#include "spiderweb/core/spiderweb_notify.h"
+#include "spiderweb/core/spiderweb_object.h"
+#include "spiderweb/io/spiderweb_buffer.h"
+
+namespace spiderweb {
+namespace io {
+
+/**
+ * @brief moves the bytes of a stream to another stream or a file, or of a file to a stream, in
+ *
+ * the kernel(linux): with splice through a pipe, or sendfile from a file. the bytes never pass
+ *
+ * through user space.
+ *
+ * the streams are any of TcpSocket, UdsSocket, NamedPipe, ProcessFd. the reading of the source is
+ *
+ * released for good(ReleaseReading), what it had received is forwarded by a copy first, and the
+ *
+ * forwarding starts once the write buffer of the sink is empty. the user must not write to the
+ *
+ * sink meanwhile.
+ *
+ * the sink is read no faster than it is written, so a slow sink slows the source down. at the end
+ *
+ * of the source, a socket sink is shut down for writing(half close) and Finished is emitted. an
+ *
+ * error of either side stops the forwarding and is emitted by Error.
+ *
+ * the forwarder holds dups of the native handles until it stops, so stop it before closing the
+ *
+ * streams.
+ *
+ * @example
+ *  auto* up = new io::StreamForwarder(client);
+ *  auto* down = new io::StreamForwarder(client);
+ *  up->Forward(client, upstream);
+ *  down->Forward(upstream, client);
+ */
+class StreamForwarder : public Object {
+ public:
+  class Private;
+
+  explicit StreamForwarder(Object* parent = nullptr);
+
+  ~StreamForwarder() override;
+
+  template <typename From, typename To>
+  void Forward(From* from, To* to) {
+    WatchErrors(from, to);
+    auto current = Current();
+    WhenWriteBufferEmpty(to, [this, from, to, current]() {
+      if (!current()) {
+        return;
+      }
+      Object::Connect(from, &From::BytesRead, this, [to, current](const io::BufferReader& reader) {
+        if (!current()) {
+          return;
+        }
+        reader.ForEachSegment([to](const char* data, std::size_t size) {
+          to->Write(reinterpret_cast<const uint8_t*>(data), size);
+        });
+        reader.Skip(static_cast<uint32_t>(reader.Len()));
+      });
+      from->ReleaseReading([this, from, to, current](const std::error_code& ec) {
+        if (!current()) {
+          return;
+        }
+        if (ec) {
+          Fail(ec);
+          return;
+        }
+        WhenWriteBufferEmpty(to, [this, from, to, current]() {
+          if (current()) {
+            Start(from->NativeHandle(), to->NativeHandle());
+          }
+        });
+      });
+    });
+  }
+
+  /**
+   * @brief send `count` bytes of the file at `path` from `offset` to `to`, with sendfile. `count`
+   *
+   * 0 means to the end of the file.
+   */
+  template <typename To>
+  void SendFile(const std::string& path, To* to, uint64_t offset = 0, uint64_t count = 0) {
+    WatchErrors(to, to);
+    auto current = Current();
+    WhenWriteBufferEmpty(to, [this, path, to, offset, count, current]() {
+      if (current()) {
+        StartSendFile(path, offset, count, to->NativeHandle());
+      }
+    });
+  }
+
+  /**
+   * @brief write what `from` reads to the file at `path`, which is created or truncated
+   */
+  template <typename From>
+  void ReceiveFile(From* from, const std::string& path) {
+    WatchErrors(from, from);
+    Object::Connect(from, &From::BytesRead, this, [this](const io::BufferReader& reader) {
+      reader.ForEachSegment([this](const char* data, std::size_t size) { WriteFile(data, size); });
+      reader.Skip(static_cast<uint32_t>(reader.Len()));
+    });
+    if (!OpenFile(path)) {
+      return;
+    }
+    auto current = Current();
+    from->ReleaseReading([this, from, current](const std::error_code& ec) {
+      if (!current()) {
+        return;
+      }
+      if (ec) {
+        Fail(ec);
+        return;
+      }
+      Start(from->NativeHandle(), -1);
+    });
+  }
+
+  /**
+   * @brief stop forwarding and release the handles, nothing is emitted any more
+   */
+  void Stop();
+
+  bool IsForwarding() const;
+
+  /**
+   * @brief bytes forwarded in the kernel, the ones forwarded by a copy before are not counted
+   */
+  uint64_t BytesForwardedTotal() const;
+
+  Notify<std::size_t> BytesForwarded;
+
+  /**
+   * @brief the end of the source, all of it is forwarded
+   */
+  Notify<> Finished;
+
+  Notify<const std::error_code&> Error;
+
+ private:
+  template <typename From, typename To>
+  void WatchErrors(From* from, To* to) {
+    Object::Connect(from, &From::Error, this, &StreamForwarder::Fail);
+    if (static_cast<void*>(from) != static_cast<void*>(to)) {
+      Object::Connect(to, &To::Error, this, &StreamForwarder::Fail);
+    }
+  }
+
+  /**
+   * @brief true until the forwarder is stopped or destroyed. the callbacks of the streams, which
+   *
+   * may come after, check it not to undo a Stop.
+   */
+  std::function<bool()> Current() const;
+
+  /**
+   * @brief `f` is called once the bytes waiting to be written to `to` are written, the slot is
+   *
+   * disconnected then.
+   */
+  template <typename To, typename F>
+  void WhenWriteBufferEmpty(To* to, F&& f) {
+    if (to->WriteBufferSize() == 0) {
+      f();
+      return;
+    }
+
+    auto connection = std::make_shared<Connection>();
+    *connection = Object::Connect(to, &To::BytesWritten, this,
+                                  [to, connection, f](std::size_t /*size*/) mutable {
+                                    if (to->WriteBufferSize() == 0) {
+                                      connection->Disconnect();
+                                      f();
+                                    }
+                                  });
+  }
+
+  /**
+   * @brief forward `from_fd` to `to_fd` in the kernel, -1 is the file opened by OpenFile
+   */
+  void Start(int from_fd, int to_fd);
+
+  void StartSendFile(const std::string& path, uint64_t offset, uint64_t count, int to_fd);
+
+  bool OpenFile(const std::string& path);
+
+  void WriteFile(const char* data, std::size_t size);
+
+  void Fail(const std::error_code& ec);
+
+  std::shared_ptr<Private> d;
+};
+
+}  // namespace io
+}  // namespace spiderweb
+
+#endif
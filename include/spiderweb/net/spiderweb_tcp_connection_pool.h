@@ -0,0 +1,135 @@
+#ifndef SPIDERWEB_NET_TCP_CONNECTION_POOL_H
+#define SPIDERWEB_NET_TCP_CONNECTION_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "spiderweb/core/spiderweb_notify.h"
+#include "spiderweb/core/spiderweb_object.h"
+#include "spiderweb/net/spiderweb_endpoint.h"
+#include "spiderweb/net/spiderweb_tcp_socket.h"
+
+namespace spiderweb {
+namespace net {
+
+/**
+ * @brief connected TcpSockets kept per endpoint, so that a request does not pay a handshake.
+ *
+ * a connection is leased, used, and returned. returned connections stay idle, at most max_idle
+ *
+ * per endpoint, and the ones idle longer than idle_timeout_ms are closed, down to min_idle.
+ *
+ * an idle connection which ends, fails or receives anything is dropped(health check), and the
+ *
+ * pool connects again in the background to keep min_idle. failed connects are retried with
+ *
+ * exponential backoff, meanwhile the leases which no idle connection serves fail at once.
+ *
+ * an endpoint can have many addresses(e.g. the ipv6 and ipv4 ones of a host), they are raced as
+ *
+ * happy eyeballs(rfc 8305): the next address is tried every happy_eyeballs_delay_ms, or when the
+ *
+ * previous one fails, the first connected wins. the address which won last is tried first.
+ *
+ * all deadlines of the pool are run by a single timer.
+ *
+ * @note the sockets are owned by the pool, never delete a leased socket, return it. disconnect
+ *
+ * your slots from it before, and return it with nothing left to read or write.
+ */
+class TcpConnectionPool : public Object {
+ public:
+  struct Options {
+    /// connections kept idle per endpoint, connected in the background
+    std::size_t min_idle = 0;
+    /// returned connections beyond are closed
+    std::size_t max_idle = 8;
+    /// leased, idle and connecting per endpoint, the leases beyond wait. 0 means no limit
+    std::size_t max_connections = 0;
+    uint32_t    idle_timeout_ms = 60 * 1000;
+    uint32_t    connect_timeout_ms = 3000;
+    /// a lease which waits longer fails with Timeout
+    uint32_t    lease_timeout_ms = 5000;
+    uint32_t    backoff_initial_ms = 100;
+    uint32_t    backoff_max_ms = 30 * 1000;
+    uint32_t    happy_eyeballs_delay_ms = 250;
+    /// bind the connections to this local ip, empty means any
+    std::string local_ip;
+    bool        no_delay = true;
+  };
+
+  /**
+   * @brief `socket` is null if `ec` is set
+   */
+  using LeaseHandler = std::function<void(const std::error_code& ec, TcpSocket* socket)>;
+
+  explicit TcpConnectionPool(Object* parent = nullptr);
+
+  /**
+   * @brief the waiting leases fail with Canceled, every connection is closed. the leased ones are
+   *
+   * closed and deleted later too, do not use them after.
+   */
+  ~TcpConnectionPool() override;
+
+  /**
+   * @brief must be called before the first lease
+   */
+  void SetOptions(const Options& options);
+
+  const Options& GetOptions() const;
+
+  /**
+   * @brief `handler` is called with a connection to `endpoint`, maybe before Lease returns if an
+   *
+   * idle one is there.
+   */
+  void Lease(const EndPoint& endpoint, LeaseHandler handler);
+
+  /**
+   * @brief the addresses of one endpoint, raced as happy eyeballs. they are the key of the
+   *
+   * endpoint in the pool, so pass them the same way each time.
+   */
+  void Lease(const std::vector<EndPoint>& addresses, LeaseHandler handler);
+
+  /**
+   * @brief give `socket` back, a closed or dirty one is dropped
+   */
+  void Return(TcpSocket* socket);
+
+  /**
+   * @brief connect min_idle connections to `addresses` before they are leased
+   */
+  void Prepare(const std::vector<EndPoint>& addresses);
+
+  std::size_t IdleCount(const std::vector<EndPoint>& addresses) const;
+
+  std::size_t LeasedCount(const std::vector<EndPoint>& addresses) const;
+
+  /**
+   * @brief close every connection, the waiting leases fail with Canceled. the leased connections
+   *
+   * are closed when returned.
+   */
+  void Clear();
+
+  /**
+   * @brief a connect to one of the addresses of an endpoint failed
+   */
+  Notify<const EndPoint&, const std::error_code&> ConnectError;
+
+ private:
+  class Private;
+  std::shared_ptr<Private> d;
+};
+
+}  // namespace net
+}  // namespace spiderweb
+
+#endif
@@ -6,6 +6,8 @@
 #include "spiderweb/core/spiderweb_object.h"
 
 namespace spiderweb {
+class EventLoopGroup;
+
 namespace net {
 class TcpSocket;
 class TcpServer : public Object {
@@ -19,6 +21,35 @@ class TcpServer : public Object {
 
   void Stop();
 
+  /**
+   * @brief the port which is listened on, the one chosen by the system when the server was
+   *
+   * created with port 0. sharded listening binds the port it was created with.
+   */
+  uint16_t ListenPort() const;
+
+  /**
+   * @brief place accepted connections on the loops of `group` instead of the loop of the server.
+   *
+   * must be called before ListenAndServ. InComingConnection is still emitted in the thread of the
+   *
+   * server, while the new socket lives in a loop of `group`: the slot must hop to
+   *
+   * socket->ownerEventLoop() before touching the socket, e.g. to connect its signals. the socket
+   *
+   * starts reading after the tasks the slot queued there, so they see every byte.
+   */
+  void SetEventLoopGroup(EventLoopGroup* group);
+
+  /**
+   * @brief if set true, every loop of the event loop group listens with its own acceptor, which
+   *
+   * binds the port with SO_REUSEPORT, the kernel then load balances the connections between them.
+   *
+   * needs SetEventLoopGroup, must be called before ListenAndServ.
+   */
+  void SetShardedListen(bool flag);
+
   Notify<TcpSocket*> InComingConnection;
 
   Notify<ErrorCode> Stopped;
@@ -1,12 +1,14 @@
 #ifndef SPIDER_WEB_TCP_SOCKET_H
 #define SPIDER_WEB_TCP_SOCKET_H
 
+#include <functional>
 #include <system_error>
 
 #include "spiderweb/core/spiderweb_error_code.h"
 #include "spiderweb/core/spiderweb_notify.h"
 #include "spiderweb/core/spiderweb_object.h"
 #include "spiderweb/io/spiderweb_buffer.h"
+#include "spiderweb/io/spiderweb_shared_slice.h"
 
 namespace spiderweb {
 
@@ -50,16 +52,120 @@ class TcpSocket : public Object {
   /**
    * @brief Write something to the remote peer.
    *
-   * Note that the write is asynchronous though. But it does not support multiple calls to write.
+   * the write is asynchronous, and Write can be called again before the former writes complete:
    *
-   * When you initiate a write call, it is not allowed to write again until the write operation is
-   *
-   * completed(see BytesWritten). The behavior of multiple writes is undefined.
+   * the data is queued and sent in order. BytesWritten reports the bytes of each completed write.
    */
   void Write(const uint8_t* data, std::size_t size);
 
   void Write(const std::vector<uint8_t>& data);
 
+  /**
+   * @brief write without copying, the socket takes the ownership of `data`.
+   *
+   * queued buffers are written together with a single gathered(writev) write, so large payloads
+   *
+   * are never copied into the send buffer.
+   */
+  void Write(std::vector<uint8_t>&& data);
+
+  void Write(io::SharedSlice slice);
+
+  /**
+   * @brief WriteBufferFull is emitted when the bytes waiting to be written reach `high`, and
+   *
+   * WriteBufferDrained when they fall to `low` again. `high` 0 means no limit, the default.
+   *
+   * see io::PauseReadingWhenFull, to stop reading a partner stream meanwhile.
+   */
+  void SetWriteBufferWatermarks(std::size_t high, std::size_t low);
+
+  /**
+   * @brief bytes waiting to be written
+   */
+  std::size_t WriteBufferSize() const;
+
+  /**
+   * @brief stop reading until ResumeReading, calls are counted. a read which is in progress still
+   *
+   * completes, and its data is delivered by BytesRead.
+   */
+  void PauseReading();
+
+  /**
+   * @brief balances one PauseReading, reading restarts when every one of them is balanced.
+   */
+  void ResumeReading();
+
+  /**
+   * @brief restarts reading which stopped at the max read buffer size, once the user has read
+   *
+   * enough of the buffered data. the PauseReading calls are not touched, a paused stream stays
+   *
+   * paused.
+   */
+  void ContinueReading();
+
+  bool IsReadingPaused() const;
+
+  /**
+   * @brief stop reading while `size` bytes received are not read by the user yet, so the kernel
+   *
+   * socket buffer fills and the peer is slowed down, instead of our heap growing. call
+   *
+   * ContinueReading after reading from the buffer. 0 means no limit, the default.
+   */
+  void SetMaxReadBufferSize(std::size_t size);
+
+  /**
+   * @brief bytes received but not read by the user yet
+   */
+  std::size_t ReadBufferSize() const;
+
+  /**
+   * @brief after a read which filled the buffer, keep reading the socket without blocking until it
+   *
+   * is empty, and emit BytesRead once for all of it. fewer, bigger BytesRead for bulk transfers.
+   *
+   * default false.
+   */
+  void SetDrainReads(bool flag);
+
+  /**
+   * @brief writes of at least `threshold` bytes are sent with MSG_ZEROCOPY(linux 4.14), the
+   *
+   * kernel sends from the buffers queued instead of copying them. the buffers(e.g. the ones of
+   *
+   * Write(std::vector<uint8_t>&&) or Write(io::SharedSlice)) are released only when the kernel
+   *
+   * reports it is done with them. BytesWritten is emitted as before, once all of a write is sent.
+   *
+   * it pays off for big writes only, and not on loopback, where the kernel copies anyway. the
+   *
+   * socket falls back to copying, and SetOptionError is emitted, if the kernel does not support it.
+   *
+   * 0 turns it off, the default.
+   */
+  void SetZeroCopyThreshold(std::size_t threshold);
+
+  /**
+   * @brief the native handle of the stream, e.g. for io::StreamForwarder
+   */
+  int NativeHandle() const;
+
+  /**
+   * @brief stop reading for good, `released` is called once no read is in progress, the bytes
+   *
+   * received and not read yet are delivered by BytesRead before. the native handle is then read
+   *
+   * by someone else, see io::StreamForwarder.
+   *
+   * the read in progress completes first, when the stream has data, ends or fails. its error is
+   *
+   * not reported by Error, but passed to `released`, its end is left to the new reader.
+   */
+  void ReleaseReading(std::function<void(const std::error_code&)> released);
+
   Notify<> ConnectionEstablished;
 
   Notify<const std::error_code&> ConnectError;
@@ -72,6 +178,16 @@ class TcpSocket : public Object {
 
   Notify<std::size_t> BytesWritten;
 
+  /**
+   * @brief the bytes waiting to be written reached the high watermark
+   */
+  Notify<std::size_t> WriteBufferFull;
+
+  /**
+   * @brief the bytes waiting to be written fell to the low watermark
+   */
+  Notify<> WriteBufferDrained;
+
   /**
    * @brief when enable reconnect, if the connection is lost,
    *
@@ -1,12 +1,18 @@
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <system_error>
+#include <utility>
 #include <vector>
 
+#include "absl/types/span.h"
 #include "spiderweb/core/spiderweb_error_code.h"
 #include "spiderweb/core/spiderweb_notify.h"
 #include "spiderweb/core/spiderweb_object.h"
+#include "spiderweb/io/spiderweb_shared_slice.h"
 #include "spiderweb/net/spiderweb_endpoint.h"
 
 namespace spiderweb {
@@ -28,21 +34,61 @@ class Datagram {
     return endpoint_;
   }
 
+  /**
+   * @brief the datagrams of DatagramBatchArrived view the receive pool, they are read without
+   *
+   * copying by Bytes(), Data() of such a const datagram is empty. the non const overload copies
+   *
+   * the bytes out of the pool on the first call.
+   */
   inline const std::vector<uint8_t>& Data() const {
     return data_;
   }
 
   inline std::vector<uint8_t>& Data() {
+    Materialize();
     return data_;
   }
 
+  inline absl::Span<const uint8_t> Bytes() const {
+    if (!slice_.empty()) {
+      return absl::Span<const uint8_t>(slice_.data(), slice_.size());
+    }
+    return absl::Span<const uint8_t>(data_.data(), data_.size());
+  }
+
+  /**
+   * @brief when the kernel received the datagram(CLOCK_REALTIME, since the epoch), only with
+   *
+   * UdpSocket::SetReceiveTimestamps, 0 otherwise.
+   */
+  inline std::chrono::nanoseconds TimeStamp() const {
+    return timestamp_;
+  }
+
  private:
-  Datagram(const EndPoint& endpoint, const uint8_t* data, std::size_t size)
-      : endpoint_(endpoint), data_(data, data + size) {
+  Datagram(const EndPoint& endpoint, const uint8_t* data, std::size_t size,
+           std::chrono::nanoseconds timestamp = std::chrono::nanoseconds(0))
+      : endpoint_(endpoint), data_(data, data + size), timestamp_(timestamp) {
+  }
+
+  Datagram(const EndPoint& endpoint, io::SharedSlice slice,
+           std::chrono::nanoseconds timestamp = std::chrono::nanoseconds(0))
+      : endpoint_(endpoint), slice_(std::move(slice)), timestamp_(timestamp) {
+  }
+
+  inline void Materialize() {
+    if (!slice_.empty()) {
+      data_.assign(slice_.data(), slice_.data() + slice_.size());
+      slice_ = io::SharedSlice();
+    }
   }
 
-  EndPoint             endpoint_;
-  std::vector<uint8_t> data_;
+  EndPoint                     endpoint_;
+  std::vector<uint8_t>     data_;
+  /// the bytes in the receive pool, if not empty
+  io::SharedSlice          slice_;
+  std::chrono::nanoseconds timestamp_{0};
 
   friend class UdpSocket;
 };
@@ -51,12 +97,24 @@ class UdpSocket : public Object {
  public:
   class Private;
 
+  enum class Protocol : uint8_t { kIpv4, kIpv6 };
+
   explicit UdpSocket(Object* parent = nullptr);
 
   ~UdpSocket() override;
 
+  /**
+   * @brief open an ipv4 socket
+   */
   void Open(spiderweb::ErrorCode& ec);
 
+  /**
+   * @brief an ipv6 socket also receives ipv4 datagrams(as v4 mapped addresses), unless the
+   *
+   * system sets IPV6_V6ONLY by default.
+   */
+  void Open(Protocol protocol, spiderweb::ErrorCode& ec);
+
   bool IsOpen() const;
 
   void Close();
@@ -65,12 +123,132 @@ class UdpSocket : public Object {
 
   void SendTo(const EndPoint& endpoint, const uint8_t* data, std::size_t size);
 
+  /**
+   * @brief takes the ownership of `data`, so it is not copied
+   */
+  void SendTo(const EndPoint& endpoint, std::vector<uint8_t>&& data);
+
+  /**
+   * @brief `data` is kept alive until it is sent, e.g. one payload sent to many endpoints
+   */
+  void SendTo(const EndPoint& endpoint, io::SharedSlice data);
+
+  /**
+   * @brief queue the datagrams sent in one loop iteration, and flush them by sendmmsg(linux),
+   *
+   * BytesWritten is then emitted once per flush, with the bytes of all the datagrams sent.
+   *
+   * default false.
+   */
+  void SetBatchSend(bool flag);
+
+  /**
+   * @brief with SetBatchSend, consecutive datagrams of the same size to the same endpoint are
+   *
+   * sent as one message with UDP_SEGMENT(GSO, linux 4.18), so the stack is walked once for up to
+   *
+   * 64 datagrams. turned off by itself if the kernel does not support it. default false.
+   */
+  void SetSegmentOffload(bool flag);
+
+  /**
+   * @brief receive up to `batch` datagrams per wakeup(recvmmsg on linux), into the slots of a
+   *
+   * preallocated pool, each slot is `max_datagram_size` bytes, longer datagrams are truncated.
+   *
+   * a batch is emitted by DatagramBatchArrived, its datagrams view the pool without copying, a
+   *
+   * pool block is reused once no datagram of it is alive. then each datagram is copied out of the
+   *
+   * pool and emitted by DatagramArrived. `batch` 1 turns it off, the default.
+   */
+  void SetBatchReceive(std::size_t batch, std::size_t max_datagram_size = 65535);
+
+  /**
+   * @brief the options below need an opened socket. SO_REUSEADDR and SO_REUSEPORT must be set
+   *
+   * before Bind, e.g. for several receivers of the same multicast port.
+   */
+  void SetReuseAddress(bool flag, spiderweb::ErrorCode& ec);
+
+  void SetReusePort(bool flag, spiderweb::ErrorCode& ec);
+
+  /**
+   * @brief SO_RCVBUF and SO_SNDBUF, the kernel doubles `size` and caps it at
+   *
+   * net.core.rmem_max/wmem_max. a big receive buffer absorbs bursts of a high rate ingest.
+   */
+  void SetReceiveBufferSize(int size, spiderweb::ErrorCode& ec);
+
+  int ReceiveBufferSize(spiderweb::ErrorCode& ec) const;
+
+  void SetSendBufferSize(int size, spiderweb::ErrorCode& ec);
+
+  int SendBufferSize(spiderweb::ErrorCode& ec) const;
+
+  /**
+   * @brief SO_BUSY_POLL(linux), the kernel polls the device queue for up to `usec` when the
+   *
+   * socket is read and empty, which trades cpu for latency. raising it above net.core.busy_read
+   *
+   * needs CAP_NET_ADMIN.
+   */
+  void SetBusyPoll(int usec, spiderweb::ErrorCode& ec);
+
+  /**
+   * @brief SO_TIMESTAMPNS(linux), each datagram received carries the kernel receive time, see
+   *
+   * Datagram::TimeStamp. the datagrams are then received by recvmmsg, in batches of
+   *
+   * SetBatchReceive.
+   */
+  void SetReceiveTimestamps(bool flag, spiderweb::ErrorCode& ec);
+
+  /**
+   * @brief join the multicast `group`, on the interface whose address is `local`(ipv4) or
+   *
+   * whose name is `local`(ipv6, e.g. "eth0"), the default interface if empty. the socket
+   *
+   * is bound to the port of the group, e.g. Bind(EndPoint("0.0.0.0", port)).
+   */
+  void JoinMulticastGroup(const std::string& group, const std::string& local,
+                          spiderweb::ErrorCode& ec);
+
+  void LeaveMulticastGroup(const std::string& group, const std::string& local,
+                           spiderweb::ErrorCode& ec);
+
+  /**
+   * @brief the interface the multicast datagrams are sent on, its address(ipv4) or its
+   *
+   * name(ipv6), by default the one of the route to the group.
+   */
+  void SetMulticastInterface(const std::string& local, spiderweb::ErrorCode& ec);
+
+  /**
+   * @brief whether the multicast datagrams sent are looped back to the local receivers, default
+   *
+   * true.
+   */
+  void SetMulticastLoopback(bool flag, spiderweb::ErrorCode& ec);
+
+  /**
+   * @brief the ttl(ipv4) or hop limit(ipv6) of the multicast datagrams sent, default 1.
+   */
+  void SetMulticastHops(int hops, spiderweb::ErrorCode& ec);
+
   Notify<const std::error_code&> Error;
 
   Notify<std::size_t> BytesWritten;
 
   Notify<Datagram> DatagramArrived;
 
+  /**
+   * @brief only with SetBatchReceive. the span is valid only in the slot, so connect it in the
+   *
+   * thread of the socket.
+   */
+  Notify<absl::Span<const Datagram>> DatagramBatchArrived;
+
  private:
   std::shared_ptr<Private> d;
 };
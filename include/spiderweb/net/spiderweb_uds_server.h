@@ -3,10 +3,12 @@
 #include "spiderweb/core/spiderweb_error_code.h"
 #include "spiderweb/core/spiderweb_notify.h"
 #include "spiderweb/core/spiderweb_object.h"
+#include "spiderweb/net/spiderweb_uds_socket.h"
 
 namespace spiderweb {
+class EventLoopGroup;
+
 namespace net {
-class UdsSocket;
 class UdsServer : public Object {
  public:
   class Private;
@@ -18,6 +20,26 @@ class UdsServer : public Object {
 
   void Stop();
 
+  /**
+   * @brief place accepted connections on the loops of `group` instead of the loop of the server.
+   *
+   * must be called before ListenAndServ. InComingConnection is still emitted in the thread of the
+   *
+   * server, while the new socket lives in a loop of `group`: the slot must hop to
+   *
+   * socket->ownerEventLoop() before touching the socket, e.g. to connect its signals. the socket
+   *
+   * starts reading after the tasks the slot queued there, so they see every byte.
+   */
+  void SetEventLoopGroup(EventLoopGroup* group);
+
+  /**
+   * @brief listen on a SOCK_SEQPACKET socket, the accepted sockets keep the boundaries of the
+   *
+   * messages, see UdsSocket::SetSeqPacket. must be called before ListenAndServ.
+   */
+  void SetSeqPacket(bool flag, std::size_t max_message_size = UdsSocket::kDefaultMaxMessageSize);
+
   Notify<UdsSocket*> InComingConnection;
 
   Notify<ErrorCode> Stopped;
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <functional>
 #include <system_error>
+#include <vector>
 
+#include "absl/types/span.h"
+#include "spiderweb/core/spiderweb_error_code.h"
 #include "spiderweb/core/spiderweb_notify.h"
 #include "spiderweb/core/spiderweb_object.h"
 #include "spiderweb/io/spiderweb_buffer.h"
+#include "spiderweb/io/spiderweb_shared_slice.h"
 
 namespace spiderweb {
 
@@ -20,12 +25,31 @@ class UdsSocket : public Object {
  public:
   class Private;
 
+  static constexpr std::size_t kDefaultMaxMessageSize = 64 * 1024;
+
   explicit UdsSocket(Object* parent = nullptr);
 
   ~UdsSocket() override;
 
   void SetSendBufferSize(uint16_t size);
 
+  /**
+   * @brief use a SOCK_SEQPACKET socket, which keeps the boundaries of the messages, instead of a
+   *
+   * byte stream. must be called before ConnectTo, the sockets accepted by a seqpacket UdsServer
+   *
+   * are ones already.
+   *
+   * every Write is then sent as one message, and every message received is delivered by
+   *
+   * MessageRead instead of BytesRead, so no framing is needed. `max_message_size` is the size
+   *
+   * of the read buffer, a longer message fails the socket with message_size.
+   */
+  void SetSeqPacket(bool flag, std::size_t max_message_size = kDefaultMaxMessageSize);
+
+  bool IsSeqPacket() const;
+
   void ConnectTo(const std::string& uds_address);
 
   void DisConnect();
@@ -37,28 +61,159 @@ class UdsSocket : public Object {
   /**
    * @brief Write something to the remote peer.
    *
-   * Note that the write is asynchronous though. But it does not support multiple calls to write.
-   *
-   * When you initiate a write call, it is not allowed to write again until the write operation is
+   * the write is asynchronous, and Write can be called again before the former writes complete:
    *
-   * completed(see BytesWritten). The behavior of multiple writes is undefined.
+   * the data is queued and sent in order. BytesWritten reports the bytes of each completed write.
    */
   void Write(const uint8_t* data, std::size_t size);
 
   void Write(const std::vector<uint8_t>& data);
 
+  /**
+   * @brief write without copying, the socket takes the ownership of `data`.
+   *
+   * queued buffers are written together with a single gathered(writev) write, so large payloads
+   *
+   * are never copied into the send buffer.
+   */
+  void Write(std::vector<uint8_t>&& data);
+
+  void Write(io::SharedSlice slice);
+
+  /**
+   * @brief write `data` and pass `fds` along with it(SCM_RIGHTS), e.g. a memfd which holds the
+   *
+   * payload, or an accepted client socket. the peer receives them with the first byte of
+   *
+   * `data`, as new descriptors of its own, see FdsReceived.
+   *
+   * `fds` are duplicated, they are still yours. `data` must not be empty, the descriptors are
+   *
+   * sent with a byte. at most 253 fds are passed with one write, more are an InvalidArgument.
+   *
+   * @return the error of duplicating `fds`, nothing is written then
+   */
+  ErrorCode WriteWithFds(std::vector<uint8_t>&& data, const std::vector<int>& fds);
+
+  /**
+   * @brief the descriptors received and not taken yet, in the order they were sent. they are
+   *
+   * yours then, close them. the ones never taken are closed with the socket.
+   */
+  std::vector<int> TakeReceivedFds();
+
+  /**
+   * @brief WriteBufferFull is emitted when the bytes waiting to be written reach `high`, and
+   *
+   * WriteBufferDrained when they fall to `low` again. `high` 0 means no limit, the default.
+   *
+   * see io::PauseReadingWhenFull, to stop reading a partner stream meanwhile.
+   */
+  void SetWriteBufferWatermarks(std::size_t high, std::size_t low);
+
+  /**
+   * @brief bytes waiting to be written
+   */
+  std::size_t WriteBufferSize() const;
+
+  /**
+   * @brief stop reading until ResumeReading, calls are counted. a read which is in progress still
+   *
+   * completes, and its data is delivered by BytesRead.
+   */
+  void PauseReading();
+
+  /**
+   * @brief balances one PauseReading, reading restarts when every one of them is balanced.
+   */
+  void ResumeReading();
+
+  /**
+   * @brief restarts reading which stopped at the max read buffer size, once the user has read
+   *
+   * enough of the buffered data. the PauseReading calls are not touched, a paused stream stays
+   *
+   * paused.
+   */
+  void ContinueReading();
+
+  bool IsReadingPaused() const;
+
+  /**
+   * @brief stop reading while `size` bytes received are not read by the user yet, so the kernel
+   *
+   * socket buffer fills and the peer is slowed down, instead of our heap growing. call
+   *
+   * ContinueReading after reading from the buffer. 0 means no limit, the default.
+   */
+  void SetMaxReadBufferSize(std::size_t size);
+
+  /**
+   * @brief bytes received but not read by the user yet
+   */
+  std::size_t ReadBufferSize() const;
+
+  /**
+   * @brief after a read which filled the buffer, keep reading the socket without blocking until it
+   *
+   * is empty, and emit BytesRead once for all of it. fewer, bigger BytesRead for bulk transfers.
+   *
+   * default false.
+   */
+  void SetDrainReads(bool flag);
+
   Notify<> ConnectionEstablished;
 
   Notify<const std::error_code&> ConnectError;
 
+  /**
+   * @brief the native handle of the stream, e.g. for io::StreamForwarder
+   */
+  int NativeHandle() const;
+
+  /**
+   * @brief stop reading for good, `released` is called once no read is in progress, the bytes
+   *
+   * received and not read yet are delivered by BytesRead before. the native handle is then read
+   *
+   * by someone else, see io::StreamForwarder.
+   *
+   * the read in progress completes first, when the stream has data, ends or fails. its error is
+   *
+   * not reported by Error, but passed to `released`, its end is left to the new reader.
+   */
+  void ReleaseReading(std::function<void(const std::error_code&)> released);
+
   Notify<const std::error_code&> Error;
 
   Notify<const std::error_code&> SetOptionError;
 
   Notify<const io::BufferReader&> BytesRead;
 
+  /**
+   * @brief descriptors arrived, emitted before the BytesRead(or MessageRead) of the bytes they came
+   *
+   * with. the argument is the count not taken yet, see TakeReceivedFds.
+   */
+  Notify<std::size_t> FdsReceived;
+
+  /**
+   * @brief a message of a seqpacket socket, valid during the emit only
+   */
+  Notify<absl::Span<const uint8_t>> MessageRead;
+
   Notify<std::size_t> BytesWritten;
 
+  /**
+   * @brief the bytes waiting to be written reached the high watermark
+   */
+  Notify<std::size_t> WriteBufferFull;
+
+  /**
+   * @brief the bytes waiting to be written fell to the low watermark
+   */
+  Notify<> WriteBufferDrained;
+
   /**
    * @brief when enable reconnect, if the connection is lost,
    *
@@ -1,6 +1,8 @@
 #ifndef SPIDERWEB_SERIALPORT_H
 #define SPIDERWEB_SERIALPORT_H
 
+#include <chrono>
+#include <cstdint>
 #include <system_error>
 
 #include "spiderweb/core/spiderweb_object.h"
@@ -44,6 +46,23 @@ enum class Parity : uint8_t {
   kOddParity,
 };
 
+/**
+ * @brief RS-485 direction control(struct serial_rs485), the driver switches the transceiver by RTS
+ *
+ * around each send, in time, which the user can not.
+ */
+struct Rs485Options {
+  bool          enabled = true;
+  /// the RTS level while sending, and after
+  bool          rts_on_send = true;
+  bool          rts_after_send = false;
+  /// milliseconds between RTS and the first bit, and between the last bit and RTS
+  std::uint32_t delay_before_send_ms = 0;
+  std::uint32_t delay_after_send_ms = 0;
+  /// also receive what is sent
+  bool          receive_during_send = false;
+};
+
 class SerialPort final : public Object {
  public:
   class Private;
@@ -62,6 +81,20 @@ class SerialPort final : public Object {
 
   BaudRate GetBaudRate() const;
 
+  /**
+   * @brief any rate, e.g. 921600 or 3000000. on linux it is set by termios2 and BOTHER, and need
+   *
+   * not be one of the Bxxx rates, the driver picks the nearest its clock can do.
+   */
+  void SetBaudRate(std::uint32_t baudrate, std::error_code& ec);
+
+  /**
+   * @brief the rate set in the driver, also one set by SetBaudRate(std::uint32_t). 0, and `ec`
+   *
+   * set, if the driver can not tell it, e.g. the port is not open.
+   */
+  std::uint32_t GetBaudRateValue(std::error_code& ec) const;
+
   void SetDataBits(DataBits bits, std::error_code& ec);
 
   DataBits GetDataBits() const;
@@ -70,12 +103,95 @@ class SerialPort final : public Object {
 
   StopBits GetStopBits() const;
 
+  /**
+   * @brief ASYNC_LOW_LATENCY(linux), the driver hands received bytes to the tty at once, instead
+   *
+   * of batching them, e.g. 16ms by USB serial adapters. for polling loops, at some cpu cost.
+   */
+  void SetLowLatency(bool flag, std::error_code& ec);
+
+  /**
+   * @brief VMIN and VTIME of termios. the reads of the loop do not block, so with `vtime` 0 the
+   *
+   * kernel wakes it only once `vmin` bytes are received, fewer wakeups for fixed size replies.
+   *
+   * `vtime`, in tenths of a second, only bounds blocking reads, and makes every byte wake the
+   *
+   * loop. 1 and 0, asio's default, wake it for every byte.
+   */
+  void SetVminVtime(std::uint8_t vmin, std::uint8_t vtime, std::error_code& ec);
+
+  /**
+   * @brief TIOCSRS485(linux), see Rs485Options. the driver must support it.
+   */
+  void SetRs485(const Rs485Options& options, std::error_code& ec);
+
+  /**
+   * @brief BytesRead is emitted once nothing has been received for `gap` after the last byte, with
+   *
+   * everything received until then, e.g. a whole Modbus RTU frame, 3.5 characters apart. 0, the
+   *
+   * default, emits every read.
+   */
+  void SetInterByteGap(std::chrono::microseconds gap);
+
   void Close();
 
   void Write(const uint8_t* data, std::size_t size);
 
   void Write(const std::vector<uint8_t>& data);
 
+  /**
+   * @brief WriteBufferFull is emitted when the bytes waiting to be written reach `high`, and
+   *
+   * WriteBufferDrained when they fall to `low` again. `high` 0 means no limit, the default.
+   *
+   * see io::PauseReadingWhenFull, to stop reading a partner stream meanwhile.
+   */
+  void SetWriteBufferWatermarks(std::size_t high, std::size_t low);
+
+  /**
+   * @brief bytes waiting to be written
+   */
+  std::size_t WriteBufferSize() const;
+
+  /**
+   * @brief stop reading until ResumeReading, calls are counted. a read which is in progress still
+   *
+   * completes, and its data is delivered by BytesRead.
+   */
+  void PauseReading();
+
+  /**
+   * @brief balances one PauseReading, reading restarts when every one of them is balanced.
+   */
+  void ResumeReading();
+
+  /**
+   * @brief restarts reading which stopped at the max read buffer size, once the user has read
+   *
+   * enough of the buffered data. the PauseReading calls are not touched, a paused stream stays
+   *
+   * paused.
+   */
+  void ContinueReading();
+
+  bool IsReadingPaused() const;
+
+  /**
+   * @brief stop reading while `size` bytes received are not read by the user yet, so the kernel
+   *
+   * socket buffer fills and the peer is slowed down, instead of our heap growing. call
+   *
+   * ContinueReading after reading from the buffer. 0 means no limit, the default.
+   */
+  void SetMaxReadBufferSize(std::size_t size);
+
+  /**
+   * @brief bytes received but not read by the user yet
+   */
+  std::size_t ReadBufferSize() const;
+
   Notify<> OpenSuccess;
 
   Notify<const std::error_code&> OpenFailed;
@@ -86,6 +202,16 @@ class SerialPort final : public Object {
 
   Notify<std::size_t> BytesWritten;
 
+  /**
+   * @brief the bytes waiting to be written reached the high watermark
+   */
+  Notify<std::size_t> WriteBufferFull;
+
+  /**
+   * @brief the bytes waiting to be written fell to the low watermark
+   */
+  Notify<> WriteBufferDrained;
+
  private:
   std::shared_ptr<io::IoPrivate<Private>> d;
 };
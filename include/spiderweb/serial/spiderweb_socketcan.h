@@ -1,9 +1,17 @@
 #ifndef SPIDERWEB_SOCKETCAN_H
 #define SPIDERWEB_SOCKETCAN_H
 
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <system_error>
+#include <vector>
 
+#include "absl/types/span.h"
 #include "canary/frame_header.hpp"
+#include "spiderweb/core/spiderweb_error_code.h"
 #include "spiderweb/core/spiderweb_object.h"
 
 namespace spiderweb {
@@ -15,8 +23,29 @@ class IoPrivate;
 
 namespace serial {
 struct CanFrame {
-  canary::frame_header        header;
-  std::array<std::uint8_t, 8> payload{0};
+  canary::frame_header         header;
+  /// up to 8 bytes for a classic frame, 64 for a CAN FD one
+  std::array<std::uint8_t, 64> payload{0};
+  /// a CAN FD frame(struct canfd_frame), only with SocketCan::SetCanFd
+  bool                         fd = false;
+  /// CANFD_BRS, CANFD_ESI of a CAN FD frame
+  std::uint8_t                 fd_flags = 0;
+  /// the receive time of the kernel(CLOCK_REALTIME), set for the frames of FramesRead only
+  std::chrono::nanoseconds     timestamp{0};
+  /// the receive time stamped by the controller, 0 if it does not stamp in hardware
+  std::chrono::nanoseconds     hw_timestamp{0};
+};
+
+/**
+ * @brief a kernel filter(struct can_filter), a frame passes if its id & mask == id & mask.
+ *
+ * the flags of linux/can.h, CAN_EFF_FLAG and CAN_RTR_FLAG, may be part of id and mask.
+ */
+struct CanFilter {
+  std::uint32_t id = 0;
+  std::uint32_t mask = 0;
+  /// pass the frames which do not match instead(CAN_INV_FILTER)
+  bool          inverted = false;
 };
 
 enum class SocketCanType : uint8_t { kRaw, kIsotp };
@@ -31,8 +60,52 @@ class SocketCan final : public Object {
 
   void Open(const std::string& can, SocketCanType type);
 
+  /**
+   * @brief read up to `max_frames` frames per wakeup with one recvmmsg, and emit them together
+   *
+   * by FramesRead instead of FrameRead, with their kernel receive timestamps(SO_TIMESTAMPING).
+   *
+   * for a raw socket only, must be called before Open. 0 turns it off, the default.
+   */
+  void SetBatchedRead(std::size_t max_frames);
+
+  /**
+   * @brief CAN_RAW_FILTER, the kernel drops the frames which pass none of `filters`, before they
+   *
+   * wake us. empty is the default, at Open as later: every frame passes but the remote frames of
+   *
+   * extended ids. for a raw socket, kept for Open, and applied at once if open.
+   */
+  void SetFilters(std::vector<CanFilter> filters, ErrorCode& ec);
+
+  /**
+   * @brief CAN_RAW_ERR_FILTER, the error frames(CAN_ERR_* of linux/can/error.h) to receive, none
+   *
+   * by default. they are read as frames with CAN_ERR_FLAG.
+   */
+  void SetErrorMask(std::uint32_t mask, ErrorCode& ec);
+
+  /**
+   * @brief CAN_RAW_FD_FRAMES, read and write CAN FD frames besides the classic ones. for a raw
+   *
+   * socket on a CAN FD interface, must be called before Open.
+   */
+  void SetCanFd(bool flag);
+
+  using FrameHandler = std::function<void(const CanFrame& frame)>;
+
+  /**
+   * @brief the frames of `id`(header.id()) are passed to `handler` directly, and not emitted by
+   *
+   * FrameRead or FramesRead. an empty handler removes the one of `id`.
+   */
+  void SetFrameHandler(std::uint32_t id, FrameHandler handler);
+
   void Close();
 
+  /**
+   * @brief one frame per send, a CAN FD frame needs SetCanFd
+   */
   void Write(const CanFrame& frame);
 
   Notify<> OpenSuccess;
@@ -43,6 +116,11 @@ class SocketCan final : public Object {
 
   Notify<const CanFrame&> FrameRead;
 
+  /**
+   * @brief the frames of one wakeup in batched mode, see SetBatchedRead. valid during the emit
+   */
+  Notify<absl::Span<const CanFrame>> FramesRead;
+
   Notify<std::size_t> BytesWritten;
 
  private:
@@ -0,0 +1,84 @@
+#ifndef INTERNAL_TIMER_POOL_H
+#define INTERNAL_TIMER_POOL_H
+
+#include <deque>
+#include <vector>
+
+#include "asio/io_service.hpp"
+#include "asio/steady_timer.hpp"
+#include "core/internal/timer_wheel.h"
+#include "spiderweb/core/spiderweb_object.h"
+#include "spiderweb/core/spiderweb_timer_handle.h"
+
+namespace spiderweb {
+
+/**
+ * @brief the timers of Object::RunAfter, owned by an EventLoop.
+ *
+ * slots(and their asio timers) are reused, so scheduling a task allocates nothing but what the
+ * task itself needs. a slot carries a generation, bumped when it is released, so that stale
+ * TimerHandles and late completions of a reused asio timer are recognized.
+ *
+ * not thread safe, used in the thread of the loop.
+ */
+class TimerPool {
+ public:
+  TimerPool(asio::io_service& io, TimerWheel& wheel);
+
+  TimerPool(const TimerPool&) = delete;
+
+  TimerPool& operator=(const TimerPool&) = delete;
+
+  TimerHandle Schedule(uint64_t delay_ms, Task&& f, TimerType type);
+
+  bool IsActive(uint32_t index, uint32_t generation) const;
+
+  void Cancel(uint32_t index, uint32_t generation);
+
+  bool Reschedule(uint32_t index, uint32_t generation, uint64_t delay_ms);
+
+  std::size_t ActiveCount() const {
+    return slots_.size() - free_.size();
+  }
+
+ private:
+  class Slot : public TimerWheel::Entry {
+   public:
+    Slot(asio::io_service& io, TimerPool* p, uint32_t i) : timer(io), pool(p), index(i) {
+    }
+
+    asio::steady_timer timer;
+    Task               task;
+    TimerPool*         pool = nullptr;
+    uint32_t           index = 0;
+    uint32_t           generation = 0;
+    /// bumped on every arming, a completion of an older arming is ignored
+    uint32_t           armed = 0;
+    TimerType          type = TimerType::kPrecise;
+    bool               active = false;
+
+   protected:
+    void OnExpired() override {
+      pool->Fire(index, generation, armed);
+    }
+  };
+
+  Slot* Find(uint32_t index, uint32_t generation);
+
+  void Arm(Slot& slot, uint64_t delay_ms);
+
+  void Disarm(Slot& slot);
+
+  void Fire(uint32_t index, uint32_t generation, uint32_t armed);
+
+  void Release(Slot& slot);
+
+  asio::io_service&     io_;
+  TimerWheel&           wheel_;
+  std::deque<Slot>      slots_;
+  std::vector<uint32_t> free_;
+};
+
+}  // namespace spiderweb
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef INTERNAL_TIMER_WHEEL_H
+#define INTERNAL_TIMER_WHEEL_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "asio/io_service.hpp"
+#include "asio/steady_timer.hpp"
+
+namespace spiderweb {
+
+/**
+ * @brief a hashed timing wheel, driven by one asio::steady_timer.
+ *
+ * Add/Remove are O(1), the price is the resolution, an entry expires at a tick boundary, at
+ * most one tick later than asked. the asio timer is only armed while there are entries.
+ *
+ * not thread safe, it is owned by an EventLoop and used in the thread of that loop.
+ */
+class TimerWheel {
+  struct Link {
+    Link* prev = this;
+    Link* next = this;
+
+    bool Linked() const {
+      return next != this;
+    }
+
+    void Unlink() {
+      prev->next = next;
+      next->prev = prev;
+      prev = next = this;
+    }
+
+    void PushBack(Link* link) {
+      link->prev = prev;
+      link->next = this;
+      prev->next = link;
+      prev = link;
+    }
+  };
+
+ public:
+  static constexpr uint32_t    kTickMs = 10;
+  static constexpr std::size_t kSlots = 512;
+
+  class Entry : private Link {
+   public:
+    Entry() = default;
+
+    Entry(const Entry&) = delete;
+
+    Entry& operator=(const Entry&) = delete;
+
+    virtual ~Entry();
+
+    bool IsActive() const {
+      return Linked();
+    }
+
+   protected:
+    /**
+     * @brief called in the thread of the loop, the entry is already removed from the wheel, so
+     *
+     * it can be added again, or deleted.
+     */
+    virtual void OnExpired() = 0;
+
+    /**
+     * @brief the wheel is destroyed(with its loop) before the entry expired
+     */
+    virtual void OnAbandoned() {
+    }
+
+   private:
+    TimerWheel* wheel_ = nullptr;
+    uint64_t    rounds_ = 0;
+
+    friend class TimerWheel;
+  };
+
+  explicit TimerWheel(asio::io_service& io, uint32_t tick_ms = kTickMs,
+                      std::size_t slots = kSlots);
+
+  ~TimerWheel();
+
+  TimerWheel(const TimerWheel&) = delete;
+
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  /**
+   * @brief (re)schedule `entry` to expire after `delay_ms`
+   */
+  void Add(Entry* entry, uint64_t delay_ms);
+
+  void Remove(Entry* entry);
+
+  std::size_t Size() const {
+    return size_;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  uint64_t NowMs() const;
+
+  uint64_t NowTick() const;
+
+  void Arm();
+
+  void OnTick();
+
+  asio::steady_timer        timer_;
+  std::chrono::milliseconds tick_;
+  std::vector<Link>         slots_;
+  Clock::time_point         start_;
+  uint64_t                  current_tick_ = 0;
+  std::size_t               size_ = 0;
+  bool                      armed_ = false;
+};
+
+}  // namespace spiderweb
+
+#endif
@@ -1,6 +1,23 @@
 #include "spiderweb/core/spiderweb_eventloop.h"
 
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#include "absl/memory/memory.h"
 #include "asio/io_service.hpp"
+#include "core/internal/timer_pool.h"
+#include "core/internal/timer_wheel.h"
+#include "spiderweb/core/internal/mpsc_queue.h"
+#include "spiderweb/ppk_assert.h"
+#if defined(__linux__)
+#include "asio/posix/stream_descriptor.hpp"
+#endif
 
 namespace spiderweb {
 
@@ -8,9 +25,26 @@ thread_local EventLoop* current_loop = nullptr;
 
 class EventLoop::Private {
  public:
-  explicit Private(EventLoop* qq) : work(io), q(qq) {
+  /**
+   * @brief at most this many tasks are run per wakeup, so that a flood of posted tasks can not
+   *
+   * starve the io handlers of the loop.
+   */
+  static constexpr std::size_t kMaxTaskBatch = 256;
+
+  explicit Private(EventLoop* qq)
+      : work(io),
+#if defined(__linux__)
+        wakeup(io, CreateWakeupFd()),
+#endif
+        q(qq),
+        objects(std::make_shared<std::atomic<std::size_t>>(0)) {
     assert(!current_loop);
     current_loop = q;
+
+#if defined(__linux__)
+    StartWaitWakeup();
+#endif
   }
 
   ~Private() {
@@ -18,10 +52,91 @@ class EventLoop::Private {
     current_loop = nullptr;
   }
 
+  /**
+   * @brief can be called in any thread, only the first task of a batch wakes up the loop.
+   */
+  void PostTask(Task&& f) {
+    tasks.Push(std::move(f));
+
+    if (!wakeup_pending.exchange(true, std::memory_order_acq_rel)) {
+      Wakeup();
+    }
+  }
+
+  /**
+   * @brief from the thread of the loop, post is cheap(no lock, no syscall) and keeps the tasks in
+   *
+   * order with the other handlers, other threads signal the eventfd.
+   */
+  void Wakeup() {
+#if defined(__linux__)
+    if (std::this_thread::get_id() != q->ThreadId()) {
+      const uint64_t one = 1;
+      (void)::write(wakeup.native_handle(), &one, sizeof(one));
+      return;
+    }
+#endif
+    io.post([this]() { RunTasks(); });
+  }
+
+#if defined(__linux__)
+  /**
+   * @brief the tasks posted from other threads never run without it, so a failure is fatal.
+   */
+  static int CreateWakeupFd() {
+    const int fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    PPK_ASSERT_FATAL(fd >= 0, "eventfd failed: %s", std::strerror(errno));
+    return fd;
+  }
+
+  void StartWaitWakeup() {
+    wakeup.async_read_some(asio::buffer(&wakeup_count, sizeof(wakeup_count)),
+                           [this](const asio::error_code& ec, std::size_t /*bytes*/) {
+                             if (ec) {
+                               return;
+                             }
+                             RunTasks();
+                             StartWaitWakeup();
+                           });
+  }
+#endif
+
+  void RunTasks() {
+    /**
+     * @brief reset before popping, a task pushed after this point either be popped below, or
+     *
+     * wakes the loop again.
+     */
+    wakeup_pending.exchange(false, std::memory_order_acq_rel);
+
+    Task task;
+    for (std::size_t i = 0; i < kMaxTaskBatch; ++i) {
+      if (!tasks.Pop(task)) {
+        return;
+      }
+      task();
+      task = nullptr;
+    }
+
+    if (!wakeup_pending.exchange(true, std::memory_order_acq_rel)) {
+      Wakeup();
+    }
+  }
+
   asio::io_service       io;
   asio::io_service::work work;
-  int32_t                exit_code = 0;
-  EventLoop*             q = nullptr;
+#if defined(__linux__)
+  asio::posix::stream_descriptor wakeup;
+  uint64_t                       wakeup_count = 0;
+#endif
+  std::unique_ptr<TimerWheel> wheel;
+  /// after the wheel, the coarse slots of the pool are entries of the wheel
+  std::unique_ptr<TimerPool>  pool;
+  MpscQueue<Task>             tasks;
+  std::atomic<bool>           wakeup_pending{false};
+  int32_t                     exit_code = 0;
+  EventLoop*                  q = nullptr;
+  ObjectCounter               objects;
 };
 
 EventLoop::EventLoop(Object* parent) : Object(this, parent), d(new Private(this)) {
@@ -59,4 +174,30 @@ NativeIoService EventLoop::IoService() {
   return &d->io;
 }
 
+std::size_t EventLoop::ObjectCount() const {
+  return d->objects->load(std::memory_order_relaxed);
+}
+
+EventLoop::ObjectCounter EventLoop::Counter() const {
+  return d->objects;
+}
+
+void EventLoop::PostTask(Task&& f) {
+  d->PostTask(std::move(f));
+}
+
+TimerWheel& EventLoop::GetTimerWheel() {
+  if (!d->wheel) {
+    d->wheel = absl::make_unique<TimerWheel>(d->io);
+  }
+  return *d->wheel;
+}
+
+TimerPool& EventLoop::GetTimerPool() {
+  if (!d->pool) {
+    d->pool = absl::make_unique<TimerPool>(d->io, GetTimerWheel());
+  }
+  return *d->pool;
+}
+
 }  // namespace spiderweb
@@ -0,0 +1,62 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "spiderweb/core/internal/asio_cast.h"
+#include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_thread.h"
+
+static constexpr int64_t kTasksPerProducer = 20000;
+
+/**
+ * @brief `producers` threads post kTasksPerProducer tasks each, returns after all of them are run.
+ */
+template <typename Post>
+static void RunProducers(int64_t producers, Post&& post) {
+  std::atomic<int64_t> executed{0};
+
+  std::vector<std::thread> threads;
+  for (int64_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&]() {
+      for (int64_t i = 0; i < kTasksPerProducer; ++i) {
+        post([&executed]() { executed.fetch_add(1, std::memory_order_relaxed); });
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  while (executed.load(std::memory_order_relaxed) < producers * kTasksPerProducer) {
+    std::this_thread::yield();
+  }
+}
+
+static void BM_EventLoopQueueTask(benchmark::State& state) {
+  spiderweb::Thread thread;
+  thread.Start();
+
+  auto* loop = thread.GetEventLoop();
+  for (auto _ : state) {
+    RunProducers(state.range(0),
+                 [loop](std::function<void()>&& f) { loop->QueueTask(std::move(f)); });
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kTasksPerProducer);
+}
+BENCHMARK(BM_EventLoopQueueTask)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+
+/**
+ * @brief baseline, post into the io service directly
+ */
+static void BM_EventLoopIoServicePost(benchmark::State& state) {
+  spiderweb::Thread thread;
+  thread.Start();
+
+  auto& io = spiderweb::AsioService(thread.GetEventLoop());
+  for (auto _ : state) {
+    RunProducers(state.range(0), [&io](std::function<void()>&& f) { io.post(std::move(f)); });
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kTasksPerProducer);
+}
+BENCHMARK(BM_EventLoopIoServicePost)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
@@ -0,0 +1,97 @@
+#include "spiderweb/core/spiderweb_eventloop_group.h"
+
+#include <atomic>
+#include <cassert>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_thread.h"
+#include "spiderweb/ppk_assert.h"
+
+namespace spiderweb {
+
+class EventLoopGroup::Private {
+ public:
+  Private(std::size_t size, Policy p) : threads(size == 0 ? 1 : size), policy(p) {
+  }
+
+  EventLoop* RoundRobin() {
+    const auto index = next.fetch_add(1, std::memory_order_relaxed);
+    return threads[index % threads.size()].GetEventLoop();
+  }
+
+  EventLoop* LeastLoaded() {
+    EventLoop*  result = nullptr;
+    std::size_t min = 0;
+
+    for (const auto& t : threads) {
+      auto* loop = t.GetEventLoop();
+      if (!result || loop->ObjectCount() < min) {
+        result = loop;
+        min = loop->ObjectCount();
+      }
+    }
+    return result;
+  }
+
+  std::vector<Thread>      threads;
+  Policy                   policy;
+  std::atomic<std::size_t> next{0};
+};
+
+EventLoopGroup::EventLoopGroup(std::size_t size, Policy policy)
+    : d(absl::make_unique<Private>(size, policy)) {
+}
+
+EventLoopGroup::~EventLoopGroup() {
+  Quit();
+}
+
+void EventLoopGroup::Start() {
+  for (auto& t : d->threads) {
+    t.Start();
+  }
+}
+
+void EventLoopGroup::Quit() {
+  for (auto& t : d->threads) {
+    t.Quit();
+  }
+}
+
+bool EventLoopGroup::IsRunning() const {
+  for (const auto& t : d->threads) {
+    if (!t.IsRunning()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::size_t EventLoopGroup::Size() const {
+  return d->threads.size();
+}
+
+EventLoopGroup::Policy EventLoopGroup::GetPolicy() const {
+  return d->policy;
+}
+
+EventLoop* EventLoopGroup::LoopAt(std::size_t index) const {
+  PPK_ASSERT_FATAL(index < d->threads.size());
+  return d->threads[index].GetEventLoop();
+}
+
+EventLoop* EventLoopGroup::NextLoop() {
+  assert(IsRunning() && "EventLoopGroup::NextLoop() called before Start()");
+
+  switch (d->policy) {
+    case Policy::kLeastLoaded:
+      return d->LeastLoaded();
+    case Policy::kRoundRobin:
+    default:
+      return d->RoundRobin();
+  }
+}
+
+}  // namespace spiderweb
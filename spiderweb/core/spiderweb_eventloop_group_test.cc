@@ -0,0 +1,56 @@
+#include "spiderweb/core/spiderweb_eventloop_group.h"
+
+#include <future>
+#include <set>
+
+#include "gtest/gtest.h"
+#include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_object.h"
+
+TEST(EventLoopGroup, Start) {
+  spiderweb::EventLoopGroup group(3);
+
+  EXPECT_FALSE(group.IsRunning());
+  group.Start();
+  EXPECT_TRUE(group.IsRunning());
+  EXPECT_EQ(group.Size(), 3);
+
+  std::set<std::thread::id> threads;
+  for (std::size_t i = 0; i < group.Size(); ++i) {
+    EXPECT_NE(group.LoopAt(i)->ThreadId(), std::this_thread::get_id());
+    threads.insert(group.LoopAt(i)->ThreadId());
+  }
+  EXPECT_EQ(threads.size(), 3);
+
+  group.Quit();
+  EXPECT_FALSE(group.IsRunning());
+}
+
+TEST(EventLoopGroup, RoundRobin) {
+  spiderweb::EventLoopGroup group(3);
+  group.Start();
+
+  for (std::size_t i = 0; i < 6; ++i) {
+    EXPECT_EQ(group.NextLoop(), group.LoopAt(i % 3));
+  }
+}
+
+TEST(EventLoopGroup, LeastLoaded) {
+  spiderweb::EventLoopGroup group(2, spiderweb::EventLoopGroup::Policy::kLeastLoaded);
+  group.Start();
+
+  std::promise<spiderweb::Object*> created;
+  group.LoopAt(0)->QueueTask([&]() { created.set_value(new spiderweb::Object()); });
+  auto* object = created.get_future().get();
+
+  EXPECT_EQ(group.LoopAt(0)->ObjectCount(), 1);
+  EXPECT_EQ(group.NextLoop(), group.LoopAt(1));
+
+  std::promise<bool> deleted;
+  group.LoopAt(0)->QueueTask([&]() {
+    delete object;
+    deleted.set_value(true);
+  });
+  deleted.get_future().get();
+  EXPECT_EQ(group.LoopAt(0)->ObjectCount(), 0);
+}
@@ -1,5 +1,9 @@
 #include "spiderweb/core/spiderweb_eventloop.h"
 
+#include <functional>
+#include <thread>
+#include <vector>
+
 #include "absl/memory/memory.h"
 #include "gtest/gtest.h"
 #include "spiderweb/core/spiderweb_timer.h"
@@ -157,3 +161,155 @@ TEST(spiderweb_EventLoop, ExecEx) {
 
   loop.ExecEx();
 }
+
+TEST(spiderweb_EventLoop, QueueTaskFromManyThreads) {
+  static constexpr int kProducers = 8;
+  static constexpr int kTasks = 10000;
+
+  spiderweb::EventLoop loop;
+
+  int              executed = 0;
+  std::vector<int> last(kProducers, -1);
+  bool             ordered = true;
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p) {
+    producers.emplace_back([&, p]() {
+      for (int i = 0; i < kTasks; ++i) {
+        loop.QueueTask([&, p, i]() {
+          /**
+           * @brief tasks of one producer are run in the order they are queued
+           */
+          ordered = ordered && last[p] + 1 == i;
+          last[p] = i;
+
+          if (++executed == kProducers * kTasks) {
+            loop.Quit();
+          }
+        });
+      }
+    });
+  }
+
+  loop.Exec();
+  for (auto& t : producers) {
+    t.join();
+  }
+
+  EXPECT_EQ(executed, kProducers * kTasks);
+  EXPECT_TRUE(ordered);
+}
+
+TEST(spiderweb_EventLoop, QueueTaskInLoopThread) {
+  spiderweb::EventLoop loop;
+
+  int  count = 0;
+  bool timer_fired = false;
+
+  std::function<void()> requeue = [&]() {
+    if (++count < 10000) {
+      loop.QueueTask(std::function<void()>(requeue));
+    }
+  };
+  loop.QueueTask(std::function<void()>(requeue));
+
+  /**
+   * @brief a task queueing tasks forever must not starve other handlers of the loop
+   */
+  loop.RunAfter(0, [&]() {
+    timer_fired = true;
+    EXPECT_LT(count, 10000);
+    loop.Quit();
+  });
+
+  loop.Exec();
+  EXPECT_TRUE(timer_fired);
+}
+
+class CountObject : public spiderweb::Object {
+ public:
+  explicit CountObject(spiderweb::Object* parent = nullptr) : spiderweb::Object(parent) {
+  }
+
+  spiderweb::Notify<int> valueChanged;
+};
+
+TEST(spiderweb_EventLoop, BatchedConnection) {
+  static constexpr int kEmissions = 1000;
+
+  spiderweb::EventLoop app;
+  CountObject          sender;
+  ReciverObject        reciver;
+
+  std::vector<int> values;
+  std::thread::id  called_thread;
+  spiderweb::Object::Connect(
+      &sender, &CountObject::valueChanged, &reciver,
+      [&](int value) {
+        values.push_back(value);
+        called_thread = std::this_thread::get_id();
+        if (value == kEmissions - 1) {
+          app.Quit();
+        }
+      },
+      spiderweb::ConnectionType::kBatched);
+
+  std::thread subthread([&]() {
+    for (int i = 0; i < kEmissions; ++i) {
+      sender.valueChanged(i);
+    }
+  });
+
+  app.Exec();
+  subthread.join();
+
+  ASSERT_EQ(values.size(), kEmissions);
+  for (int i = 0; i < kEmissions; ++i) {
+    EXPECT_EQ(values[i], i);
+  }
+  EXPECT_EQ(called_thread, reciver.ThreadId());
+}
+
+TEST(spiderweb_EventLoop, LatestConnection) {
+  spiderweb::EventLoop app;
+  CountObject          sender;
+  ReciverObject        reciver;
+
+  std::vector<int> values;
+  spiderweb::Object::Connect(
+      &sender, &CountObject::valueChanged, &reciver, [&](int value) { values.push_back(value); },
+      spiderweb::ConnectionType::kLatest);
+
+  /**
+   * @brief the loop is not running, all emissions but the last one are conflated
+   */
+  std::thread subthread([&]() {
+    for (int i = 0; i < 100; ++i) {
+      sender.valueChanged(i);
+    }
+  });
+  subthread.join();
+
+  app.QueueTask([&]() { app.Quit(); });
+  app.Exec();
+
+  EXPECT_EQ(values, std::vector<int>{99});
+}
+
+TEST(spiderweb_EventLoop, BatchedConnectionClassMember) {
+  spiderweb::EventLoop app;
+  TestObject           test;
+  ReciverObject        reciver;
+
+  spiderweb::Object::Connect(&test, &TestObject::statedChanged, &reciver, &ReciverObject::SetValue,
+                             spiderweb::ConnectionType::kBatched);
+
+  std::thread subthread([&]() { test.SetState(true); });
+  subthread.join();
+
+  app.QueueTask([&]() { app.Quit(); });
+  app.Exec();
+
+  EXPECT_TRUE(reciver.State());
+  EXPECT_EQ(reciver.CalledThread(), reciver.ThreadId());
+}
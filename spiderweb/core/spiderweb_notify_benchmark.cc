@@ -1,5 +1,9 @@
+#include <atomic>
+#include <future>
+
 #include "benchmark/benchmark.h"
 #include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_thread.h"
 
 class MyObject : public spiderweb::Object {
  public:
@@ -40,19 +44,28 @@ static void BM_NotifyConnectClassMethod(benchmark::State& state) {
 }
 BENCHMARK(BM_NotifyConnectClassMethod);
 
+/**
+ * @brief emit a signal with range(0) connected slots, items are slot calls.
+ */
 static void BM_NotifyCall(benchmark::State& state) {
   spiderweb::EventLoop loop;
 
-  uint64_t          called = 0;
-  static const auto f = [&](const std::string& /*a*/, int /*b*/, float /*c*/) { called++; };
+  uint64_t   called = 0;
+  const auto f = [&](const std::string& /*a*/, int /*b*/, float /*c*/) { called++; };
 
-  for (auto _ : state) {
-    MyObject obj;
+  MyObject obj;
+  for (int64_t i = 0; i < state.range(0); ++i) {
     spiderweb::Object::Connect(&obj, &MyObject::voidEvent, &loop, f);
-    obj.voidEvent("123", 2, static_cast<float>(3.33));
   }
+
+  const std::string a("123");
+  for (auto _ : state) {
+    obj.voidEvent(a, 2, static_cast<float>(3.33));
+  }
+  benchmark::DoNotOptimize(called);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
 }
-BENCHMARK(BM_NotifyCall);
+BENCHMARK(BM_NotifyCall)->Arg(1)->Arg(4)->Arg(16);
 
 static void BM_CallDirectly(benchmark::State& state) {
   uint64_t                                                  called = 0;
@@ -67,3 +80,47 @@ static void BM_CallDirectly(benchmark::State& state) {
   }
 }
 BENCHMARK(BM_CallDirectly);
+
+/**
+ * @brief emissions toward a receiver in another thread, range(0) is the ConnectionType.
+ */
+static void BM_NotifyQueued(benchmark::State& state) {
+  static constexpr int64_t kEmissions = 10000;
+
+  struct Sender : public spiderweb::Object {
+    spiderweb::Notify<int> valueChanged;
+  };
+
+  spiderweb::EventLoop loop;
+  spiderweb::Thread    thread;
+  thread.Start();
+
+  std::promise<spiderweb::Object*> created;
+  thread.QueueTask([&]() { created.set_value(new spiderweb::Object()); });
+  auto* reciver = created.get_future().get();
+
+  std::atomic<int64_t> called{0};
+  Sender               sender;
+  spiderweb::Object::Connect(
+      &sender, &Sender::valueChanged, reciver,
+      [&](int /*value*/) { called.fetch_add(1, std::memory_order_relaxed); },
+      static_cast<spiderweb::ConnectionType>(state.range(0)));
+
+  int64_t expected = 0;
+  for (auto _ : state) {
+    for (int64_t i = 0; i < kEmissions; ++i) {
+      sender.valueChanged(static_cast<int>(i));
+    }
+    expected += kEmissions;
+    while (called.load(std::memory_order_relaxed) < expected) {
+      std::this_thread::yield();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kEmissions);
+
+  reciver->DeleteLater();
+}
+BENCHMARK(BM_NotifyQueued)
+    ->Arg(static_cast<int64_t>(spiderweb::ConnectionType::kAuto))
+    ->Arg(static_cast<int64_t>(spiderweb::ConnectionType::kBatched))
+    ->UseRealTime();
@@ -1,9 +1,15 @@
 #include "spiderweb/core/spiderweb_object.h"
 
-#include <asio/steady_timer.hpp>
+#include <algorithm>
+#include <deque>
+#include <mutex>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "core/internal/asio_cast.h"
+#include "core/internal/timer_pool.h"
+#include "spiderweb/core/internal/mpsc_queue.h"
 #include "spiderweb/core/spiderweb_eventloop.h"
 
 namespace spiderweb {
@@ -19,6 +25,41 @@ struct ObjectDleter {
  private:
   Object* ptr_{nullptr};
 };
+
+/**
+ * @brief tasks queued by one object into one loop, see Object::QueueTaskBatched
+ */
+struct TaskBatch {
+  /**
+   * @brief returns true if the batch need to be scheduled
+   */
+  bool Append(Task&& f) {
+    tasks.Push(std::move(f));
+    return !scheduled.exchange(true, std::memory_order_acq_rel);
+  }
+
+  /**
+   * @brief run at most kMaxTasks tasks, returns true if the batch need to be scheduled again
+   */
+  bool Run() {
+    static constexpr std::size_t kMaxTasks = 256;
+
+    scheduled.exchange(false, std::memory_order_acq_rel);
+
+    Task task;
+    for (std::size_t i = 0; i < kMaxTasks; ++i) {
+      if (!tasks.Pop(task)) {
+        return false;
+      }
+      task();
+      task = nullptr;
+    }
+    return !scheduled.exchange(true, std::memory_order_acq_rel);
+  }
+
+  MpscQueue<Task>   tasks;
+  std::atomic<bool> scheduled{false};
+};
 }  // namespace detail
 
 class Object::Private {
@@ -27,18 +68,54 @@ class Object::Private {
       : id(std::this_thread::get_id()), loop(_loop), parent(_parent) {
   }
 
-  std::thread::id id;
-  EventLoop*      loop = nullptr;
-  Object*         parent = nullptr;
+  std::thread::id                           id;
+  EventLoop*                                loop = nullptr;
+  Object*                                   parent = nullptr;
+  std::shared_ptr<std::atomic<std::size_t>> counter;
+  std::mutex                                mutex;
+  std::vector<Connection>                   connections;
+  std::size_t                               compact_at = 8;
+
+  using Batch = std::pair<EventLoop*, std::shared_ptr<detail::TaskBatch>>;
+
+  const std::shared_ptr<detail::TaskBatch>& BatchOf(EventLoop* target) {
+    std::lock_guard<std::mutex> lock(batches_mutex);
+    for (const auto& batch : batches) {
+      if (batch.first == target) {
+        return batch.second;
+      }
+    }
+    batches.emplace_back(target, std::make_shared<detail::TaskBatch>());
+    return batches.back().second;
+  }
+
+  std::mutex         batches_mutex;
+  std::deque<Batch>  batches;
 };
 
 Object::Object(Object* parent) : d(new Private(GetLoop(parent), parent)) {
+  d->counter = d->loop->Counter();
+  d->counter->fetch_add(1, std::memory_order_relaxed);
 }
 
 Object::Object(EventLoop* loop, Object* parent) : d(new Private(loop, parent)) {
 }
 
-Object::~Object() = default;
+Object::~Object() {
+  {
+    std::lock_guard<std::mutex> lock(d->mutex);
+    for (auto& connection : d->connections) {
+      connection.Disconnect();
+    }
+  }
+
+  /**
+   * @brief the loop itself is not counted, see EventLoop::ObjectCount
+   */
+  if (d->counter) {
+    d->counter->fetch_sub(1, std::memory_order_relaxed);
+  }
+}
 
 spiderweb::EventLoop* Object::ownerEventLoop() {
   return d->loop;
@@ -48,21 +125,49 @@ EventLoop* Object::ownerEventLoop() const {
   return d->loop;
 }
 
-void Object::QueueTask(std::function<void()>&& f) const {
-  AsioService(d->loop).post(std::forward<decltype(f)>(f));
+void Object::QueueTask(Task&& f) const {
+  d->loop->PostTask(std::forward<decltype(f)>(f));
 }
 
-void Object::RunAfter(uint64_t delay_ms, std::function<void()>&& f) const {
-  auto timer = std::make_shared<asio::steady_timer>(AsioService(ownerEventLoop()),
-                                                    std::chrono::milliseconds(delay_ms));
-  timer->async_wait([timer, ff = std::move(f)](const asio::error_code& ec) {
-    if (ec.value() == asio::error::operation_aborted) {
-      return;
+static void ScheduleBatch(EventLoop* loop, std::shared_ptr<detail::TaskBatch> batch) {
+  loop->QueueTask([loop, batch]() {
+    if (batch->Run()) {
+      ScheduleBatch(loop, batch);
     }
-    ff();
   });
 }
 
+void Object::QueueTaskBatched(EventLoop* loop, Task&& f) const {
+  const auto& batch = d->BatchOf(loop);
+  if (batch->Append(std::move(f))) {
+    ScheduleBatch(loop, batch);
+  }
+}
+
+TimerHandle Object::RunAfter(uint64_t delay_ms, Task&& f, TimerType type) const {
+  auto* loop = ownerEventLoop();
+  if (std::this_thread::get_id() != ThreadId()) {
+    loop->QueueTask([loop, delay_ms, type, ff = std::move(f)]() mutable {
+      loop->RunAfter(delay_ms, std::move(ff), type);
+    });
+    return {};
+  }
+
+  return loop->GetTimerPool().Schedule(delay_ms, std::move(f), type);
+}
+
+void Object::TrackConnection(const Connection& connection) {
+  std::lock_guard<std::mutex> lock(d->mutex);
+
+  if (d->connections.size() >= d->compact_at) {
+    d->connections.erase(std::remove_if(d->connections.begin(), d->connections.end(),
+                                        [](const Connection& c) { return !c.Connected(); }),
+                         d->connections.end());
+    d->compact_at = std::max<std::size_t>(8, d->connections.size() * 2);
+  }
+  d->connections.push_back(connection);
+}
+
 std::thread::id Object::ThreadId() const {
   return d->id;
 }
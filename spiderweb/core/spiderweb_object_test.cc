@@ -1,5 +1,8 @@
 #include "spiderweb/core/spiderweb_object.h"
 
+#include <thread>
+#include <vector>
+
 #include "gtest/gtest.h"
 #include "spiderweb/core/spiderweb_eventloop.h"
 
@@ -28,3 +31,178 @@ TEST(spiderweb_object, DeleteLater) {
 
   loop.ExecEx();
 }
+
+class SlotReciver : public spiderweb::Object {
+ public:
+  explicit SlotReciver(spiderweb::Object* parent = nullptr) : spiderweb::Object(parent) {
+  }
+
+  void OnEvent() {
+    ++called;
+  }
+
+  int called = 0;
+};
+
+TEST(spiderweb_object, ConnectMultipleSlots) {
+  spiderweb::EventLoop loop;
+  Sender               sender;
+  SlotReciver          r1;
+  SlotReciver          r2;
+
+  std::vector<int> order;
+  spiderweb::Object::Connect(&sender, &Sender::a_event, &r1, &SlotReciver::OnEvent);
+  spiderweb::Object::Connect(&sender, &Sender::a_event, &r2, &SlotReciver::OnEvent);
+  spiderweb::Object::Connect(&sender, &Sender::a_event, &loop, [&]() { order.push_back(1); });
+  spiderweb::Object::Connect(&sender, &Sender::a_event, &loop, [&]() { order.push_back(2); });
+
+  sender.a_event();
+  EXPECT_EQ(r1.called, 1);
+  EXPECT_EQ(r2.called, 1);
+  EXPECT_EQ(order, (std::vector<int>{1, 2}));
+  EXPECT_EQ(sender.a_event.SlotCount(), 4);
+}
+
+TEST(spiderweb_object, Disconnect) {
+  spiderweb::EventLoop loop;
+  Sender               sender;
+  SlotReciver          reciver;
+
+  auto connection = spiderweb::Object::Connect(&sender, &Sender::a_event, &reciver,
+                                               &SlotReciver::OnEvent);
+  EXPECT_TRUE(connection.Connected());
+
+  sender.a_event();
+  connection.Disconnect();
+  EXPECT_FALSE(connection.Connected());
+  sender.a_event();
+
+  EXPECT_EQ(reciver.called, 1);
+  EXPECT_EQ(sender.a_event.SlotCount(), 0);
+}
+
+TEST(spiderweb_object, DisconnectDuringEmit) {
+  spiderweb::EventLoop loop;
+  Sender               sender;
+
+  int                   first = 0;
+  int                   second = 0;
+  spiderweb::Connection c1;
+  spiderweb::Connection c2;
+
+  /**
+   * @brief the first slot disconnects itself and the next one, the next one is not called
+   */
+  c1 = spiderweb::Object::Connect(&sender, &Sender::a_event, &loop, [&]() {
+    ++first;
+    c1.Disconnect();
+    c2.Disconnect();
+  });
+  c2 = spiderweb::Object::Connect(&sender, &Sender::a_event, &loop, [&]() { ++second; });
+
+  sender.a_event();
+  sender.a_event();
+
+  EXPECT_EQ(first, 1);
+  EXPECT_EQ(second, 0);
+}
+
+TEST(spiderweb_object, ConnectDuringEmit) {
+  spiderweb::EventLoop loop;
+  Sender               sender;
+
+  int inner = 0;
+  spiderweb::Object::Connect(&sender, &Sender::a_event, &loop, [&]() {
+    for (int i = 0; i < 8; ++i) {
+      spiderweb::Object::Connect(&sender, &Sender::a_event, &loop, [&]() { ++inner; });
+    }
+  });
+
+  /**
+   * @brief slots connected during the emission are called from the next emission on
+   */
+  sender.a_event();
+  EXPECT_EQ(inner, 0);
+
+  sender.a_event();
+  EXPECT_EQ(inner, 8);
+}
+
+TEST(spiderweb_object, ReciverDestroyed) {
+  spiderweb::EventLoop loop;
+  Sender               sender;
+
+  auto* reciver = new SlotReciver;
+  auto  connection =
+      spiderweb::Object::Connect(&sender, &Sender::a_event, reciver, &SlotReciver::OnEvent);
+
+  delete reciver;
+  EXPECT_FALSE(connection.Connected());
+
+  sender.a_event();
+  EXPECT_EQ(sender.a_event.SlotCount(), 0);
+}
+
+TEST(spiderweb_object, ScopedConnection) {
+  spiderweb::EventLoop loop;
+  Sender               sender;
+  SlotReciver          reciver;
+
+  {
+    spiderweb::ScopedConnection scoped =
+        spiderweb::Object::Connect(&sender, &Sender::a_event, &reciver, &SlotReciver::OnEvent);
+    sender.a_event();
+  }
+  sender.a_event();
+
+  EXPECT_EQ(reciver.called, 1);
+}
+
+TEST(spiderweb_object, SenderDestroyedBeforeQueuedCall) {
+  spiderweb::EventLoop loop;
+  SlotReciver          reciver;
+  auto*                sender = new Sender;
+
+  int batched = 0;
+  int latest = 0;
+  spiderweb::Object::Connect(sender, &Sender::a_event, &reciver, &SlotReciver::OnEvent);
+  spiderweb::Object::Connect(
+      sender, &Sender::a_event, &reciver, [&]() { ++batched; },
+      spiderweb::ConnectionType::kBatched);
+  spiderweb::Object::Connect(
+      sender, &Sender::a_event, &reciver, [&]() { ++latest; }, spiderweb::ConnectionType::kLatest);
+
+  /**
+   * @brief the calls are queued into the loop of the reciver, they still run after the sender
+   *
+   * has gone
+   */
+  std::thread emitter([sender]() { sender->a_event(); });
+  emitter.join();
+  delete sender;
+
+  loop.QueueTask([&]() { loop.Quit(); });
+  loop.Exec();
+
+  EXPECT_EQ(reciver.called, 1);
+  EXPECT_EQ(batched, 1);
+  EXPECT_EQ(latest, 1);
+}
+
+TEST(spiderweb_object, DisconnectDropsQueuedCall) {
+  spiderweb::EventLoop loop;
+  Sender               sender;
+  SlotReciver          reciver;
+
+  auto connection =
+      spiderweb::Object::Connect(&sender, &Sender::a_event, &reciver, &SlotReciver::OnEvent);
+
+  std::thread emitter([&sender]() { sender.a_event(); });
+  emitter.join();
+  connection.Disconnect();
+
+  loop.QueueTask([&]() { loop.Quit(); });
+  loop.Exec();
+
+  EXPECT_EQ(reciver.called, 0);
+}
@@ -66,8 +66,17 @@ class Process::Private {
   bool                                         enable_parent_env = false;
   std::vector<std::string>                     cmdline;
 
+  /**
+   * @brief fds which reached the end, they are kept until the next Start(), so that the readers
+   *
+   * handed out by BytesRead stay valid after the program exited.
+   */
+  std::vector<ProcessFd*> finished;
+
   bool TryCleanup(int& code);
 
+  void DeleteFinished();
+
   void SetupFd(ProcessFd* fd, FILE* f, Channnel ch);
 
   void SetState(State state);
@@ -94,7 +103,7 @@ void Process::Private::SetupFd(ProcessFd* fd, FILE* f, Channnel ch) {
 
   Connect(fd, &ProcessFd::Error, fd, [this, fd, ch](const std::error_code&) {
     fd->Release();
-    fd->DeleteLater();
+    finished.push_back(fd);
 
     if (ch == Channnel::kStdErr) {
       stde = nullptr;
@@ -105,6 +114,13 @@ void Process::Private::SetupFd(ProcessFd* fd, FILE* f, Channnel ch) {
   fd->Assign(f);
 }
 
+void Process::Private::DeleteFinished() {
+  for (auto* fd : finished) {
+    fd->DeleteLater();
+  }
+  finished.clear();
+}
+
 void Process::Private::SetState(State state) {
   if (this->state != state) {
     this->state = state;
@@ -142,6 +158,8 @@ Process::~Process() {
     d->stde = nullptr;
   }
 
+  d->DeleteFinished();
+
   int code = 0;
   d->TryCleanup(code);
 }
@@ -158,6 +176,7 @@ ErrorCode Process::Start() {
   d->SetState(State::kStarting);
 
   assert(!d->stdo && !d->stde);
+  d->DeleteFinished();
 
   auto cmdline = ptr_vec(d->cmdline);
   auto env_list = env_vec(d->env);
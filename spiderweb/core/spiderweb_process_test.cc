@@ -8,6 +8,7 @@
 
 #include <cstdio>
 #include <string>
+#include <vector>
 
 #include "spiderweb/core/spiderweb_eventloop.h"
 #include "spiderweb/core/spiderweb_notify_spy.h"
@@ -23,6 +24,20 @@ class ProcessTest : public testing::Test {
     loop.ExecEx();
   }
 
+  /**
+   * @brief collect the output of `ch` in the slot, while the reader is surely valid
+   */
+  void Collect(Process::Channnel ch, std::string* output) {
+    Object::Connect(&proc, &Process::BytesRead, &proc,
+                    [ch, output](Process::Channnel c, const io::BufferReader& reader) {
+                      std::vector<char> data;
+                      reader.Read(data);
+                      if (c == ch) {
+                        output->append(data.begin(), data.end());
+                      }
+                    });
+  }
+
   EventLoop loop;
   Process   proc;
 };
@@ -62,6 +77,30 @@ TEST_F(ProcessTest, StdErr) {
             "ls: cannot access 'abc': No such file or directory\n");
 }
 
+TEST_F(ProcessTest, StdOutReadInSlot) {
+  NotifySpy   spy(&proc, &Process::Stopped);
+  std::string output;
+  Collect(Process::Channnel::kStdOut, &output);
+
+  proc.SetProgram({"echo", "123"});
+  proc.Start();
+
+  spy.Wait();
+  EXPECT_EQ(output, "123\n");
+}
+
+TEST_F(ProcessTest, StdErrReadInSlot) {
+  NotifySpy   spy(&proc, &Process::Stopped);
+  std::string output;
+  Collect(Process::Channnel::kStdErr, &output);
+
+  proc.SetProgram({"ls", "abc"});
+  proc.Start();
+
+  spy.Wait();
+  EXPECT_EQ(output, "ls: cannot access 'abc': No such file or directory\n");
+}
+
 static std::string pstatus(int status) {
   if (WIFSIGNALED(status)) {
     int sig = WTERMSIG(status);
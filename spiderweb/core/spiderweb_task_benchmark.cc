@@ -0,0 +1,109 @@
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "spiderweb/core/internal/asio_cast.h"
+#include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_thread.h"
+#include "spiderweb/test/spiderweb_allocation_counter.h"
+
+using spiderweb::test::Allocations;
+
+/**
+ * @brief post a task which carries `Payload` into the loop of another thread, and wait for it.
+ *
+ * the payload is moved back and forth, so only the posting itself may allocate.
+ */
+template <typename Payload, typename Post>
+static void PostPayload(benchmark::State& state, Payload payload, Post&& post) {
+  spiderweb::Thread thread;
+  thread.Start();
+
+  Payload           slot;
+  std::atomic<bool> done{false};
+
+  const auto before = Allocations();
+  for (auto _ : state) {
+    done.store(false, std::memory_order_relaxed);
+    post(thread.GetEventLoop(), [&slot, &done, p = std::move(payload)]() mutable {
+      slot = std::move(p);
+      done.store(true, std::memory_order_release);
+    });
+
+    while (!done.load(std::memory_order_acquire)) {
+    }
+    payload = std::move(slot);
+  }
+  state.counters["allocs_per_post"] = benchmark::Counter(
+      static_cast<double>(Allocations() - before), benchmark::Counter::kAvgIterations);
+}
+
+static const auto kQueueTask = [](spiderweb::EventLoop* loop, auto&& f) {
+  loop->QueueTask(std::forward<decltype(f)>(f));
+};
+
+static void BM_TaskPostVector(benchmark::State& state) {
+  PostPayload(state, std::vector<uint8_t>(256), kQueueTask);
+}
+BENCHMARK(BM_TaskPostVector)->UseRealTime();
+
+static void BM_TaskPostUniquePtr(benchmark::State& state) {
+  PostPayload(state, std::make_unique<uint64_t>(0), kQueueTask);
+}
+BENCHMARK(BM_TaskPostUniquePtr)->UseRealTime();
+
+/**
+ * @brief a signal queued into another thread, the arguments are carried by the MoveTuple wrapper
+ */
+static void BM_TaskPostSignal(benchmark::State& state) {
+  struct Sender : public spiderweb::Object {
+    spiderweb::Notify<int, double, uint64_t> changed;
+  };
+
+  struct Reciver : public spiderweb::Object {
+    void OnChanged(int /*a*/, double /*b*/, uint64_t c) {
+      sum.fetch_add(c, std::memory_order_release);
+    }
+
+    std::atomic<uint64_t> sum{0};
+  };
+
+  spiderweb::EventLoop loop;
+  spiderweb::Thread    thread;
+  thread.Start();
+
+  std::promise<Reciver*> created;
+  thread.QueueTask([&]() { created.set_value(new Reciver()); });
+  auto* reciver = created.get_future().get();
+
+  Sender sender;
+  spiderweb::Object::Connect(&sender, &Sender::changed, reciver, &Reciver::OnChanged);
+
+  uint64_t   expected = 0;
+  const auto before = Allocations();
+  for (auto _ : state) {
+    spider_emit sender.changed(1, 2.0, 1);
+
+    ++expected;
+    while (reciver->sum.load(std::memory_order_acquire) != expected) {
+    }
+  }
+  state.counters["allocs_per_post"] = benchmark::Counter(
+      static_cast<double>(Allocations() - before), benchmark::Counter::kAvgIterations);
+
+  reciver->DeleteLater();
+}
+BENCHMARK(BM_TaskPostSignal)->UseRealTime();
+
+/**
+ * @brief baseline, std::function needs a copyable callable, and allocates for the capture
+ */
+static void BM_StdFunctionPostVector(benchmark::State& state) {
+  PostPayload(state, std::vector<uint8_t>(256), [](spiderweb::EventLoop* loop, auto&& f) {
+    spiderweb::AsioService(loop).post(std::function<void()>(std::forward<decltype(f)>(f)));
+  });
+}
+BENCHMARK(BM_StdFunctionPostVector)->UseRealTime();
@@ -0,0 +1,84 @@
+#include "spiderweb/core/spiderweb_task.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "spiderweb/core/spiderweb_eventloop.h"
+
+TEST(spiderweb_Task, Empty) {
+  spiderweb::Task task;
+  EXPECT_FALSE(task);
+
+  spiderweb::Task null(nullptr);
+  EXPECT_FALSE(null);
+}
+
+TEST(spiderweb_Task, MoveOnlyCapture) {
+  auto value = std::make_unique<int>(42);
+  int  result = 0;
+
+  spiderweb::Task task([v = std::move(value), &result]() { result = *v; });
+  EXPECT_TRUE(task);
+
+  spiderweb::Task other(std::move(task));
+  EXPECT_FALSE(task);  // NOLINT
+  EXPECT_TRUE(other);
+
+  other();
+  EXPECT_EQ(result, 42);
+}
+
+TEST(spiderweb_Task, InlineAndHeap) {
+  using Small = std::array<uint8_t, spiderweb::Task::kInlineSize>;
+  using Big = std::array<uint8_t, spiderweb::Task::kInlineSize + 1>;
+
+  EXPECT_TRUE(spiderweb::Task::IsInline<Small>());
+  EXPECT_FALSE(spiderweb::Task::IsInline<Big>());
+  EXPECT_TRUE(spiderweb::Task::IsInline<std::vector<uint8_t>>());
+
+  Big  big{};
+  int  sum = 0;
+  auto task = spiderweb::Task([big, &sum]() mutable {
+    big.back() = 3;
+    sum = big.back();
+  });
+
+  spiderweb::Task other;
+  other = std::move(task);
+  other();
+  EXPECT_EQ(sum, 3);
+}
+
+TEST(spiderweb_Task, Destroy) {
+  auto counter = std::make_shared<int>(0);
+
+  {
+    spiderweb::Task task([counter]() {});
+    EXPECT_EQ(counter.use_count(), 2);
+
+    spiderweb::Task other(std::move(task));
+    EXPECT_EQ(counter.use_count(), 2);
+
+    other = nullptr;
+    EXPECT_EQ(counter.use_count(), 1);
+  }
+  EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST(spiderweb_Task, QueueTaskMoveOnly) {
+  spiderweb::EventLoop loop;
+
+  std::vector<uint8_t> payload{0x01, 0x02, 0x03};
+  const auto*          data = payload.data();
+
+  loop.QueueTask([&loop, data, p = std::move(payload)]() {
+    /**
+     * @brief the payload is moved, never copied
+     */
+    EXPECT_EQ(p.data(), data);
+    loop.Quit();
+  });
+  loop.Exec();
+}
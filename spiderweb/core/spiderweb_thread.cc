@@ -86,7 +86,7 @@ void Thread::Quit() {
   d->WaitForThreadExit();
 }
 
-void Thread::QueueTask(std::function<void()>&& f) {
+void Thread::QueueTask(Task&& f) {
   if (IsRunning()) {
     d->loop->QueueTask(std::move(f));
   }
@@ -100,4 +100,8 @@ Thread::Id Thread::GetThreadId() const {
   return IsRunning() ? d->loop->ThreadId() : d->t.get_id();
 }
 
+EventLoop* Thread::GetEventLoop() const {
+  return d->loop.get();
+}
+
 }  // namespace spiderweb
@@ -1,25 +1,36 @@
 #include "spiderweb/core/spiderweb_timer.h"
 
 #include "asio/steady_timer.hpp"
+#include "core/internal/timer_wheel.h"
 #include "spiderweb/core/internal/asio_cast.h"
 
 namespace spiderweb {
-class Timer::Private {
+class Timer::Private : public TimerWheel::Entry {
  public:
-  Private(Timer *qq, Object *parent) : q(qq), timer(AsioService(GetLoop(parent))) {
+  Private(Timer *qq, Object *parent)
+      : q(qq), loop(GetLoop(parent)), timer(AsioService(loop)) {
   }
 
   Timer             *q = nullptr;
+  EventLoop         *loop = nullptr;
   asio::steady_timer timer;
   uint32_t           timeoutms = 3000;
   bool               is_running = {false};
   bool               singal_shot = false;
+  TimerType          type = TimerType::kPrecise;
+  uint64_t           wheel_timeout_ms = 0;
 
   void SetExpired(const uint64_t timeout_ms) {
     if (!is_running) {
       return;
     }
 
+    if (type == TimerType::kCoarse) {
+      wheel_timeout_ms = timeout_ms;
+      loop->GetTimerWheel().Add(this, timeout_ms);
+      return;
+    }
+
     timer.expires_from_now(std::chrono::milliseconds(timeout_ms));
     timer.async_wait([this, timeout_ms](const asio::error_code &e) {
       if (e.value() == asio::error::operation_aborted || !is_running) {
@@ -35,6 +46,29 @@ class Timer::Private {
       SetExpired(timeout_ms);
     });
   }
+
+  void Cancel() {
+    if (type == TimerType::kCoarse) {
+      loop->GetTimerWheel().Remove(this);
+      return;
+    }
+    timer.cancel();
+  }
+
+ protected:
+  void OnExpired() override {
+    if (!is_running) {
+      return;
+    }
+    is_running = false;
+    spider_emit q->timeout();
+
+    if (singal_shot) {
+      return;
+    }
+    is_running = true;
+    SetExpired(wheel_timeout_ms);
+  }
 };
 
 Timer::Timer(Object *parent) : Object(parent), d(new Private(this, parent)) {
@@ -54,13 +88,22 @@ void Timer::SetSingalShot(bool flag) {
   d->singal_shot = flag;
 }
 
+void Timer::SetTimerType(TimerType type) {
+  assert(!d->is_running && "can not change the type of a running timer");
+  d->type = type;
+}
+
+TimerType Timer::GetTimerType() const {
+  return d->type;
+}
+
 void Timer::Start() {
   Reset(d->timeoutms);
 }
 
 void Timer::Stop() {
   d->is_running = false;
-  d->timer.cancel();
+  d->Cancel();
 }
 
 void Timer::Reset(const uint64_t timeout_ms) {
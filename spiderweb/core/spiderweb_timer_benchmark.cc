@@ -1,4 +1,10 @@
+#include <memory>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "asio/steady_timer.hpp"
 #include "benchmark/benchmark.h"
+#include "core/internal/asio_cast.h"
 #include "spiderweb/core/spiderweb_eventloop.h"
 #include "spiderweb/core/spiderweb_timer.h"
 
@@ -30,3 +36,87 @@ static void BM_TimerAdd(benchmark::State &state) {
 }
 
 BENCHMARK(BM_TimerAdd);
+
+/**
+ * @brief start and stop range(1) running timers, range(0) is the TimerType.
+ */
+static void BM_TimerStartStop(benchmark::State &state) {
+  spiderweb::EventLoop loop;
+
+  const auto type = static_cast<spiderweb::TimerType>(state.range(0));
+
+  std::vector<std::unique_ptr<spiderweb::Timer>> timers;
+  for (int64_t i = 0; i < state.range(1); ++i) {
+    timers.emplace_back(absl::make_unique<spiderweb::Timer>());
+    timers.back()->SetTimerType(type);
+    timers.back()->SetInterval(static_cast<uint32_t>(30000 + i));
+    timers.back()->Start();
+  }
+
+  std::size_t index = 0;
+  for (auto _ : state) {
+    auto &timer = timers[index++ % timers.size()];
+    timer->Stop();
+    timer->Start();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TimerStartStop)
+    ->Args({static_cast<int64_t>(spiderweb::TimerType::kPrecise), 1000})
+    ->Args({static_cast<int64_t>(spiderweb::TimerType::kPrecise), 100000})
+    ->Args({static_cast<int64_t>(spiderweb::TimerType::kCoarse), 1000})
+    ->Args({static_cast<int64_t>(spiderweb::TimerType::kCoarse), 100000});
+
+/**
+ * @brief schedule a RunAfter and cancel it, range(0) is the TimerType.
+ */
+static void BM_RunAfterScheduleCancel(benchmark::State &state) {
+  spiderweb::EventLoop loop;
+  auto                &io = spiderweb::AsioService(&loop);
+
+  const auto type = static_cast<spiderweb::TimerType>(state.range(0));
+
+  int64_t count = 0;
+  for (auto _ : state) {
+    auto handle = loop.RunAfter(30000, [&count]() { ++count; }, type);
+    handle.Cancel();
+    /**
+     * @brief run the aborted completions, as the loop would
+     */
+    if ((++count & 1023) == 0) {
+      io.poll();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RunAfterScheduleCancel)
+    ->Arg(static_cast<int64_t>(spiderweb::TimerType::kPrecise))
+    ->Arg(static_cast<int64_t>(spiderweb::TimerType::kCoarse));
+
+/**
+ * @brief the same with a shared asio::steady_timer per call, what RunAfter did before it was
+ *
+ * backed by pooled timers.
+ */
+static void BM_SteadyTimerScheduleCancel(benchmark::State &state) {
+  spiderweb::EventLoop loop;
+  auto                &io = spiderweb::AsioService(&loop);
+
+  int64_t count = 0;
+  for (auto _ : state) {
+    spiderweb::Task f = [&count]() { ++count; };
+    auto timer = std::make_shared<asio::steady_timer>(io, std::chrono::milliseconds(30000));
+    timer->async_wait([timer, ff = std::move(f)](const asio::error_code &ec) mutable {
+      if (ec.value() == asio::error::operation_aborted) {
+        return;
+      }
+      ff();
+    });
+    timer->cancel();
+    if ((++count & 1023) == 0) {
+      io.poll();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SteadyTimerScheduleCancel);
@@ -0,0 +1,115 @@
+#include "core/internal/timer_pool.h"
+
+namespace spiderweb {
+
+bool TimerHandle::IsActive() const {
+  return pool_ && pool_->IsActive(index_, generation_);
+}
+
+void TimerHandle::Cancel() {
+  if (pool_) {
+    pool_->Cancel(index_, generation_);
+  }
+}
+
+bool TimerHandle::Reschedule(uint64_t delay_ms) {
+  return pool_ && pool_->Reschedule(index_, generation_, delay_ms);
+}
+
+TimerPool::TimerPool(asio::io_service& io, TimerWheel& wheel) : io_(io), wheel_(wheel) {
+}
+
+TimerHandle TimerPool::Schedule(uint64_t delay_ms, Task&& f, TimerType type) {
+  Slot* slot = nullptr;
+  if (free_.empty()) {
+    slots_.emplace_back(io_, this, static_cast<uint32_t>(slots_.size()));
+    slot = &slots_.back();
+  } else {
+    slot = &slots_[free_.back()];
+    free_.pop_back();
+  }
+
+  slot->task = std::move(f);
+  slot->type = type;
+  slot->active = true;
+  Arm(*slot, delay_ms);
+
+  return TimerHandle(this, slot->index, slot->generation);
+}
+
+bool TimerPool::IsActive(uint32_t index, uint32_t generation) const {
+  return index < slots_.size() && slots_[index].active && slots_[index].generation == generation;
+}
+
+void TimerPool::Cancel(uint32_t index, uint32_t generation) {
+  auto* slot = Find(index, generation);
+  if (!slot) {
+    return;
+  }
+
+  Disarm(*slot);
+  slot->task = nullptr;
+  Release(*slot);
+}
+
+bool TimerPool::Reschedule(uint32_t index, uint32_t generation, uint64_t delay_ms) {
+  auto* slot = Find(index, generation);
+  if (!slot) {
+    return false;
+  }
+
+  Arm(*slot, delay_ms);
+  return true;
+}
+
+TimerPool::Slot* TimerPool::Find(uint32_t index, uint32_t generation) {
+  return IsActive(index, generation) ? &slots_[index] : nullptr;
+}
+
+void TimerPool::Arm(Slot& slot, uint64_t delay_ms) {
+  ++slot.armed;
+
+  if (slot.type == TimerType::kCoarse) {
+    wheel_.Add(&slot, delay_ms);
+    return;
+  }
+
+  slot.timer.expires_from_now(std::chrono::milliseconds(delay_ms));
+  slot.timer.async_wait([this, index = slot.index, generation = slot.generation,
+                         armed = slot.armed](const asio::error_code& ec) {
+    if (ec.value() == asio::error::operation_aborted) {
+      return;
+    }
+    Fire(index, generation, armed);
+  });
+}
+
+void TimerPool::Disarm(Slot& slot) {
+  if (slot.type == TimerType::kCoarse) {
+    wheel_.Remove(&slot);
+    return;
+  }
+  slot.timer.cancel();
+}
+
+void TimerPool::Fire(uint32_t index, uint32_t generation, uint32_t armed) {
+  auto* slot = Find(index, generation);
+  if (!slot || slot->armed != armed) {
+    return;
+  }
+
+  /**
+   * @brief release first, the task may schedule again, and reuse this slot
+   */
+  auto task = std::move(slot->task);
+  Release(*slot);
+  task();
+}
+
+void TimerPool::Release(Slot& slot) {
+  slot.active = false;
+  ++slot.generation;
+  free_.push_back(slot.index);
+}
+
+}  // namespace spiderweb
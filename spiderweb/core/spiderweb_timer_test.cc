@@ -1,5 +1,7 @@
 #include "spiderweb/core/spiderweb_timer.h"
 
+#include <chrono>
+
 #include "gtest/gtest.h"
 #include "spiderweb/core/spiderweb_eventloop.h"
 
@@ -59,3 +61,124 @@ TEST(spiderweb_timer, Stop) {
 
   EXPECT_FALSE(timer.IsRunning());
 }
+
+TEST(spiderweb_timer, CoarseTimeout) {
+  spiderweb::EventLoop loop;
+
+  spiderweb::Timer timer;
+  timer.SetTimerType(spiderweb::TimerType::kCoarse);
+  timer.SetInterval(20);
+
+  int count = 0;
+  spiderweb::Object::Connect(&timer, &spiderweb::Timer::timeout, &loop, [&]() {
+    if (++count == 3) {
+      loop.Quit();
+    }
+  });
+
+  const auto start = std::chrono::steady_clock::now();
+  timer.Start();
+  loop.Exec();
+
+  EXPECT_EQ(count, 3);
+  EXPECT_TRUE(timer.IsRunning());
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(60));
+}
+
+TEST(spiderweb_timer, CoarseStop) {
+  spiderweb::EventLoop loop;
+
+  spiderweb::Timer timer;
+  timer.SetTimerType(spiderweb::TimerType::kCoarse);
+  timer.SetInterval(10);
+
+  bool called = false;
+  spiderweb::Object::Connect(&timer, &spiderweb::Timer::timeout, &loop, [&]() { called = true; });
+
+  timer.Start();
+  timer.Stop();
+  EXPECT_FALSE(timer.IsRunning());
+
+  loop.RunAfter(50, [&]() { loop.Quit(); });
+  loop.Exec();
+  EXPECT_FALSE(called);
+}
+
+TEST(spiderweb_timer, CoarseRunAfter) {
+  spiderweb::EventLoop loop;
+
+  bool called = false;
+  loop.RunAfter(
+      10,
+      [&]() {
+        called = true;
+        loop.Quit();
+      },
+      spiderweb::TimerType::kCoarse);
+
+  loop.Exec();
+  EXPECT_TRUE(called);
+}
+
+TEST(spiderweb_timer, RunAfterCancel) {
+  for (auto type : {spiderweb::TimerType::kPrecise, spiderweb::TimerType::kCoarse}) {
+    spiderweb::EventLoop loop;
+
+    bool called = false;
+    auto handle = loop.RunAfter(10, [&]() { called = true; }, type);
+    EXPECT_TRUE(handle.IsActive());
+
+    handle.Cancel();
+    EXPECT_FALSE(handle.IsActive());
+
+    loop.RunAfter(50, [&]() { loop.Quit(); });
+    loop.Exec();
+    EXPECT_FALSE(called);
+  }
+}
+
+TEST(spiderweb_timer, RunAfterReschedule) {
+  for (auto type : {spiderweb::TimerType::kPrecise, spiderweb::TimerType::kCoarse}) {
+    spiderweb::EventLoop loop;
+
+    bool called = false;
+    auto handle = loop.RunAfter(10, [&]() { called = true; }, type);
+    EXPECT_TRUE(handle.Reschedule(500));
+
+    loop.RunAfter(50, [&]() {
+      EXPECT_FALSE(called);
+      EXPECT_TRUE(handle.Reschedule(0));
+    });
+    loop.RunAfter(100, [&]() { loop.Quit(); });
+    loop.Exec();
+    EXPECT_TRUE(called);
+    EXPECT_FALSE(handle.IsActive());
+    EXPECT_FALSE(handle.Reschedule(10));
+  }
+}
+
+TEST(spiderweb_timer, RunAfterStaleHandle) {
+  spiderweb::EventLoop loop;
+
+  int  first = 0;
+  int  second = 0;
+  auto stale = loop.RunAfter(10, [&]() { ++first; });
+  stale.Cancel();
+
+  /**
+   * @brief reuses the slot of `stale`
+   */
+  auto handle = loop.RunAfter(10, [&]() { ++second; });
+  stale.Cancel();
+  EXPECT_FALSE(stale.Reschedule(0));
+  EXPECT_TRUE(handle.IsActive());
+
+  loop.RunAfter(50, [&]() { loop.Quit(); });
+  loop.Exec();
+  EXPECT_EQ(first, 0);
+  EXPECT_EQ(second, 1);
+
+  spiderweb::TimerHandle empty;
+  EXPECT_FALSE(empty.IsActive());
+  empty.Cancel();
+}
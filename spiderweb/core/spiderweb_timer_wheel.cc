@@ -0,0 +1,124 @@
+#include "core/internal/timer_wheel.h"
+
+#include <algorithm>
+
+namespace spiderweb {
+
+TimerWheel::Entry::~Entry() {
+  if (wheel_) {
+    wheel_->Remove(this);
+  }
+}
+
+TimerWheel::TimerWheel(asio::io_service& io, uint32_t tick_ms, std::size_t slots)
+    : timer_(io), tick_(tick_ms), slots_(slots), start_(Clock::now()) {
+}
+
+TimerWheel::~TimerWheel() {
+  for (auto& slot : slots_) {
+    while (slot.Linked()) {
+      auto* entry = static_cast<Entry*>(slot.next);
+      entry->Unlink();
+      entry->wheel_ = nullptr;
+      entry->OnAbandoned();
+    }
+  }
+  timer_.cancel();
+}
+
+void TimerWheel::Add(Entry* entry, uint64_t delay_ms) {
+  Remove(entry);
+
+  if (size_ == 0) {
+    current_tick_ = NowTick();
+  }
+
+  /**
+   * @brief expire at the first tick boundary after the deadline
+   */
+  const uint64_t deadline = NowMs() + delay_ms;
+  const uint64_t target =
+      std::max(current_tick_ + 1, (deadline + tick_.count() - 1) / tick_.count());
+
+  entry->wheel_ = this;
+  entry->rounds_ = (target - current_tick_ - 1) / slots_.size();
+  slots_[target % slots_.size()].PushBack(entry);
+  ++size_;
+
+  Arm();
+}
+
+void TimerWheel::Remove(Entry* entry) {
+  if (entry->Linked()) {
+    entry->Unlink();
+    --size_;
+  }
+  entry->wheel_ = nullptr;
+}
+
+uint64_t TimerWheel::NowMs() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - start_).count();
+}
+
+uint64_t TimerWheel::NowTick() const {
+  return NowMs() / tick_.count();
+}
+
+void TimerWheel::Arm() {
+  if (armed_ || size_ == 0) {
+    return;
+  }
+
+  armed_ = true;
+  timer_.expires_at(start_ + tick_ * (current_tick_ + 1));
+  timer_.async_wait([this](const asio::error_code& ec) {
+    if (ec.value() == asio::error::operation_aborted) {
+      return;
+    }
+    armed_ = false;
+    OnTick();
+    Arm();
+  });
+}
+
+void TimerWheel::OnTick() {
+  const uint64_t now = NowTick();
+
+  while (current_tick_ < now && size_ > 0) {
+    ++current_tick_;
+
+    /**
+     * @brief move the slot aside, so that entries added or removed by the callbacks are safe
+     */
+    auto& slot = slots_[current_tick_ % slots_.size()];
+    Link  expiring;
+    if (slot.Linked()) {
+      expiring.next = slot.next;
+      expiring.prev = slot.prev;
+      slot.next->prev = &expiring;
+      slot.prev->next = &expiring;
+      slot.next = slot.prev = &slot;
+    }
+
+    while (expiring.Linked()) {
+      auto* entry = static_cast<Entry*>(expiring.next);
+      entry->Unlink();
+
+      if (entry->rounds_ > 0) {
+        --entry->rounds_;
+        slot.PushBack(entry);
+        continue;
+      }
+
+      --size_;
+      entry->wheel_ = nullptr;
+      entry->OnExpired();
+    }
+  }
+
+  if (size_ == 0) {
+    current_tick_ = now;
+  }
+}
+
+}  // namespace spiderweb
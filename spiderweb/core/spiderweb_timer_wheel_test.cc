@@ -0,0 +1,117 @@
+#include "core/internal/timer_wheel.h"
+
+#include <chrono>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+class CountEntry : public spiderweb::TimerWheel::Entry {
+ public:
+  void OnExpired() override {
+    ++expired;
+    expired_at = std::chrono::steady_clock::now();
+  }
+
+  int                                   expired = 0;
+  std::chrono::steady_clock::time_point expired_at;
+};
+
+void RunFor(asio::io_service& io, int ms) {
+  io.reset();
+  io.run_for(std::chrono::milliseconds(ms));
+}
+
+}  // namespace
+
+TEST(spiderweb_TimerWheel, Expire) {
+  asio::io_service      io;
+  spiderweb::TimerWheel wheel(io, 1, 8);
+
+  CountEntry entry;
+  const auto start = std::chrono::steady_clock::now();
+  wheel.Add(&entry, 5);
+  EXPECT_TRUE(entry.IsActive());
+  EXPECT_EQ(wheel.Size(), 1);
+
+  RunFor(io, 50);
+  EXPECT_EQ(entry.expired, 1);
+  EXPECT_FALSE(entry.IsActive());
+  EXPECT_EQ(wheel.Size(), 0);
+  EXPECT_GE(entry.expired_at - start, std::chrono::milliseconds(5));
+}
+
+TEST(spiderweb_TimerWheel, MoreThanOneRound) {
+  asio::io_service      io;
+  spiderweb::TimerWheel wheel(io, 1, 8);
+
+  /**
+   * @brief 8 slots of 1ms, the 30ms entry waits for several rounds
+   */
+  CountEntry early;
+  CountEntry late;
+  wheel.Add(&early, 3);
+  wheel.Add(&late, 30);
+
+  RunFor(io, 15);
+  EXPECT_EQ(early.expired, 1);
+  EXPECT_EQ(late.expired, 0);
+
+  RunFor(io, 50);
+  EXPECT_EQ(late.expired, 1);
+}
+
+TEST(spiderweb_TimerWheel, RemoveAndReAdd) {
+  asio::io_service      io;
+  spiderweb::TimerWheel wheel(io, 1, 8);
+
+  std::vector<CountEntry> entries(100);
+  for (auto& entry : entries) {
+    wheel.Add(&entry, 5);
+  }
+  for (std::size_t i = 0; i < entries.size(); i += 2) {
+    wheel.Remove(&entries[i]);
+  }
+  /**
+   * @brief adding an active entry reschedules it
+   */
+  wheel.Add(&entries[1], 1000);
+  EXPECT_EQ(wheel.Size(), 50);
+
+  RunFor(io, 50);
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    EXPECT_EQ(entries[i].expired, (i % 2 == 1 && i != 1) ? 1 : 0) << i;
+  }
+  EXPECT_EQ(wheel.Size(), 1);
+}
+
+TEST(spiderweb_TimerWheel, DestroyEntry) {
+  asio::io_service      io;
+  spiderweb::TimerWheel wheel(io, 1, 8);
+
+  {
+    CountEntry entry;
+    wheel.Add(&entry, 5);
+  }
+  EXPECT_EQ(wheel.Size(), 0);
+}
+
+TEST(spiderweb_TimerWheel, EntryOutlivesWheel) {
+  CountEntry expired;
+  CountEntry abandoned;
+  {
+    asio::io_service      io;
+    spiderweb::TimerWheel wheel(io, 1, 8);
+
+    wheel.Add(&expired, 1);
+    wheel.Add(&abandoned, 1000);
+    RunFor(io, 20);
+    EXPECT_EQ(expired.expired, 1);
+  }
+  /**
+   * @brief neither entry may touch the destroyed wheel when it is destroyed
+   */
+  EXPECT_FALSE(expired.IsActive());
+  EXPECT_FALSE(abandoned.IsActive());
+}
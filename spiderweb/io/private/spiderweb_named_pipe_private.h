@@ -34,8 +34,23 @@ class NamedPipe::Private {
     stream.async_read_some(buffer, std::forward<Handler>(handler));
   }
 
-  template <typename AsyncStream, typename Handler>
-  void Write(AsyncStream& stream, const asio::mutable_buffers_1& buffers, Handler&& handler) {
+  /**
+   * @brief a non blocking read, used to drain the stream after a full read
+   */
+  template <typename AsyncStream>
+  std::size_t TryRead(AsyncStream& stream, const asio::mutable_buffers_1& buffer,
+                      asio::error_code& ec) {
+    if (!stream.non_blocking()) {
+      (void)stream.non_blocking(true, ec);
+      if (ec) {
+        return 0;
+      }
+    }
+    return stream.read_some(buffer, ec);
+  }
+
+  template <typename AsyncStream, typename ConstBufferSequence, typename Handler>
+  void Write(AsyncStream& stream, const ConstBufferSequence& buffers, Handler&& handler) {
     asio::async_write(stream, buffers, asio::transfer_all(), std::forward<Handler>(handler));
   }
 
@@ -53,6 +68,14 @@ class NamedPipe::Private {
     spider_emit q->BytesWritten(size);
   }
 
+  void WriteBufferFull(std::size_t size) {
+    spider_emit q->WriteBufferFull(size);
+  }
+
+  void WriteBufferDrained() {
+    spider_emit q->WriteBufferDrained();
+  }
+
   void Readden(const io::BufferReader& reader) {
     spider_emit q->BytesRead(reader);
   }
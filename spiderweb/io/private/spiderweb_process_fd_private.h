@@ -28,8 +28,18 @@ class ProcessFd::Private {
     stream.async_read_some(buffer, std::forward<Handler>(handler));
   }
 
-  template <typename AsyncStream, typename Handler>
-  void Write(AsyncStream& stream, const asio::mutable_buffers_1& buffers, Handler&& handler) {
+  /**
+   * @brief process pipes are not drained, see IoPrivate::DrainRead
+   */
+  template <typename AsyncStream>
+  std::size_t TryRead(AsyncStream& /*stream*/, const asio::mutable_buffers_1& /*buffer*/,
+                      asio::error_code& ec) {
+    ec = asio::error::would_block;
+    return 0;
+  }
+
+  template <typename AsyncStream, typename ConstBufferSequence, typename Handler>
+  void Write(AsyncStream& stream, const ConstBufferSequence& buffers, Handler&& handler) {
     asio::async_write(stream, buffers, asio::transfer_all(), std::forward<Handler>(handler));
   }
 
@@ -45,6 +55,14 @@ class ProcessFd::Private {
     spider_emit q->BytesWritten(size);
   }
 
+  void WriteBufferFull(std::size_t size) {
+    spider_emit q->WriteBufferFull(size);
+  }
+
+  void WriteBufferDrained() {
+    spider_emit q->WriteBufferDrained();
+  }
+
   void Readden(const io::BufferReader& reader) {
     spider_emit q->BytesRead(reader);
   }
@@ -1,13 +1,20 @@
 #ifndef SPIDERWEB_STREAM_PRIVATE_H
 #define SPIDERWEB_STREAM_PRIVATE_H
 
+#include <algorithm>
 #include <cstdio>
+#include <functional>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "asio.hpp"
 #include "spdlog/spdlog.h"
 #include "spiderweb/core/spiderweb_traits.h"
+#include "spiderweb/io/private/spiderweb_write_queue.h"
 #include "spiderweb/io/spiderweb_buffer.h"
+#include "spiderweb/io/spiderweb_buffer_chain.h"
+#include "spiderweb/io/spiderweb_shared_slice.h"
 
 namespace spiderweb {
 namespace io {
@@ -92,7 +99,7 @@ class IoPrivate : public std::enable_shared_from_this<IoPrivate<IoImpl>> {
 
   template <typename AsyncStream>
   void StartRead(AsyncStream& stream) {
-    if (stopped) {
+    if (stopped || IsReadPaused()) {
       return;
     }
 
@@ -111,7 +118,7 @@ class IoPrivate : public std::enable_shared_from_this<IoPrivate<IoImpl>> {
      *
      * every time we receive data. Looks fine, just one more copy. So we can avoid it
      *
-     * as much as possible. The Write process of @ref io::Buffer is:
+     * as much as possible. The Write process of @ref io::BufferChain is:
      *
      * 1. PrepareWrite
      *
@@ -120,19 +127,36 @@ class IoPrivate : public std::enable_shared_from_this<IoPrivate<IoImpl>> {
      * 3. Commit
      *
      * Therefore, in StartRead, we separate these three steps and execute them.
+     *
+     * The receive buffer is a chain of blocks, if the user does not read everything, new data is
+     *
+     * read into a new block, what has been buffered is never moved. PrepareWrite also releases the
+     *
+     * blocks which have been read.
      */
-    if (recv_buffer.leftSpace() < kSpaceGrowSize) {
-      recv_buffer.PrepareWrite(kSpaceGrowSize);
-    }
+    recv_buffer.PrepareWrite(read_size);
 
     const auto buffer = asio::buffer(recv_buffer.beginWrite(), recv_buffer.leftSpace());
 
     auto self = this->shared_from_this();
-    impl.Read(stream, buffer, [this, self, &stream](const asio::error_code& ec, std::size_t n) {
+    reading = true;
+    impl.Read(stream, buffer, [this, self, &stream, size = buffer.size()](
+                                  const asio::error_code& ec, std::size_t n) {
+      reading = false;
       if (stopped) {
         return;
       }
 
+      /**
+       * @brief the end of the stream is left to the one who reads it now, an error is handed to
+       *
+       * it, the stream would only report its end after.
+       */
+      if (ec && on_read_released) {
+        CallReadReleased(ec == asio::error::eof ? asio::error_code() : ec);
+        return;
+      }
+
       if (ec) {
         Stop(stream);
         /**
@@ -143,11 +167,164 @@ class IoPrivate : public std::enable_shared_from_this<IoPrivate<IoImpl>> {
       }
 
       recv_buffer.CommitWrite(n);
-      StartRead(stream);
+      AdaptReadSize(n, size);
+
+      asio::error_code drain_ec;
+      if (drain_reads && n == size) {
+        drain_ec = DrainRead(stream);
+      }
       impl.Readden(io::BufferReader(this->recv_buffer));
+
+      if (drain_ec) {
+        if (!stopped) {
+          Stop(stream);
+          impl.Error(drain_ec);
+        }
+        return;
+      }
+
+      if (on_read_released) {
+        CallReadReleased(asio::error_code());
+        return;
+      }
+
+      /**
+       * @brief read again after the user has consumed what it wants, so that max_read_buffer
+       *
+       * sees what is really left. the slot may have resumed reading already.
+       */
+      RestartRead(stream);
     });
   }
 
+  /**
+   * @brief a read which filled the buffer doubles the next read, up to kMaxReadSize, a read
+   *
+   * which used less than half of it halves the next one, down to min_read_size. bulk streams
+   *
+   * then need less syscalls and loop round trips per byte, and idle ones do not hold big blocks.
+   */
+  void AdaptReadSize(std::size_t n, std::size_t size) {
+    if (n == size) {
+      read_size = std::min(read_size * 2, std::max(kMaxReadSize, min_read_size));
+    } else if (n < read_size / 2) {
+      read_size = std::max(read_size / 2, min_read_size);
+    }
+  }
+
+  /**
+   * @brief after a read which filled the buffer, keep reading without blocking until the stream
+   *
+   * has nothing more(EAGAIN), so that BytesRead is emitted once for all of it. at most
+   *
+   * kMaxDrainReads reads are done, not to starve the other work of the loop.
+   *
+   * @return the error which stops the stream, the bytes read before it are still delivered
+   */
+  template <typename AsyncStream>
+  asio::error_code DrainRead(AsyncStream& stream) {
+    for (std::size_t i = 0; i < kMaxDrainReads && !IsReadPaused(); ++i) {
+      recv_buffer.PrepareWrite(read_size);
+
+      const auto       buffer = asio::buffer(recv_buffer.beginWrite(), recv_buffer.leftSpace());
+      asio::error_code ec;
+      const auto       n = impl.TryRead(stream, buffer, ec);
+      if (ec == asio::error::would_block || ec == asio::error::try_again) {
+        return asio::error_code();
+      }
+      if (ec) {
+        return ec;
+      }
+
+      recv_buffer.CommitWrite(n);
+      AdaptReadSize(n, buffer.size());
+      if (n < buffer.size()) {
+        break;
+      }
+    }
+    return asio::error_code();
+  }
+
+  /**
+   * @brief reading is paused until every PauseRead is balanced by a ResumeRead. a read which is
+   *
+   * already in progress still completes, and its data is delivered.
+   */
+  void PauseRead() {
+    ++read_paused;
+  }
+
+  /**
+   * @brief balances one PauseRead. when the stream is not paused by the user, it restarts reading
+   *
+   * which stopped at max_read_buffer instead, the pause count is then left as it is.
+   */
+  template <typename AsyncStream>
+  void ResumeRead(AsyncStream& stream) {
+    if (read_paused > 0 && --read_paused > 0) {
+      return;
+    }
+
+    RestartRead(stream);
+  }
+
+  /**
+   * @brief read again, if neither the user nor max_read_buffer keeps the stream paused.
+   */
+  template <typename AsyncStream>
+  void RestartRead(AsyncStream& stream) {
+    if (!reading) {
+      StartRead(stream);
+    }
+  }
+
+  bool IsReadPaused() const {
+    return read_released || read_paused > 0 ||
+           (max_read_buffer > 0 && recv_buffer.Len() >= max_read_buffer);
+  }
+
+  using ReadReleased = std::function<void(const std::error_code&)>;
+
+  /**
+   * @brief stop reading for good, the stream is then read by someone else, e.g. a
+   *
+   * StreamForwarder. `released` is called once no read is in progress: a read can not be
+   *
+   * cancelled alone, so the one in progress completes first, when the stream has data, ends or
+   *
+   * fails. the bytes received and not read by the user yet are delivered by Readden before, and
+   *
+   * the error of the read, if any, is passed to `released`.
+   */
+  void ReleaseRead(ReadReleased released) {
+    read_released = true;
+    if (reading) {
+      on_read_released = std::move(released);
+      return;
+    }
+
+    if (recv_buffer.Len() > 0) {
+      impl.Readden(io::BufferReader(recv_buffer));
+    }
+    released(asio::error_code());
+  }
+
+  void CallReadReleased(const asio::error_code& ec) {
+    auto released = std::move(on_read_released);
+    on_read_released = nullptr;
+    released(ec);
+  }
+
+  /**
+   * @brief WriteBufferFull is reported when the bytes waiting to be written reach `high`, and
+   *
+   * WriteBufferDrained when they fall to `low` again. `high` 0 means no limit.
+   */
+  void SetWriteWatermarks(std::size_t high, std::size_t low) {
+    high_watermark = high;
+    low_watermark = std::min(low, high);
+  }
+
   template <typename AsyncStream, typename Byte,
             typename = typename std::enable_if<IsByte<Byte>::value>::type>
   void StartWrite(AsyncStream& stream, const std::vector<Byte>& data) {
@@ -161,18 +338,20 @@ class IoPrivate : public std::enable_shared_from_this<IoPrivate<IoImpl>> {
 
   template <typename AsyncStream>
   void StartWrite(AsyncStream& stream, const uint8_t* data, std::size_t size) {
-    if (stopped) {
-      spdlog::warn("{}({}) stopped", impl.Description(), fmt::ptr(impl.q));
-      return;
-    }
-
-    const bool should_write = send_buffer.Len() == 0;
+    QueueWrite(stream, data, size);
+  }
 
-    send_buffer.Write(reinterpret_cast<const char*>(data), size);
+  /**
+   * @brief the buffer is queued as is, and written with a gathered write, without any copy.
+   */
+  template <typename AsyncStream>
+  void StartWrite(AsyncStream& stream, std::vector<uint8_t>&& data) {
+    QueueWrite(stream, std::move(data));
+  }
 
-    if (should_write) {
-      StartWrite(stream);
-    }
+  template <typename AsyncStream>
+  void StartWrite(AsyncStream& stream, io::SharedSlice slice) {
+    QueueWrite(stream, std::move(slice));
   }
 
   template <typename AsyncStream>
@@ -182,15 +361,24 @@ class IoPrivate : public std::enable_shared_from_this<IoPrivate<IoImpl>> {
       return;
     }
 
-    if (send_buffer.Len() == 0) {
+    if (send_queue.Empty()) {
       return;
     }
 
     auto self = this->shared_from_this();
-    impl.Write(stream, asio::buffer(send_buffer.lastRead(), send_buffer.Len()),
-               [this, self, &stream](const asio::error_code& ec, std::size_t size) {
-                 HandleWrite(stream, ec, size);
-               });
+    auto handler = [this, self, &stream](const asio::error_code& ec, std::size_t size) {
+      HandleWrite(stream, ec, size);
+    };
+
+    /**
+     * @brief a single buffer is written as before, many are gathered into one writev.
+     */
+    const auto buffers = send_queue.Prepare();
+    if (buffers.size() == 1) {
+      impl.Write(stream, asio::buffer(buffers[0]), std::move(handler));
+    } else {
+      impl.Write(stream, buffers, std::move(handler));
+    }
   }
 
   template <typename AsyncStream>
@@ -208,11 +396,15 @@ class IoPrivate : public std::enable_shared_from_this<IoPrivate<IoImpl>> {
       return;
     }
 
-    char* ptr = nullptr;
-    send_buffer.ZeroCopyRead(ptr, size);
+    send_queue.Consume(size);
     StartWrite(stream);
 
     impl.Written(size);
+
+    if (write_full && send_queue.Len() <= low_watermark) {
+      write_full = false;
+      impl.WriteBufferDrained();
+    }
   }
 
   template <typename AsyncStream>
@@ -232,14 +424,66 @@ class IoPrivate : public std::enable_shared_from_this<IoPrivate<IoImpl>> {
     close_called = true;
   }
 
-  IoImpl                   impl;
-  bool                     stopped = true;
-  io::Buffer               recv_buffer;
-  io::Buffer               send_buffer;
-  static const std::size_t kSpaceGrowSize = 8192;
-  bool                     close_called = false;
+ private:
+  template <typename AsyncStream, typename... Data>
+  void QueueWrite(AsyncStream& stream, Data&&... data) {
+    if (stopped) {
+      spdlog::warn("{}({}) stopped", impl.Description(), fmt::ptr(impl.q));
+      return;
+    }
+
+    const bool should_write = send_queue.Empty();
+
+    send_queue.Append(std::forward<Data>(data)...);
+
+    if (should_write) {
+      StartWrite(stream);
+    }
+
+    if (!write_full && high_watermark > 0 && send_queue.Len() >= high_watermark) {
+      write_full = true;
+      impl.WriteBufferFull(send_queue.Len());
+    }
+  }
+
+ public:
+
+  IoImpl                       impl;
+  bool                         stopped = true;
+  io::BufferChain              recv_buffer;
+  io::WriteQueue               send_queue;
+  static constexpr std::size_t kSpaceGrowSize = 8192;
+  static constexpr std::size_t kMaxReadSize = 64 * 1024;
+  static constexpr std::size_t kMaxDrainReads = 16;
+  /// size of the next read, see AdaptReadSize
+  std::size_t                  read_size = kSpaceGrowSize;
+  /// reads are never smaller, e.g. the max message size of a message oriented stream
+  std::size_t                  min_read_size = kSpaceGrowSize;
+  /// see DrainRead
+  bool                         drain_reads = false;
+  bool                         close_called = false;
+  /// a read is in progress
+  bool                         reading = false;
+  uint32_t                     read_paused = 0;
+  /// see ReleaseRead
+  bool                         read_released = false;
+  ReadReleased                 on_read_released;
+  /// reading stops while the user leaves this many bytes in recv_buffer, 0 means no limit
+  std::size_t                  max_read_buffer = 0;
+  std::size_t                  high_watermark = 0;
+  std::size_t                  low_watermark = 0;
+  bool                         write_full = false;
 };
 
+template <typename IoImpl>
+constexpr std::size_t IoPrivate<IoImpl>::kSpaceGrowSize;
+
+template <typename IoImpl>
+constexpr std::size_t IoPrivate<IoImpl>::kMaxReadSize;
+
+template <typename IoImpl>
+constexpr std::size_t IoPrivate<IoImpl>::kMaxDrainReads;
+
 }  // namespace io
 }  // namespace spiderweb
 
@@ -0,0 +1,185 @@
+#ifndef SPIDERWEB_WRITE_QUEUE_H
+#define SPIDERWEB_WRITE_QUEUE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "asio/buffer.hpp"
+#include "spiderweb/io/spiderweb_shared_slice.h"
+
+namespace spiderweb {
+namespace io {
+
+/**
+ * @brief the send queue of a stream.
+ *
+ * it is a queue of chunks, which are written with one gathered(writev) write. copied writes are
+ *
+ * coalesced into the chunk at the tail, owned buffers(std::vector<uint8_t>&&, SharedSlice) become
+ *
+ * chunks of their own, so their bytes are never copied.
+ *
+ * the chunks of a pending write(see Prepare) are never touched until Consume.
+ */
+class WriteQueue {
+ public:
+  /**
+   * @brief copied writes are coalesced into one chunk up to this size
+   */
+  static constexpr std::size_t kCoalesceSize = 64 * 1024;
+
+  /**
+   * @brief buffers of one write, more than that is split by asio anyway
+   */
+  static constexpr std::size_t kMaxBuffers = 64;
+
+  bool Empty() const {
+    return len_ == 0;
+  }
+
+  /**
+   * @brief bytes not written yet, including the pending write
+   */
+  std::size_t Len() const {
+    return len_;
+  }
+
+  void Append(const uint8_t* data, std::size_t size) {
+    if (size == 0) {
+      return;
+    }
+
+    if (chunks_.size() == pending_ || !chunks_.back().coalesce ||
+        chunks_.back().bytes.size() + size > kCoalesceSize) {
+      chunks_.emplace_back();
+      chunks_.back().coalesce = true;
+      chunks_.back().bytes.swap(spare_);
+    }
+
+    auto& bytes = chunks_.back().bytes;
+    bytes.insert(bytes.end(), data, data + size);
+    len_ += size;
+  }
+
+  void Append(std::vector<uint8_t>&& data) {
+    if (data.empty()) {
+      return;
+    }
+
+    len_ += data.size();
+    chunks_.emplace_back();
+    chunks_.back().bytes = std::move(data);
+  }
+
+  void Append(SharedSlice slice) {
+    if (slice.empty()) {
+      return;
+    }
+
+    len_ += slice.size();
+    chunks_.emplace_back();
+    chunks_.back().slice = std::move(slice);
+    chunks_.back().shared = true;
+  }
+
+  /**
+   * @brief the buffers of the next write, valid until Consume
+   */
+  absl::Span<const asio::const_buffer> Prepare() {
+    pending_ = std::min(chunks_.size(), std::size_t{kMaxBuffers});
+
+    buffers_.clear();
+    for (std::size_t i = 0; i < pending_; ++i) {
+      buffers_.emplace_back(chunks_[i].Data(), chunks_[i].Size());
+    }
+    return buffers_;
+  }
+
+  /**
+   * @brief append the owners of the pending write to `owners`, they keep its bytes alive after
+   *
+   * Consume, e.g. until the kernel is done with a zero copy send. the chunks become shared ones,
+   *
+   * their bytes are moved, not copied, so the buffers of Prepare stay valid.
+   */
+  void ShareOwners(std::vector<SharedSlice>* owners) {
+    for (std::size_t i = 0; i < pending_; ++i) {
+      auto& chunk = chunks_[i];
+      if (!chunk.shared) {
+        auto bytes = std::make_shared<const std::vector<uint8_t>>(std::move(chunk.bytes));
+        chunk.slice =
+            SharedSlice(bytes, bytes->data() + chunk.offset, bytes->size() - chunk.offset);
+        chunk.bytes = std::vector<uint8_t>();
+        chunk.offset = 0;
+        chunk.shared = true;
+        chunk.coalesce = false;
+      }
+      owners->push_back(chunk.slice);
+    }
+  }
+
+  /**
+   * @brief `n` bytes of the pending write are written
+   */
+  void Consume(std::size_t n) {
+    pending_ = 0;
+    len_ -= n;
+
+    while (n > 0) {
+      auto& chunk = chunks_.front();
+      if (n < chunk.Size()) {
+        chunk.RemovePrefix(n);
+        return;
+      }
+
+      n -= chunk.Size();
+      if (chunk.coalesce && chunk.bytes.capacity() <= kCoalesceSize) {
+        chunk.bytes.clear();
+        spare_.swap(chunk.bytes);
+      }
+      chunks_.pop_front();
+    }
+  }
+
+ private:
+  struct Chunk {
+    const uint8_t* Data() const {
+      return shared ? slice.data() : bytes.data() + offset;
+    }
+
+    std::size_t Size() const {
+      return shared ? slice.size() : bytes.size() - offset;
+    }
+
+    void RemovePrefix(std::size_t n) {
+      if (shared) {
+        slice.RemovePrefix(n);
+      } else {
+        offset += n;
+      }
+    }
+
+    std::vector<uint8_t> bytes;
+    SharedSlice          slice;
+    std::size_t          offset = 0;
+    bool                 shared = false;
+    bool                 coalesce = false;
+  };
+
+  std::deque<Chunk>               chunks_;
+  std::vector<asio::const_buffer> buffers_;
+  /// the memory of the last coalesced chunk, reused by the next one
+  std::vector<uint8_t>            spare_;
+  std::size_t                     pending_ = 0;
+  std::size_t                     len_ = 0;
+};
+
+}  // namespace io
+}  // namespace spiderweb
+
+#endif
@@ -0,0 +1,38 @@
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "spiderweb/io/spiderweb_buffer.h"
+#include "spiderweb/io/spiderweb_buffer_chain.h"
+
+/**
+ * @brief a slow consumer, range(0) bytes stay buffered, while 4KB are written and read per
+ *
+ * iteration, as the receive buffer of a stream does.
+ */
+template <typename BufferType>
+static void BM_BufferSustained(benchmark::State &state) {
+  const std::string chunk(4096, 'x');
+  std::vector<char> out(chunk.size());
+  BufferType        buffer;
+
+  for (int64_t i = 0; i < state.range(0); i += static_cast<int64_t>(chunk.size())) {
+    buffer.Write(chunk);
+  }
+
+  for (auto _ : state) {
+    buffer.PrepareWrite(chunk.size());
+    buffer.Write(chunk);
+    buffer.Read(out.data(), out.size());
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(chunk.size()));
+}
+BENCHMARK_TEMPLATE(BM_BufferSustained, spiderweb::io::Buffer)
+    ->Arg(0)
+    ->Arg(64 << 10)
+    ->Arg(4 << 20);
+BENCHMARK_TEMPLATE(BM_BufferSustained, spiderweb::io::BufferChain)
+    ->Arg(0)
+    ->Arg(64 << 10)
+    ->Arg(4 << 20);
@@ -0,0 +1,453 @@
+#include "spiderweb/io/spiderweb_buffer_chain.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <new>
+
+namespace spiderweb {
+namespace io {
+
+constexpr std::size_t BufferChain::kBlockSize;
+
+namespace detail {
+struct BufferBlock {
+  explicit BufferBlock(uint32_t cap) : capacity(cap) {
+  }
+
+  char* Data() {
+    return reinterpret_cast<char*>(this + 1);
+  }
+
+  std::atomic<uint32_t> refs{1};
+  uint32_t              capacity;
+};
+}  // namespace detail
+
+namespace {
+using detail::BufferBlock;
+
+constexpr std::size_t kMaxCachedBlocks = 64;
+
+/**
+ * @brief blocks of kBlockSize released in this thread, reused by the next NewBlock
+ */
+struct BlockCache {
+  ~BlockCache();
+
+  std::vector<BufferBlock*> blocks;
+};
+
+thread_local bool       cache_destroyed = false;
+thread_local BlockCache cache;
+
+void DeleteBlock(BufferBlock* block) {
+  block->~BufferBlock();
+  ::operator delete(block);
+}
+
+BlockCache::~BlockCache() {
+  for (auto* block : blocks) {
+    DeleteBlock(block);
+  }
+  cache_destroyed = true;
+}
+
+BufferBlock* NewBlock(std::size_t capacity) {
+  if (capacity <= BufferChain::kBlockSize) {
+    capacity = BufferChain::kBlockSize;
+
+    if (!cache_destroyed && !cache.blocks.empty()) {
+      auto* block = cache.blocks.back();
+      cache.blocks.pop_back();
+      block->refs.store(1, std::memory_order_relaxed);
+      return block;
+    }
+  }
+
+  void* mem = ::operator new(sizeof(BufferBlock) + capacity);
+  return new (mem) BufferBlock(static_cast<uint32_t>(capacity));
+}
+
+void Ref(BufferBlock* block) {
+  block->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Unref(BufferBlock* block) {
+  if (block->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+
+  if (block->capacity == BufferChain::kBlockSize && !cache_destroyed &&
+      cache.blocks.size() < kMaxCachedBlocks) {
+    cache.blocks.push_back(block);
+    return;
+  }
+  DeleteBlock(block);
+}
+}  // namespace
+
+char* BufferChain::Segment::Data() const {
+  return block->Data();
+}
+
+BufferChain::~BufferChain() {
+  Reset();
+}
+
+BufferChain::BufferChain(BufferChain&& other) noexcept {
+  *this = std::move(other);
+}
+
+BufferChain& BufferChain::operator=(BufferChain&& other) noexcept {
+  if (this != &other) {
+    Reset();
+    segments_.swap(other.segments_);
+    retired_.swap(other.retired_);
+    std::swap(head_, other.head_);
+    std::swap(len_, other.len_);
+    std::swap(write_block_, other.write_block_);
+    std::swap(write_pos_, other.write_pos_);
+  }
+  return *this;
+}
+
+// Read All
+size_t BufferChain::Read(std::vector<char>& p) {
+  return ReadBytes(p, Len());
+}
+
+// Read One Byte
+char BufferChain::ReadByte() {
+  assert(len_ > 0 && "BufferChain::ReadByte(), empty buffer");
+
+  const auto& seg = segments_[head_];
+  const char  ch = seg.Data()[seg.read];
+  Consume(1);
+  return ch;
+}
+
+// Read N Bytes from buffer
+size_t BufferChain::ReadBytes(std::vector<char>& p, size_t n) {
+  p.clear();
+  n = std::min(n, Len());
+  p.resize(n);
+  return Read(p.data(), n);
+}
+
+size_t BufferChain::Read(char* buffer, size_t n) {
+  n = std::min(n, Len());
+
+  std::size_t copied = 0;
+  for (std::size_t i = head_; copied < n; ++i) {
+    const auto&       seg = segments_[i];
+    const std::size_t size = std::min<std::size_t>(seg.end - seg.read, n - copied);
+    std::memcpy(buffer + copied, seg.Data() + seg.read, size);
+    copied += size;
+  }
+  Consume(n);
+  return n;
+}
+
+size_t BufferChain::ZeroCopyRead(char*& ptr, size_t n) {
+  n = std::min(n, Len());
+  if (n == 0) {
+    ptr = nullptr;
+    return 0;
+  }
+
+  ptr = Contiguous(0, n);
+  Consume(n);
+  return n;
+}
+
+// write data into buffer
+size_t BufferChain::Write(const char* d, size_t len) {
+  std::size_t written = 0;
+  while (written < len) {
+    PrepareWrite(std::min(len - written, kBlockSize));
+
+    const std::size_t size = std::min(len - written, leftSpace());
+    std::memcpy(beginWrite(), d + written, size);
+    CommitWrite(size);
+    written += size;
+  }
+  return len;
+}
+
+size_t BufferChain::Write(const std::string& s) {
+  return Write(s.data(), s.size());
+}
+
+size_t BufferChain::Write(const std::vector<char>& p) {
+  return Write(p.data(), p.size());
+}
+
+void BufferChain::Append(BufferChain&& other) {
+  if (this == &other) {
+    return;
+  }
+
+  for (std::size_t i = other.head_; i < other.segments_.size(); ++i) {
+    auto seg = other.segments_[i];
+    seg.begin = seg.read;
+    segments_.push_back(seg);
+  }
+  len_ += other.len_;
+
+  /**
+   * @brief the refs of the unread segments are moved, release the rest of `other`
+   */
+  other.segments_.resize(other.head_);
+  other.len_ = 0;
+  other.Reset();
+}
+
+void BufferChain::UnReadByte() {
+  UnReadBytes(1);
+}
+
+void BufferChain::UnReadBytes(size_t n) {
+  while (n > 0) {
+    if (head_ == segments_.size() || segments_[head_].read == segments_[head_].begin) {
+      assert(head_ > 0 && "BufferChain::UnReadBytes too much data size");
+      if (head_ == 0) {
+        return;
+      }
+      --head_;
+      continue;
+    }
+
+    auto&             seg = segments_[head_];
+    const std::size_t size = std::min<std::size_t>(n, seg.read - seg.begin);
+    seg.read -= static_cast<uint32_t>(size);
+    len_ += size;
+    n -= size;
+  }
+}
+
+size_t BufferChain::Cap() const {
+  return len_ + leftSpace();
+}
+
+void BufferChain::Reset() {
+  for (const auto& seg : segments_) {
+    Unref(seg.block);
+  }
+  segments_.clear();
+  head_ = 0;
+  len_ = 0;
+
+  for (auto* block : retired_) {
+    Unref(block);
+  }
+  retired_.clear();
+
+  if (write_block_) {
+    Unref(write_block_);
+    write_block_ = nullptr;
+  }
+  write_pos_ = 0;
+}
+
+void BufferChain::Skip(uint32_t size) {
+  Consume(std::min<std::size_t>(size, Len()));
+}
+
+bool BufferChain::PeekAt(std::vector<char>& p, size_t index, size_t size) {
+  char* pointer = nullptr;
+  if (!PointerAt(&pointer, index, size)) {
+    return false;
+  }
+  p.insert(p.end(), pointer, pointer + size);
+  return true;
+}
+
+bool BufferChain::PointerAt(char** p, size_t index, size_t size) {
+  if (index >= Len() || size == 0 || size > Len() - index) {
+    return false;
+  }
+
+  *p = Contiguous(index, size);
+  return true;
+}
+
+void BufferChain::PrepareWrite(std::size_t n) {
+  Reclaim();
+
+  if (leftSpace() >= n) {
+    return;
+  }
+
+  /**
+   * @brief the bytes written to the old block are owned by the segments
+   */
+  if (write_block_) {
+    Unref(write_block_);
+  }
+  write_block_ = NewBlock(n);
+  write_pos_ = 0;
+}
+
+void BufferChain::CommitWrite(std::size_t n) {
+  if (n == 0) {
+    return;
+  }
+  assert(write_block_ && n <= leftSpace());
+
+  if (!segments_.empty() && segments_.back().block == write_block_ &&
+      segments_.back().end == write_pos_) {
+    if (head_ == segments_.size()) {
+      --head_;
+    }
+    segments_.back().end += static_cast<uint32_t>(n);
+  } else {
+    Ref(write_block_);
+    segments_.push_back(Segment{write_block_, write_pos_, write_pos_,
+                                static_cast<uint32_t>(write_pos_ + n)});
+  }
+
+  write_pos_ += static_cast<uint32_t>(n);
+  len_ += n;
+}
+
+char* BufferChain::beginWrite() {
+  return write_block_ ? write_block_->Data() + write_pos_ : nullptr;
+}
+
+size_t BufferChain::leftSpace() const {
+  return write_block_ ? write_block_->capacity - write_pos_ : 0;
+}
+
+BufferChain BufferChain::Split(std::size_t n) {
+  n = std::min(n, Len());
+
+  BufferChain result;
+  for (std::size_t i = head_; result.len_ < n; ++i) {
+    const auto&    seg = segments_[i];
+    const uint32_t size = static_cast<uint32_t>(std::min<std::size_t>(seg.end - seg.read,
+                                                                      n - result.len_));
+    Ref(seg.block);
+    result.segments_.push_back(Segment{seg.block, seg.read, seg.read, seg.read + size});
+    result.len_ += size;
+  }
+  Consume(n);
+  return result;
+}
+
+BufferChain BufferChain::Clone() const {
+  BufferChain result;
+  for (std::size_t i = head_; i < segments_.size(); ++i) {
+    const auto& seg = segments_[i];
+    Ref(seg.block);
+    result.segments_.push_back(Segment{seg.block, seg.read, seg.read, seg.end});
+  }
+  result.len_ = len_;
+  return result;
+}
+
+SharedSlice BufferChain::Share(std::size_t index, std::size_t size) {
+  char* data = nullptr;
+  if (!PointerAt(&data, index, size)) {
+    return SharedSlice();
+  }
+
+  /**
+   * @brief after PointerAt the range is in one segment
+   */
+  std::size_t i = head_;
+  while (data < segments_[i].Data() + segments_[i].read ||
+         data >= segments_[i].Data() + segments_[i].end) {
+    ++i;
+  }
+
+  auto* block = segments_[i].block;
+  Ref(block);
+  return SharedSlice(
+      std::shared_ptr<const void>(block, [](const void* b) {
+        Unref(static_cast<BufferBlock*>(const_cast<void*>(b)));
+      }),
+      reinterpret_cast<const uint8_t*>(data), size);
+}
+
+void BufferChain::Consume(std::size_t n) {
+  assert(n <= len_);
+  len_ -= n;
+
+  while (n > 0) {
+    auto&             seg = segments_[head_];
+    const std::size_t avail = seg.end - seg.read;
+    if (n < avail) {
+      seg.read += static_cast<uint32_t>(n);
+      return;
+    }
+
+    seg.read = seg.end;
+    n -= avail;
+    ++head_;
+  }
+}
+
+char* BufferChain::Contiguous(std::size_t index, std::size_t size) {
+  std::size_t i = head_;
+  while (index >= segments_[i].end - segments_[i].read) {
+    index -= segments_[i].end - segments_[i].read;
+    ++i;
+  }
+
+  auto& first = segments_[i];
+  if (index + size <= first.end - first.read) {
+    return first.Data() + first.read + index;
+  }
+
+  /**
+   * @brief copy the segments covering the range into one block, the read bytes of the first
+   *
+   * segment too, so that they can still be unread.
+   */
+  std::size_t j = i + 1;
+  std::size_t covered = first.end - first.read - index;
+  std::size_t bytes = first.end - first.begin;
+  while (covered < size) {
+    covered += segments_[j].end - segments_[j].read;
+    bytes += segments_[j].end - segments_[j].begin;
+    ++j;
+  }
+
+  auto*       block = NewBlock(bytes);
+  std::size_t offset = 0;
+  for (std::size_t k = i; k < j; ++k) {
+    const auto& seg = segments_[k];
+    std::memcpy(block->Data() + offset, seg.Data() + seg.begin, seg.end - seg.begin);
+    offset += seg.end - seg.begin;
+    retired_.push_back(seg.block);
+  }
+
+  const uint32_t read = first.read - first.begin;
+  segments_.erase(segments_.begin() + static_cast<std::ptrdiff_t>(i + 1),
+                  segments_.begin() + static_cast<std::ptrdiff_t>(j));
+  segments_[i] = Segment{block, 0, read, static_cast<uint32_t>(bytes)};
+
+  return block->Data() + read + index;
+}
+
+void BufferChain::Reclaim() {
+  for (std::size_t i = 0; i < head_; ++i) {
+    Unref(segments_[i].block);
+  }
+  segments_.erase(segments_.begin(), segments_.begin() + static_cast<std::ptrdiff_t>(head_));
+  head_ = 0;
+
+  if (!segments_.empty()) {
+    segments_.front().begin = segments_.front().read;
+  }
+
+  for (auto* block : retired_) {
+    Unref(block);
+  }
+  retired_.clear();
+}
+
+}  // namespace io
+}  // namespace spiderweb
@@ -0,0 +1,170 @@
+#include "spiderweb/io/spiderweb_buffer_chain.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "spiderweb/io/spiderweb_buffer.h"
+
+namespace {
+std::string Pattern(std::size_t size) {
+  std::string s(size, '\0');
+  for (std::size_t i = 0; i < size; ++i) {
+    s[i] = static_cast<char>('a' + i % 26);
+  }
+  return s;
+}
+
+std::string ReadAll(spiderweb::io::BufferChain& chain) {
+  std::vector<char> p;
+  chain.Read(p);
+  return std::string(p.begin(), p.end());
+}
+}  // namespace
+
+TEST(BufferChain, WriteRead) {
+  spiderweb::io::BufferChain chain;
+  EXPECT_EQ(chain.Len(), 0);
+
+  chain.Write("hello");
+  chain.Write(std::string(" world"));
+  EXPECT_EQ(chain.Len(), 11);
+  EXPECT_EQ(chain.SegmentCount(), 1);
+
+  EXPECT_EQ(chain.ReadByte(), 'h');
+  EXPECT_EQ(ReadAll(chain), "ello world");
+  EXPECT_EQ(chain.Len(), 0);
+}
+
+TEST(BufferChain, WriteAcrossBlocks) {
+  spiderweb::io::BufferChain chain;
+
+  const auto data = Pattern(spiderweb::io::BufferChain::kBlockSize * 3 + 100);
+  chain.Write(data);
+  EXPECT_EQ(chain.Len(), data.size());
+  EXPECT_EQ(chain.SegmentCount(), 4);
+
+  std::string out(data.size(), '\0');
+  EXPECT_EQ(chain.Read(&out[0], out.size()), data.size());
+  EXPECT_EQ(out, data);
+}
+
+TEST(BufferChain, PointerAtAcrossBlocks) {
+  spiderweb::io::BufferChain chain;
+
+  const auto block = spiderweb::io::BufferChain::kBlockSize;
+  const auto data = Pattern(block * 2);
+  chain.Write(data);
+  chain.Skip(10);
+
+  char* p = nullptr;
+  EXPECT_TRUE(chain.PointerAt(&p, block - 20, 40));
+  EXPECT_EQ(std::string(p, 40), data.substr(block - 10, 40));
+  EXPECT_FALSE(chain.PointerAt(&p, chain.Len(), 1));
+  EXPECT_FALSE(chain.PointerAt(&p, 0, chain.Len() + 1));
+
+  /**
+   * @brief the copy is made once, the read bytes can still be unread
+   */
+  chain.UnReadBytes(10);
+  EXPECT_EQ(ReadAll(chain), data);
+}
+
+TEST(BufferChain, ZeroCopyRead) {
+  spiderweb::io::BufferChain chain;
+
+  chain.Write("1234");
+  chain.PrepareWrite(spiderweb::io::BufferChain::kBlockSize);
+  chain.Write("5678");
+  EXPECT_EQ(chain.SegmentCount(), 2);
+
+  char* p = nullptr;
+  EXPECT_EQ(chain.ZeroCopyRead(p, 6), 6);
+  EXPECT_EQ(std::string(p, 6), "123456");
+  EXPECT_EQ(ReadAll(chain), "78");
+}
+
+TEST(BufferChain, UnReadAcrossSegments) {
+  spiderweb::io::BufferChain chain;
+
+  chain.Write("abc");
+  chain.PrepareWrite(spiderweb::io::BufferChain::kBlockSize);
+  chain.Write("def");
+
+  std::vector<char> p;
+  chain.ReadBytes(p, 5);
+  EXPECT_EQ(chain.Len(), 1);
+  chain.UnReadBytes(4);
+  EXPECT_EQ(chain.Len(), 5);
+  EXPECT_EQ(ReadAll(chain), "bcdef");
+  chain.UnReadByte();
+  EXPECT_EQ(ReadAll(chain), "f");
+}
+
+TEST(BufferChain, SplitAndCloneShareBlocks) {
+  spiderweb::io::BufferChain chain;
+  chain.Write("header:payload");
+
+  char* p = nullptr;
+  chain.PointerAt(&p, 0, 1);
+
+  auto header = chain.Split(7);
+  EXPECT_EQ(chain.Len(), 7);
+  EXPECT_EQ(header.Len(), 7);
+
+  char* q = nullptr;
+  header.PointerAt(&q, 0, 1);
+  EXPECT_EQ(p, q);
+
+  auto clone = chain.Clone();
+  EXPECT_EQ(ReadAll(header), "header:");
+  EXPECT_EQ(ReadAll(chain), "payload");
+  EXPECT_EQ(ReadAll(clone), "payload");
+}
+
+TEST(BufferChain, Append) {
+  spiderweb::io::BufferChain a;
+  spiderweb::io::BufferChain b;
+
+  a.Write("12");
+  b.Write("34");
+  b.Skip(1);
+  a.Append(std::move(b));
+  EXPECT_EQ(b.Len(), 0);
+  EXPECT_EQ(a.Len(), 3);
+
+  a.Write("5");
+  EXPECT_EQ(ReadAll(a), "1245");
+}
+
+TEST(BufferChain, Share) {
+  spiderweb::io::SharedSlice slice;
+  {
+    spiderweb::io::BufferChain chain;
+    chain.Write("0123456789");
+    slice = chain.Share(2, 5);
+    EXPECT_TRUE(chain.Share(8, 5).empty());
+  }
+
+  EXPECT_EQ(std::string(reinterpret_cast<const char*>(slice.data()), slice.size()), "23456");
+}
+
+TEST(BufferChain, ReaderView) {
+  spiderweb::io::BufferChain chain;
+  chain.Write("hello world");
+
+  spiderweb::io::BufferReader reader(chain);
+  EXPECT_EQ(reader.Len(), 11);
+
+  auto span = reader.SpanAt(6, 5);
+  EXPECT_EQ(std::string(reinterpret_cast<const char*>(span.data()), span.size()), "world");
+
+  std::vector<char> p;
+  EXPECT_TRUE(reader.PeekAt(p, 0, 5));
+  EXPECT_EQ(std::string(p.begin(), p.end()), "hello");
+
+  reader.Skip(6);
+  EXPECT_EQ(reader.Len(), 5);
+  reader.UnReadBytes(6);
+  EXPECT_EQ(reader.Len(), 11);
+}
@@ -0,0 +1,288 @@
+#include "spiderweb/io/spiderweb_frame_decoder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "spiderweb/core/internal/thread_check.h"
+
+namespace spiderweb {
+namespace io {
+
+namespace {
+/**
+ * @brief BufferReader::Skip takes 32 bits, a frame of 4GiB or more is skipped in steps
+ */
+void SkipBytes(const BufferReader& reader, std::size_t n) {
+  while (n > 0) {
+    const auto step = static_cast<uint32_t>(std::min<std::size_t>(n, UINT32_MAX));
+    reader.Skip(step);
+    n -= step;
+  }
+}
+}  // namespace
+
+FrameDecoder::FrameDecoder(Object* parent) : Object(parent) {
+}
+
+FrameDecoder::~FrameDecoder() = default;
+
+void FrameDecoder::Decode(const BufferReader& reader) {
+  SPIDERWEB_CALL_THREAD_CHECK(FrameDecoder::Decode);
+
+  if (broken_) {
+    return;
+  }
+
+  Frame     frame;
+  ErrorCode ec;
+  while (NextFrame(reader, &frame, &ec)) {
+    if (frame.size > max_frame_size_) {
+      ec = InvalidArgument("frame too large");
+      break;
+    }
+
+    char* data = nullptr;
+    if (frame.size > 0) {
+      reader.PointerAt(data, frame.offset, frame.size);
+    }
+    ResetScan();
+
+    spider_emit FrameRead(
+        absl::Span<const uint8_t>(reinterpret_cast<const uint8_t*>(data), frame.size));
+    SkipBytes(reader, frame.consumed);
+  }
+
+  if (ec) {
+    broken_ = true;
+    spider_emit Error(ec);
+  }
+}
+
+void FrameDecoder::Reset() {
+  SPIDERWEB_CALL_THREAD_CHECK(FrameDecoder::Reset);
+  broken_ = false;
+  ResetScan();
+}
+
+void FrameDecoder::SetMaxFrameSize(std::size_t size) {
+  SPIDERWEB_CALL_THREAD_CHECK(FrameDecoder::SetMaxFrameSize);
+  max_frame_size_ = size;
+}
+
+std::size_t FrameDecoder::MaxFrameSize() const {
+  return max_frame_size_;
+}
+
+bool FrameDecoder::CopyAt(const BufferReader& reader, std::size_t index, void* out,
+                          std::size_t n) {
+  if (index + n > reader.Len()) {
+    return false;
+  }
+
+  auto*       dst = static_cast<char*>(out);
+  std::size_t base = 0;
+  reader.ForEachSegment([&](const char* data, std::size_t size) {
+    if (n > 0 && index < base + size) {
+      const std::size_t from = index - base;
+      const std::size_t count = std::min(n, size - from);
+      std::memcpy(dst, data + from, count);
+      dst += count;
+      index += count;
+      n -= count;
+    }
+    base += size;
+  });
+  return true;
+}
+
+LengthFieldDecoder::LengthFieldDecoder(std::size_t length_offset, std::size_t length_size,
+                                       arch::ArchType endian, int64_t length_adjust,
+                                       std::size_t strip, Object* parent)
+    : FrameDecoder(parent),
+      length_offset_(length_offset),
+      length_size_(length_size),
+      endian_(endian),
+      length_adjust_(length_adjust),
+      strip_(strip) {
+  assert((length_size == 1 || length_size == 2 || length_size == 4 || length_size == 8) &&
+         "LengthFieldDecoder, length_size must be 1, 2, 4 or 8");
+}
+
+bool LengthFieldDecoder::NextFrame(const BufferReader& reader, Frame* frame, ErrorCode* ec) {
+  const std::size_t header_size = length_offset_ + length_size_;
+
+  if (frame_size_ == 0) {
+    if (reader.Len() < header_size) {
+      return false;
+    }
+
+    /**
+     * @brief the length comes from the peer, compute in unsigned, and check every step against
+     *
+     * wrapping around, a signed sum of a huge length and the adjustment would overflow.
+     */
+    const uint64_t length = ReadLength(reader);
+    const uint64_t adjust = length_adjust_ < 0 ? 0 - static_cast<uint64_t>(length_adjust_)
+                                               : static_cast<uint64_t>(length_adjust_);
+    uint64_t       size = header_size;
+    bool           valid = length <= UINT64_MAX - size;
+    size += valid ? length : 0;
+    if (length_adjust_ < 0) {
+      valid = valid && size >= adjust;
+      size -= valid ? adjust : 0;
+    } else {
+      valid = valid && size <= UINT64_MAX - adjust;
+      size += valid ? adjust : 0;
+    }
+
+    if (!valid || size < header_size || size < strip_) {
+      *ec = InvalidArgument("invalid frame length");
+      return false;
+    }
+
+    if (size > MaxFrameSize()) {
+      *ec = InvalidArgument("frame too large");
+      return false;
+    }
+    frame_size_ = static_cast<std::size_t>(size);
+  }
+
+  if (reader.Len() < frame_size_) {
+    return false;
+  }
+
+  frame->offset = strip_;
+  frame->size = frame_size_ - strip_;
+  frame->consumed = frame_size_;
+  return true;
+}
+
+void LengthFieldDecoder::ResetScan() {
+  frame_size_ = 0;
+}
+
+uint64_t LengthFieldDecoder::ReadLength(const BufferReader& reader) const {
+  const bool big = endian_ == arch::ArchType::kBig;
+  switch (length_size_) {
+    case 1: {
+      uint8_t v = 0;
+      CopyAt(reader, length_offset_, &v, sizeof(v));
+      return v;
+    }
+    case 2: {
+      uint16_t v = 0;
+      CopyAt(reader, length_offset_, &v, sizeof(v));
+      return big ? arch::FromEndian<arch::ArchType::kBig, 2>()(v)
+                 : arch::FromEndian<arch::ArchType::kLittle, 2>()(v);
+    }
+    case 4: {
+      uint32_t v = 0;
+      CopyAt(reader, length_offset_, &v, sizeof(v));
+      return big ? arch::FromEndian<arch::ArchType::kBig, 4>()(v)
+                 : arch::FromEndian<arch::ArchType::kLittle, 4>()(v);
+    }
+    default: {
+      uint64_t v = 0;
+      CopyAt(reader, length_offset_, &v, sizeof(v));
+      return big ? arch::FromEndian<arch::ArchType::kBig, 8>()(v)
+                 : arch::FromEndian<arch::ArchType::kLittle, 8>()(v);
+    }
+  }
+}
+
+DelimiterDecoder::DelimiterDecoder(std::string delimiter, bool strip_delimiter, Object* parent)
+    : FrameDecoder(parent), delimiter_(std::move(delimiter)), strip_delimiter_(strip_delimiter) {
+  assert(!delimiter_.empty() && "DelimiterDecoder, empty delimiter");
+}
+
+bool DelimiterDecoder::NextFrame(const BufferReader& reader, Frame* frame, ErrorCode* ec) {
+  const std::size_t len = reader.Len();
+  if (len < delimiter_.size()) {
+    return false;
+  }
+
+  /**
+   * @brief candidates are the indexes in [scanned_, last], at the ones after last the delimiter
+   *
+   * can not be complete yet, they are scanned by the next read.
+   */
+  const std::size_t last = len - delimiter_.size();
+  std::size_t       found = std::string::npos;
+  std::size_t       base = 0;
+  reader.ForEachSegment([&](const char* data, std::size_t size) {
+    std::size_t from = scanned_ > base ? scanned_ - base : 0;
+    const auto  to = std::min(size, last + 1 > base ? last + 1 - base : 0);
+
+    while (found == std::string::npos && from < to) {
+      const auto* p =
+          static_cast<const char*>(std::memchr(data + from, delimiter_[0], to - from));
+      if (!p) {
+        break;
+      }
+
+      const std::size_t index = base + static_cast<std::size_t>(p - data);
+      if (MatchAt(reader, index)) {
+        found = index;
+      }
+      from = static_cast<std::size_t>(p - data) + 1;
+    }
+    base += size;
+  });
+
+  if (found == std::string::npos) {
+    scanned_ = std::max(scanned_, last + 1);
+    if (scanned_ > MaxFrameSize()) {
+      *ec = InvalidArgument("frame too large");
+    }
+    return false;
+  }
+
+  frame->offset = 0;
+  frame->size = strip_delimiter_ ? found : found + delimiter_.size();
+  frame->consumed = found + delimiter_.size();
+  return true;
+}
+
+void DelimiterDecoder::ResetScan() {
+  scanned_ = 0;
+}
+
+bool DelimiterDecoder::MatchAt(const BufferReader& reader, std::size_t index) const {
+  if (delimiter_.size() == 1) {
+    return true;
+  }
+
+  char tail[32];
+  for (std::size_t i = 1; i < delimiter_.size(); i += sizeof(tail)) {
+    const std::size_t n = std::min(sizeof(tail), delimiter_.size() - i);
+    if (!CopyAt(reader, index + i, tail, n) || std::memcmp(tail, delimiter_.data() + i, n) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+FixedSizeDecoder::FixedSizeDecoder(std::size_t size, Object* parent)
+    : FrameDecoder(parent), size_(size) {
+  assert(size > 0 && "FixedSizeDecoder, size must not be 0");
+}
+
+bool FixedSizeDecoder::NextFrame(const BufferReader& reader, Frame* frame, ErrorCode* /*ec*/) {
+  if (reader.Len() < size_) {
+    return false;
+  }
+
+  frame->offset = 0;
+  frame->size = size_;
+  frame->consumed = size_;
+  return true;
+}
+
+void FixedSizeDecoder::ResetScan() {
+}
+
+}  // namespace io
+}  // namespace spiderweb
@@ -0,0 +1,173 @@
+#include "spiderweb/io/spiderweb_frame_decoder.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/io/spiderweb_buffer_chain.h"
+
+namespace {
+/**
+ * @brief collects the frames of a decoder as strings
+ */
+class FrameCollector {
+ public:
+  explicit FrameCollector(spiderweb::io::FrameDecoder* decoder) {
+    spiderweb::Object::Connect(decoder, &spiderweb::io::FrameDecoder::FrameRead, decoder,
+                               [this](absl::Span<const uint8_t> frame) {
+                                 frames.emplace_back(frame.begin(), frame.end());
+                               });
+    spiderweb::Object::Connect(decoder, &spiderweb::io::FrameDecoder::Error, decoder,
+                               [this](const std::error_code&) { ++errors; });
+  }
+
+  std::vector<std::string> frames;
+  int                      errors = 0;
+};
+
+void Feed(spiderweb::io::FrameDecoder& decoder, spiderweb::io::BufferChain& chain,
+          const std::string& data) {
+  chain.Write(data);
+  decoder.Decode(spiderweb::io::BufferReader(chain));
+}
+}  // namespace
+
+TEST(FrameDecoder, LengthFieldBigEndian) {
+  spiderweb::EventLoop              loop;
+  spiderweb::io::LengthFieldDecoder decoder(0, 2, spiderweb::arch::ArchType::kBig, 0, 2);
+  spiderweb::io::BufferChain        chain;
+  FrameCollector                    collector(&decoder);
+
+  /**
+   * @brief a frame split in the header, and two frames in one read
+   */
+  Feed(decoder, chain, std::string("\x00", 1));
+  Feed(decoder, chain, std::string("\x03" "ab", 3));
+  EXPECT_TRUE(collector.frames.empty());
+
+  Feed(decoder, chain, std::string("c\x00\x01x\x00\x00", 6));
+  EXPECT_EQ(collector.frames, (std::vector<std::string>{"abc", "x", ""}));
+  EXPECT_EQ(chain.Len(), 0);
+}
+
+TEST(FrameDecoder, LengthFieldLittleEndianWithAdjust) {
+  spiderweb::EventLoop              loop;
+  /**
+   * @brief 1 byte type, then a 4 bytes length which counts the whole frame, header not stripped
+   */
+  spiderweb::io::LengthFieldDecoder decoder(1, 4, spiderweb::arch::ArchType::kLittle, -5);
+  spiderweb::io::BufferChain        chain;
+  FrameCollector                    collector(&decoder);
+
+  Feed(decoder, chain, std::string("T\x07\x00\x00\x00hiT\x05\x00\x00\x00", 12));
+  ASSERT_EQ(collector.frames.size(), 2);
+  EXPECT_EQ(collector.frames[0], std::string("T\x07\x00\x00\x00hi", 7));
+  EXPECT_EQ(collector.frames[1], std::string("T\x05\x00\x00\x00", 5));
+}
+
+TEST(FrameDecoder, LengthFieldTooLarge) {
+  spiderweb::EventLoop              loop;
+  spiderweb::io::LengthFieldDecoder decoder(0, 4);
+  spiderweb::io::BufferChain        chain;
+  FrameCollector                    collector(&decoder);
+
+  decoder.SetMaxFrameSize(16);
+  Feed(decoder, chain, std::string("\x00\x00\x01\x00", 4));
+  EXPECT_EQ(collector.errors, 1);
+
+  /**
+   * @brief decoding stopped until Reset
+   */
+  Feed(decoder, chain, std::string("\x00\x00\x00\x01x", 5));
+  EXPECT_TRUE(collector.frames.empty());
+  EXPECT_EQ(collector.errors, 1);
+}
+
+TEST(FrameDecoder, LengthFieldOverflow) {
+  spiderweb::EventLoop loop;
+
+  /**
+   * @brief the length plus the header, or plus the adjustment, wraps around 64 bits
+   */
+  const std::string huge("\xff\xff\xff\xff\xff\xff\xff\xfe", 8);
+  for (const int64_t adjust : {int64_t(0), int64_t(16), INT64_MAX}) {
+    spiderweb::io::LengthFieldDecoder decoder(0, 8, spiderweb::arch::ArchType::kBig, adjust);
+    spiderweb::io::BufferChain        chain;
+    FrameCollector                    collector(&decoder);
+
+    decoder.SetMaxFrameSize(UINT64_MAX);
+    Feed(decoder, chain, huge + "abcdefgh");
+    EXPECT_EQ(collector.errors, 1) << adjust;
+    EXPECT_TRUE(collector.frames.empty()) << adjust;
+  }
+
+  spiderweb::io::LengthFieldDecoder decoder(0, 8, spiderweb::arch::ArchType::kBig, INT64_MIN);
+  spiderweb::io::BufferChain        chain;
+  FrameCollector                    collector(&decoder);
+
+  Feed(decoder, chain, huge);
+  EXPECT_EQ(collector.errors, 1);
+}
+
+TEST(FrameDecoder, Delimiter) {
+  spiderweb::EventLoop            loop;
+  spiderweb::io::DelimiterDecoder decoder("\r\n");
+  spiderweb::io::BufferChain      chain;
+  FrameCollector                  collector(&decoder);
+
+  /**
+   * @brief the delimiter split between reads, and a lone '\r' in a frame
+   */
+  Feed(decoder, chain, "GET / HTTP/1.1\r");
+  EXPECT_TRUE(collector.frames.empty());
+  Feed(decoder, chain, "\nHost: a\rb\r\n\r\nrest");
+
+  EXPECT_EQ(collector.frames, (std::vector<std::string>{"GET / HTTP/1.1", "Host: a\rb", ""}));
+  EXPECT_EQ(chain.Len(), 4);
+}
+
+TEST(FrameDecoder, DelimiterAcrossBlocks) {
+  spiderweb::EventLoop            loop;
+  spiderweb::io::DelimiterDecoder decoder("\n", false);
+  spiderweb::io::BufferChain      chain;
+  FrameCollector                  collector(&decoder);
+
+  const std::string line(spiderweb::io::BufferChain::kBlockSize + 100, 'x');
+  Feed(decoder, chain, line.substr(0, 1000));
+  Feed(decoder, chain, line.substr(1000));
+  EXPECT_TRUE(collector.frames.empty());
+
+  Feed(decoder, chain, "\n");
+  ASSERT_EQ(collector.frames.size(), 1);
+  EXPECT_EQ(collector.frames[0], line + "\n");
+}
+
+TEST(FrameDecoder, DelimiterTooLarge) {
+  spiderweb::EventLoop            loop;
+  spiderweb::io::DelimiterDecoder decoder("\n");
+  spiderweb::io::BufferChain      chain;
+  FrameCollector                  collector(&decoder);
+
+  decoder.SetMaxFrameSize(8);
+  Feed(decoder, chain, "0123456789");
+  EXPECT_EQ(collector.errors, 1);
+
+  chain.Skip(static_cast<uint32_t>(chain.Len()));
+  decoder.Reset();
+  Feed(decoder, chain, "ok\n");
+  EXPECT_EQ(collector.frames, std::vector<std::string>{"ok"});
+}
+
+TEST(FrameDecoder, FixedSize) {
+  spiderweb::EventLoop            loop;
+  spiderweb::io::FixedSizeDecoder decoder(3);
+  spiderweb::io::BufferChain      chain;
+  FrameCollector                  collector(&decoder);
+
+  Feed(decoder, chain, "abcd");
+  Feed(decoder, chain, "efghi");
+  EXPECT_EQ(collector.frames, (std::vector<std::string>{"abc", "def", "ghi"}));
+  EXPECT_EQ(chain.Len(), 0);
+}
@@ -34,4 +34,55 @@ void NamedPipe::Write(const std::vector<uint8_t>& data) {
   d->StartWrite(d->impl.pipe, data);
 }
 
+void NamedPipe::SetWriteBufferWatermarks(std::size_t high, std::size_t low) {
+  SPIDERWEB_CALL_THREAD_CHECK(NamedPipe::SetWriteBufferWatermarks);
+  d->SetWriteWatermarks(high, low);
+}
+
+std::size_t NamedPipe::WriteBufferSize() const {
+  return d->send_queue.Len();
+}
+
+void NamedPipe::PauseReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(NamedPipe::PauseReading);
+  d->PauseRead();
+}
+
+void NamedPipe::ResumeReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(NamedPipe::ResumeReading);
+  d->ResumeRead(d->impl.pipe);
+}
+
+void NamedPipe::ContinueReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(NamedPipe::ContinueReading);
+  d->RestartRead(d->impl.pipe);
+}
+
+bool NamedPipe::IsReadingPaused() const {
+  return d->IsReadPaused();
+}
+
+void NamedPipe::SetMaxReadBufferSize(std::size_t size) {
+  SPIDERWEB_CALL_THREAD_CHECK(NamedPipe::SetMaxReadBufferSize);
+  d->max_read_buffer = size;
+}
+
+std::size_t NamedPipe::ReadBufferSize() const {
+  return d->recv_buffer.Len();
+}
+
+int NamedPipe::NativeHandle() const {
+  return static_cast<int>(d->impl.pipe.native_handle());
+}
+
+void NamedPipe::ReleaseReading(std::function<void(const std::error_code&)> released) {
+  SPIDERWEB_CALL_THREAD_CHECK(NamedPipe::ReleaseReading);
+  d->ReleaseRead(std::move(released));
+}
+
+void NamedPipe::SetDrainReads(bool flag) {
+  SPIDERWEB_CALL_THREAD_CHECK(NamedPipe::SetDrainReads);
+  d->drain_reads = flag;
+}
+
 }  // namespace spiderweb
@@ -97,4 +97,50 @@ void ProcessFd::Write(const std::vector<uint8_t>& data) {
   d->StartWrite(d->impl.stream, data);
 }
 
+void ProcessFd::SetWriteBufferWatermarks(std::size_t high, std::size_t low) {
+  SPIDERWEB_CALL_THREAD_CHECK(ProcessFd::SetWriteBufferWatermarks);
+  d->SetWriteWatermarks(high, low);
+}
+
+std::size_t ProcessFd::WriteBufferSize() const {
+  return d->send_queue.Len();
+}
+
+void ProcessFd::PauseReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(ProcessFd::PauseReading);
+  d->PauseRead();
+}
+
+void ProcessFd::ResumeReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(ProcessFd::ResumeReading);
+  d->ResumeRead(d->impl.stream);
+}
+
+void ProcessFd::ContinueReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(ProcessFd::ContinueReading);
+  d->RestartRead(d->impl.stream);
+}
+
+bool ProcessFd::IsReadingPaused() const {
+  return d->IsReadPaused();
+}
+
+void ProcessFd::SetMaxReadBufferSize(std::size_t size) {
+  SPIDERWEB_CALL_THREAD_CHECK(ProcessFd::SetMaxReadBufferSize);
+  d->max_read_buffer = size;
+}
+
+std::size_t ProcessFd::ReadBufferSize() const {
+  return d->recv_buffer.Len();
+}
+
+int ProcessFd::NativeHandle() const {
+  return static_cast<int>(d->impl.stream.native_handle());
+}
+
+void ProcessFd::ReleaseReading(std::function<void(const std::error_code&)> released) {
+  SPIDERWEB_CALL_THREAD_CHECK(ProcessFd::ReleaseReading);
+  d->ReleaseRead(std::move(released));
+}
+
 }  // namespace spiderweb
@@ -0,0 +1,568 @@
+#include "spiderweb/io/spiderweb_shm_channel.h"
+
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "asio.hpp"
+#include "core/internal/asio_cast.h"
+#include "spdlog/spdlog.h"
+#include "spiderweb/core/internal/thread_check.h"
+#include "spiderweb/io/private/spiderweb_write_queue.h"
+#include "spiderweb/io/spiderweb_buffer_chain.h"
+
+namespace spiderweb {
+namespace io {
+
+namespace {
+constexpr uint32_t    kMagic = 0x5357434e;
+constexpr std::size_t kCacheLine = 64;
+constexpr std::size_t kPageSize = 4096;
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "the rings are shared between processes, their atomics must be lock free");
+
+/**
+ * @brief the indexes of one ring. head and tail count the bytes ever written and read, each is
+ *
+ * written by one side only, on a cache line of its own. a waiting flag is set by a side before it
+ *
+ * sleeps, the other side then rings the eventfd.
+ */
+struct RingIndex {
+  alignas(kCacheLine) std::atomic<uint64_t> head;
+  alignas(kCacheLine) std::atomic<uint64_t> tail;
+  alignas(kCacheLine) std::atomic<uint32_t> consumer_waiting;
+  std::atomic<uint32_t> producer_waiting;
+  /// the producer closed, after the last head
+  std::atomic<uint32_t> closed;
+};
+
+/**
+ * @brief the start of the shared memory, the data of the rings follow at kDataOffset. the creator
+ *
+ * writes rings[0] and reads rings[1].
+ */
+struct Layout {
+  uint32_t  magic;
+  uint32_t  reserved;
+  uint64_t  ring_size;
+  RingIndex rings[2];
+};
+
+constexpr std::size_t kDataOffset = (sizeof(Layout) + kPageSize - 1) / kPageSize * kPageSize;
+
+ErrorCode LastError() {
+  return ErrorCode(errno, std::system_category());
+}
+
+void CloseFd(int& fd) {
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+}
+}  // namespace
+
+class ShmChannel::Private : public std::enable_shared_from_this<Private> {
+ public:
+  /// rounds of reading and writing before the other handlers of the loop get a chance
+  static constexpr int kMaxRounds = 16;
+
+  explicit Private(ShmChannel* qq) : q(qq), wake(AsioService(qq->ownerEventLoop())) {
+  }
+
+  ~Private() {
+    Release();
+  }
+
+  ErrorCode Create(std::size_t ring_size) {
+    Release();
+    if (ring_size < kPageSize || (ring_size & (ring_size - 1)) != 0) {
+      return MakeErrorCode(ErrC::kInvalidArgument);
+    }
+
+    memfd = ::memfd_create("spiderweb_shm_channel", MFD_CLOEXEC);
+    if (memfd < 0) {
+      return LastError();
+    }
+
+    const auto size = kDataOffset + 2 * ring_size;
+    if (::ftruncate(memfd, static_cast<off_t>(size)) != 0) {
+      auto ec = LastError();
+      Release();
+      return ec;
+    }
+
+    auto ec = Map(size);
+    if (ec) {
+      return ec;
+    }
+
+    auto* layout = new (base) Layout();
+    layout->magic = kMagic;
+    layout->ring_size = ring_size;
+
+    int own = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    peer_wake = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (own < 0 || peer_wake < 0) {
+      ec = LastError();
+      CloseFd(own);
+      Release();
+      return ec;
+    }
+
+    ec = Open(layout, own, true);
+    return ec;
+  }
+
+  ErrorCode Attach(const std::vector<int>& fds) {
+    Release();
+    if (fds.size() != 3) {
+      for (int fd : fds) {
+        CloseFd(fd);
+      }
+      return MakeErrorCode(ErrC::kInvalidArgument);
+    }
+
+    memfd = fds[0];
+    int own = fds[1];
+    peer_wake = fds[2];
+
+    struct stat stat;
+    if (::fstat(memfd, &stat) != 0) {
+      auto ec = LastError();
+      CloseFd(own);
+      Release();
+      return ec;
+    }
+
+    const auto size = static_cast<std::size_t>(stat.st_size);
+    auto       ec = size > kDataOffset ? Map(size) : MakeErrorCode(ErrC::kInvalidArgument);
+    if (ec) {
+      CloseFd(own);
+      Release();
+      return ec;
+    }
+
+    auto* layout = static_cast<Layout*>(base);
+    if (layout->magic != kMagic || layout->ring_size < kPageSize ||
+        (layout->ring_size & (layout->ring_size - 1)) != 0 ||
+        kDataOffset + 2 * layout->ring_size != size) {
+      CloseFd(own);
+      Release();
+      return MakeErrorCode(ErrC::kInvalidArgument);
+    }
+    return Open(layout, own, false);
+  }
+
+  std::vector<int> PeerFds() const {
+    if (!open || !creator) {
+      return {};
+    }
+    return {memfd, peer_wake, own_wake};
+  }
+
+  template <typename... Data>
+  void Write(Data&&... data) {
+    if (!open) {
+      spdlog::warn("ShmChannel({}) closed", fmt::ptr(q));
+      return;
+    }
+
+    send_queue.Append(std::forward<Data>(data)...);
+    Schedule();
+  }
+
+  /**
+   * @brief the peer sees the end of the stream, the memory and the descriptors are released
+   */
+  void Release() {
+    open = false;
+    if (out) {
+      out->closed.store(1, std::memory_order_release);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      Signal();
+    }
+
+    if (base) {
+      ::munmap(base, map_size);
+      base = nullptr;
+    }
+    in = out = nullptr;
+    send_queue = WriteQueue();
+
+    asio::error_code ec;
+    (void)wake.close(ec);
+    own_wake = -1;
+    CloseFd(peer_wake);
+    CloseFd(memfd);
+  }
+
+  bool IsReadPaused() const {
+    return max_read_buffer > 0 && recv_buffer.Len() >= max_read_buffer;
+  }
+
+  /**
+   * @brief wake up the loop, the user read from a full read buffer
+   */
+  void ContinueRead() {
+    if (!IsReadPaused()) {
+      Schedule();
+    }
+  }
+
+  ShmChannel*                    q = nullptr;
+  asio::posix::stream_descriptor wake;
+  /// the eventfd we wait on, owned by `wake`
+  int                            own_wake = -1;
+  /// the eventfd the peer waits on
+  int                            peer_wake = -1;
+  int                            memfd = -1;
+  void*                          base = nullptr;
+  std::size_t                    map_size = 0;
+  std::size_t                    ring_size = 0;
+  /// the ring we read, and the one we write
+  RingIndex*                     in = nullptr;
+  RingIndex*                     out = nullptr;
+  const uint8_t*                 in_data = nullptr;
+  uint8_t*                       out_data = nullptr;
+  bool                           creator = false;
+  bool                           open = false;
+  /// a Pump is posted
+  bool                           scheduled = false;
+  /// the eventfd is waited on
+  bool                           waiting = false;
+  BufferChain                    recv_buffer;
+  WriteQueue                     send_queue;
+  /// the ring is not read while the user leaves this many bytes in recv_buffer, 0 means no limit
+  std::size_t                    max_read_buffer = 0;
+
+ private:
+  ErrorCode Map(std::size_t size) {
+    base = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (base == MAP_FAILED) {
+      base = nullptr;
+      auto ec = LastError();
+      Release();
+      return ec;
+    }
+    map_size = size;
+    return ErrorCode();
+  }
+
+  ErrorCode Open(Layout* layout, int own, bool create) {
+    asio::error_code ec;
+    (void)wake.assign(own, ec);
+    if (ec) {
+      ::close(own);
+      Release();
+      return ErrorCode(ec.value(), ec.category());
+    }
+
+    own_wake = own;
+    creator = create;
+    ring_size = layout->ring_size;
+    in = &layout->rings[create ? 1 : 0];
+    out = &layout->rings[create ? 0 : 1];
+    auto* data = static_cast<uint8_t*>(base) + kDataOffset;
+    in_data = data + (create ? ring_size : 0);
+    out_data = data + (create ? 0 : ring_size);
+
+    open = true;
+    Schedule();
+    return ErrorCode();
+  }
+
+  void Schedule() {
+    if (!open || scheduled) {
+      return;
+    }
+
+    scheduled = true;
+    auto self = shared_from_this();
+    asio::post(wake.get_executor(), [this, self]() {
+      scheduled = false;
+      Pump();
+    });
+  }
+
+  /**
+   * @brief copy into the write ring and out of the read ring until neither moves, then sleep
+   */
+  void Pump() {
+    if (!open) {
+      return;
+    }
+
+    /**
+     * @brief awake, the peer needs not ring
+     */
+    in->consumer_waiting.store(0, std::memory_order_relaxed);
+    out->producer_waiting.store(0, std::memory_order_relaxed);
+
+    for (int round = 0; round < kMaxRounds; ++round) {
+      const bool wrote = FlushWrites();
+      if (!open) {
+        return;
+      }
+
+      const bool read = ReadRing();
+      if (!open) {
+        return;
+      }
+
+      if (!wrote && !read) {
+        Sleep();
+        return;
+      }
+    }
+    Schedule();
+  }
+
+  bool FlushWrites() {
+    if (send_queue.Empty()) {
+      return false;
+    }
+
+    const auto head = out->head.load(std::memory_order_relaxed);
+    const auto used = head - out->tail.load(std::memory_order_acquire);
+    if (used > ring_size) {
+      Corrupt();
+      return false;
+    }
+
+    const auto space = static_cast<std::size_t>(ring_size - used);
+    if (space == 0) {
+      return false;
+    }
+
+    std::size_t copied = 0;
+    for (const auto& buffer : send_queue.Prepare()) {
+      const auto size = std::min(buffer.size(), space - copied);
+      CopyIn(head + copied, static_cast<const uint8_t*>(buffer.data()), size);
+      copied += size;
+      if (copied == space) {
+        break;
+      }
+    }
+    out->head.store(head + copied, std::memory_order_release);
+    send_queue.Consume(copied);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (out->consumer_waiting.load(std::memory_order_relaxed) != 0) {
+      Signal();
+    }
+
+    Object::Emit(q, &ShmChannel::BytesWritten, std::move(copied));
+    return true;
+  }
+
+  bool ReadRing() {
+    if (IsReadPaused()) {
+      return false;
+    }
+
+    /**
+     * @brief closed is loaded before head, so the bytes written before the close are seen
+     */
+    const bool closed = in->closed.load(std::memory_order_acquire) != 0;
+    const auto tail = in->tail.load(std::memory_order_relaxed);
+    const auto unread = in->head.load(std::memory_order_acquire) - tail;
+    if (unread > ring_size) {
+      Corrupt();
+      return false;
+    }
+
+    if (unread == 0) {
+      if (closed) {
+        Fail(asio::error::eof);
+      }
+      return false;
+    }
+
+    /**
+     * @brief no more than max_read_buffer is buffered, the rest waits in the ring
+     */
+    auto size = static_cast<std::size_t>(unread);
+    if (max_read_buffer > 0) {
+      size = std::min(size, max_read_buffer - recv_buffer.Len());
+    }
+
+    recv_buffer.PrepareWrite(size);
+    CopyOut(tail, reinterpret_cast<uint8_t*>(recv_buffer.beginWrite()), size);
+    recv_buffer.CommitWrite(size);
+    in->tail.store(tail + size, std::memory_order_release);
+
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (in->producer_waiting.load(std::memory_order_relaxed) != 0) {
+      Signal();
+    }
+
+    const io::BufferReader reader(recv_buffer);
+    Object::Emit(q, &ShmChannel::BytesRead, reader);
+    return true;
+  }
+
+  /**
+   * @brief set the waiting flags, and look at the rings once more before waiting: the peer may
+   *
+   * have moved in between, without ringing.
+   */
+  void Sleep() {
+    in->consumer_waiting.store(1, std::memory_order_relaxed);
+    out->producer_waiting.store(send_queue.Empty() ? 0 : 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    const auto unread = in->head.load(std::memory_order_acquire) -
+                        in->tail.load(std::memory_order_relaxed);
+    const auto unsent = out->head.load(std::memory_order_relaxed) -
+                        out->tail.load(std::memory_order_acquire);
+    const bool readable =
+        !IsReadPaused() && (unread > 0 || in->closed.load(std::memory_order_acquire) != 0);
+    const bool writable = !send_queue.Empty() && unsent < ring_size;
+    if (readable || writable) {
+      Schedule();
+      return;
+    }
+
+    if (waiting) {
+      return;
+    }
+
+    waiting = true;
+    auto self = shared_from_this();
+    wake.async_wait(asio::posix::descriptor_base::wait_read,
+                    [this, self](const asio::error_code& ec) {
+                      waiting = false;
+                      if (!open || ec == asio::error::operation_aborted) {
+                        return;
+                      }
+
+                      if (ec) {
+                        Fail(ec);
+                        return;
+                      }
+
+                      uint64_t count = 0;
+                      std::ignore = ::read(wake.native_handle(), &count, sizeof(count));
+                      Pump();
+                    });
+  }
+
+  void Signal() {
+    const uint64_t one = 1;
+    if (peer_wake >= 0) {
+      std::ignore = ::write(peer_wake, &one, sizeof(one));
+    }
+  }
+
+  void CopyIn(uint64_t position, const uint8_t* data, std::size_t size) {
+    const auto offset = static_cast<std::size_t>(position & (ring_size - 1));
+    const auto first = std::min(size, ring_size - offset);
+    std::memcpy(out_data + offset, data, first);
+    std::memcpy(out_data, data + first, size - first);
+  }
+
+  void CopyOut(uint64_t position, uint8_t* data, std::size_t size) {
+    const auto offset = static_cast<std::size_t>(position & (ring_size - 1));
+    const auto first = std::min(size, ring_size - offset);
+    std::memcpy(data, in_data + offset, first);
+    std::memcpy(data + first, in_data, size - first);
+  }
+
+  void Fail(const std::error_code& ec) {
+    Release();
+    Object::Emit(q, &ShmChannel::Error, ec);
+  }
+
+  /**
+   * @brief the peer wrote indexes which no ring can have, nothing it wrote is trusted any more
+   */
+  void Corrupt() {
+    spdlog::error("ShmChannel({}) the peer corrupted the ring indexes", fmt::ptr(q));
+    Fail(RuntimeError("corrupted ring indexes"));
+  }
+};
+
+ShmChannel::ShmChannel(Object* parent) : Object(parent), d(std::make_shared<Private>(this)) {
+}
+
+ShmChannel::~ShmChannel() {
+  SPIDERWEB_CALL_THREAD_CHECK(ShmChannel::~ShmChannel);
+  d->q = nullptr;
+  d->Release();
+}
+
+ErrorCode ShmChannel::Create(std::size_t ring_size) {
+  SPIDERWEB_CALL_THREAD_CHECK(ShmChannel::Create);
+  return d->Create(ring_size);
+}
+
+std::vector<int> ShmChannel::PeerFds() const {
+  return d->PeerFds();
+}
+
+ErrorCode ShmChannel::Attach(const std::vector<int>& fds) {
+  SPIDERWEB_CALL_THREAD_CHECK(ShmChannel::Attach);
+  return d->Attach(fds);
+}
+
+void ShmChannel::Close() {
+  SPIDERWEB_CALL_THREAD_CHECK(ShmChannel::Close);
+  d->Release();
+}
+
+bool ShmChannel::IsClosed() const {
+  return !d->open;
+}
+
+void ShmChannel::Write(const uint8_t* data, std::size_t size) {
+  SPIDERWEB_CALL_THREAD_CHECK(ShmChannel::Write);
+  d->Write(data, size);
+}
+
+void ShmChannel::Write(const std::vector<uint8_t>& data) {
+  SPIDERWEB_CALL_THREAD_CHECK(ShmChannel::Write);
+  d->Write(data.data(), data.size());
+}
+
+void ShmChannel::Write(std::vector<uint8_t>&& data) {
+  SPIDERWEB_CALL_THREAD_CHECK(ShmChannel::Write);
+  d->Write(std::move(data));
+}
+
+void ShmChannel::Write(io::SharedSlice slice) {
+  SPIDERWEB_CALL_THREAD_CHECK(ShmChannel::Write);
+  d->Write(std::move(slice));
+}
+
+std::size_t ShmChannel::WriteBufferSize() const {
+  return d->send_queue.Len();
+}
+
+std::size_t ShmChannel::ReadBufferSize() const {
+  return d->recv_buffer.Len();
+}
+
+void ShmChannel::SetMaxReadBufferSize(std::size_t size) {
+  SPIDERWEB_CALL_THREAD_CHECK(ShmChannel::SetMaxReadBufferSize);
+  d->max_read_buffer = size;
+  d->ContinueRead();
+}
+
+void ShmChannel::ContinueReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(ShmChannel::ContinueReading);
+  d->ContinueRead();
+}
+
+}  // namespace io
+}  // namespace spiderweb
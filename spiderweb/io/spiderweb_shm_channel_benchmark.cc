@@ -0,0 +1,232 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "core/internal/asio_cast.h"
+#include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_thread.h"
+#include "spiderweb/io/spiderweb_shm_channel.h"
+#include "spiderweb/net/spiderweb_uds_server.h"
+#include "spiderweb/net/spiderweb_uds_socket.h"
+
+namespace {
+/**
+ * @brief what the far end of a link does with the bytes it reads, besides counting them
+ */
+enum class FarEnd { kCount, kEcho };
+
+template <typename End>
+void WatchFarEnd(End* end, FarEnd mode, std::atomic<int64_t>* received) {
+  spiderweb::Object::Connect(
+      end, &End::BytesRead, end, [end, mode, received](const spiderweb::io::BufferReader& reader) {
+        const auto n = reader.Len();
+        if (mode == FarEnd::kEcho) {
+          reader.ForEachSegment([end](const char* data, std::size_t size) {
+            end->Write(reinterpret_cast<const uint8_t*>(data), size);
+          });
+        }
+        reader.Skip(static_cast<uint32_t>(n));
+        received->fetch_add(static_cast<int64_t>(n), std::memory_order_relaxed);
+      });
+}
+
+/**
+ * @brief a ShmChannel from the loop of the benchmark to another thread, as to another process
+ */
+class ShmLink {
+ public:
+  using End = spiderweb::io::ShmChannel;
+
+  bool Open(asio::io_context& /*io*/, spiderweb::Thread& thread, FarEnd mode,
+            std::atomic<int64_t>* received) {
+    if (near.Create()) {
+      return false;
+    }
+
+    std::vector<int> fds;
+    for (const int fd : near.PeerFds()) {
+      fds.push_back(::fcntl(fd, F_DUPFD_CLOEXEC, 0));
+    }
+
+    std::promise<bool> attached;
+    thread.QueueTask([&]() {
+      far = std::make_unique<End>();
+      WatchFarEnd(far.get(), mode, received);
+      attached.set_value(!far->Attach(fds));
+    });
+    return attached.get_future().get();
+  }
+
+  void Close(spiderweb::Thread& thread) {
+    near.Close();
+
+    std::promise<bool> closed;
+    thread.QueueTask([&]() {
+      far.reset();
+      closed.set_value(true);
+    });
+    closed.get_future().get();
+  }
+
+  End                  near;
+  std::unique_ptr<End> far;
+};
+
+/**
+ * @brief the same over a UdsSocket
+ */
+class UdsLink {
+ public:
+  using End = spiderweb::net::UdsSocket;
+
+  ~UdsLink() {
+    if (!path.empty()) {
+      ::unlink(path.c_str());
+    }
+  }
+
+  bool Open(asio::io_context& io, spiderweb::Thread& thread, FarEnd mode,
+            std::atomic<int64_t>* received) {
+    path = "/tmp/spiderweb_shm_benchmark_" + std::to_string(::getpid()) + ".sock";
+
+    std::promise<bool> listening;
+    thread.QueueTask([&, mode, received]() {
+      server = std::make_unique<spiderweb::net::UdsServer>();
+      spiderweb::Object::Connect(server.get(), &spiderweb::net::UdsServer::InComingConnection,
+                                 server.get(), [mode, received](End* socket) {
+                                   WatchFarEnd(socket, mode, received);
+                                 });
+      listening.set_value(!server->ListenAndServ(path));
+    });
+    if (!listening.get_future().get()) {
+      return false;
+    }
+
+    bool connected = false;
+    bool failed = false;
+    spiderweb::Object::Connect(&near, &End::ConnectionEstablished, &near,
+                               [&]() { connected = true; });
+    spiderweb::Object::Connect(&near, &End::ConnectError, &near,
+                               [&](const std::error_code&) { failed = true; });
+    near.ConnectTo(path);
+    while (!connected && !failed) {
+      io.run_one();
+    }
+    return connected;
+  }
+
+  void Close(spiderweb::Thread& thread) {
+    near.DisConnect();
+
+    std::promise<bool> closed;
+    thread.QueueTask([&]() {
+      server.reset();
+      closed.set_value(true);
+    });
+    closed.get_future().get();
+  }
+
+  End                                        near;
+  std::unique_ptr<spiderweb::net::UdsServer> server;
+  std::string                                path;
+};
+}  // namespace
+
+/**
+ * @brief range(0) bytes per write to a reader in another thread, at most 4 writes in flight
+ */
+template <typename Link>
+static void BM_LocalLinkThroughput(benchmark::State& state) {
+  const auto           size = static_cast<std::size_t>(state.range(0));
+  spiderweb::EventLoop loop;
+  spiderweb::Thread    thread;
+  std::atomic<int64_t> received{0};
+  auto&                io = spiderweb::AsioService(&loop);
+
+  thread.Start();
+  Link link;
+  if (!link.Open(io, thread, FarEnd::kCount, &received)) {
+    state.SkipWithError("open failed");
+    thread.Quit();
+    return;
+  }
+
+  const std::vector<uint8_t> chunk(size, 'x');
+  int64_t                    sent = 0;
+  const auto                 drain = [&](int64_t in_flight) {
+    while (sent - received.load(std::memory_order_relaxed) > in_flight) {
+      if (io.poll() == 0) {
+        std::this_thread::yield();
+      }
+    }
+  };
+
+  for (auto _ : state) {
+    link.near.Write(chunk.data(), chunk.size());
+    sent += static_cast<int64_t>(size);
+    drain(static_cast<int64_t>(4 * size));
+  }
+  drain(0);
+  state.SetBytesProcessed(sent);
+
+  link.Close(thread);
+  thread.Quit();
+}
+BENCHMARK_TEMPLATE(BM_LocalLinkThroughput, ShmLink)
+    ->Arg(4 << 10)
+    ->Arg(256 << 10)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_LocalLinkThroughput, UdsLink)
+    ->Arg(4 << 10)
+    ->Arg(256 << 10)
+    ->UseRealTime();
+
+/**
+ * @brief the round trip of 64 bytes echoed by another thread, both sides sleep in their loops
+ */
+template <typename Link>
+static void BM_LocalLinkRoundTrip(benchmark::State& state) {
+  static constexpr std::size_t kSize = 64;
+
+  spiderweb::EventLoop loop;
+  spiderweb::Thread    thread;
+  std::atomic<int64_t> echoed{0};
+  auto&                io = spiderweb::AsioService(&loop);
+
+  thread.Start();
+  Link link;
+  if (!link.Open(io, thread, FarEnd::kEcho, &echoed)) {
+    state.SkipWithError("open failed");
+    thread.Quit();
+    return;
+  }
+
+  std::size_t got = 0;
+  spiderweb::Object::Connect(&link.near, &Link::End::BytesRead, &link.near,
+                             [&got](const spiderweb::io::BufferReader& reader) {
+                               got += reader.Len();
+                               reader.Skip(static_cast<uint32_t>(reader.Len()));
+                             });
+
+  const std::vector<uint8_t> message(kSize, 'p');
+  std::size_t                target = 0;
+  for (auto _ : state) {
+    target += kSize;
+    link.near.Write(message.data(), message.size());
+    while (got < target) {
+      io.run_one();
+    }
+  }
+
+  link.Close(thread);
+  thread.Quit();
+}
+BENCHMARK_TEMPLATE(BM_LocalLinkRoundTrip, ShmLink)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_LocalLinkRoundTrip, UdsLink)->UseRealTime();
@@ -0,0 +1,224 @@
+#include "spiderweb/io/spiderweb_shm_channel.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "core/internal/asio_cast.h"
+#include "gtest/gtest.h"
+#include "spiderweb/core/spiderweb_error_code.h"
+#include "spiderweb/core/spiderweb_eventloop.h"
+
+namespace {
+using spiderweb::io::ShmChannel;
+
+/**
+ * @brief collects what a channel reads, and its error
+ */
+struct ShmReader {
+  explicit ShmReader(ShmChannel* channel) {
+    spiderweb::Object::Connect(channel, &ShmChannel::BytesRead, channel,
+                               [this](const spiderweb::io::BufferReader& reader) {
+                                 std::string data(reader.Len(), '\0');
+                                 reader.Read(&data[0], data.size());
+                                 received += data;
+                               });
+    spiderweb::Object::Connect(channel, &ShmChannel::BytesWritten, channel,
+                               [this](std::size_t size) { written += size; });
+    spiderweb::Object::Connect(channel, &ShmChannel::Error, channel,
+                               [this](const std::error_code& ec) { error = ec; });
+  }
+
+  std::string     received;
+  std::size_t     written = 0;
+  std::error_code error;
+};
+
+/**
+ * @brief the fds of `channel` as another process gets them, duplicated
+ */
+std::vector<int> DupPeerFds(const ShmChannel& channel) {
+  std::vector<int> fds;
+  for (const int fd : channel.PeerFds()) {
+    fds.push_back(::fcntl(fd, F_DUPFD_CLOEXEC, 0));
+  }
+  return fds;
+}
+
+void RunShm(spiderweb::EventLoop& loop, const std::function<bool()>& done) {
+  auto& io = spiderweb::AsioService(&loop);
+  for (int i = 0; i < 500 && !done(); ++i) {
+    io.run_one_for(std::chrono::milliseconds(10));
+  }
+}
+}  // namespace
+
+TEST(ShmChannel, BothDirections) {
+  spiderweb::EventLoop loop;
+  ShmChannel           a;
+  ShmChannel           b;
+  ShmReader            a_reader(&a);
+  ShmReader            b_reader(&b);
+
+  ASSERT_FALSE(a.Create(4096));
+  ASSERT_EQ(a.PeerFds().size(), 3);
+  ASSERT_FALSE(b.Attach(DupPeerFds(a)));
+  EXPECT_TRUE(b.PeerFds().empty());
+
+  a.Write(reinterpret_cast<const uint8_t*>("ping"), 4);
+  b.Write(std::vector<uint8_t>{'p', 'o', 'n', 'g'});
+
+  RunShm(loop, [&]() { return b_reader.received.size() == 4 && a_reader.received.size() == 4; });
+  EXPECT_EQ(b_reader.received, "ping");
+  EXPECT_EQ(a_reader.received, "pong");
+  EXPECT_EQ(a_reader.written, 4);
+  EXPECT_EQ(b_reader.written, 4);
+}
+
+TEST(ShmChannel, LargerThanTheRing) {
+  static constexpr std::size_t kSize = 3 * 1024 * 1024 + 5;
+
+  spiderweb::EventLoop loop;
+  ShmChannel           a;
+  ShmChannel           b;
+  ShmReader            a_reader(&a);
+  ShmReader            b_reader(&b);
+
+  ASSERT_FALSE(a.Create(64 * 1024));
+  ASSERT_FALSE(b.Attach(DupPeerFds(a)));
+
+  /**
+   * @brief the writer waits for space while the reader empties the ring
+   */
+  std::string payload(kSize, '\0');
+  for (std::size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<char>(i * 13);
+  }
+  a.Write(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+  EXPECT_EQ(a.WriteBufferSize(), kSize);
+
+  RunShm(loop, [&]() { return b_reader.received.size() == kSize; });
+  EXPECT_EQ(b_reader.received, payload);
+  EXPECT_EQ(a_reader.written, kSize);
+  EXPECT_EQ(a.WriteBufferSize(), 0);
+}
+
+TEST(ShmChannel, CloseIsEof) {
+  spiderweb::EventLoop loop;
+  ShmChannel           a;
+  ShmChannel           b;
+  ShmReader            b_reader(&b);
+
+  ASSERT_FALSE(a.Create(4096));
+  ASSERT_FALSE(b.Attach(DupPeerFds(a)));
+
+  a.Write(reinterpret_cast<const uint8_t*>("last"), 4);
+  RunShm(loop, [&]() { return a.WriteBufferSize() == 0; });
+  a.Close();
+  EXPECT_TRUE(a.IsClosed());
+
+  /**
+   * @brief what was in the ring is read before the end
+   */
+  RunShm(loop, [&]() { return static_cast<bool>(b_reader.error); });
+  EXPECT_EQ(b_reader.received, "last");
+  EXPECT_EQ(b_reader.error, asio::error::eof);
+  EXPECT_TRUE(b.IsClosed());
+}
+
+TEST(ShmChannel, AttachInvalid) {
+  spiderweb::EventLoop loop;
+  ShmChannel           channel;
+
+  EXPECT_TRUE(channel.Create(5000));
+  EXPECT_TRUE(channel.Attach({}));
+
+  int pipe[2];
+  ASSERT_EQ(::pipe(pipe), 0);
+  EXPECT_TRUE(channel.Attach({pipe[0], pipe[1], ::dup(pipe[1])}));
+  EXPECT_TRUE(channel.IsClosed());
+}
+
+TEST(ShmChannel, MaxReadBuffer) {
+  static constexpr std::size_t kRing = 64 * 1024;
+  static constexpr std::size_t kMax = 16 * 1024;
+  static constexpr std::size_t kSize = 1024 * 1024;
+
+  spiderweb::EventLoop loop;
+  ShmChannel           a;
+  ShmChannel           b;
+  ASSERT_FALSE(a.Create(kRing));
+  ASSERT_FALSE(b.Attach(DupPeerFds(a)));
+
+  std::string                              received;
+  std::vector<spiderweb::io::BufferReader> kept;
+  auto read = [&](const spiderweb::io::BufferReader& reader) {
+    std::string data(reader.Len(), '\0');
+    reader.Read(&data[0], data.size());
+    received += data;
+  };
+  spiderweb::Object::Connect(&b, &ShmChannel::BytesRead, &b,
+                             [&](const spiderweb::io::BufferReader& reader) {
+                               if (kept.empty()) {
+                                 kept.push_back(reader);
+                                 return;
+                               }
+                               read(reader);
+                             });
+  b.SetMaxReadBufferSize(kMax);
+
+  /**
+   * @brief the reader stops at kMax, the ring fills, and the rest waits in the writer
+   */
+  std::string payload(kSize, '\0');
+  for (std::size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<char>(i * 11);
+  }
+  a.Write(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+  RunShm(loop, [&]() { return a.WriteBufferSize() == kSize - kMax - kRing; });
+  spiderweb::AsioService(&loop).run_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(b.ReadBufferSize(), kMax);
+  EXPECT_EQ(a.WriteBufferSize(), kSize - kMax - kRing);
+
+  /**
+   * @brief reading from the buffer later, out of the slot, takes ContinueReading
+   */
+  read(kept.front());
+  b.ContinueReading();
+  RunShm(loop, [&]() { return received.size() == kSize; });
+  EXPECT_EQ(received, payload);
+  EXPECT_EQ(a.WriteBufferSize(), 0);
+}
+
+TEST(ShmChannel, CorruptIndexes) {
+  spiderweb::EventLoop loop;
+  ShmChannel           a;
+  ShmChannel           b;
+  ShmReader            b_reader(&b);
+  ASSERT_FALSE(a.Create(4096));
+  ASSERT_FALSE(b.Attach(DupPeerFds(a)));
+
+  /**
+   * @brief the head of the ring a writes, at the second cache line of the layout, is moved past
+   *
+   * a whole ring, as a broken peer would. b is woken by the eventfd it waits on.
+   */
+  const auto fds = a.PeerFds();
+  void*      base = ::mmap(nullptr, 4096, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+  ASSERT_NE(base, MAP_FAILED);
+  const uint64_t head = 3 * 4096;
+  std::memcpy(static_cast<uint8_t*>(base) + 64, &head, sizeof(head));
+  ::munmap(base, 4096);
+  const uint64_t one = 1;
+  ASSERT_EQ(::write(fds[1], &one, sizeof(one)), sizeof(one));
+
+  RunShm(loop, [&]() { return static_cast<bool>(b_reader.error); });
+  EXPECT_EQ(b_reader.error, std::error_code(spiderweb::RuntimeError()));
+  EXPECT_TRUE(b_reader.received.empty());
+  EXPECT_TRUE(b.IsClosed());
+}
@@ -0,0 +1,547 @@
+#include "spiderweb/io/spiderweb_stream_forwarder.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <utility>
+
+#include "asio.hpp"
+#include "core/internal/asio_cast.h"
+#include "spiderweb/core/internal/thread_check.h"
+#include "spiderweb/core/spiderweb_error_code.h"
+
+namespace spiderweb {
+namespace io {
+
+namespace {
+/**
+ * @brief splice and sendfile have no MSG_NOSIGNAL, SIGPIPE is blocked instead in the thread of
+ *
+ * the forwarders, while any of them forwards. a write to a closed sink then fails with EPIPE, and
+ *
+ * the SIGPIPE raised meanwhile is consumed once the last of them stops.
+ */
+class SigPipeBlock {
+ public:
+  ~SigPipeBlock() {
+    Release();
+  }
+
+  void Acquire() {
+    if (held_) {
+      return;
+    }
+    held_ = true;
+
+    auto& thread = State();
+    if (thread.users++ > 0) {
+      return;
+    }
+
+    /**
+     * @brief a SIGPIPE blocked before is not ours to unblock or consume
+     */
+    sigset_t pipe = PipeSet();
+    sigset_t old;
+    thread.blocked =
+        pthread_sigmask(SIG_BLOCK, &pipe, &old) == 0 && sigismember(&old, SIGPIPE) != 1;
+    thread.epipe = false;
+  }
+
+  void Release() {
+    if (!held_) {
+      return;
+    }
+    held_ = false;
+
+    auto& thread = State();
+    if (--thread.users > 0 || !thread.blocked) {
+      return;
+    }
+
+    sigset_t pipe = PipeSet();
+    if (thread.epipe) {
+      const timespec zero{0, 0};
+      while (sigtimedwait(&pipe, nullptr, &zero) == -1 && errno == EINTR) {
+      }
+    }
+    pthread_sigmask(SIG_UNBLOCK, &pipe, nullptr);
+    thread.blocked = false;
+  }
+
+  static void OnError(int error) {
+    if (error == EPIPE) {
+      State().epipe = true;
+    }
+  }
+
+ private:
+  struct ThreadState {
+    int  users = 0;
+    bool blocked = false;
+    bool epipe = false;
+  };
+
+  static ThreadState& State() {
+    static thread_local ThreadState state;
+    return state;
+  }
+
+  static sigset_t PipeSet() {
+    sigset_t pipe;
+    sigemptyset(&pipe);
+    sigaddset(&pipe, SIGPIPE);
+    return pipe;
+  }
+
+  bool held_ = false;
+};
+
+std::error_code LastError() {
+  return std::error_code(errno, std::system_category());
+}
+
+/**
+ * @brief a dup of `fd`, non blocking. it shares the file description of `fd`, so `fd` is non
+ *
+ * blocking too, as asio has it anyway.
+ */
+int DupNonBlocking(int fd) {
+  const int dup = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+  if (dup < 0) {
+    return -1;
+  }
+
+  const int flags = ::fcntl(dup, F_GETFL);
+  if (flags < 0 || ::fcntl(dup, F_SETFL, flags | O_NONBLOCK) < 0) {
+    ::close(dup);
+    return -1;
+  }
+  return dup;
+}
+
+bool IsSocket(int fd) {
+  struct stat stat;
+  return ::fstat(fd, &stat) == 0 && S_ISSOCK(stat.st_mode);
+}
+}  // namespace
+
+class StreamForwarder::Private : public std::enable_shared_from_this<Private> {
+ public:
+  /// bytes moved per splice
+  static constexpr std::size_t kChunk = 1024 * 1024;
+  /// the pipe between source and sink, best effort
+  static constexpr int         kPipeSize = 1024 * 1024;
+  /// syscalls in a row before the other handlers of the loop get a chance
+  static constexpr int         kMaxRounds = 64;
+
+  explicit Private(StreamForwarder* qq)
+      : q(qq),
+        source(AsioService(qq->ownerEventLoop())),
+        sink(AsioService(qq->ownerEventLoop())) {
+  }
+
+  ~Private() {
+    Stop();
+    CloseFile();
+  }
+
+  void Start(int from_fd, int to_fd) {
+    Stop();
+    stopped = false;
+    finished = false;
+    eof = false;
+    piped = 0;
+    file_remaining = 0;
+
+    if (!Assign(source, from_fd)) {
+      return;
+    }
+
+    if (to_fd < 0) {
+      sink_fd = file;
+    } else {
+      if (!Assign(sink, to_fd)) {
+        return;
+      }
+      sink_fd = sink.native_handle();
+      sink_is_socket = IsSocket(sink_fd);
+    }
+
+    if (::pipe2(pipe, O_NONBLOCK | O_CLOEXEC) != 0) {
+      pipe[0] = pipe[1] = -1;
+      Fail(LastError());
+      return;
+    }
+    (void)::fcntl(pipe[1], F_SETPIPE_SZ, kPipeSize);
+
+    sig_pipe.Acquire();
+    Splice();
+  }
+
+  void StartSendFile(const std::string& path, uint64_t offset, uint64_t count, int to_fd) {
+    Stop();
+    CloseFile();
+    stopped = false;
+    finished = false;
+
+    file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) {
+      Fail(LastError());
+      return;
+    }
+
+    struct stat stat;
+    if (::fstat(file, &stat) != 0) {
+      Fail(LastError());
+      return;
+    }
+
+    const auto size = static_cast<uint64_t>(stat.st_size);
+    if (offset > size) {
+      Fail(InvalidArgument("offset beyond the end of the file"));
+      return;
+    }
+
+    file_offset = static_cast<off_t>(offset);
+    file_remaining = count > 0 ? std::min(count, size - offset) : size - offset;
+
+    if (!Assign(sink, to_fd)) {
+      return;
+    }
+    sink_fd = sink.native_handle();
+    sink_is_socket = false;
+
+    sig_pipe.Acquire();
+    SendFile();
+  }
+
+  bool OpenFile(const std::string& path) {
+    CloseFile();
+    file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file < 0) {
+      Fail(LastError());
+      return false;
+    }
+    return true;
+  }
+
+  void WriteFile(const char* data, std::size_t size) {
+    while (size > 0 && file >= 0) {
+      const auto n = ::write(file, data, size);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        Fail(LastError());
+        return;
+      }
+      data += n;
+      size -= static_cast<std::size_t>(n);
+    }
+  }
+
+  /**
+   * @brief splice source -> pipe -> sink. the source is only read while the pipe is empty, so it
+   *
+   * goes no faster than the sink. before waiting for a side, it has been tried until EAGAIN.
+   */
+  void Splice() {
+    auto        self = shared_from_this();
+    std::size_t moved = 0;
+    int         round = 0;
+    for (; round < kMaxRounds && !stopped; ++round) {
+      if (piped > 0) {
+        const auto n = ::splice(pipe[0], nullptr, sink_fd, nullptr, piped,
+                                SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n < 0) {
+          SigPipeBlock::OnError(errno);
+          if (errno == EINTR) {
+            continue;
+          }
+          if (errno == EAGAIN) {
+            Wait(sink, asio::posix::descriptor_base::wait_write);
+            break;
+          }
+          Fail(LastError());
+          return;
+        }
+        piped -= static_cast<std::size_t>(n);
+        moved += static_cast<std::size_t>(n);
+        continue;
+      }
+
+      if (eof) {
+        Finish(moved);
+        return;
+      }
+
+      const auto n = ::splice(source.native_handle(), nullptr, pipe[1], nullptr, kChunk,
+                              SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno == EAGAIN) {
+          Wait(source, asio::posix::descriptor_base::wait_read);
+          break;
+        }
+        Fail(LastError());
+        return;
+      }
+
+      if (n == 0) {
+        eof = true;
+      }
+      piped += static_cast<std::size_t>(n);
+    }
+
+    if (round == kMaxRounds) {
+      Post([](Private* self) { self->Splice(); });
+    }
+    Report(moved);
+  }
+
+  void SendFile() {
+    auto        self = shared_from_this();
+    std::size_t moved = 0;
+    int         round = 0;
+    for (; round < kMaxRounds && !stopped && file_remaining > 0; ++round) {
+      const auto size = static_cast<std::size_t>(std::min<uint64_t>(file_remaining, kChunk));
+      const auto n = ::sendfile(sink_fd, file, &file_offset, size);
+      if (n < 0) {
+        SigPipeBlock::OnError(errno);
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno == EAGAIN) {
+          Wait(sink, asio::posix::descriptor_base::wait_write);
+          break;
+        }
+        Fail(LastError());
+        return;
+      }
+
+      /**
+       * @brief the file has been truncated meanwhile
+       */
+      if (n == 0) {
+        file_remaining = 0;
+        break;
+      }
+      file_remaining -= static_cast<uint64_t>(n);
+      moved += static_cast<std::size_t>(n);
+    }
+
+    if (!stopped && file_remaining == 0) {
+      Finish(moved);
+      return;
+    }
+
+    if (round == kMaxRounds) {
+      Post([](Private* self) { self->SendFile(); });
+    }
+    Report(moved);
+  }
+
+  /**
+   * @brief the dups and the pipe are closed, the waits in progress are aborted
+   */
+  void Stop() {
+    stopped = true;
+    ++generation;
+    sig_pipe.Release();
+
+    asio::error_code ec;
+    (void)source.close(ec);
+    (void)sink.close(ec);
+    sink_fd = -1;
+    for (auto& fd : pipe) {
+      if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+      }
+    }
+  }
+
+  void CloseFile() {
+    if (file >= 0) {
+      ::close(file);
+      file = -1;
+    }
+  }
+
+  void Fail(const std::error_code& ec) {
+    Stop();
+    CloseFile();
+    Object::Emit(q, &StreamForwarder::Error, ec);
+  }
+
+  StreamForwarder*               q = nullptr;
+  asio::posix::stream_descriptor source;
+  asio::posix::stream_descriptor sink;
+  /// the sink descriptor, or the file of ReceiveFile
+  int                            sink_fd = -1;
+  bool                           sink_is_socket = false;
+  int                            pipe[2] = {-1, -1};
+  SigPipeBlock                   sig_pipe;
+  /// bytes in the pipe
+  std::size_t                    piped = 0;
+  int                            file = -1;
+  off_t                          file_offset = 0;
+  uint64_t                       file_remaining = 0;
+  uint64_t                       forwarded = 0;
+  bool                           eof = false;
+  bool                           stopped = true;
+  /// bumped by Stop, see StreamForwarder::Current
+  uint64_t                       generation = 0;
+  /// the streams may fail after, it is no matter of the forwarder any more
+  bool                           finished = false;
+
+ private:
+  bool Assign(asio::posix::stream_descriptor& descriptor, int fd) {
+    const int dup = DupNonBlocking(fd);
+    if (dup < 0) {
+      Fail(LastError());
+      return false;
+    }
+
+    asio::error_code ec;
+    (void)descriptor.assign(dup, ec);
+    if (ec) {
+      ::close(dup);
+      Fail(ec);
+      return false;
+    }
+    return true;
+  }
+
+  void Wait(asio::posix::stream_descriptor&        descriptor,
+            asio::posix::descriptor_base::wait_type type) {
+    auto self = shared_from_this();
+    descriptor.async_wait(type, [this, self](const asio::error_code& ec) {
+      if (stopped || ec == asio::error::operation_aborted) {
+        return;
+      }
+
+      if (ec) {
+        Fail(ec);
+        return;
+      }
+
+      if (file_remaining > 0) {
+        SendFile();
+      } else {
+        Splice();
+      }
+    });
+  }
+
+  template <typename F>
+  void Post(F&& f) {
+    std::weak_ptr<Private> weak = shared_from_this();
+    asio::post(source.get_executor(), [weak, f]() {
+      auto self = weak.lock();
+      if (self && !self->stopped) {
+        f(self.get());
+      }
+    });
+  }
+
+  void Report(std::size_t moved) {
+    if (moved > 0) {
+      forwarded += moved;
+      Object::Emit(q, &StreamForwarder::BytesForwarded, std::move(moved));
+    }
+  }
+
+  /**
+   * @brief everything is forwarded, a socket sink gets the end of the source too(half close)
+   */
+  void Finish(std::size_t moved) {
+    if (sink_is_socket) {
+      ::shutdown(sink_fd, SHUT_WR);
+    }
+    finished = true;
+    Stop();
+    CloseFile();
+
+    /**
+     * @brief the forwarder may be deleted by a slot of BytesForwarded, `q` is null then
+     */
+    Report(moved);
+    Object::Emit(q, &StreamForwarder::Finished);
+  }
+};
+
+constexpr std::size_t StreamForwarder::Private::kChunk;
+
+StreamForwarder::StreamForwarder(Object* parent)
+    : Object(parent), d(std::make_shared<Private>(this)) {
+}
+
+StreamForwarder::~StreamForwarder() {
+  SPIDERWEB_CALL_THREAD_CHECK(StreamForwarder::~StreamForwarder);
+  d->q = nullptr;
+  d->Stop();
+  d->CloseFile();
+}
+
+void StreamForwarder::Stop() {
+  SPIDERWEB_CALL_THREAD_CHECK(StreamForwarder::Stop);
+  d->Stop();
+  d->CloseFile();
+}
+
+bool StreamForwarder::IsForwarding() const {
+  return !d->stopped;
+}
+
+uint64_t StreamForwarder::BytesForwardedTotal() const {
+  return d->forwarded;
+}
+
+std::function<bool()> StreamForwarder::Current() const {
+  std::weak_ptr<Private> weak = d;
+  const auto             generation = d->generation;
+  return [weak, generation]() {
+    auto d = weak.lock();
+    return d && d->q && d->generation == generation;
+  };
+}
+
+void StreamForwarder::Start(int from_fd, int to_fd) {
+  SPIDERWEB_CALL_THREAD_CHECK(StreamForwarder::Start);
+  d->Start(from_fd, to_fd);
+}
+
+void StreamForwarder::StartSendFile(const std::string& path, uint64_t offset, uint64_t count,
+                                    int to_fd) {
+  SPIDERWEB_CALL_THREAD_CHECK(StreamForwarder::StartSendFile);
+  d->StartSendFile(path, offset, count, to_fd);
+}
+
+bool StreamForwarder::OpenFile(const std::string& path) {
+  return d->OpenFile(path);
+}
+
+void StreamForwarder::WriteFile(const char* data, std::size_t size) {
+  d->WriteFile(data, size);
+}
+
+void StreamForwarder::Fail(const std::error_code& ec) {
+  if (!d->finished) {
+    d->Fail(ec);
+  }
+}
+
+}  // namespace io
+}  // namespace spiderweb
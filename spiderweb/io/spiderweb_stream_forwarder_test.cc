@@ -0,0 +1,411 @@
+#include "spiderweb/io/spiderweb_stream_forwarder.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+
+#include "core/internal/asio_cast.h"
+#include "gtest/gtest.h"
+#include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_notify_spy.h"
+#include "spiderweb/net/spiderweb_tcp_server.h"
+#include "spiderweb/net/spiderweb_tcp_socket.h"
+
+namespace {
+/**
+ * @brief a loopback server which keeps its first connection, and what it receives until the end
+ */
+class Peer {
+ public:
+  explicit Peer(uint16_t port) : server(port) {
+    spiderweb::Object::Connect(
+        &server, &spiderweb::net::TcpServer::InComingConnection, &server,
+        [this](spiderweb::net::TcpSocket* s) {
+          socket = s;
+          spiderweb::Object::Connect(s, &spiderweb::net::TcpSocket::BytesRead, s,
+                                     [this](const spiderweb::io::BufferReader& reader) {
+                                       if (!collect) {
+                                         return;
+                                       }
+                                       std::string data(reader.Len(), '\0');
+                                       reader.Read(&data[0], data.size());
+                                       received += data;
+                                     });
+          spiderweb::Object::Connect(s, &spiderweb::net::TcpSocket::Error, s,
+                                     [this](const std::error_code& ec) {
+                                       ended = ec == asio::error::eof;
+                                     });
+        });
+  }
+
+  spiderweb::net::TcpServer  server;
+  spiderweb::net::TcpSocket* socket = nullptr;
+  bool                       collect = true;
+  std::string                received;
+  bool                       ended = false;
+};
+
+void RunUntil(spiderweb::EventLoop& loop, const std::function<bool()>& done) {
+  auto& io = spiderweb::AsioService(&loop);
+  for (int i = 0; i < 500 && !done(); ++i) {
+    io.run_one_for(std::chrono::milliseconds(10));
+  }
+}
+
+/**
+ * @brief run the loop until `value` stays the same for 200ms
+ */
+void RunUntilStalled(spiderweb::EventLoop& loop, const std::function<uint64_t()>& value) {
+  auto& io = spiderweb::AsioService(&loop);
+  for (int i = 0; i < 100; ++i) {
+    const auto before = value();
+    io.run_for(std::chrono::milliseconds(200));
+    if (value() == before) {
+      return;
+    }
+  }
+}
+
+/**
+ * @brief close `socket` with a reset instead of a fin
+ */
+void Reset(spiderweb::net::TcpSocket& socket) {
+  const linger abort{1, 0};
+  ::setsockopt(socket.NativeHandle(), SOL_SOCKET, SO_LINGER, &abort, sizeof(abort));
+  socket.DisConnectFromHost();
+}
+
+std::string TempPath(const char* name) {
+  return std::string("/tmp/spiderweb_") + name + "_" + std::to_string(::getpid());
+}
+}  // namespace
+
+TEST(StreamForwarder, ForwardHalfClose) {
+  static constexpr std::size_t kSize = 4 * 1024 * 1024;
+
+  spiderweb::EventLoop loop;
+  Peer                 front(12450);
+  Peer                 back(12451);
+  ASSERT_FALSE(front.server.ListenAndServ("127.0.0.1"));
+  ASSERT_FALSE(back.server.ListenAndServ("127.0.0.1"));
+
+  /**
+   * @brief what the front peer has received before forwarding is left in its socket
+   */
+  front.collect = false;
+  spiderweb::net::TcpSocket client;
+  client.ConnectToHost("127.0.0.1", 12450);
+  client.Write(reinterpret_cast<const uint8_t*>("head"), 4);
+  RunUntil(loop, [&]() { return front.socket && front.socket->ReadBufferSize() == 4; });
+  ASSERT_NE(front.socket, nullptr);
+
+  spiderweb::net::TcpSocket upstream;
+  spiderweb::NotifySpy      connected(&upstream, &spiderweb::net::TcpSocket::ConnectionEstablished);
+  upstream.ConnectToHost("127.0.0.1", 12451);
+  connected.Wait();
+
+  spiderweb::io::StreamForwarder forwarder;
+  spiderweb::NotifySpy           finished(&forwarder, &spiderweb::io::StreamForwarder::Finished);
+  spiderweb::NotifySpy           error(&forwarder, &spiderweb::io::StreamForwarder::Error);
+  std::size_t                    forwarded = 0;
+  spiderweb::Object::Connect(&forwarder, &spiderweb::io::StreamForwarder::BytesForwarded,
+                             &forwarder, [&](std::size_t size) { forwarded += size; });
+  forwarder.Forward(front.socket, &upstream);
+
+  std::string payload(kSize, '\0');
+  for (std::size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<char>(i * 31);
+  }
+  client.Write(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+  RunUntil(loop, [&]() { return client.WriteBufferSize() == 0; });
+  client.DisConnectFromHost();
+
+  /**
+   * @brief the end of the client reaches the back peer through the forwarder
+   */
+  RunUntil(loop, [&]() { return finished.Count() > 0 && back.ended; });
+  EXPECT_EQ(error.Count(), 0);
+  EXPECT_EQ(finished.Count(), 1);
+  EXPECT_TRUE(back.ended);
+  EXPECT_FALSE(forwarder.IsForwarding());
+  /**
+   * @brief the bytes of the read in progress when reading was released are forwarded by a copy
+   */
+  EXPECT_GT(forwarded, 0);
+  EXPECT_LE(forwarded, kSize);
+  EXPECT_EQ(forwarder.BytesForwardedTotal(), forwarded);
+  ASSERT_EQ(back.received.size(), kSize + 4);
+  EXPECT_EQ(back.received, "head" + payload);
+}
+
+TEST(StreamForwarder, SendFile) {
+  static constexpr std::size_t kSize = 3 * 1024 * 1024 + 17;
+
+  const auto  path = TempPath("send_file");
+  std::string content(kSize, '\0');
+  for (std::size_t i = 0; i < content.size(); ++i) {
+    content[i] = static_cast<char>(i * 7);
+  }
+  std::ofstream(path, std::ios::binary) << content;
+
+  spiderweb::EventLoop loop;
+  Peer                 peer(12452);
+  ASSERT_FALSE(peer.server.ListenAndServ("127.0.0.1"));
+
+  spiderweb::net::TcpSocket client;
+  spiderweb::NotifySpy      connected(&client, &spiderweb::net::TcpSocket::ConnectionEstablished);
+  client.ConnectToHost("127.0.0.1", 12452);
+  connected.Wait();
+
+  spiderweb::io::StreamForwarder forwarder;
+  spiderweb::NotifySpy           finished(&forwarder, &spiderweb::io::StreamForwarder::Finished);
+  client.Write(reinterpret_cast<const uint8_t*>("<"), 1);
+  forwarder.SendFile(path, &client, 10);
+
+  RunUntil(loop, [&]() { return peer.received.size() >= kSize - 10 + 1; });
+  EXPECT_EQ(finished.Count(), 1);
+  EXPECT_EQ(forwarder.BytesForwardedTotal(), kSize - 10);
+
+  /**
+   * @brief the stream is usable again, it is not shut down after a file
+   */
+  client.Write(reinterpret_cast<const uint8_t*>(">"), 1);
+  RunUntil(loop, [&]() { return peer.received.size() == kSize - 10 + 2; });
+  EXPECT_EQ(peer.received, "<" + content.substr(10) + ">");
+  std::remove(path.c_str());
+}
+
+TEST(StreamForwarder, ReceiveFile) {
+  static constexpr std::size_t kSize = 2 * 1024 * 1024;
+
+  const auto path = TempPath("receive_file");
+
+  spiderweb::EventLoop loop;
+  Peer                 peer(12453);
+  ASSERT_FALSE(peer.server.ListenAndServ("127.0.0.1"));
+
+  spiderweb::net::TcpSocket client;
+  spiderweb::NotifySpy      connected(&client, &spiderweb::net::TcpSocket::ConnectionEstablished);
+  client.ConnectToHost("127.0.0.1", 12453);
+  connected.Wait();
+  RunUntil(loop, [&]() { return peer.socket != nullptr; });
+  ASSERT_NE(peer.socket, nullptr);
+
+  spiderweb::io::StreamForwarder forwarder;
+  spiderweb::NotifySpy           finished(&forwarder, &spiderweb::io::StreamForwarder::Finished);
+  spiderweb::NotifySpy           error(&forwarder, &spiderweb::io::StreamForwarder::Error);
+  peer.collect = false;
+  forwarder.ReceiveFile(peer.socket, path);
+
+  const std::string payload(kSize, 'f');
+  client.Write(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+  RunUntil(loop, [&]() { return client.WriteBufferSize() == 0; });
+  client.DisConnectFromHost();
+
+  RunUntil(loop, [&]() { return finished.Count() > 0 || error.Count() > 0; });
+  EXPECT_EQ(error.Count(), 0);
+  EXPECT_EQ(finished.Count(), 1);
+
+  std::ifstream     file(path, std::ios::binary);
+  const std::string written((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+  EXPECT_EQ(written, payload);
+  std::remove(path.c_str());
+}
+
+TEST(StreamForwarder, SinkError) {
+  spiderweb::EventLoop loop;
+  Peer                 front(12454);
+  Peer                 back(12455);
+  ASSERT_FALSE(front.server.ListenAndServ("127.0.0.1"));
+  ASSERT_FALSE(back.server.ListenAndServ("127.0.0.1"));
+
+  spiderweb::net::TcpSocket client;
+  client.ConnectToHost("127.0.0.1", 12454);
+  spiderweb::net::TcpSocket upstream;
+  spiderweb::NotifySpy      connected(&upstream, &spiderweb::net::TcpSocket::ConnectionEstablished);
+  upstream.ConnectToHost("127.0.0.1", 12455);
+  connected.Wait();
+  RunUntil(loop, [&]() { return front.socket && back.socket; });
+  ASSERT_NE(front.socket, nullptr);
+  ASSERT_NE(back.socket, nullptr);
+
+  spiderweb::io::StreamForwarder forwarder;
+  spiderweb::NotifySpy           error(&forwarder, &spiderweb::io::StreamForwarder::Error);
+  forwarder.Forward(front.socket, &upstream);
+
+  /**
+   * @brief the back peer goes away, writing to it fails(EPIPE or ECONNRESET, without SIGPIPE)
+   */
+  back.socket->DisConnectFromHost();
+  const std::string payload(1024 * 1024, 'e');
+  for (int i = 0; i < 8 && error.Count() == 0; ++i) {
+    client.Write(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+    RunUntil(loop, [&]() { return client.WriteBufferSize() == 0 || error.Count() > 0; });
+  }
+
+  EXPECT_GE(error.Count(), 1);
+  EXPECT_FALSE(forwarder.IsForwarding());
+}
+
+TEST(StreamForwarder, SourceReset) {
+  spiderweb::EventLoop loop;
+  Peer                 front(12456);
+  Peer                 back(12457);
+  ASSERT_FALSE(front.server.ListenAndServ("127.0.0.1"));
+  ASSERT_FALSE(back.server.ListenAndServ("127.0.0.1"));
+
+  spiderweb::net::TcpSocket client;
+  client.ConnectToHost("127.0.0.1", 12456);
+  spiderweb::net::TcpSocket upstream;
+  spiderweb::NotifySpy      connected(&upstream, &spiderweb::net::TcpSocket::ConnectionEstablished);
+  upstream.ConnectToHost("127.0.0.1", 12457);
+  connected.Wait();
+  RunUntil(loop, [&]() { return front.socket && back.socket; });
+  ASSERT_NE(front.socket, nullptr);
+  front.collect = false;
+
+  spiderweb::io::StreamForwarder forwarder;
+  spiderweb::NotifySpy           finished(&forwarder, &spiderweb::io::StreamForwarder::Finished);
+  std::error_code                error;
+  spiderweb::Object::Connect(&forwarder, &spiderweb::io::StreamForwarder::Error, &forwarder,
+                             [&](const std::error_code& ec) { error = ec; });
+  forwarder.Forward(front.socket, &upstream);
+
+  /**
+   * @brief the reset fails the read in progress when reading was released, it is reported, not
+   *
+   * taken for the end of the source
+   */
+  Reset(client);
+  RunUntil(loop, [&]() { return error || finished.Count() > 0; });
+  EXPECT_EQ(error, asio::error::connection_reset);
+  EXPECT_EQ(finished.Count(), 0);
+  EXPECT_FALSE(forwarder.IsForwarding());
+}
+
+TEST(StreamForwarder, StopBeforeReleased) {
+  spiderweb::EventLoop loop;
+  Peer                 front(12469);
+  Peer                 back(12470);
+  ASSERT_FALSE(front.server.ListenAndServ("127.0.0.1"));
+  ASSERT_FALSE(back.server.ListenAndServ("127.0.0.1"));
+
+  spiderweb::net::TcpSocket client;
+  client.ConnectToHost("127.0.0.1", 12469);
+  spiderweb::net::TcpSocket upstream;
+  spiderweb::NotifySpy      connected(&upstream, &spiderweb::net::TcpSocket::ConnectionEstablished);
+  upstream.ConnectToHost("127.0.0.1", 12470);
+  connected.Wait();
+  RunUntil(loop, [&]() { return front.socket && back.socket; });
+  ASSERT_NE(front.socket, nullptr);
+  front.collect = false;
+
+  spiderweb::io::StreamForwarder forwarder;
+  forwarder.Forward(front.socket, &upstream);
+  forwarder.Stop();
+
+  /**
+   * @brief the read in progress completes after the stop, it does not start the forwarding
+   */
+  client.Write(reinterpret_cast<const uint8_t*>("late"), 4);
+  RunUntil(loop, [&]() { return client.WriteBufferSize() == 0; });
+  RunUntil(loop, [&]() { return front.socket->ReadBufferSize() == 4; });
+  RunUntilStalled(loop, [&]() { return back.received.size(); });
+  EXPECT_FALSE(forwarder.IsForwarding());
+  EXPECT_EQ(front.socket->ReadBufferSize(), 4);
+  EXPECT_TRUE(back.received.empty());
+}
+
+TEST(StreamForwarder, SourceResetMidTransfer) {
+  spiderweb::EventLoop loop;
+  Peer                 front(12458);
+  Peer                 back(12459);
+  ASSERT_FALSE(front.server.ListenAndServ("127.0.0.1"));
+  ASSERT_FALSE(back.server.ListenAndServ("127.0.0.1"));
+
+  spiderweb::net::TcpSocket client;
+  client.ConnectToHost("127.0.0.1", 12458);
+  spiderweb::net::TcpSocket upstream;
+  spiderweb::NotifySpy      connected(&upstream, &spiderweb::net::TcpSocket::ConnectionEstablished);
+  upstream.ConnectToHost("127.0.0.1", 12459);
+  connected.Wait();
+  RunUntil(loop, [&]() { return front.socket && back.socket; });
+  ASSERT_NE(front.socket, nullptr);
+  front.collect = false;
+
+  spiderweb::io::StreamForwarder forwarder;
+  spiderweb::NotifySpy           finished(&forwarder, &spiderweb::io::StreamForwarder::Finished);
+  std::error_code                error;
+  spiderweb::Object::Connect(&forwarder, &spiderweb::io::StreamForwarder::Error, &forwarder,
+                             [&](const std::error_code& ec) { error = ec; });
+  forwarder.Forward(front.socket, &upstream);
+
+  const std::string payload(1024 * 1024, 'r');
+  client.Write(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+  RunUntil(loop, [&]() { return back.received.size() == payload.size(); });
+  ASSERT_EQ(back.received.size(), payload.size());
+
+  Reset(client);
+  RunUntil(loop, [&]() { return error || finished.Count() > 0; });
+  EXPECT_EQ(error, asio::error::connection_reset);
+  EXPECT_EQ(finished.Count(), 0);
+  EXPECT_FALSE(forwarder.IsForwarding());
+}
+
+TEST(StreamForwarder, SlowSink) {
+  static constexpr std::size_t kSize = 64 * 1024 * 1024;
+
+  spiderweb::EventLoop loop;
+  Peer                 front(12460);
+  Peer                 back(12461);
+  ASSERT_FALSE(front.server.ListenAndServ("127.0.0.1"));
+  ASSERT_FALSE(back.server.ListenAndServ("127.0.0.1"));
+
+  spiderweb::net::TcpSocket client;
+  client.ConnectToHost("127.0.0.1", 12460);
+  spiderweb::net::TcpSocket upstream;
+  spiderweb::NotifySpy      connected(&upstream, &spiderweb::net::TcpSocket::ConnectionEstablished);
+  upstream.ConnectToHost("127.0.0.1", 12461);
+  connected.Wait();
+  RunUntil(loop, [&]() { return front.socket && back.socket; });
+  ASSERT_NE(front.socket, nullptr);
+  front.collect = false;
+  ASSERT_NE(back.socket, nullptr);
+
+  spiderweb::io::StreamForwarder forwarder;
+  spiderweb::NotifySpy           error(&forwarder, &spiderweb::io::StreamForwarder::Error);
+  forwarder.Forward(front.socket, &upstream);
+
+  /**
+   * @brief the back peer does not read, the forwarding stalls once the kernel buffers are full,
+   *
+   * and the rest of the payload waits in the write buffer of the client
+   */
+  back.socket->PauseReading();
+  std::string payload(kSize, '\0');
+  for (std::size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<char>(i * 13);
+  }
+  client.Write(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+  RunUntilStalled(loop, [&]() { return forwarder.BytesForwardedTotal(); });
+  EXPECT_EQ(error.Count(), 0);
+  EXPECT_TRUE(forwarder.IsForwarding());
+  EXPECT_LT(forwarder.BytesForwardedTotal(), kSize);
+  EXPECT_GT(client.WriteBufferSize(), 0);
+
+  back.socket->ResumeReading();
+  auto& io = spiderweb::AsioService(&loop);
+  for (int i = 0; i < 100 && back.received.size() < kSize; ++i) {
+    io.run_for(std::chrono::milliseconds(100));
+  }
+  EXPECT_EQ(error.Count(), 0);
+  ASSERT_EQ(back.received.size(), kSize);
+  EXPECT_EQ(back.received, payload);
+}
@@ -2,10 +2,13 @@
 #define SPIDERWEB_TCP_SERVER_PRIVATE_H
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "asio.hpp"
 #include "spdlog/spdlog.h"
 #include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_eventloop_group.h"
 #include "spiderweb/io/private/spiderweb_stream_private.h"
 #include "spiderweb/net/spiderweb_tcp_server.h"
 #include "spiderweb/net/spiderweb_tcp_socket.h"
@@ -18,6 +21,7 @@ class TcpServer::Private : public std::enable_shared_from_this<TcpServer::Privat
  public:
   explicit Private(uint16_t port, TcpServer* qq)
       : q(qq),
+        server_loop(qq->ownerEventLoop()),
         port_(port),
         /**
          * @brief currently, only support ipv4
@@ -27,7 +31,53 @@ class TcpServer::Private : public std::enable_shared_from_this<TcpServer::Privat
 
   ~Private() = default;
 
-  ErrorCode Listen(std::string ip_v4) {
+  ErrorCode Listen(const std::string& ip_v4) {
+    return ListenOn(acceptor, ip_v4, false);
+  }
+
+  /**
+   * @brief one acceptor per loop of the group, all of them bind the same port with SO_REUSEPORT,
+   *
+   * so the kernel load balance the incoming connections between the loops.
+   */
+  ErrorCode ListenSharded(const std::string& ip_v4) {
+    SPIDERWEB_VERIFY(group, return InvalidArgument("sharded listen needs an EventLoopGroup"));
+
+    for (std::size_t i = 0; i < group->Size(); ++i) {
+      auto* loop = group->LoopAt(i);
+      auto  shard = std::make_shared<asio::ip::tcp::acceptor>(AsioService(loop));
+
+      auto ec = ListenOn(*shard, ip_v4, true);
+      SPIDERWEB_VERIFY(!ec, {
+        CloseShards();
+        return ec;
+      });
+      shards.emplace_back(loop, shard);
+    }
+
+    for (const auto& shard : shards) {
+      auto* loop = shard.first;
+      loop->QueueTask([this, self = shared_from_this(), shard]() {
+        StartShardAccept(shard.first, shard.second);
+      });
+    }
+    return Ok();
+  }
+
+  /**
+   * @brief shard acceptors are used in the threads of their loops, so close them there.
+   */
+  void CloseShards() {
+    for (const auto& shard : shards) {
+      shard.first->QueueTask([shard]() {
+        ErrorCode ec;
+        (void)shard.second->close(ec);
+      });
+    }
+    shards.clear();
+  }
+
+  ErrorCode ListenOn(asio::ip::tcp::acceptor& tcp_acceptor, std::string ip_v4, bool reuse_port) {
     asio::ip::address addr;
     if (ip_v4.empty() || ip_v4 == "0.0.0.0") {
       ip_v4 = "0.0.0.0";
@@ -42,20 +92,32 @@ class TcpServer::Private : public std::enable_shared_from_this<TcpServer::Privat
 
     asio::ip::tcp::endpoint endpoint(addr, port_);
 
-    auto e = acceptor.open(endpoint.protocol(), ec);
+    auto e = tcp_acceptor.open(endpoint.protocol(), ec);
     SPIDERWEB_VERIFY(!e, {
       spdlog::warn("TcpServer({}) {}", fmt::ptr(q), ec.message());
       return ec;
     });
-    acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+    tcp_acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true));
 
-    e = acceptor.bind(endpoint, ec);
+    if (reuse_port) {
+#if defined(SO_REUSEPORT)
+      e = tcp_acceptor.set_option(ReusePort(true), ec);
+#else
+      ec = InvalidArgument("SO_REUSEPORT not supported");
+#endif
+      SPIDERWEB_VERIFY(!ec, {
+        spdlog::warn("TcpServer({}) {}", fmt::ptr(q), ec.message());
+        return ec;
+      });
+    }
+
+    e = tcp_acceptor.bind(endpoint, ec);
     SPIDERWEB_VERIFY(!e, {
       spdlog::warn("TcpServer({}) {}", fmt::ptr(q), ec.message());
       return ec;
     });
 
-    e = acceptor.listen(asio::socket_base::max_listen_connections, ec);
+    e = tcp_acceptor.listen(asio::socket_base::max_listen_connections, ec);
     SPIDERWEB_VERIFY(!e, {
       spdlog::warn("TcpServer({}) {}", fmt::ptr(q), ec.message());
       return ec;
@@ -69,6 +131,11 @@ class TcpServer::Private : public std::enable_shared_from_this<TcpServer::Privat
       return;
     }
 
+    if (group) {
+      StartAcceptOn(tcp_acceptor, group->NextLoop());
+      return;
+    }
+
     auto* client = new TcpSocket(q);
     tcp_acceptor.async_accept(
         client->d->impl.socket,
@@ -91,9 +158,112 @@ class TcpServer::Private : public std::enable_shared_from_this<TcpServer::Privat
     spider_emit Object::Emit(q, &TcpServer::InComingConnection, std::forward<TcpSocket*>(client));
   }
 
+  /**
+   * @brief runs in the thread of `loop`, the accepted TcpSocket lives in the same loop.
+   */
+  void StartShardAccept(EventLoop* loop, const std::shared_ptr<asio::ip::tcp::acceptor>& shard) {
+    if (!shard->is_open()) {
+      return;
+    }
+
+    auto* client = new TcpSocket(static_cast<Object*>(loop));
+    client->d->stopped = false;
+    shard->async_accept(client->d->impl.socket, [this, self = shared_from_this(), loop, shard,
+                                                 client](const asio::error_code& ec) {
+      HandleShardAccept(loop, shard, client, ec);
+    });
+  }
+
+  void HandleShardAccept(EventLoop* loop, const std::shared_ptr<asio::ip::tcp::acceptor>& shard,
+                         TcpSocket* client, const asio::error_code& ec) {
+    if (ec) {
+      spdlog::warn("TcpServer({}) {}", fmt::ptr(this), ec.message());
+
+      client->DeleteLater();
+      return;
+    }
+    StartShardAccept(loop, shard);
+
+    EmitIncoming(loop, client);
+  }
+
+  /**
+   * @brief accept into a socket of `loop`, the TcpSocket object is then created in the thread of
+   *
+   * `loop`, so that all the io of the connection happens there.
+   */
+  template <typename Acceptor>
+  void StartAcceptOn(Acceptor& tcp_acceptor, EventLoop* loop) {
+    auto peer = std::make_shared<asio::ip::tcp::socket>(AsioService(loop));
+    tcp_acceptor.async_accept(*peer, [this, self = shared_from_this(), &tcp_acceptor, loop,
+                                 peer](const asio::error_code& ec) {
+      HandleAcceptOn(tcp_acceptor, loop, peer, ec);
+    });
+  }
+
+  template <typename Acceptor>
+  void HandleAcceptOn(Acceptor& tcp_acceptor, EventLoop* loop,
+                      const std::shared_ptr<asio::ip::tcp::socket>& peer,
+                      const asio::error_code& ec) {
+    if (ec) {
+      spdlog::warn("TcpServer({}) {}", fmt::ptr(q), ec.message());
+      return;
+    }
+    StartAccept(tcp_acceptor);
+
+    loop->QueueTask([this, self = shared_from_this(), loop, peer]() {
+      auto* client = new TcpSocket(static_cast<Object*>(loop));
+      client->d->stopped = false;
+      client->d->impl.socket = std::move(*peer);
+
+      EmitIncoming(loop, client);
+    });
+  }
+
+  /**
+   * @brief called in the thread of `loop`, where `client` lives. `q` is only touched in the
+   *
+   * thread of the server, so InComingConnection is emitted there. a connection accepted after
+   *
+   * the server has gone is deleted in its own loop.
+   *
+   * `client` starts reading only after the slots, back in its loop: the bytes read before would
+   *
+   * reach no slot, and the slots connect from another thread. the tasks they queue to `loop`
+   *
+   * run first.
+   */
+  void EmitIncoming(EventLoop* loop, TcpSocket* client) {
+    server_loop->QueueTask([this, self = shared_from_this(), loop, client]() mutable {
+      if (!q) {
+        loop->QueueTask([client]() { delete client; });
+        return;
+      }
+
+      std::weak_ptr<io::IoPrivate<TcpSocket::Private>> weak = client->d;
+      spider_emit Object::Emit(q, &TcpServer::InComingConnection, std::forward<TcpSocket*>(client));
+      loop->QueueTask([weak]() {
+        auto d = weak.lock();
+        if (d && d->impl.q && !d->stopped) {
+          d->StartRead(d->impl.socket);
+        }
+      });
+    });
+  }
+
+#if defined(SO_REUSEPORT)
+  using ReusePort = asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+  using Shard = std::pair<EventLoop*, std::shared_ptr<asio::ip::tcp::acceptor>>;
+
   TcpServer*              q = nullptr;
+  /// the loop of the server, where `q` is used
+  EventLoop*              server_loop = nullptr;
   uint16_t                port_;
   asio::ip::tcp::acceptor acceptor;
+  EventLoopGroup*         group = nullptr;
+  bool                    sharded = false;
+  std::vector<Shard>      shards;
 };
 
 }  // namespace net
@@ -1,13 +1,20 @@
 #ifndef SPIDERWEB_TCP_SOCKET_PRIVATE_H
 #define SPIDERWEB_TCP_SOCKET_PRIVATE_H
 
+#include <memory>
 #include <tuple>
+#include <vector>
 
 #include "asio.hpp"
 #include "core/internal/asio_cast.h"
 #include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/io/private/spiderweb_write_queue.h"
 #include "spiderweb/net/spiderweb_tcp_socket.h"
 
+#if defined(__linux__)
+#include "spiderweb/net/private/spiderweb_zero_copy_writer.h"
+#endif
+
 namespace spiderweb {
 namespace net {
 class TcpSocket::Private {
@@ -26,8 +33,46 @@ class TcpSocket::Private {
     stream.async_read_some(buffer, std::forward<Handler>(handler));
   }
 
-  template <typename AsyncStream, typename Handler>
-  void Write(AsyncStream& stream, const asio::mutable_buffers_1& buffers, Handler&& handler) {
+  /**
+   * @brief a non blocking read, used to drain the stream after a full read
+   */
+  template <typename AsyncStream>
+  std::size_t TryRead(AsyncStream& stream, const asio::mutable_buffers_1& buffer,
+                      asio::error_code& ec) {
+    if (!stream.non_blocking()) {
+      (void)stream.non_blocking(true, ec);
+      if (ec) {
+        return 0;
+      }
+    }
+    return stream.read_some(buffer, ec);
+  }
+
+  template <typename AsyncStream, typename ConstBufferSequence, typename Handler>
+  void Write(AsyncStream& stream, const ConstBufferSequence& buffers, Handler&& handler) {
+    asio::async_write(stream, buffers, asio::transfer_all(), std::forward<Handler>(handler));
+  }
+
+  /**
+   * @brief writes of at least zero_copy_threshold bytes are sent with MSG_ZEROCOPY, their chunks
+   *
+   * are then kept alive by the zero copy writer, after the send queue has consumed them.
+   */
+  template <typename ConstBufferSequence, typename Handler>
+  void Write(asio::ip::tcp::socket& stream, const ConstBufferSequence& buffers,
+             Handler&& handler) {
+#if defined(__linux__)
+    if (zero_copy_threshold > 0 && send_queue != nullptr &&
+        asio::buffer_size(buffers) >= zero_copy_threshold && EnableZeroCopy(stream)) {
+      std::vector<io::SharedSlice> owners;
+      send_queue->ShareOwners(&owners);
+      zero_copy->Write(stream,
+                       std::vector<asio::const_buffer>(asio::buffer_sequence_begin(buffers),
+                                                       asio::buffer_sequence_end(buffers)),
+                       std::move(owners), std::forward<Handler>(handler));
+      return;
+    }
+#endif
     asio::async_write(stream, buffers, asio::transfer_all(), std::forward<Handler>(handler));
   }
 
@@ -46,12 +91,25 @@ class TcpSocket::Private {
   template <typename AsyncStream>
   void Close(AsyncStream& stream) {
     stream.close();
+#if defined(__linux__)
+    if (zero_copy) {
+      zero_copy->Close();
+    }
+#endif
   }
 
   void Written(std::size_t size) {
     spider_emit q->BytesWritten(size);
   }
 
+  void WriteBufferFull(std::size_t size) {
+    spider_emit q->WriteBufferFull(size);
+  }
+
+  void WriteBufferDrained() {
+    spider_emit q->WriteBufferDrained();
+  }
+
   void Readden(const io::BufferReader& reader) {
     spider_emit q->BytesRead(reader);
   }
@@ -95,11 +153,39 @@ class TcpSocket::Private {
     }
   }
 
-  TcpSocket*            q = nullptr;
-  asio::ip::tcp::socket socket;
-  std::string           local_ip;
-  uint16_t              local_port = 0;
-  uint32_t              send_buffer_size = 0;
+#if defined(__linux__)
+  /**
+   * @brief SO_ZEROCOPY, turned off if the kernel does not support it
+   */
+  bool EnableZeroCopy(asio::ip::tcp::socket& stream) {
+    if (!zero_copy) {
+      zero_copy = std::make_unique<ZeroCopyWriter>(stream.get_executor());
+    }
+
+    std::error_code ec;
+    if (zero_copy->Enable(stream, ec)) {
+      return true;
+    }
+
+    zero_copy_threshold = 0;
+    const std::error_code& error = ec;
+    spider_emit Object::Emit(q, &TcpSocket::SetOptionError, error);
+    return false;
+  }
+#endif
+
+  TcpSocket*                      q = nullptr;
+  asio::ip::tcp::socket           socket;
+  std::string                     local_ip;
+  uint16_t                        local_port = 0;
+  uint32_t                        send_buffer_size = 0;
+  /// writes of at least this many bytes are sent with MSG_ZEROCOPY, 0 means off
+  std::size_t                     zero_copy_threshold = 0;
+  /// the send queue of the IoPrivate which owns this
+  io::WriteQueue*                 send_queue = nullptr;
+#if defined(__linux__)
+  std::unique_ptr<ZeroCopyWriter> zero_copy;
+#endif
 };
 }  // namespace net
 }  // namespace spiderweb
@@ -5,6 +5,7 @@
 #include "asio.hpp"
 #include "spdlog/spdlog.h"
 #include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_eventloop_group.h"
 #include "spiderweb/io/private/spiderweb_stream_private.h"
 #include "spiderweb/net/spiderweb_uds_server.h"
 #include "spiderweb/net/spiderweb_uds_socket.h"
@@ -15,7 +16,8 @@ namespace spiderweb {
 namespace net {
 class UdsServer::Private : public std::enable_shared_from_this<UdsServer::Private> {
  public:
-  explicit Private(UdsServer* qq) : q(qq), acceptor(AsioService(qq->ownerEventLoop())) {
+  explicit Private(UdsServer* qq)
+      : q(qq), server_loop(qq->ownerEventLoop()), acceptor(AsioService(qq->ownerEventLoop())) {
   }
 
   ~Private() = default;
@@ -25,7 +27,13 @@ class UdsServer::Private : public std::enable_shared_from_this<UdsServer::Privat
 
     asio::local::stream_protocol::endpoint endpoint(uds_address);
 
-    auto e = acceptor.open(endpoint.protocol(), ec);
+    asio::error_code e;
+    if (seqpacket) {
+      UdsSocket::Private::AssignSeqPacket(acceptor, e);
+      ec.SetErrorCode(e);
+    } else {
+      e = acceptor.open(endpoint.protocol(), ec);
+    }
     SPIDERWEB_VERIFY(!ec, {
       spdlog::warn("UdsServer({}) open {}", fmt::ptr(q), ec.message());
       return ec;
@@ -51,6 +59,11 @@ class UdsServer::Private : public std::enable_shared_from_this<UdsServer::Privat
       return;
     }
 
+    if (group) {
+      StartAcceptOn(uds_acceptor, group->NextLoop());
+      return;
+    }
+
     auto* client = new UdsSocket(q);
     uds_acceptor.async_accept(
         client->d->impl.socket,
@@ -69,12 +82,84 @@ class UdsServer::Private : public std::enable_shared_from_this<UdsServer::Privat
     }
     StartAccept(uds_acceptor);
 
+    if (seqpacket) {
+      client->SetSeqPacket(true, max_message_size);
+    }
     client->d->StartRead(client->d->impl.socket);
     spider_emit Object::Emit(q, &UdsServer::InComingConnection, std::forward<UdsSocket*>(client));
   }
 
+  /**
+   * @brief accept into a socket of `loop`, the UdsSocket object is then created in the thread of
+   *
+   * `loop`, so that all the io of the connection happens there.
+   */
+  template <typename Acceptor>
+  void StartAcceptOn(Acceptor& uds_acceptor, EventLoop* loop) {
+    auto peer = std::make_shared<asio::local::stream_protocol::socket>(AsioService(loop));
+    uds_acceptor.async_accept(*peer, [this, self = shared_from_this(), &uds_acceptor, loop,
+                                 peer](const asio::error_code& ec) {
+      HandleAcceptOn(uds_acceptor, loop, peer, ec);
+    });
+  }
+
+  template <typename Acceptor>
+  void HandleAcceptOn(Acceptor& uds_acceptor, EventLoop* loop,
+                      const std::shared_ptr<asio::local::stream_protocol::socket>& peer,
+                      const asio::error_code& ec) {
+    if (ec) {
+      spdlog::warn("UdsServer({}) {}", fmt::ptr(q), ec.message());
+      return;
+    }
+    StartAccept(uds_acceptor);
+
+    loop->QueueTask([this, self = shared_from_this(), loop, peer]() {
+      auto* client = new UdsSocket(static_cast<Object*>(loop));
+      client->d->stopped = false;
+      client->d->impl.socket = std::move(*peer);
+      if (seqpacket) {
+        client->SetSeqPacket(true, max_message_size);
+      }
+
+      EmitIncoming(loop, client);
+    });
+  }
+
+  /**
+   * @brief called in the thread of `loop`, where `client` lives. `q` is only touched in the
+   *
+   * thread of the server, so InComingConnection is emitted there. a connection accepted after
+   *
+   * the server has gone is deleted in its own loop.
+   *
+   * `client` starts reading only after the slots, back in its loop, as TcpServer does.
+   */
+  void EmitIncoming(EventLoop* loop, UdsSocket* client) {
+    server_loop->QueueTask([this, self = shared_from_this(), loop, client]() mutable {
+      if (!q) {
+        loop->QueueTask([client]() { delete client; });
+        return;
+      }
+
+      std::weak_ptr<io::IoPrivate<UdsSocket::Private>> weak = client->d;
+      spider_emit Object::Emit(q, &UdsServer::InComingConnection, std::forward<UdsSocket*>(client));
+      loop->QueueTask([weak]() {
+        auto d = weak.lock();
+        if (d && d->impl.q && !d->stopped) {
+          d->StartRead(d->impl.socket);
+        }
+      });
+    });
+  }
+
   UdsServer*                             q = nullptr;
+  /// the loop of the server, where `q` is used
+  EventLoop*                             server_loop = nullptr;
   asio::local::stream_protocol::acceptor acceptor;
+  EventLoopGroup*                        group = nullptr;
+  /// see UdsServer::SetSeqPacket
+  bool                                   seqpacket = false;
+  std::size_t                            max_message_size = UdsSocket::kDefaultMaxMessageSize;
 };
 
 }  // namespace net
@@ -1,10 +1,19 @@
 #pragma once
 
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
 #include <tuple>
+#include <vector>
 
 #include "asio.hpp"
 #include "core/internal/asio_cast.h"
 #include "spiderweb/core/spiderweb_eventloop.h"
+#include "spdlog/spdlog.h"
 #include "spiderweb/net/spiderweb_uds_socket.h"
 
 namespace spiderweb {
@@ -14,20 +23,94 @@ class UdsSocket::Private {
   explicit Private(UdsSocket* qq) : q(qq), socket(AsioService(qq->ownerEventLoop())) {
   }
 
+  ~Private() {
+    CloseFds();
+  }
+
+  /**
+   * @brief a seqpacket socket is created here, asio only knows stream ones. connect works the
+   *
+   * same on it.
+   */
   template <typename AsyncStream, typename Handler>
   void Open(AsyncStream& stream, const asio::local::stream_protocol::endpoint& endpoint,
             Handler&& handler) {
+    written = 0;
+    if (seqpacket) {
+      asio::error_code ec;
+      AssignSeqPacket(stream, ec);
+      if (ec) {
+        asio::post(stream.get_executor(),
+                   [handler = std::forward<Handler>(handler), ec]() mutable { handler(ec); });
+        return;
+      }
+    }
     stream.async_connect(endpoint, std::forward<Handler>(handler));
   }
 
+  /**
+   * @brief reads with recvmsg, so that the descriptors passed along with the bytes are received.
+   *
+   * the socket is read at once, and waited for only if it has nothing.
+   */
   template <typename AsyncStream, typename Handler>
   void Read(AsyncStream& stream, const asio::mutable_buffers_1& buffer, Handler&& handler) {
-    stream.async_read_some(buffer, std::forward<Handler>(handler));
+    asio::error_code ec;
+    const auto       n = Receive(stream, buffer, ec);
+    if (IsWouldBlock(ec)) {
+      WaitRead(stream, buffer, std::forward<Handler>(handler));
+      return;
+    }
+
+    asio::post(stream.get_executor(), [handler = std::forward<Handler>(handler), ec, n]() mutable {
+      handler(ec, n);
+    });
   }
 
-  template <typename AsyncStream, typename Handler>
-  void Write(AsyncStream& stream, const asio::mutable_buffers_1& buffers, Handler&& handler) {
-    asio::async_write(stream, buffers, asio::transfer_all(), std::forward<Handler>(handler));
+  /**
+   * @brief a non blocking read, used to drain the stream after a full read. a seqpacket socket is
+   *
+   * never drained, one read is one message.
+   */
+  template <typename AsyncStream>
+  std::size_t TryRead(AsyncStream& stream, const asio::mutable_buffers_1& buffer,
+                      asio::error_code& ec) {
+    if (seqpacket) {
+      ec = asio::error::would_block;
+      return 0;
+    }
+    return Receive(stream, buffer, ec);
+  }
+
+  /**
+   * @brief the bytes are written with asio, unless descriptors are to be passed or the socket is
+   *
+   * a seqpacket one, then sendmsg is used, see Send.
+   */
+  template <typename AsyncStream, typename ConstBufferSequence, typename Handler>
+  void Write(AsyncStream& stream, const ConstBufferSequence& buffers, Handler&& handler) {
+    auto counted = [this, handler = std::forward<Handler>(handler)](const asio::error_code& ec,
+                                                                    std::size_t n) mutable {
+      written += n;
+      handler(ec, n);
+    };
+
+    if (!seqpacket && fd_batches.empty()) {
+      asio::async_write(stream, buffers, asio::transfer_all(), std::move(counted));
+      return;
+    }
+
+    std::vector<asio::const_buffer> list(asio::buffer_sequence_begin(buffers),
+                                         asio::buffer_sequence_end(buffers));
+    asio::error_code                ec;
+    const auto                      n = Send(stream, list, ec);
+    if (IsWouldBlock(ec)) {
+      WaitWrite(stream, std::move(list), std::move(counted));
+      return;
+    }
+
+    asio::post(stream.get_executor(),
+               [counted = std::move(counted), ec, n]() mutable { counted(ec, n); });
   }
 
   void Error(const asio::error_code& ec) {
@@ -45,13 +128,40 @@ class UdsSocket::Private {
   template <typename AsyncStream>
   void Close(AsyncStream& stream) {
     stream.close();
+    CloseFds();
   }
 
   void Written(std::size_t size) {
     spider_emit q->BytesWritten(size);
   }
 
+  void WriteBufferFull(std::size_t size) {
+    spider_emit q->WriteBufferFull(size);
+  }
+
+  void WriteBufferDrained() {
+    spider_emit q->WriteBufferDrained();
+  }
+
   void Readden(const io::BufferReader& reader) {
+    if (fds_arrived) {
+      fds_arrived = false;
+      spider_emit q->FdsReceived(received_fds.size());
+    }
+
+    /**
+     * @brief one read is one message, and the messages before have been skipped, so the buffer
+     *
+     * holds it in one piece
+     */
+    if (seqpacket) {
+      const auto size = reader.Len();
+      if (size > 0) {
+        spider_emit q->MessageRead(reader.SpanAt(0, size));
+        reader.Skip(static_cast<uint32_t>(size));
+      }
+      return;
+    }
     spider_emit q->BytesRead(reader);
   }
 
@@ -71,9 +181,293 @@ class UdsSocket::Private {
     }
   }
 
+  /**
+   * @brief open `socket`(or an acceptor) as a seqpacket one
+   */
+  template <typename Socket>
+  static void AssignSeqPacket(Socket& socket, asio::error_code& ec) {
+    const int fd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      ec = asio::error_code(errno, asio::error::get_system_category());
+      return;
+    }
+
+    std::ignore = socket.assign(asio::local::stream_protocol(), fd, ec);
+    if (ec) {
+      ::close(fd);
+    }
+  }
+
+  /**
+   * @brief the most descriptors of one message, SCM_MAX_FD of linux
+   */
+  static constexpr std::size_t kMaxFds = 253;
+
+  /**
+   * @brief queue duplicates of `fds`, they are sent with the next byte queued after `queued` bytes
+   *
+   * which wait to be written, and closed then
+   */
+  asio::error_code QueueFds(const std::vector<int>& fds, std::size_t queued) {
+    FdBatch batch;
+    batch.offset = written + queued;
+    for (const int fd : fds) {
+      const int dup = ::fcntl(fd, F_DUPFD_CLOEXEC, 0);
+      if (dup < 0) {
+        const asio::error_code ec(errno, asio::error::get_system_category());
+        for (const int d : batch.fds) {
+          ::close(d);
+        }
+        return ec;
+      }
+      batch.fds.push_back(dup);
+    }
+    fd_batches.push_back(std::move(batch));
+    return asio::error_code();
+  }
+
+  std::vector<int> TakeReceivedFds() {
+    std::vector<int> fds(received_fds.begin(), received_fds.end());
+    received_fds.clear();
+    return fds;
+  }
+
+  void CloseFds() {
+    for (const int fd : received_fds) {
+      ::close(fd);
+    }
+    received_fds.clear();
+
+    for (const auto& batch : fd_batches) {
+      for (const int fd : batch.fds) {
+        ::close(fd);
+      }
+    }
+    fd_batches.clear();
+  }
+
   UdsSocket*                           q = nullptr;
   asio::local::stream_protocol::socket socket;
   uint32_t                             send_buffer_size = 0;
+  /// see UdsSocket::SetSeqPacket
+  bool                                 seqpacket = false;
+  std::size_t                          max_message_size = UdsSocket::kDefaultMaxMessageSize;
+  /// received and not taken by the user yet, see UdsSocket::TakeReceivedFds
+  std::deque<int>                      received_fds;
+  bool                                 fds_arrived = false;
+
+ private:
+  /**
+   * @brief the descriptors to send with the byte at `offset` of the stream
+   */
+  struct FdBatch {
+    uint64_t         offset = 0;
+    std::vector<int> fds;
+  };
+
+  static bool IsWouldBlock(const asio::error_code& ec) {
+    return ec == asio::error::would_block || ec == asio::error::try_again;
+  }
+
+  template <typename AsyncStream, typename Handler>
+  void WaitRead(AsyncStream& stream, const asio::mutable_buffers_1& buffer, Handler&& handler) {
+    stream.async_wait(asio::socket_base::wait_read,
+                      [this, &stream, buffer, handler = std::forward<Handler>(handler)](
+                          const asio::error_code& ec) mutable {
+                        if (ec) {
+                          handler(ec, 0);
+                          return;
+                        }
+
+                        asio::error_code read_ec;
+                        const auto       n = Receive(stream, buffer, read_ec);
+                        if (IsWouldBlock(read_ec)) {
+                          WaitRead(stream, buffer, std::move(handler));
+                          return;
+                        }
+                        handler(read_ec, n);
+                      });
+  }
+
+  template <typename AsyncStream, typename Handler>
+  void WaitWrite(AsyncStream& stream, std::vector<asio::const_buffer> list, Handler&& handler) {
+    stream.async_wait(asio::socket_base::wait_write,
+                      [this, &stream, list = std::move(list),
+                       handler = std::forward<Handler>(handler)](const asio::error_code& ec) mutable {
+                        if (ec) {
+                          handler(ec, 0);
+                          return;
+                        }
+
+                        asio::error_code send_ec;
+                        const auto       n = Send(stream, list, send_ec);
+                        if (IsWouldBlock(send_ec)) {
+                          WaitWrite(stream, std::move(list), std::move(handler));
+                          return;
+                        }
+                        handler(send_ec, n);
+                      });
+  }
+
+  /**
+   * @brief one recvmsg, the descriptors which come with the bytes are queued to received_fds. a
+   *
+   * message longer than max_message_size fails with message_size, it is lost anyway.
+   */
+  template <typename AsyncStream>
+  std::size_t Receive(AsyncStream& stream, const asio::mutable_buffers_1& buffer,
+                      asio::error_code& ec) {
+    const auto size = seqpacket ? std::min(buffer.size(), max_message_size) : buffer.size();
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxFds)];
+    iovec                 iov{buffer.data(), size};
+    msghdr                msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t n = 0;
+    do {
+      n = ::recvmsg(stream.native_handle(), &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+      ec = asio::error_code(errno, asio::error::get_system_category());
+      return 0;
+    }
+
+    for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+      if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+        continue;
+      }
+
+      const auto count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+      for (std::size_t i = 0; i < count; ++i) {
+        int fd = -1;
+        std::memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+        received_fds.push_back(fd);
+      }
+      fds_arrived = fds_arrived || count > 0;
+    }
+    if (msg.msg_flags & MSG_CTRUNC) {
+      spdlog::warn("UdsSocket({}) more than {} fds in one message, the rest are closed",
+                   fmt::ptr(q), kMaxFds);
+    }
+
+    if (seqpacket && (msg.msg_flags & MSG_TRUNC)) {
+      ec = asio::error::message_size;
+      return 0;
+    }
+    if (n == 0) {
+      ec = asio::error::eof;
+      return 0;
+    }
+    return static_cast<std::size_t>(n);
+  }
+
+  /**
+   * @brief write `list` with sendmsg, without blocking, as far as it goes. the descriptors of a
+   *
+   * batch are sent with its first byte, a write stops before the byte of the next batch.
+   *
+   * on a seqpacket socket every buffer is one message, sent by its own sendmsg.
+   *
+   * @return the bytes sent, would_block only if none
+   */
+  template <typename AsyncStream>
+  std::size_t Send(AsyncStream& stream, const std::vector<asio::const_buffer>& list,
+                   asio::error_code& ec) {
+    std::size_t sent = 0;
+    std::size_t index = 0;
+    while (index < list.size()) {
+      const uint64_t offset = written + sent;
+      const bool     attach = !fd_batches.empty() && fd_batches.front().offset == offset;
+
+      uint64_t limit = UINT64_MAX;
+      if (seqpacket) {
+        limit = list[index].size();
+      } else if (!fd_batches.empty()) {
+        const auto next = attach ? (fd_batches.size() > 1 ? fd_batches[1].offset : UINT64_MAX)
+                                 : fd_batches.front().offset;
+        limit = next - offset;
+      }
+
+      iovec       iov[io::WriteQueue::kMaxBuffers];
+      std::size_t iov_count = 0;
+      for (std::size_t i = index; i < list.size() && limit > 0; ++i) {
+        const auto size = static_cast<std::size_t>(std::min<uint64_t>(list[i].size(), limit));
+        iov[iov_count].iov_base = const_cast<void*>(list[i].data());
+        iov[iov_count].iov_len = size;
+        ++iov_count;
+        limit -= size;
+        if (iov_count == io::WriteQueue::kMaxBuffers) {
+          break;
+        }
+      }
+
+      const auto n = SendMsg(stream.native_handle(), iov, iov_count,
+                             attach ? &fd_batches.front().fds : nullptr, ec);
+      if (ec) {
+        break;
+      }
+      if (attach) {
+        for (const int fd : fd_batches.front().fds) {
+          ::close(fd);
+        }
+        fd_batches.pop_front();
+      }
+
+      sent += n;
+      std::size_t left = n;
+      while (index < list.size() && left >= list[index].size()) {
+        left -= list[index].size();
+        ++index;
+      }
+      if (left > 0 || !seqpacket) {
+        break;
+      }
+    }
+
+    /**
+     * @brief an error after some bytes is reported by the next write
+     */
+    if (sent > 0) {
+      ec = asio::error_code();
+    }
+    return sent;
+  }
+
+  std::size_t SendMsg(int fd, iovec* iov, std::size_t iov_count, const std::vector<int>* fds,
+                      asio::error_code& ec) {
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxFds)];
+    msghdr                msg{};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iov_count;
+    if (fds && !fds->empty()) {
+      const auto count = std::min(fds->size(), kMaxFds);
+      msg.msg_control = control;
+      msg.msg_controllen = CMSG_SPACE(sizeof(int) * count);
+
+      auto* cmsg = CMSG_FIRSTHDR(&msg);
+      cmsg->cmsg_level = SOL_SOCKET;
+      cmsg->cmsg_type = SCM_RIGHTS;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(int) * count);
+      std::memcpy(CMSG_DATA(cmsg), fds->data(), sizeof(int) * count);
+    }
+
+    ssize_t n = 0;
+    do {
+      n = ::sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+      ec = asio::error_code(errno, asio::error::get_system_category());
+      return 0;
+    }
+    return static_cast<std::size_t>(n);
+  }
+
+  /// bytes written since connected, the offsets of fd_batches count from there
+  uint64_t            written = 0;
+  std::deque<FdBatch> fd_batches;
 };
 }  // namespace net
 }  // namespace spiderweb
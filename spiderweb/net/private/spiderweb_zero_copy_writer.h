@@ -0,0 +1,361 @@
+#ifndef SPIDERWEB_ZERO_COPY_WRITER_H
+#define SPIDERWEB_ZERO_COPY_WRITER_H
+
+// linux/errqueue.h uses timespec without including it
+#include <time.h>
+
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "asio.hpp"
+#include "spiderweb/io/spiderweb_shared_slice.h"
+
+#if !defined(SO_ZEROCOPY)
+#define SO_ZEROCOPY 60
+#endif
+
+#if !defined(MSG_ZEROCOPY)
+#define MSG_ZEROCOPY 0x4000000
+#endif
+
+#if !defined(SO_EE_ORIGIN_ZEROCOPY)
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+
+namespace spiderweb {
+namespace net {
+
+/**
+ * @brief the writes of a tcp socket, sent with MSG_ZEROCOPY(linux 4.14).
+ *
+ * the kernel sends from the pages of the caller instead of copying them, so the bytes of a write
+ *
+ * are kept alive by their owners until the kernel reports all of its sends done, by notifications
+ *
+ * on the error queue of the socket.
+ *
+ * the error queue is read from a dup of the socket, which is only waited for errors, so the reads
+ *
+ * of the socket itself are not disturbed by it. a write completes, as asio::async_write, when all
+ *
+ * of its bytes are sent.
+ */
+class ZeroCopyWriter {
+ public:
+  explicit ZeroCopyWriter(const asio::ip::tcp::socket::executor_type& executor)
+      : executor_(executor), state_(std::make_shared<State>(executor)) {
+  }
+
+  ~ZeroCopyWriter() {
+    Drain(state_);
+  }
+
+  ZeroCopyWriter(const ZeroCopyWriter&) = delete;
+
+  ZeroCopyWriter& operator=(const ZeroCopyWriter&) = delete;
+
+  /**
+   * @brief set SO_ZEROCOPY on `socket`, once per connection
+   */
+  bool Enable(asio::ip::tcp::socket& socket, asio::error_code& ec) {
+    if (state_->errors.is_open()) {
+      return true;
+    }
+
+    const int one = 1;
+    if (::setsockopt(socket.native_handle(), SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) != 0) {
+      ec = asio::error_code(errno, asio::error::get_system_category());
+      return false;
+    }
+
+    const int fd = ::dup(socket.native_handle());
+    if (fd < 0) {
+      ec = asio::error_code(errno, asio::error::get_system_category());
+      return false;
+    }
+
+    (void)state_->errors.assign(fd, ec);
+    if (ec) {
+      ::close(fd);
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * @brief `owners` keep the bytes of `buffers` alive, until the kernel is done with them
+   */
+  template <typename Handler>
+  void Write(asio::ip::tcp::socket& socket, std::vector<asio::const_buffer> buffers,
+             std::vector<io::SharedSlice> owners, Handler&& handler) {
+    state_->buffers = std::move(buffers);
+    state_->sending = true;
+    state_->writes.emplace_back();
+    state_->writes.back().first = state_->next_seq;
+    state_->writes.back().owners = std::move(owners);
+
+    Send(state_, socket, 0, std::forward<Handler>(handler));
+  }
+
+  /**
+   * @brief writes whose bytes are still held, because the kernel is not done with them
+   */
+  std::size_t PendingWrites() const {
+    return state_->writes.size();
+  }
+
+  /**
+   * @brief sends reported done by the kernel so far
+   */
+  uint64_t CompletedSends() const {
+    return state_->completed;
+  }
+
+  /**
+   * @brief the writes in flight are left to drain: their owners are kept until the kernel reports
+   *
+   * them done, the socket is shut down meanwhile, so the dup does not keep the connection open.
+   *
+   * the writer can then be enabled on a new connection.
+   */
+  void Close() {
+    auto state = std::move(state_);
+    state_ = std::make_shared<State>(executor_);
+    Drain(state);
+  }
+
+  /**
+   * @brief the number of the sends [first, first + sends) in the notification of the sends
+   *
+   * [lo, hi], the sequence numbers of the kernel are 32 bits, and wrap around.
+   */
+  static uint32_t DoneSends(uint32_t first, uint32_t sends, uint32_t lo, uint32_t hi) {
+    const uint64_t kWrap = uint64_t(1) << 32;
+    const uint32_t offset = lo - first;
+    const uint64_t count = uint64_t(uint32_t(hi - lo)) + 1;
+
+    if (offset < sends) {
+      return static_cast<uint32_t>(std::min<uint64_t>(sends - offset, count));
+    }
+    /**
+     * @brief the notification starts before the write
+     */
+    if (offset + count > kWrap) {
+      return static_cast<uint32_t>(std::min<uint64_t>(offset + count - kWrap, sends));
+    }
+    return 0;
+  }
+
+ private:
+  struct PendingWrite {
+    /// the sequence number of the first send of the write, the kernel counts the sends
+    uint32_t                     first = 0;
+    uint32_t                     sends = 0;
+    /// sends not reported done yet
+    uint32_t                     remaining = 0;
+    bool                         finished = false;
+    std::vector<io::SharedSlice> owners;
+  };
+
+  struct State {
+    explicit State(const asio::ip::tcp::socket::executor_type& executor) : errors(executor) {
+    }
+
+    /// the dup of the socket, waited for the notifications
+    asio::posix::stream_descriptor  errors;
+    /// what is left of the write in progress
+    std::vector<asio::const_buffer> buffers;
+    std::deque<PendingWrite>        writes;
+    uint32_t                        next_seq = 0;
+    uint64_t                        completed = 0;
+    bool                            waiting = false;
+    /// a send of the last write is in progress
+    bool                            sending = false;
+    /// closed by the user, only waits for the notifications of the writes left
+    bool                            closing = false;
+  };
+
+  static void Drain(const std::shared_ptr<State>& state) {
+    state->closing = true;
+    for (std::size_t i = 0; i < state->writes.size(); ++i) {
+      if (!(state->sending && i + 1 == state->writes.size())) {
+        state->writes[i].finished = true;
+      }
+    }
+
+    if (state->errors.is_open() && !state->writes.empty()) {
+      ::shutdown(state->errors.native_handle(), SHUT_RDWR);
+    }
+    Poll(state);
+  }
+
+  template <typename Handler>
+  static void Send(const std::shared_ptr<State>& state, asio::ip::tcp::socket& socket,
+                   std::size_t written, Handler&& handler) {
+    socket.async_send(
+        state->buffers, MSG_ZEROCOPY,
+        [state, &socket, written, handler = std::forward<Handler>(handler)](
+            const asio::error_code& ec, std::size_t n) mutable {
+          state->sending = false;
+          auto& write = state->writes.back();
+
+          /**
+           * @brief closed meanwhile, the send may still have been made, its pages are then kept
+           *
+           * until it is reported done
+           */
+          if (state->closing) {
+            if (!ec && n > 0) {
+              ++state->next_seq;
+              ++write.sends;
+              ++write.remaining;
+            }
+            write.finished = true;
+            Poll(state);
+            handler(ec ? ec : asio::error::operation_aborted, written);
+            return;
+          }
+
+          /**
+           * @brief too many notifications are not read yet(optmem_max), copy the rest
+           */
+          if (ec == asio::error::no_buffer_space) {
+            write.finished = true;
+            asio::async_write(socket, state->buffers, asio::transfer_all(),
+                              [written, handler = std::move(handler)](
+                                  const asio::error_code& e, std::size_t size) mutable {
+                                handler(e, written + size);
+                              });
+            return;
+          }
+
+          if (ec) {
+            write.finished = true;
+            handler(ec, written);
+            return;
+          }
+
+          ++state->next_seq;
+          ++write.sends;
+          ++write.remaining;
+          Consume(&state->buffers, n);
+          if (!state->buffers.empty()) {
+            state->sending = true;
+            Send(state, socket, written + n, std::move(handler));
+            return;
+          }
+
+          write.finished = true;
+          Poll(state);
+          handler(ec, written + n);
+        });
+  }
+
+  static void Consume(std::vector<asio::const_buffer>* buffers, std::size_t n) {
+    auto it = buffers->begin();
+    while (it != buffers->end() && n >= it->size()) {
+      n -= it->size();
+      ++it;
+    }
+    buffers->erase(buffers->begin(), it);
+    if (n > 0) {
+      buffers->front() += n;
+    }
+  }
+
+  /**
+   * @brief wait before reading the error queue, so that a notification which comes after the
+   *
+   * read wakes the wait.
+   */
+  static void Poll(const std::shared_ptr<State>& state) {
+    Wait(state);
+    Reap(state);
+  }
+
+  static void Wait(const std::shared_ptr<State>& state) {
+    if (state->waiting || state->writes.empty() || !state->errors.is_open()) {
+      return;
+    }
+
+    state->waiting = true;
+    state->errors.async_wait(asio::posix::descriptor_base::wait_error,
+                             [state](const asio::error_code& ec) {
+                               if (ec == asio::error::operation_aborted) {
+                                 return;
+                               }
+
+                               state->waiting = false;
+                               if (!ec && state->errors.is_open()) {
+                                 Poll(state);
+                               }
+                             });
+  }
+
+  static void Reap(const std::shared_ptr<State>& state) {
+    for (;;) {
+      char   control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+      msghdr msg{};
+      msg.msg_control = control;
+      msg.msg_controllen = sizeof(control);
+      if (::recvmsg(state->errors.native_handle(), &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+        break;
+      }
+
+      for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+            !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)) {
+          continue;
+        }
+
+        sock_extended_err err;
+        std::memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+        if (err.ee_errno == 0 && err.ee_origin == SO_EE_ORIGIN_ZEROCOPY) {
+          Complete(state.get(), err.ee_info, err.ee_data);
+        }
+      }
+    }
+
+    auto& writes = state->writes;
+    writes.erase(std::remove_if(writes.begin(), writes.end(),
+                                [](const PendingWrite& write) {
+                                  return write.finished && write.remaining == 0;
+                                }),
+                 writes.end());
+
+    if (state->closing && writes.empty()) {
+      asio::error_code ec;
+      (void)state->errors.close(ec);
+    }
+  }
+
+  /**
+   * @brief the sends [lo, hi] are done
+   */
+  static void Complete(State* state, uint32_t lo, uint32_t hi) {
+    for (auto& write : state->writes) {
+      const auto done = std::min(DoneSends(write.first, write.sends, lo, hi), write.remaining);
+      write.remaining -= done;
+      state->completed += done;
+    }
+  }
+
+  asio::ip::tcp::socket::executor_type executor_;
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace net
+}  // namespace spiderweb
+
+#endif
@@ -0,0 +1,637 @@
+#include "spiderweb/net/spiderweb_tcp_connection_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "spiderweb/core/internal/thread_check.h"
+#include "spiderweb/core/spiderweb_error_code.h"
+#include "spiderweb/core/spiderweb_timer.h"
+
+namespace spiderweb {
+namespace net {
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+std::string KeyOf(const std::vector<EndPoint>& addresses) {
+  std::string key;
+  for (const auto& address : addresses) {
+    key += address.String();
+    key += ',';
+  }
+  return key;
+}
+}  // namespace
+
+class TcpConnectionPool::Private {
+ public:
+  struct Idle {
+    TcpSocket*              socket = nullptr;
+    Clock::time_point       since;
+    /// the health check slots, disconnected when leased
+    std::vector<Connection> watches;
+  };
+
+  struct Waiter {
+    LeaseHandler      handler;
+    Clock::time_point deadline;
+  };
+
+  struct Racer {
+    TcpSocket*              socket = nullptr;
+    std::size_t             address = 0;
+    std::vector<Connection> slots;
+  };
+
+  /**
+   * @brief one connection being established, its addresses raced
+   */
+  struct Attempt {
+    /// indexes of the addresses, in the order they are tried
+    std::vector<std::size_t> order;
+    std::size_t              next = 0;
+    std::vector<Racer>       racers;
+    Clock::time_point        next_start;
+    Clock::time_point        deadline;
+    std::error_code          error;
+  };
+
+  struct Host {
+    std::vector<EndPoint>                 addresses;
+    /// the address which won last
+    std::size_t                           preferred = 0;
+    std::deque<Idle>                      idle;
+    std::size_t                           leased = 0;
+    std::vector<std::unique_ptr<Attempt>> attempts;
+    std::deque<Waiter>                    waiters;
+    uint32_t                              failures = 0;
+    Clock::time_point                     retry_at;
+    std::error_code                       error;
+  };
+
+  /**
+   * @brief a lease handler to call once the state of the pool is consistent again
+   */
+  struct Ready {
+    LeaseHandler    handler;
+    std::error_code ec;
+    TcpSocket*      socket = nullptr;
+  };
+
+  explicit Private(TcpConnectionPool* qq) : q(qq), timer(absl::make_unique<Timer>(qq)) {
+    timer->SetSingalShot(true);
+    Object::Connect(timer.get(), &Timer::timeout, qq, [this]() {
+      Tick();
+      Flush();
+    });
+  }
+
+  Host* HostOf(const std::vector<EndPoint>& addresses) {
+    auto& host = hosts[KeyOf(addresses)];
+    if (!host) {
+      host.reset(new Host());
+      host->addresses = addresses;
+    }
+    return host.get();
+  }
+
+  Host* FindHost(const std::vector<EndPoint>& addresses) const {
+    auto it = hosts.find(KeyOf(addresses));
+    return it == hosts.end() ? nullptr : it->second.get();
+  }
+
+  void Lease(Host* host, LeaseHandler handler) {
+    const auto now = Clock::now();
+    if (auto* socket = TakeIdle(host)) {
+      ++host->leased;
+      ready.push_back({std::move(handler), std::error_code(), socket});
+    } else if (InBackoff(host, now)) {
+      ready.push_back({std::move(handler), host->error, nullptr});
+    } else {
+      host->waiters.push_back({std::move(handler), now + Ms(options.lease_timeout_ms)});
+    }
+    Refill(host, now);
+  }
+
+  void Return(TcpSocket* socket) {
+    auto it = owners.find(socket);
+    if (it == owners.end()) {
+      return;
+    }
+
+    auto* host = it->second;
+    --host->leased;
+    if (socket->IsClosed() || socket->ReadBufferSize() > 0 || socket->WriteBufferSize() > 0) {
+      Drop(socket);
+    } else {
+      Offer(host, socket, Clock::now());
+    }
+    Refill(host, Clock::now());
+  }
+
+  /**
+   * @brief a connection which is free, to the first waiter, or idle
+   */
+  void Offer(Host* host, TcpSocket* socket, Clock::time_point now) {
+    if (!host->waiters.empty()) {
+      ++host->leased;
+      ready.push_back({std::move(host->waiters.front().handler), std::error_code(), socket});
+      host->waiters.pop_front();
+      return;
+    }
+
+    if (host->idle.size() >= options.max_idle) {
+      Drop(socket);
+      return;
+    }
+
+    Idle idle;
+    idle.socket = socket;
+    idle.since = now;
+    idle.watches.push_back(Object::Connect(socket, &TcpSocket::Error, socket,
+                                           [this, host, socket](const std::error_code&) {
+                                             Unhealthy(host, socket);
+                                           }));
+    idle.watches.push_back(Object::Connect(socket, &TcpSocket::BytesRead, socket,
+                                           [this, host, socket](const io::BufferReader&) {
+                                             Unhealthy(host, socket);
+                                           }));
+    host->idle.push_back(std::move(idle));
+  }
+
+  /**
+   * @brief an idle connection ended, failed, or received what nobody asked for
+   */
+  void Unhealthy(Host* host, TcpSocket* socket) {
+    auto it = std::find_if(host->idle.begin(), host->idle.end(),
+                           [socket](const Idle& idle) { return idle.socket == socket; });
+    if (it == host->idle.end()) {
+      return;
+    }
+
+    Unwatch(&*it);
+    host->idle.erase(it);
+    Drop(socket);
+    Refill(host, Clock::now());
+    Arm();
+  }
+
+  /**
+   * @brief the most recently returned, the ones idle the longest are left to be evicted
+   */
+  TcpSocket* TakeIdle(Host* host) {
+    while (!host->idle.empty()) {
+      auto idle = std::move(host->idle.back());
+      host->idle.pop_back();
+      Unwatch(&idle);
+      if (!idle.socket->IsClosed()) {
+        return idle.socket;
+      }
+      Drop(idle.socket);
+    }
+    return nullptr;
+  }
+
+  /**
+   * @brief connect for the waiters and min_idle, unless backing off
+   */
+  void Refill(Host* host, Clock::time_point now) {
+    if (InBackoff(host, now)) {
+      return;
+    }
+
+    const std::size_t idle = host->idle.size();
+    const std::size_t want =
+        host->waiters.size() + (options.min_idle > idle ? options.min_idle - idle : 0);
+    while (host->attempts.size() < want &&
+           (options.max_connections == 0 || Total(host) < options.max_connections)) {
+      StartAttempt(host, now);
+    }
+  }
+
+  std::size_t Total(const Host* host) const {
+    return host->idle.size() + host->leased + host->attempts.size();
+  }
+
+  bool InBackoff(const Host* host, Clock::time_point now) const {
+    return host->failures > 0 && now < host->retry_at;
+  }
+
+  /**
+   * @brief the preferred address first, then the families alternated, as rfc 8305 says
+   */
+  std::vector<std::size_t> Order(const Host* host) const {
+    const auto&              addresses = host->addresses;
+    const bool               v6 = addresses[host->preferred].IsIpv6();
+    std::deque<std::size_t>  same;
+    std::deque<std::size_t>  other;
+    std::vector<std::size_t> order{host->preferred};
+    for (std::size_t i = 0; i < addresses.size(); ++i) {
+      if (i != host->preferred) {
+        (addresses[i].IsIpv6() == v6 ? same : other).push_back(i);
+      }
+    }
+
+    bool take_other = true;
+    while (!same.empty() || !other.empty()) {
+      auto& from = (take_other && !other.empty()) || same.empty() ? other : same;
+      order.push_back(from.front());
+      from.pop_front();
+      take_other = !take_other;
+    }
+    return order;
+  }
+
+  void StartAttempt(Host* host, Clock::time_point now) {
+    std::unique_ptr<Attempt> attempt(new Attempt());
+    attempt->order = Order(host);
+    attempt->deadline = now + Ms(options.connect_timeout_ms);
+
+    auto* raw = attempt.get();
+    host->attempts.push_back(std::move(attempt));
+    StartNext(host, raw, now);
+  }
+
+  /**
+   * @brief race the next address
+   */
+  bool StartNext(Host* host, Attempt* attempt, Clock::time_point now) {
+    if (attempt->next >= attempt->order.size()) {
+      return false;
+    }
+
+    Racer racer;
+    racer.address = attempt->order[attempt->next++];
+    racer.socket = new TcpSocket(q);
+    auto* socket = racer.socket;
+    racer.slots.push_back(Object::Connect(socket, &TcpSocket::ConnectionEstablished, socket,
+                                          [this, host, attempt, socket]() {
+                                            Won(host, attempt, socket);
+                                            Arm();
+                                            Flush();
+                                          }));
+    racer.slots.push_back(
+        Object::Connect(socket, &TcpSocket::ConnectError, socket,
+                        [this, host, attempt, socket](const std::error_code& ec) {
+                          Lost(host, attempt, socket, ec);
+                          Arm();
+                          Flush();
+                        }));
+    attempt->racers.push_back(std::move(racer));
+    attempt->next_start = now + Ms(options.happy_eyeballs_delay_ms);
+
+    const auto& address = host->addresses[attempt->racers.back().address];
+    if (!options.local_ip.empty()) {
+      socket->Bind(options.local_ip, 0);
+    }
+    socket->ConnectToHost(address.IpString(), address.Port());
+    return true;
+  }
+
+  void Won(Host* host, Attempt* attempt, TcpSocket* socket) {
+    for (auto& racer : attempt->racers) {
+      Unwatch(&racer.slots);
+      if (racer.socket == socket) {
+        host->preferred = racer.address;
+      } else {
+        Drop(racer.socket);
+      }
+    }
+    RemoveAttempt(host, attempt);
+
+    host->failures = 0;
+    host->error = std::error_code();
+    owners[socket] = host;
+    if (options.no_delay) {
+      socket->SetNoDelay(true);
+    }
+    Offer(host, socket, Clock::now());
+  }
+
+  void Lost(Host* host, Attempt* attempt, TcpSocket* socket, const std::error_code& ec) {
+    auto it = std::find_if(attempt->racers.begin(), attempt->racers.end(),
+                           [socket](const Racer& racer) { return racer.socket == socket; });
+    if (it == attempt->racers.end()) {
+      return;
+    }
+
+    spider_emit q->ConnectError(host->addresses[it->address], ec);
+    Unwatch(&it->slots);
+    Drop(socket);
+    attempt->racers.erase(it);
+    attempt->error = ec;
+
+    const auto now = Clock::now();
+    if (!StartNext(host, attempt, now) && attempt->racers.empty()) {
+      Failed(host, attempt, now);
+    }
+  }
+
+  /**
+   * @brief every address failed, or the deadline passed
+   */
+  void Failed(Host* host, Attempt* attempt, Clock::time_point now) {
+    for (auto& racer : attempt->racers) {
+      Unwatch(&racer.slots);
+      Drop(racer.socket);
+    }
+    const auto ec = attempt->error ? attempt->error : std::error_code(Timeout("connect timeout"));
+    RemoveAttempt(host, attempt);
+
+    host->error = ec;
+    const uint64_t backoff = std::min<uint64_t>(
+        uint64_t(options.backoff_initial_ms) << std::min<uint32_t>(host->failures, 20),
+        options.backoff_max_ms);
+    ++host->failures;
+    host->retry_at = now + Ms(backoff);
+
+    /**
+     * @brief the waiters beyond the attempts left fail now, not after the backoff
+     */
+    while (host->waiters.size() > host->attempts.size()) {
+      ready.push_back({std::move(host->waiters.back().handler), ec, nullptr});
+      host->waiters.pop_back();
+    }
+  }
+
+  void RemoveAttempt(Host* host, Attempt* attempt) {
+    auto& attempts = host->attempts;
+    attempts.erase(std::remove_if(attempts.begin(), attempts.end(),
+                                  [attempt](const std::unique_ptr<Attempt>& a) {
+                                    return a.get() == attempt;
+                                  }),
+                   attempts.end());
+  }
+
+  /**
+   * @brief run what is due: the next racer of an attempt, attempts and leases out of time, idle
+   *
+   * connections to evict, and the reconnects after a backoff.
+   */
+  void Tick() {
+    const auto now = Clock::now();
+    for (auto& entry : hosts) {
+      auto* host = entry.second.get();
+
+      const auto attempts = Attempts(host);
+      for (auto* attempt : attempts) {
+        if (now >= attempt->deadline) {
+          Failed(host, attempt, now);
+        } else if (now >= attempt->next_start) {
+          StartNext(host, attempt, now);
+        }
+      }
+
+      while (!host->waiters.empty() && now >= host->waiters.front().deadline) {
+        ready.push_back({std::move(host->waiters.front().handler),
+                         std::error_code(Timeout("lease timeout")), nullptr});
+        host->waiters.pop_front();
+      }
+
+      while (host->idle.size() > options.min_idle &&
+             now >= host->idle.front().since + Ms(options.idle_timeout_ms)) {
+        Unwatch(&host->idle.front());
+        Drop(host->idle.front().socket);
+        host->idle.pop_front();
+      }
+
+      Refill(host, now);
+    }
+    Arm();
+  }
+
+  std::vector<Attempt*> Attempts(const Host* host) const {
+    std::vector<Attempt*> attempts;
+    for (const auto& attempt : host->attempts) {
+      attempts.push_back(attempt.get());
+    }
+    return attempts;
+  }
+
+  /**
+   * @brief the single timer of the pool is set to the nearest deadline
+   */
+  void Arm() {
+    bool              armed = false;
+    Clock::time_point next;
+    auto              at = [&](Clock::time_point t) {
+      if (!armed || t < next) {
+        next = t;
+        armed = true;
+      }
+    };
+
+    for (const auto& entry : hosts) {
+      const auto* host = entry.second.get();
+      for (const auto& attempt : host->attempts) {
+        at(attempt->deadline);
+        if (attempt->next < attempt->order.size()) {
+          at(attempt->next_start);
+        }
+      }
+      if (!host->waiters.empty()) {
+        at(host->waiters.front().deadline);
+      }
+      if (host->idle.size() > options.min_idle) {
+        at(host->idle.front().since + Ms(options.idle_timeout_ms));
+      }
+      if (host->failures > 0 && (!host->waiters.empty() || host->idle.size() < options.min_idle)) {
+        at(host->retry_at);
+      }
+    }
+
+    if (!armed) {
+      timer->Stop();
+      return;
+    }
+
+    const auto delay =
+        std::chrono::duration_cast<std::chrono::milliseconds>(next - Clock::now()).count();
+    timer->Reset(static_cast<uint64_t>(std::max<int64_t>(delay, 0)));
+  }
+
+  void Flush() {
+    while (!ready.empty()) {
+      auto calls = std::move(ready);
+      ready.clear();
+      for (auto& call : calls) {
+        call.handler(call.ec, call.socket);
+      }
+    }
+  }
+
+  /**
+   * @brief the pool is destroyed: the leases not served yet fail with Canceled, a connection
+   *
+   * which was about to be handed out is closed with the pool instead.
+   */
+  void Cancel() {
+    destroyed = true;
+    auto calls = std::move(ready);
+    ready.clear();
+    for (auto& call : calls) {
+      call.handler(std::error_code(Canceled()), nullptr);
+    }
+  }
+
+  void Clear() {
+    for (auto& entry : hosts) {
+      auto* host = entry.second.get();
+      for (auto& attempt : host->attempts) {
+        for (auto& racer : attempt->racers) {
+          Unwatch(&racer.slots);
+          Drop(racer.socket);
+        }
+      }
+      host->attempts.clear();
+
+      for (auto& idle : host->idle) {
+        Unwatch(&idle);
+        Drop(idle.socket);
+      }
+      host->idle.clear();
+
+      for (auto& waiter : host->waiters) {
+        ready.push_back({std::move(waiter.handler), std::error_code(Canceled()), nullptr});
+      }
+      host->waiters.clear();
+    }
+
+    /**
+     * @brief leased connections are dropped when returned, their hosts are kept for them
+     */
+    for (auto it = hosts.begin(); it != hosts.end();) {
+      if (it->second->leased == 0) {
+        it = hosts.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    timer->Stop();
+  }
+
+  /**
+   * @brief the leased connections can not be returned to a destroyed pool
+   */
+  void DropLeased() {
+    auto leased = std::move(owners);
+    owners.clear();
+    for (auto& entry : leased) {
+      entry.first->DisConnectFromHost();
+      entry.first->DeleteLater();
+    }
+  }
+
+  void Drop(TcpSocket* socket) {
+    owners.erase(socket);
+    socket->DisConnectFromHost();
+    socket->DeleteLater();
+  }
+
+  static void Unwatch(Idle* idle) {
+    Unwatch(&idle->watches);
+  }
+
+  static void Unwatch(std::vector<Connection>* slots) {
+    for (auto& slot : *slots) {
+      slot.Disconnect();
+    }
+    slots->clear();
+  }
+
+  static Clock::duration Ms(uint64_t ms) {
+    return std::chrono::milliseconds(ms);
+  }
+
+  TcpConnectionPool*                           q = nullptr;
+  Options                                      options;
+  std::unique_ptr<Timer>                       timer;
+  std::map<std::string, std::unique_ptr<Host>> hosts;
+  /// the host of the connected sockets, idle or leased
+  std::unordered_map<TcpSocket*, Host*>        owners;
+  std::vector<Ready>                           ready;
+  /// see Cancel, the leases asked for meanwhile fail at once
+  bool                                         destroyed = false;
+};
+
+TcpConnectionPool::TcpConnectionPool(Object* parent)
+    : Object(parent), d(std::make_shared<Private>(this)) {
+}
+
+TcpConnectionPool::~TcpConnectionPool() {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpConnectionPool::~TcpConnectionPool);
+  d->Clear();
+  d->DropLeased();
+  d->Cancel();
+}
+
+void TcpConnectionPool::SetOptions(const Options& options) {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpConnectionPool::SetOptions);
+  d->options = options;
+}
+
+const TcpConnectionPool::Options& TcpConnectionPool::GetOptions() const {
+  return d->options;
+}
+
+void TcpConnectionPool::Lease(const EndPoint& endpoint, LeaseHandler handler) {
+  Lease(std::vector<EndPoint>{endpoint}, std::move(handler));
+}
+
+void TcpConnectionPool::Lease(const std::vector<EndPoint>& addresses, LeaseHandler handler) {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpConnectionPool::Lease);
+  if (addresses.empty()) {
+    handler(InvalidArgument("no address"), nullptr);
+    return;
+  }
+
+  if (d->destroyed) {
+    handler(Canceled("the pool is destroyed"), nullptr);
+    return;
+  }
+
+  d->Lease(d->HostOf(addresses), std::move(handler));
+  d->Arm();
+  d->Flush();
+}
+
+void TcpConnectionPool::Return(TcpSocket* socket) {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpConnectionPool::Return);
+  d->Return(socket);
+  d->Arm();
+  d->Flush();
+}
+
+void TcpConnectionPool::Prepare(const std::vector<EndPoint>& addresses) {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpConnectionPool::Prepare);
+  if (addresses.empty()) {
+    return;
+  }
+
+  d->Refill(d->HostOf(addresses), Clock::now());
+  d->Arm();
+}
+
+std::size_t TcpConnectionPool::IdleCount(const std::vector<EndPoint>& addresses) const {
+  const auto* host = d->FindHost(addresses);
+  return host ? host->idle.size() : 0;
+}
+
+std::size_t TcpConnectionPool::LeasedCount(const std::vector<EndPoint>& addresses) const {
+  const auto* host = d->FindHost(addresses);
+  return host ? host->leased : 0;
+}
+
+void TcpConnectionPool::Clear() {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpConnectionPool::Clear);
+  d->Clear();
+  d->Flush();
+}
+
+}  // namespace net
+}  // namespace spiderweb
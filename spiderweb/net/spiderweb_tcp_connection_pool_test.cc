@@ -0,0 +1,278 @@
+#include "spiderweb/net/spiderweb_tcp_connection_pool.h"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "core/internal/asio_cast.h"
+#include "gtest/gtest.h"
+#include "spiderweb/core/spiderweb_error_code.h"
+#include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_notify_spy.h"
+#include "spiderweb/net/spiderweb_tcp_server.h"
+
+namespace {
+using spiderweb::net::EndPoint;
+using spiderweb::net::TcpConnectionPool;
+using spiderweb::net::TcpSocket;
+
+/**
+ * @brief a loopback server which keeps the connections it accepts
+ */
+class PoolServer {
+ public:
+  explicit PoolServer(uint16_t port) : server(port) {
+    spiderweb::Object::Connect(&server, &spiderweb::net::TcpServer::InComingConnection, &server,
+                               [this](TcpSocket* socket) { accepted.push_back(socket); });
+  }
+
+  spiderweb::net::TcpServer server;
+  std::vector<TcpSocket*>   accepted;
+};
+
+struct Leased {
+  std::error_code ec;
+  TcpSocket*      socket = nullptr;
+  bool            done = false;
+};
+
+TcpConnectionPool::LeaseHandler Into(Leased* leased) {
+  return [leased](const std::error_code& ec, TcpSocket* socket) {
+    leased->ec = ec;
+    leased->socket = socket;
+    leased->done = true;
+  };
+}
+
+void RunPool(spiderweb::EventLoop& loop, const std::function<bool()>& done) {
+  auto& io = spiderweb::AsioService(&loop);
+  for (int i = 0; i < 300 && !done(); ++i) {
+    io.run_one_for(std::chrono::milliseconds(10));
+  }
+}
+
+void RunPoolFor(spiderweb::EventLoop& loop, int ms) {
+  const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+  RunPool(loop, [until]() { return std::chrono::steady_clock::now() >= until; });
+}
+}  // namespace
+
+TEST(TcpConnectionPool, LeaseReturnReuse) {
+  spiderweb::EventLoop loop;
+  PoolServer           server(12460);
+  ASSERT_FALSE(server.server.ListenAndServ("127.0.0.1"));
+
+  TcpConnectionPool           pool;
+  const std::vector<EndPoint> endpoint{EndPoint("127.0.0.1", 12460)};
+
+  Leased first;
+  pool.Lease(endpoint[0], Into(&first));
+  RunPool(loop, [&]() { return first.done; });
+  ASSERT_FALSE(first.ec);
+  ASSERT_NE(first.socket, nullptr);
+  EXPECT_EQ(pool.LeasedCount(endpoint), 1);
+
+  pool.Return(first.socket);
+  EXPECT_EQ(pool.LeasedCount(endpoint), 0);
+  EXPECT_EQ(pool.IdleCount(endpoint), 1);
+
+  /**
+   * @brief an idle connection is leased at once
+   */
+  Leased second;
+  pool.Lease(endpoint[0], Into(&second));
+  EXPECT_TRUE(second.done);
+  EXPECT_EQ(second.socket, first.socket);
+
+  RunPoolFor(loop, 100);
+  EXPECT_EQ(server.accepted.size(), 1);
+  pool.Return(second.socket);
+}
+
+TEST(TcpConnectionPool, MinIdleAndHealthCheck) {
+  spiderweb::EventLoop loop;
+  PoolServer           server(12461);
+  ASSERT_FALSE(server.server.ListenAndServ("127.0.0.1"));
+
+  TcpConnectionPool          pool;
+  TcpConnectionPool::Options options;
+  options.min_idle = 2;
+  pool.SetOptions(options);
+
+  const std::vector<EndPoint> endpoint{EndPoint("127.0.0.1", 12461)};
+  pool.Prepare(endpoint);
+  RunPool(loop, [&]() { return pool.IdleCount(endpoint) == 2 && server.accepted.size() == 2; });
+  EXPECT_EQ(pool.IdleCount(endpoint), 2);
+
+  /**
+   * @brief the peer closes an idle connection, it is dropped and replaced in the background
+   */
+  server.accepted[0]->DisConnectFromHost();
+  RunPool(loop, [&]() { return server.accepted.size() == 3 && pool.IdleCount(endpoint) == 2; });
+  EXPECT_EQ(server.accepted.size(), 3);
+  EXPECT_EQ(pool.IdleCount(endpoint), 2);
+}
+
+TEST(TcpConnectionPool, IdleEviction) {
+  spiderweb::EventLoop loop;
+  PoolServer           server(12462);
+  ASSERT_FALSE(server.server.ListenAndServ("127.0.0.1"));
+
+  TcpConnectionPool          pool;
+  TcpConnectionPool::Options options;
+  options.idle_timeout_ms = 50;
+  pool.SetOptions(options);
+
+  const std::vector<EndPoint> endpoint{EndPoint("127.0.0.1", 12462)};
+  Leased                      leased;
+  pool.Lease(endpoint, Into(&leased));
+  RunPool(loop, [&]() { return leased.done; });
+  ASSERT_NE(leased.socket, nullptr);
+
+  pool.Return(leased.socket);
+  EXPECT_EQ(pool.IdleCount(endpoint), 1);
+  RunPool(loop, [&]() { return pool.IdleCount(endpoint) == 0; });
+  EXPECT_EQ(pool.IdleCount(endpoint), 0);
+}
+
+TEST(TcpConnectionPool, HappyEyeballs) {
+  spiderweb::EventLoop loop;
+  PoolServer           server(12463);
+  ASSERT_FALSE(server.server.ListenAndServ("127.0.0.1"));
+
+  TcpConnectionPool    pool;
+  spiderweb::NotifySpy connect_error(&pool, &TcpConnectionPool::ConnectError);
+
+  /**
+   * @brief nothing listens on the first address, the second one wins and is tried first then
+   */
+  const std::vector<EndPoint> addresses{EndPoint("127.0.0.1", 12464),
+                                        EndPoint("127.0.0.1", 12463)};
+  Leased                      first;
+  pool.Lease(addresses, Into(&first));
+  RunPool(loop, [&]() { return first.done; });
+  ASSERT_FALSE(first.ec);
+  ASSERT_NE(first.socket, nullptr);
+  EXPECT_EQ(connect_error.Count(), 1);
+
+  Leased second;
+  pool.Lease(addresses, Into(&second));
+  RunPool(loop, [&]() { return second.done; });
+  ASSERT_FALSE(second.ec);
+  EXPECT_NE(second.socket, first.socket);
+  EXPECT_EQ(connect_error.Count(), 1);
+  EXPECT_EQ(server.accepted.size(), 2);
+
+  pool.Return(first.socket);
+  pool.Return(second.socket);
+}
+
+TEST(TcpConnectionPool, Backoff) {
+  spiderweb::EventLoop loop;
+  TcpConnectionPool    pool;
+  spiderweb::NotifySpy connect_error(&pool, &TcpConnectionPool::ConnectError);
+
+  TcpConnectionPool::Options options;
+  options.backoff_initial_ms = 200;
+  pool.SetOptions(options);
+
+  const std::vector<EndPoint> endpoint{EndPoint("127.0.0.1", 12465)};
+  Leased                      first;
+  pool.Lease(endpoint, Into(&first));
+  RunPool(loop, [&]() { return first.done; });
+  EXPECT_TRUE(first.ec);
+  EXPECT_EQ(first.socket, nullptr);
+
+  /**
+   * @brief backing off, the lease fails at once without connecting
+   */
+  Leased second;
+  pool.Lease(endpoint, Into(&second));
+  EXPECT_TRUE(second.done);
+  EXPECT_EQ(second.ec, first.ec);
+  EXPECT_EQ(connect_error.Count(), 1);
+
+  /**
+   * @brief after the backoff it connects again
+   */
+  RunPoolFor(loop, 300);
+  Leased third;
+  pool.Lease(endpoint, Into(&third));
+  EXPECT_FALSE(third.done);
+  RunPool(loop, [&]() { return third.done; });
+  EXPECT_TRUE(third.ec);
+  EXPECT_EQ(connect_error.Count(), 2);
+}
+
+TEST(TcpConnectionPool, MaxConnections) {
+  spiderweb::EventLoop loop;
+  PoolServer           server(12466);
+  ASSERT_FALSE(server.server.ListenAndServ("127.0.0.1"));
+
+  TcpConnectionPool          pool;
+  TcpConnectionPool::Options options;
+  options.max_connections = 1;
+  pool.SetOptions(options);
+
+  const std::vector<EndPoint> endpoint{EndPoint("127.0.0.1", 12466)};
+  Leased                      first;
+  Leased                      second;
+  pool.Lease(endpoint, Into(&first));
+  pool.Lease(endpoint, Into(&second));
+  RunPool(loop, [&]() { return first.done; });
+  ASSERT_NE(first.socket, nullptr);
+  EXPECT_FALSE(second.done);
+
+  /**
+   * @brief the waiting lease gets the returned connection
+   */
+  pool.Return(first.socket);
+  EXPECT_TRUE(second.done);
+  EXPECT_EQ(second.socket, first.socket);
+  EXPECT_EQ(server.accepted.size(), 1);
+  pool.Return(second.socket);
+}
+
+TEST(TcpConnectionPool, DestroyCancelsLeases) {
+  spiderweb::EventLoop loop;
+  PoolServer           server(12467);
+  ASSERT_FALSE(server.server.ListenAndServ("127.0.0.1"));
+
+  std::unique_ptr<TcpConnectionPool> pool(new TcpConnectionPool());
+  TcpConnectionPool::Options         options;
+  options.max_connections = 1;
+  pool->SetOptions(options);
+
+  const std::vector<EndPoint> endpoint{EndPoint("127.0.0.1", 12467)};
+  Leased                      first;
+  Leased                      second;
+  Leased                      again;
+  auto*                       raw = pool.get();
+  pool->Lease(endpoint, Into(&first));
+  pool->Lease(endpoint, [&](const std::error_code& ec, TcpSocket* socket) {
+    Into(&second)(ec, socket);
+    raw->Lease(endpoint, Into(&again));
+  });
+  RunPool(loop, [&]() { return first.done && !server.accepted.empty(); });
+  ASSERT_NE(first.socket, nullptr);
+  EXPECT_FALSE(second.done);
+  ASSERT_EQ(server.accepted.size(), 1);
+  spiderweb::NotifySpy ended(server.accepted[0], &TcpSocket::Error);
+
+  /**
+   * @brief the waiting lease fails, and so does the one asked for by its handler
+   */
+  pool.reset();
+  EXPECT_TRUE(second.done);
+  EXPECT_EQ(second.ec, std::error_code(spiderweb::Canceled()));
+  EXPECT_EQ(second.socket, nullptr);
+  EXPECT_TRUE(again.done);
+  EXPECT_EQ(again.ec, std::error_code(spiderweb::Canceled()));
+
+  /**
+   * @brief the leased connection is closed too
+   */
+  ended.Wait();
+  EXPECT_EQ(ended.Count(), 1);
+}
@@ -14,11 +14,16 @@ TcpServer::TcpServer(uint16_t port, Object* parent)
 TcpServer::~TcpServer() {
   SPIDERWEB_CALL_THREAD_CHECK(TcpServer::~TcpServer);
   d->q = nullptr;
+  d->CloseShards();
 }
 
 ErrorCode TcpServer::ListenAndServ(const std::string& ip_v4) {
   SPIDERWEB_CALL_THREAD_CHECK(TcpServer::~ListenAndServ);
 
+  if (d->sharded) {
+    return d->ListenSharded(ip_v4);
+  }
+
   auto ec = d->Listen(ip_v4);
   SPIDERWEB_VERIFY(!ec, return ec);
 
@@ -30,8 +35,31 @@ void TcpServer::Stop() {
   SPIDERWEB_CALL_THREAD_CHECK(TcpServer::~Stop);
   ErrorCode ec;
   (void)d->acceptor.close(ec);
+  d->CloseShards();
   spider_emit Stopped(std::move(ec));
 }
 
+uint16_t TcpServer::ListenPort() const {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpServer::ListenPort);
+  asio::error_code ec;
+  if (d->acceptor.is_open()) {
+    const auto endpoint = d->acceptor.local_endpoint(ec);
+    if (!ec) {
+      return endpoint.port();
+    }
+  }
+  return d->port_;
+}
+
+void TcpServer::SetEventLoopGroup(EventLoopGroup* group) {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpServer::SetEventLoopGroup);
+  d->group = group;
+}
+
+void TcpServer::SetShardedListen(bool flag) {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpServer::SetShardedListen);
+  d->sharded = flag;
+}
+
 }  // namespace net
 }  // namespace spiderweb
@@ -0,0 +1,92 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <future>
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "spiderweb/core/spiderweb_eventloop_group.h"
+#include "spiderweb/core/spiderweb_thread.h"
+#include "spiderweb/net/spiderweb_tcp_server.h"
+#include "spiderweb/net/spiderweb_tcp_socket.h"
+
+static bool ConnectAndClose(uint16_t port) {
+  const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return false;
+  }
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  /**
+   * @brief reset instead of fin, so that no TIME_WAIT left on the loopback
+   */
+  linger lg{1, 0};
+  ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &lg, sizeof(lg));
+
+  const bool ok = ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+  ::close(fd);
+  return ok;
+}
+
+/**
+ * @brief connections accepted per second, with 1 vs N SO_REUSEPORT shards
+ */
+static void BM_TcpServerShardedAccept(benchmark::State& state) {
+  static constexpr uint16_t kPort = 12400;
+
+  const auto                shards = static_cast<std::size_t>(state.range(0));
+  spiderweb::EventLoopGroup group(shards);
+  spiderweb::Thread         thread;
+  std::atomic<int64_t>      accepted{0};
+
+  group.Start();
+  thread.Start();
+
+  std::unique_ptr<spiderweb::net::TcpServer> server;
+  std::promise<bool>                         listening;
+  thread.QueueTask([&]() {
+    server = std::make_unique<spiderweb::net::TcpServer>(kPort);
+    server->SetEventLoopGroup(&group);
+    server->SetShardedListen(true);
+
+    spiderweb::Object::Connect(server.get(), &spiderweb::net::TcpServer::InComingConnection,
+                               server.get(), [&](spiderweb::net::TcpSocket* socket) {
+                                 socket->DeleteLater();
+                                 accepted.fetch_add(1, std::memory_order_relaxed);
+                               });
+    listening.set_value(!server->ListenAndServ("127.0.0.1"));
+  });
+  if (!listening.get_future().get()) {
+    state.SkipWithError("listen failed");
+    thread.Quit();
+    return;
+  }
+
+  int64_t connected = 0;
+  for (auto _ : state) {
+    if (ConnectAndClose(kPort)) {
+      ++connected;
+    }
+  }
+
+  while (accepted.load(std::memory_order_relaxed) < connected) {
+    std::this_thread::yield();
+  }
+  state.SetItemsProcessed(connected);
+
+  std::promise<bool> stopped;
+  thread.QueueTask([&]() {
+    server.reset();
+    stopped.set_value(true);
+  });
+  stopped.get_future().get();
+  thread.Quit();
+}
+BENCHMARK(BM_TcpServerShardedAccept)->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
@@ -1,8 +1,18 @@
 #include "spiderweb/net/spiderweb_tcp_server.h"
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "core/internal/asio_cast.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_eventloop_group.h"
 #include "spiderweb/core/spiderweb_notify_spy.h"
 #include "spiderweb/core/spiderweb_object.h"
 #include "spiderweb/net/private/spiderweb_tcp_server_private.h"
@@ -99,6 +109,207 @@ TEST(spiderweb_tcp_server, ListenAndServFailed) {
   delete server;
 }
 
+TEST(spiderweb_tcp_server, AcceptOnEventLoopGroup) {
+  spiderweb::EventLoop      loop;
+  spiderweb::EventLoopGroup group(2);
+  spiderweb::net::TcpServer server(12346);
+
+  group.Start();
+  server.SetEventLoopGroup(&group);
+
+  auto ec = server.ListenAndServ("127.0.0.1");
+  ASSERT_FALSE(ec) << ec.FormatedMessage();
+
+  spiderweb::NotifySpy spy(&server, &spiderweb::net::TcpServer::InComingConnection);
+
+  spiderweb::net::TcpSocket c1;
+  spiderweb::net::TcpSocket c2;
+  c1.ConnectToHost("127.0.0.1", 12346);
+  c2.ConnectToHost("127.0.0.1", 12346);
+
+  spy.Wait(3000, 2);
+  ASSERT_EQ(spy.Count(), 2);
+
+  auto* s1 = std::get<0>(spy.ResultAt<spiderweb::net::TcpSocket*>(0));
+  auto* s2 = std::get<0>(spy.ResultAt<spiderweb::net::TcpSocket*>(1));
+  /**
+   * @brief round robin, each connection lives in its own loop thread
+   */
+  EXPECT_NE(s1->ownerEventLoop(), s2->ownerEventLoop());
+  EXPECT_EQ(s1->ThreadId(), s1->ownerEventLoop()->ThreadId());
+  EXPECT_EQ(s2->ThreadId(), s2->ownerEventLoop()->ThreadId());
+  EXPECT_NE(s1->ThreadId(), std::this_thread::get_id());
+
+  s1->DeleteLater();
+  s2->DeleteLater();
+  server.Stop();
+
+  loop.Quit();
+  loop.ExecEx();
+}
+
+TEST(spiderweb_tcp_server, ShardedListen) {
+  spiderweb::EventLoop      loop;
+  spiderweb::EventLoopGroup group(2);
+  spiderweb::net::TcpServer server(12347);
+
+  group.Start();
+  server.SetEventLoopGroup(&group);
+  server.SetShardedListen(true);
+
+  auto ec = server.ListenAndServ("127.0.0.1");
+  ASSERT_FALSE(ec) << ec.FormatedMessage();
+
+  spiderweb::NotifySpy spy(&server, &spiderweb::net::TcpServer::InComingConnection);
+
+  std::vector<std::unique_ptr<spiderweb::net::TcpSocket>> clients;
+  for (int i = 0; i < 8; ++i) {
+    clients.emplace_back(absl::make_unique<spiderweb::net::TcpSocket>());
+    clients.back()->ConnectToHost("127.0.0.1", 12347);
+  }
+
+  spy.Wait(3000, 8);
+  ASSERT_EQ(spy.Count(), 8);
+
+  for (int i = 0; i < 8; ++i) {
+    auto* s = std::get<0>(spy.ResultAt<spiderweb::net::TcpSocket*>(i));
+    /**
+     * @brief accepted by the acceptor of its own loop, never by the thread of the server
+     */
+    EXPECT_EQ(s->ThreadId(), s->ownerEventLoop()->ThreadId());
+    EXPECT_NE(s->ThreadId(), std::this_thread::get_id());
+    s->DeleteLater();
+  }
+  server.Stop();
+
+  loop.Quit();
+  loop.ExecEx();
+}
+
+/**
+ * @brief connections accepted in the group loops while the server goes away are deleted there,
+ *
+ * InComingConnection is only emitted in the thread of the server, before it is destroyed.
+ */
+TEST(spiderweb_tcp_server, DestroyWhileAccepting) {
+  for (const bool sharded : {false, true}) {
+    spiderweb::EventLoop      loop;
+    spiderweb::EventLoopGroup group(2);
+    auto*                     server = new spiderweb::net::TcpServer(12349);
+
+    group.Start();
+    server->SetEventLoopGroup(&group);
+    server->SetShardedListen(sharded);
+    auto ec = server->ListenAndServ("127.0.0.1");
+    ASSERT_FALSE(ec) << ec.FormatedMessage();
+
+    const auto       server_thread = std::this_thread::get_id();
+    std::atomic<int> incoming{0};
+    spiderweb::Object::Connect(server, &spiderweb::net::TcpServer::InComingConnection, server,
+                               [&](spiderweb::net::TcpSocket* s) {
+                                 EXPECT_EQ(std::this_thread::get_id(), server_thread);
+                                 incoming.fetch_add(1);
+                                 s->DeleteLater();
+                               });
+
+    std::atomic<bool> stop{false};
+    std::thread       connector([&stop]() {
+      while (!stop.load()) {
+        asio::io_context      io;
+        asio::ip::tcp::socket socket(io);
+        asio::error_code      connect_ec;
+        socket.connect({asio::ip::make_address("127.0.0.1"), 12349}, connect_ec);
+      }
+    });
+
+    auto&      io = spiderweb::AsioService(&loop);
+    const auto run = [&io](std::chrono::milliseconds duration, const std::function<bool()>& done) {
+      const auto deadline = std::chrono::steady_clock::now() + duration;
+      while (std::chrono::steady_clock::now() < deadline && !done()) {
+        io.run_one_for(std::chrono::milliseconds(1));
+      }
+    };
+    run(std::chrono::milliseconds(3000), [&incoming]() { return incoming.load() >= 5; });
+    delete server;
+
+    /**
+     * @brief the connections still queued to the server thread now find it gone
+     */
+    run(std::chrono::milliseconds(50), []() { return false; });
+    stop = true;
+    connector.join();
+    EXPECT_GT(incoming.load(), 0);
+  }
+}
+
+/**
+ * @brief the bytes sent right at connect time reach the slots which the InComingConnection slot
+ *
+ * connects from the loop of the socket: reading starts after them.
+ */
+TEST(spiderweb_tcp_server, NoBytesLostAtAccept) {
+  static constexpr int         kClients = 8;
+  static constexpr std::size_t kSize = 5;
+
+  for (const bool sharded : {false, true}) {
+    spiderweb::EventLoop      loop;
+    spiderweb::EventLoopGroup group(2);
+    spiderweb::net::TcpServer server(12468);
+
+    group.Start();
+    server.SetEventLoopGroup(&group);
+    server.SetShardedListen(sharded);
+    auto ec = server.ListenAndServ("127.0.0.1");
+    ASSERT_FALSE(ec) << ec.FormatedMessage();
+
+    std::atomic<std::size_t>                 received{0};
+    std::vector<spiderweb::net::TcpSocket*>  accepted;
+    spiderweb::Object::Connect(
+        &server, &spiderweb::net::TcpServer::InComingConnection, &server,
+        [&](spiderweb::net::TcpSocket* s) {
+          accepted.push_back(s);
+          s->ownerEventLoop()->QueueTask([s, &received]() {
+            spiderweb::Object::Connect(s, &spiderweb::net::TcpSocket::BytesRead, s,
+                                       [&received](const spiderweb::io::BufferReader& reader) {
+                                         received += reader.Len();
+                                         reader.Skip(static_cast<uint32_t>(reader.Len()));
+                                       });
+          });
+        });
+
+    asio::io_context                   io;
+    std::vector<asio::ip::tcp::socket> clients;
+    for (int i = 0; i < kClients; ++i) {
+      clients.emplace_back(io);
+      clients.back().connect({asio::ip::make_address("127.0.0.1"), 12468});
+      asio::write(clients.back(), asio::buffer("hello", kSize));
+    }
+
+    auto& service = spiderweb::AsioService(&loop);
+    for (int i = 0; i < 3000 && received.load() < kClients * kSize; ++i) {
+      service.run_one_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_EQ(received.load(), kClients * kSize);
+    EXPECT_EQ(accepted.size(), kClients);
+
+    for (auto* s : accepted) {
+      s->DeleteLater();
+    }
+    server.Stop();
+
+    loop.Quit();
+    loop.ExecEx();
+  }
+}
+
+TEST(spiderweb_tcp_server, ShardedListenWithoutGroup) {
+  spiderweb::EventLoop      loop;
+  spiderweb::net::TcpServer server(12348);
+
+  server.SetShardedListen(true);
+  EXPECT_TRUE(server.ListenAndServ("127.0.0.1"));
+}
+
 TEST(spiderweb_tcp_server, SafeDelete) {
   using ::testing::_;
 
@@ -140,3 +351,12 @@ TEST(spiderweb_tcp_server, Stop) {
   // SPIDERWEB_VERIFY(1 == 1, spy.Clear(); return);
   // delete server;
 }
+
+TEST(spiderweb_tcp_server, ListenPortZero) {
+  spiderweb::EventLoop      loop;
+  spiderweb::net::TcpServer server(0);
+
+  EXPECT_EQ(server.ListenPort(), 0);
+  EXPECT_FALSE(server.ListenAndServ("127.0.0.1"));
+  EXPECT_NE(server.ListenPort(), 0);
+}
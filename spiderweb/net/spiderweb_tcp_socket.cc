@@ -10,6 +10,7 @@ namespace net {
 
 TcpSocket::TcpSocket(Object* parent)
     : Object(parent), d(std::make_shared<io::IoPrivate<Private>>(this)) {
+  d->impl.send_queue = &d->send_queue;
 }
 
 TcpSocket::TcpSocket(TcpServer* parent) : TcpSocket(static_cast<Object*>(parent)) {
@@ -82,5 +83,71 @@ void TcpSocket::Write(const std::vector<uint8_t>& data) {
   d->StartWrite(d->impl.socket, data);
 }
 
+void TcpSocket::Write(std::vector<uint8_t>&& data) {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpSocket::Write);
+  d->StartWrite(d->impl.socket, std::move(data));
+}
+
+void TcpSocket::Write(io::SharedSlice slice) {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpSocket::Write);
+  d->StartWrite(d->impl.socket, std::move(slice));
+}
+
+void TcpSocket::SetWriteBufferWatermarks(std::size_t high, std::size_t low) {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpSocket::SetWriteBufferWatermarks);
+  d->SetWriteWatermarks(high, low);
+}
+
+std::size_t TcpSocket::WriteBufferSize() const {
+  return d->send_queue.Len();
+}
+
+void TcpSocket::PauseReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpSocket::PauseReading);
+  d->PauseRead();
+}
+
+void TcpSocket::ResumeReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpSocket::ResumeReading);
+  d->ResumeRead(d->impl.socket);
+}
+
+void TcpSocket::ContinueReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpSocket::ContinueReading);
+  d->RestartRead(d->impl.socket);
+}
+
+bool TcpSocket::IsReadingPaused() const {
+  return d->IsReadPaused();
+}
+
+void TcpSocket::SetMaxReadBufferSize(std::size_t size) {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpSocket::SetMaxReadBufferSize);
+  d->max_read_buffer = size;
+}
+
+std::size_t TcpSocket::ReadBufferSize() const {
+  return d->recv_buffer.Len();
+}
+
+int TcpSocket::NativeHandle() const {
+  return static_cast<int>(d->impl.socket.native_handle());
+}
+
+void TcpSocket::ReleaseReading(std::function<void(const std::error_code&)> released) {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpSocket::ReleaseReading);
+  d->ReleaseRead(std::move(released));
+}
+
+void TcpSocket::SetDrainReads(bool flag) {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpSocket::SetDrainReads);
+  d->drain_reads = flag;
+}
+
+void TcpSocket::SetZeroCopyThreshold(std::size_t threshold) {
+  SPIDERWEB_CALL_THREAD_CHECK(TcpSocket::SetZeroCopyThreshold);
+  d->impl.zero_copy_threshold = threshold;
+}
+
 }  // namespace net
 }  // namespace spiderweb
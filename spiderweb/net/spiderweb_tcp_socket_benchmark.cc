@@ -0,0 +1,230 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <ctime>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "core/internal/asio_cast.h"
+#include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_thread.h"
+#include "spiderweb/io/spiderweb_buffer.h"
+#include "spiderweb/net/spiderweb_tcp_server.h"
+#include "spiderweb/net/spiderweb_tcp_socket.h"
+
+static int ConnectLoopback(uint16_t port) {
+  const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static int ListenLoopback(uint16_t port) {
+  const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+
+  const int one = 1;
+  ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, 1) != 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static bool SendAll(int fd, const std::vector<char>& data) {
+  std::size_t sent = 0;
+  while (sent < data.size()) {
+    const auto n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n <= 0) {
+      return false;
+    }
+    sent += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+/**
+ * @brief loopback bytes received per second by a TcpSocket, which reads with or without
+ *
+ * draining(SetDrainReads), the user skips everything in BytesRead. the read size adapts in both.
+ *
+ * release build, 1MB sends, same machine:
+ *
+ *   fixed 16K reads(before the read size adapted): 2.36-2.47 GB/s, 16K per BytesRead
+ *
+ *   Arg(0), adaptive:                               2.71-2.77 GB/s, 64K per BytesRead
+ *
+ *   Arg(1), adaptive and drained:                   2.70 GB/s, 1.1M per BytesRead
+ */
+static void BM_TcpSocketReceive(benchmark::State& state) {
+  static constexpr std::size_t kChunkSize = 1024 * 1024;
+
+  const bool           drain = state.range(0) != 0;
+  spiderweb::Thread    thread;
+  std::atomic<int64_t> received{0};
+  std::atomic<int64_t> reads{0};
+
+  thread.Start();
+
+  std::unique_ptr<spiderweb::net::TcpServer> server;
+  std::unique_ptr<spiderweb::net::TcpSocket> accepted;
+  std::promise<uint16_t>                     listening;
+  thread.QueueTask([&]() {
+    server = std::make_unique<spiderweb::net::TcpServer>(0);
+
+    spiderweb::Object::Connect(
+        server.get(), &spiderweb::net::TcpServer::InComingConnection, server.get(),
+        [&, drain](spiderweb::net::TcpSocket* socket) {
+          accepted.reset(socket);
+          socket->SetDrainReads(drain);
+          spiderweb::Object::Connect(socket, &spiderweb::net::TcpSocket::BytesRead, socket,
+                                     [&](const spiderweb::io::BufferReader& reader) {
+                                       const auto n = reader.Len();
+                                       reader.Skip(static_cast<uint32_t>(n));
+                                       reads.fetch_add(1, std::memory_order_relaxed);
+                                       received.fetch_add(static_cast<int64_t>(n),
+                                                          std::memory_order_relaxed);
+                                     });
+        });
+    listening.set_value(server->ListenAndServ("127.0.0.1") ? 0 : server->ListenPort());
+  });
+
+  const auto port = listening.get_future().get();
+  const int  fd = port != 0 ? ConnectLoopback(port) : -1;
+  if (fd < 0) {
+    state.SkipWithError("connect failed");
+    thread.Quit();
+    return;
+  }
+
+  const std::vector<char> chunk(kChunkSize, 'x');
+  int64_t                 sent = 0;
+  for (auto _ : state) {
+    if (!SendAll(fd, chunk)) {
+      state.SkipWithError("send failed");
+      break;
+    }
+    sent += static_cast<int64_t>(chunk.size());
+  }
+
+  while (received.load(std::memory_order_relaxed) < sent) {
+    std::this_thread::yield();
+  }
+  state.SetBytesProcessed(sent);
+  state.counters["bytes_per_read"] =
+      static_cast<double>(sent) / static_cast<double>(std::max<int64_t>(reads.load(), 1));
+
+  ::close(fd);
+
+  std::promise<bool> stopped;
+  thread.QueueTask([&]() {
+    accepted.reset();
+    server.reset();
+    stopped.set_value(true);
+  });
+  stopped.get_future().get();
+  thread.Quit();
+}
+BENCHMARK(BM_TcpSocketReceive)->Arg(0)->Arg(1)->UseRealTime();
+
+/**
+ * @brief 1MB writes of a TcpSocket to a loopback peer which reads in another thread, by
+ *
+ * asio::async_write(0) or MSG_ZEROCOPY(1, SetZeroCopyThreshold). cpu_s_per_gb is the cpu time of
+ *
+ * the process, both sides, per GB. note that on loopback the kernel copies zero copy sends too.
+ */
+static void BM_TcpSocketSend(benchmark::State& state) {
+  static constexpr uint16_t    kPort = 12411;
+  static constexpr std::size_t kChunkSize = 1024 * 1024;
+
+  const int listener = ListenLoopback(kPort);
+  if (listener < 0) {
+    state.SkipWithError("listen failed");
+    return;
+  }
+
+  std::thread reader([listener]() {
+    const int fd = ::accept(listener, nullptr, nullptr);
+    if (fd < 0) {
+      return;
+    }
+
+    std::vector<char> buffer(kChunkSize);
+    while (::recv(fd, buffer.data(), buffer.size(), 0) > 0) {
+    }
+    ::close(fd);
+  });
+
+  spiderweb::EventLoop      loop;
+  spiderweb::net::TcpSocket socket;
+  bool                      connected = false;
+  bool                      failed = false;
+  std::size_t               written = 0;
+
+  socket.SetZeroCopyThreshold(state.range(0) != 0 ? 64 * 1024 : 0);
+  spiderweb::Object::Connect(&socket, &spiderweb::net::TcpSocket::ConnectionEstablished, &socket,
+                             [&]() { connected = true; });
+  spiderweb::Object::Connect(&socket, &spiderweb::net::TcpSocket::Error, &socket,
+                             [&](const std::error_code&) { failed = true; });
+  spiderweb::Object::Connect(&socket, &spiderweb::net::TcpSocket::BytesWritten, &socket,
+                             [&](std::size_t size) { written += size; });
+
+  auto& io = spiderweb::AsioService(&loop);
+  socket.ConnectToHost("127.0.0.1", kPort);
+  while (!connected && !failed) {
+    io.run_one();
+  }
+
+  const auto  payload = std::make_shared<const std::vector<uint8_t>>(kChunkSize, 'x');
+  std::size_t target = 0;
+  const auto  cpu_begin = std::clock();
+  for (auto _ : state) {
+    socket.Write(spiderweb::io::SharedSlice(payload));
+    target += kChunkSize;
+    while (written < target && !failed) {
+      io.run_one();
+    }
+  }
+  const auto cpu = static_cast<double>(std::clock() - cpu_begin) / CLOCKS_PER_SEC;
+
+  if (failed) {
+    state.SkipWithError("write failed");
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(target));
+  state.counters["cpu_s_per_gb"] =
+      cpu / (static_cast<double>(std::max<std::size_t>(target, 1)) / 1e9);
+
+  socket.DisConnectFromHost();
+  ::shutdown(listener, SHUT_RDWR);
+  reader.join();
+  ::close(listener);
+}
+BENCHMARK(BM_TcpSocketSend)->Arg(0)->Arg(1)->UseRealTime();
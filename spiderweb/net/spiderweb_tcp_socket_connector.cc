@@ -9,14 +9,23 @@ namespace net {
 
 class TcpSocketConnector::Private {
  public:
-  int32_t     deadline = 3000;
-  TcpSocket*  pending = nullptr;
-  std::string local_ip;
-  uint16_t    local_port;
+  int32_t                deadline = 3000;
+  TcpSocket*             pending = nullptr;
+  /// one timer for all the attempts, the deadline of the pending one
+  std::unique_ptr<Timer> timer;
+  std::string            local_ip;
+  uint16_t               local_port = 0;
 };
 
 TcpSocketConnector::TcpSocketConnector(spiderweb::Object* parent)
     : spiderweb::Object(parent), d(absl::make_unique<Private>()) {
+  d->timer = absl::make_unique<spiderweb::Timer>(this);
+  d->timer->SetSingalShot(true);
+  Connect(d->timer.get(), &spiderweb::Timer::timeout, this, [this]() {
+    if (d->pending) {
+      d->pending->DisConnectFromHost();
+    }
+  });
 }
 
 TcpSocketConnector::~TcpSocketConnector() {
@@ -28,6 +37,8 @@ void TcpSocketConnector::SetDeadline(int32_t timeout) {
 }
 
 void TcpSocketConnector::Bind(const std::string& local_ip, uint16_t port) {
+  d->local_ip = local_ip;
+  d->local_port = port;
 }
 
 void TcpSocketConnector::ConnectToHost(const std::string& ip, uint16_t port) {
@@ -35,41 +46,40 @@ void TcpSocketConnector::ConnectToHost(const std::string& ip, uint16_t port) {
     return;
   }
 
-  auto* timer = new spiderweb::Timer(this);
   auto* sd = new TcpSocket(this);
 
   d->pending = sd;
 
-  Connect(sd, &TcpSocket::ConnectionEstablished, sd, [this, sd, timer]() {
+  Connect(sd, &TcpSocket::ConnectionEstablished, sd, [this, sd]() {
     d->pending = nullptr;
-    timer->Stop();
-    timer->DeleteLater();
+    d->timer->Stop();
     spider_emit ConnectionEstablished(sd);
   });
 
-  Connect(sd, &TcpSocket::ConnectError, sd, [this, sd, timer](const std::error_code& ec) {
-    d->pending = nullptr;
-    timer->Stop();
-    timer->DeleteLater();
+  Connect(sd, &TcpSocket::ConnectError, sd, [this, sd](const std::error_code& ec) {
+    /**
+     * @brief a canceled attempt fails after another one may have started
+     */
+    if (d->pending == sd) {
+      d->pending = nullptr;
+      d->timer->Stop();
+    }
 
     sd->DeleteLater();
     spider_emit ConnectError(ec);
   });
 
-  Connect(sd, &TcpSocket::SetOptionError, sd, [this, sd, timer](const std::error_code& ec) {
-    d->pending = nullptr;
-    timer->Stop();
-    timer->DeleteLater();
+  Connect(sd, &TcpSocket::SetOptionError, sd, [this, sd](const std::error_code& ec) {
+    if (d->pending == sd) {
+      d->pending = nullptr;
+      d->timer->Stop();
+    }
 
     sd->DeleteLater();
     spider_emit SetOptionError(ec);
   });
 
-  Connect(timer, &spiderweb::Timer::timeout, sd, [sd]() { sd->DisConnectFromHost(); });
-
-  timer->SetInterval(d->deadline);
-  timer->SetSingalShot(true);
-  timer->Start();
+  d->timer->Reset(static_cast<uint64_t>(d->deadline));
 
   sd->Bind(d->local_ip, d->local_port);
 
@@ -80,6 +90,7 @@ void TcpSocketConnector::CancelConnect() {
   if (d->pending) {
     d->pending->DisConnectFromHost();
     d->pending = nullptr;
+    d->timer->Stop();
   }
 }
 
@@ -10,6 +10,7 @@
 #include "spiderweb/core/spiderweb_notify_spy.h"
 #include "spiderweb/io/private/spiderweb_stream_private.h"
 #include "spiderweb/net/private/spiderweb_tcp_socket_private.h"
+#include "spiderweb/net/spiderweb_tcp_server.h"
 #include "spiderweb/test/spiderweb_test_stream.hpp"
 
 using TestIoPrivate = spiderweb::io::IoPrivate<spiderweb::net::TcpSocket::Private>;
@@ -221,6 +222,263 @@ TEST(spiderweb_tcp_socket, MultiWrite) {
   EXPECT_TRUE(spy.Count() == 2);
 }
 
+TEST(spiderweb_tcp_socket, GatherOwnedWrites) {
+  using ::testing::_;
+
+  spiderweb::EventLoop loop;
+  MockSocket           mocker(loop);
+
+  spiderweb::NotifySpy spy(&mocker.socket, &spiderweb::net::TcpSocket::BytesWritten);
+  spiderweb::NotifySpy on_conn(&mocker.socket, &spiderweb::net::TcpSocket::ConnectionEstablished);
+
+  std::vector<uint8_t> owned{'5', '6', '7', '8'};
+  const auto*          owned_data = owned.data();
+  auto                 shared = std::make_shared<const std::vector<uint8_t>>(
+      std::vector<uint8_t>{'x', 'a', 'b', 'c', 'd'});
+
+  mocker.SimulateConnectSuccess();
+  mocker.ShouldCallReadWhenConnectSuccess();
+  EXPECT_CALL(mocker.stream, async_write_some(_, _))
+      .WillOnce(
+          [&](const asio::const_buffers_1& buffers, const test_stream::WriteHandler& handler) {
+            EXPECT_EQ(buffers.size(), 4);
+            loop.QueueTask([handler, buffers]() { handler(asio::error_code(), buffers.size()); });
+          });
+  EXPECT_CALL(mocker.stream, async_write_gather(_, _))
+      .WillOnce([&](const std::vector<asio::const_buffer>& buffers,
+                    const test_stream::WriteHandler&        handler) {
+        /**
+         * @brief the owned buffers are written in place, the copied ones are coalesced
+         */
+        EXPECT_EQ(buffers.size(), 3);
+        EXPECT_EQ(buffers[0].data(), owned_data);
+        EXPECT_EQ(buffers[1].data(), shared->data() + 1);
+        EXPECT_TRUE(std::memcmp(buffers[2].data(), "efgh", 4) == 0);
+        EXPECT_EQ(asio::buffer_size(buffers), 12);
+        loop.QueueTask([handler]() { handler(asio::error_code(), 12); });
+      });
+
+  mocker.d->StartOpen(mocker.stream, mocker.endpoint);
+  on_conn.Wait();
+  EXPECT_EQ(on_conn.Count(), 1);
+
+  mocker.d->StartWrite(mocker.stream, "1234");
+  mocker.d->StartWrite(mocker.stream, std::move(owned));
+  mocker.d->StartWrite(mocker.stream, spiderweb::io::SharedSlice(shared).Slice(1, 4));
+  mocker.d->StartWrite(mocker.stream, "ef");
+  mocker.d->StartWrite(mocker.stream, "gh");
+
+  spy.Wait(3000, 2);
+  EXPECT_EQ(spy.Count(), 2);
+  EXPECT_EQ(std::get<0>(spy.LastResult<std::size_t>()), 12);
+}
+
+TEST(spiderweb_tcp_socket, WriteBufferWatermarks) {
+  using ::testing::_;
+
+  spiderweb::EventLoop loop;
+  MockSocket           mocker(loop);
+
+  spiderweb::NotifySpy full(&mocker.socket, &spiderweb::net::TcpSocket::WriteBufferFull);
+  spiderweb::NotifySpy drained(&mocker.socket, &spiderweb::net::TcpSocket::WriteBufferDrained);
+  spiderweb::NotifySpy on_conn(&mocker.socket, &spiderweb::net::TcpSocket::ConnectionEstablished);
+
+  mocker.SimulateConnectSuccess();
+  mocker.ShouldCallReadWhenConnectSuccess();
+  mocker.SimulateWriteSuccess();
+
+  mocker.d->SetWriteWatermarks(8, 2);
+  mocker.d->StartOpen(mocker.stream, mocker.endpoint);
+  on_conn.Wait();
+  EXPECT_EQ(on_conn.Count(), 1);
+
+  mocker.d->StartWrite(mocker.stream, "1234");
+  EXPECT_EQ(full.Count(), 0);
+
+  /**
+   * @brief crossing the high watermark again, before drained, is not notified
+   */
+  mocker.d->StartWrite(mocker.stream, "5678");
+  mocker.d->StartWrite(mocker.stream, "abcd");
+  EXPECT_EQ(full.Count(), 1);
+  EXPECT_EQ(std::get<0>(full.LastResult<std::size_t>()), 8);
+
+  drained.Wait();
+  EXPECT_EQ(drained.Count(), 1);
+  EXPECT_EQ(full.Count(), 1);
+  EXPECT_EQ(mocker.d->send_queue.Len(), 0);
+}
+
+TEST(spiderweb_tcp_socket, PauseReading) {
+  using ::testing::_;
+
+  spiderweb::EventLoop loop;
+  MockSocket           mocker(loop);
+
+  spiderweb::NotifySpy spy(&mocker.socket, &spiderweb::net::TcpSocket::BytesRead);
+  spiderweb::NotifySpy on_conn(&mocker.socket, &spiderweb::net::TcpSocket::ConnectionEstablished);
+
+  mocker.SimulateConnectSuccess();
+  EXPECT_CALL(mocker.stream, async_read_some(_, _))
+      .WillOnce(
+          [&](const asio::mutable_buffers_1& buffers, const test_stream::ReadHandler& handler) {
+            asio::buffer_copy(buffers, asio::buffer("hello", 5));
+            loop.QueueTask([handler]() { handler(asio::error_code(), 5); });
+          })
+      .WillOnce(
+          [&](const asio::mutable_buffers_1& buffers, const test_stream::ReadHandler& handler) {});
+
+  /**
+   * @brief paused twice, so the first resume does not read
+   */
+  mocker.d->PauseRead();
+  mocker.d->PauseRead();
+  mocker.d->StartOpen(mocker.stream, mocker.endpoint);
+  on_conn.Wait();
+  EXPECT_EQ(on_conn.Count(), 1);
+
+  mocker.d->ResumeRead(mocker.stream);
+  spy.Wait(100);
+  EXPECT_EQ(spy.Count(), 0);
+
+  mocker.d->ResumeRead(mocker.stream);
+  spy.Wait();
+  EXPECT_EQ(spy.Count(), 1);
+}
+
+TEST(spiderweb_tcp_socket, MaxReadBufferSize) {
+  using ::testing::_;
+
+  spiderweb::EventLoop loop;
+  MockSocket           mocker(loop);
+
+  spiderweb::NotifySpy spy(&mocker.socket, &spiderweb::net::TcpSocket::BytesRead);
+
+  auto simulate_read = [&](const char* data) {
+    return [&loop, data](const asio::mutable_buffers_1& buffers,
+                         const test_stream::ReadHandler& handler) {
+      asio::buffer_copy(buffers, asio::buffer(data, 5));
+      loop.QueueTask([handler]() { handler(asio::error_code(), 5); });
+    };
+  };
+
+  mocker.SimulateConnectSuccess();
+  EXPECT_CALL(mocker.stream, async_read_some(_, _))
+      .WillOnce(simulate_read("hello"))
+      .WillOnce(simulate_read("world"))
+      .WillOnce(
+          [&](const asio::mutable_buffers_1& buffers, const test_stream::ReadHandler& handler) {});
+
+  /**
+   * @brief nothing is read by the user, so reading stops after 10 bytes
+   */
+  mocker.d->max_read_buffer = 8;
+  mocker.d->StartOpen(mocker.stream, mocker.endpoint);
+  spy.Wait(200, 3);
+  EXPECT_EQ(spy.Count(), 2);
+  EXPECT_EQ(mocker.d->recv_buffer.Len(), 10);
+  EXPECT_TRUE(mocker.d->IsReadPaused());
+  EXPECT_FALSE(mocker.d->reading);
+
+  /**
+   * @brief resuming without reading the buffer does nothing
+   */
+  mocker.d->ResumeRead(mocker.stream);
+  EXPECT_FALSE(mocker.d->reading);
+
+  mocker.d->recv_buffer.Skip(4);
+  mocker.d->ResumeRead(mocker.stream);
+  EXPECT_TRUE(mocker.d->reading);
+}
+
+TEST(spiderweb_tcp_socket, PauseReadingWithFullReadBuffer) {
+  using ::testing::_;
+
+  spiderweb::EventLoop loop;
+  MockSocket           mocker(loop);
+
+  spiderweb::NotifySpy spy(&mocker.socket, &spiderweb::net::TcpSocket::BytesRead);
+
+  mocker.SimulateConnectSuccess();
+  EXPECT_CALL(mocker.stream, async_read_some(_, _))
+      .WillOnce(
+          [&](const asio::mutable_buffers_1& buffers, const test_stream::ReadHandler& handler) {
+            asio::buffer_copy(buffers, asio::buffer("hello", 5));
+            loop.QueueTask([handler]() { handler(asio::error_code(), 5); });
+          })
+      .WillOnce(
+          [&](const asio::mutable_buffers_1& buffers, const test_stream::ReadHandler& handler) {});
+
+  /**
+   * @brief the buffer is full after the first read, and the user pauses as well
+   */
+  mocker.d->max_read_buffer = 4;
+  mocker.d->StartOpen(mocker.stream, mocker.endpoint);
+  spy.Wait();
+  EXPECT_EQ(spy.Count(), 1);
+  EXPECT_FALSE(mocker.d->reading);
+
+  mocker.d->PauseRead();
+
+  /**
+   * @brief restarting after the buffer is read keeps the pause of the user
+   */
+  mocker.d->recv_buffer.Skip(5);
+  mocker.d->RestartRead(mocker.stream);
+  EXPECT_FALSE(mocker.d->reading);
+  EXPECT_EQ(mocker.d->read_paused, 1);
+
+  mocker.d->ResumeRead(mocker.stream);
+  EXPECT_TRUE(mocker.d->reading);
+  EXPECT_FALSE(mocker.d->IsReadPaused());
+}
+
+TEST(spiderweb_tcp_socket, DrainReads) {
+  using ::testing::_;
+
+  spiderweb::EventLoop loop;
+  MockSocket           mocker(loop);
+
+  spiderweb::NotifySpy spy(&mocker.socket, &spiderweb::net::TcpSocket::BytesRead);
+
+  std::size_t first = 0;
+  std::size_t drained = 0;
+
+  mocker.SimulateConnectSuccess();
+  ON_CALL(mocker.stream, non_blocking()).WillByDefault(testing::Return(true));
+  EXPECT_CALL(mocker.stream, non_blocking()).Times(testing::AnyNumber());
+  EXPECT_CALL(mocker.stream, async_read_some(_, _))
+      .WillOnce(
+          [&](const asio::mutable_buffers_1& buffers, const test_stream::ReadHandler& handler) {
+            first = buffers.size();
+            loop.QueueTask([handler, &first]() { handler(asio::error_code(), first); });
+          })
+      .WillOnce(
+          [&](const asio::mutable_buffers_1& buffers, const test_stream::ReadHandler& handler) {});
+
+  /**
+   * @brief the first read filled the buffer, so the stream is read until it would block, and the
+   *
+   * read size grows with every full read.
+   */
+  EXPECT_CALL(mocker.stream, read_some(_, _))
+      .WillOnce([&](const asio::mutable_buffers_1& buffers, asio::error_code&) {
+        drained += buffers.size();
+        return buffers.size();
+      })
+      .WillOnce([&](const asio::mutable_buffers_1& buffers, asio::error_code&) {
+        drained += 10;
+        return std::size_t(10);
+      });
+
+  mocker.d->drain_reads = true;
+  mocker.d->StartOpen(mocker.stream, mocker.endpoint);
+  spy.Wait(200, 2);
+  EXPECT_EQ(spy.Count(), 1);
+  EXPECT_EQ(mocker.d->recv_buffer.Len(), first + drained);
+  EXPECT_GT(mocker.d->read_size, TestIoPrivate::kSpaceGrowSize);
+}
+
 TEST(spiderweb_tcp_socket, ReadSuccess) {
   using ::testing::_;
 
@@ -369,3 +627,66 @@ TEST(spiderweb_tcp_socket, SafeDelete) {
 
   loop.Exec();
 }
+
+TEST(spiderweb_tcp_socket, ZeroCopyWrite) {
+  static constexpr std::size_t kSize = 1024 * 1024;
+
+  spiderweb::EventLoop      loop;
+  spiderweb::net::TcpServer server(12431);
+  std::string               received;
+
+  ASSERT_FALSE(server.ListenAndServ("127.0.0.1"));
+  spiderweb::Object::Connect(
+      &server, &spiderweb::net::TcpServer::InComingConnection, &server,
+      [&](spiderweb::net::TcpSocket* socket) {
+        spiderweb::Object::Connect(socket, &spiderweb::net::TcpSocket::BytesRead, socket,
+                                   [&](const spiderweb::io::BufferReader& reader) {
+                                     std::string data(reader.Len(), '\0');
+                                     reader.Read(&data[0], data.size());
+                                     received += data;
+                                   });
+      });
+
+  spiderweb::net::TcpSocket client;
+  spiderweb::NotifySpy      connected(&client, &spiderweb::net::TcpSocket::ConnectionEstablished);
+  spiderweb::NotifySpy      option_error(&client, &spiderweb::net::TcpSocket::SetOptionError);
+  std::size_t               written = 0;
+  spiderweb::Object::Connect(&client, &spiderweb::net::TcpSocket::BytesWritten, &client,
+                             [&](std::size_t size) { written += size; });
+
+  client.SetZeroCopyThreshold(64 * 1024);
+  client.ConnectToHost("127.0.0.1", 12431);
+  connected.Wait();
+  ASSERT_EQ(connected.Count(), 1);
+
+  /**
+   * @brief the payload is released by the socket only when the kernel is done with it, so not
+   *
+   * before all of it is written. ZeroCopyWriterTest checks it waits for the notifications.
+   */
+  bool        released = false;
+  std::size_t written_at_release = 0;
+  {
+    std::shared_ptr<const std::vector<uint8_t>> payload(
+        new std::vector<uint8_t>(kSize, 'z'), [&](const std::vector<uint8_t>* p) {
+          released = true;
+          written_at_release = written;
+          delete p;
+        });
+    client.Write(reinterpret_cast<const uint8_t*>("head"), 4);
+    client.Write(spiderweb::io::SharedSlice(payload));
+  }
+
+  auto& io = spiderweb::AsioService(&loop);
+  for (int i = 0; i < 300 && (received.size() < kSize + 4 || !released); ++i) {
+    io.run_one_for(std::chrono::milliseconds(10));
+  }
+
+  EXPECT_EQ(option_error.Count(), 0);
+  EXPECT_EQ(written, kSize + 4);
+  ASSERT_EQ(received.size(), kSize + 4);
+  EXPECT_EQ(received.substr(0, 4), "head");
+  EXPECT_EQ(received.find_first_not_of('z', 4), std::string::npos);
+  EXPECT_TRUE(released);
+  EXPECT_EQ(written_at_release, kSize + 4);
+}
@@ -2,43 +2,287 @@
 
 #include <absl/types/span.h>
 
+#if defined(__linux__)
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <time.h>
+#endif
+
+#if !defined(_WIN32)
+#include <net/if.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <utility>
+
 #include "asio.hpp"
 #include "core/internal/asio_cast.h"
 #include "spdlog/spdlog.h"
 #include "spiderweb/core/internal/thread_check.h"
 #include "spiderweb_endpoint_visitor.h"
 
+#if defined(__linux__) && !defined(UDP_SEGMENT)
+#define UDP_SEGMENT 103
+#endif
+
 namespace spiderweb {
 namespace net {
 using asio::ip::udp;
 
 class UdpSocket::Private : public std::enable_shared_from_this<Private> {
  public:
+  using Block = std::shared_ptr<std::vector<uint8_t>>;
+
+  static constexpr std::size_t kMaxPoolBlocks = 8;
+  static constexpr std::size_t kMaxBatch = 64;
+  static constexpr std::size_t kMaxIov = 1024;
+  /// limits of UDP_SEGMENT
+  static constexpr std::size_t kMaxSegments = 64;
+  static constexpr std::size_t kMaxGsoSize = 65507;
+
+  struct Outgoing {
+    udp::endpoint   endpoint;
+    io::SharedSlice data;
+  };
+
+#if defined(__linux__)
+  using Control = std::array<char, CMSG_SPACE(sizeof(uint16_t))>;
+  using TimestampControl = std::array<char, CMSG_SPACE(sizeof(timespec))>;
+  using Timestamps = asio::detail::socket_option::boolean<SOL_SOCKET, SO_TIMESTAMPNS>;
+#endif
+#if defined(SO_REUSEPORT)
+  using ReusePort = asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+#if defined(SO_BUSY_POLL)
+  using BusyPoll = asio::detail::socket_option::integer<SOL_SOCKET, SO_BUSY_POLL>;
+#endif
+
   explicit Private(UdpSocket* qq) : q(qq), socket(AsioService(qq->ownerEventLoop())) {
   }
 
-  void SendTo(const EndPoint& endpoint, const uint8_t* data, std::size_t size) {
+  void SendTo(const EndPoint& endpoint, io::SharedSlice data) {
     if (stopped) {
       spdlog::warn("{}({}) stopped", Description(), fmt::ptr(q));
       return;
     }
 
-    Datagram            datagram(endpoint, data, size);
-    absl::Span<uint8_t> span(const_cast<uint8_t*>(datagram.Data().data()), datagram.Data().size());
-    auto                self = shared_from_this();
+    if (batch_send) {
+      QueueSend(EndPointVisitor::MakeAsioEndpoint<udp>(endpoint), std::move(data));
+      return;
+    }
 
+    const auto buffer = asio::buffer(data.data(), data.size());
+    auto       self = shared_from_this();
     socket.async_send_to(
-        asio::buffer(span), EndPointVisitor::MakeAsioEndpoint<udp>(endpoint),
-        [this, datagram = std::move(datagram), self](const asio::error_code& ec, std::size_t size) {
+        buffer, EndPointVisitor::MakeAsioEndpoint<udp>(endpoint),
+        [this, data = std::move(data), self](const asio::error_code& ec, std::size_t size) {
           HandleWrite(ec, size);
         });
   }
 
+  /**
+   * @brief datagrams sent in one loop iteration are flushed together, by sendmmsg
+   */
+  void QueueSend(const udp::endpoint& endpoint, io::SharedSlice data) {
+    send_queue.push_back(Outgoing{endpoint, std::move(data)});
+    if (flush_scheduled || sending) {
+      return;
+    }
+
+    flush_scheduled = true;
+    auto self = shared_from_this();
+    asio::post(socket.get_executor(), [this, self]() {
+      flush_scheduled = false;
+      Flush();
+    });
+  }
+
+  /**
+   * @brief BytesWritten is emitted once, for `written` and all the datagrams sent here
+   */
+  void Flush(std::size_t written = 0) {
+    while (!stopped && !send_queue.empty()) {
+      std::size_t      bytes = 0;
+      asio::error_code ec;
+      const auto       sent = SendBatch(&bytes, ec);
+
+      if (ec == asio::error::would_block || ec == asio::error::try_again) {
+        SendOne();
+        break;
+      }
+
+      if (ec) {
+        Stop();
+        /**
+         * @brief we use Object::Emit here, beause maybe `q` has gone.
+         */
+        Error(ec);
+        return;
+      }
+
+      send_queue.erase(send_queue.begin(),
+                       send_queue.begin() + static_cast<std::ptrdiff_t>(sent));
+      written += bytes;
+    }
+
+    if (written > 0 && !stopped) {
+      spider_emit q->BytesWritten(written);
+    }
+  }
+
+  /**
+   * @brief the socket buffer is full, let asio wait for the head datagram, then flush the rest,
+   *
+   * the head is reported with them.
+   */
+  void SendOne() {
+    sending = true;
+
+    const auto& head = send_queue.front();
+    auto        self = shared_from_this();
+    socket.async_send_to(asio::buffer(head.data.data(), head.data.size()), head.endpoint,
+                         [this, self](const asio::error_code& ec, std::size_t size) {
+                           sending = false;
+                           if (stopped) {
+                             return;
+                           }
+
+                           if (ec) {
+                             Stop();
+                             Error(ec);
+                             return;
+                           }
+
+                           send_queue.pop_front();
+                           Flush(size);
+                         });
+  }
+
+  /**
+   * @brief send the head of the queue by one sendmmsg, of at most kMaxBatch messages. with
+   *
+   * segment_offload, consecutive datagrams of the same size to the same endpoint are sent as one
+   *
+   * message with UDP_SEGMENT, the kernel splits it.
+   *
+   * @return the number of datagrams sent
+   */
+  std::size_t SendBatch(std::size_t* bytes, asio::error_code& ec) {
+#if defined(__linux__)
+    msgs.resize(kMaxBatch);
+    iovs.resize(kMaxIov);
+    controls.resize(kMaxBatch);
+
+    std::size_t count = 0;
+    std::size_t iov = 0;
+    std::size_t index = 0;
+    std::size_t covered[kMaxBatch];
+    while (count < kMaxBatch && index < send_queue.size() && iov < kMaxIov) {
+      const auto& first = send_queue[index];
+      const auto  segment = first.data.size();
+      auto&       hdr = msgs[count].msg_hdr;
+
+      std::memset(&hdr, 0, sizeof(hdr));
+      hdr.msg_name = const_cast<void*>(static_cast<const void*>(first.endpoint.data()));
+      hdr.msg_namelen = static_cast<socklen_t>(first.endpoint.size());
+      hdr.msg_iov = &iovs[iov];
+
+      std::size_t total = 0;
+      std::size_t n = 0;
+      while (index + n < send_queue.size() && iov < kMaxIov) {
+        const auto& next = send_queue[index + n];
+        if (n > 0 && (!segment_offload || segment == 0 || n == kMaxSegments ||
+                      next.endpoint != first.endpoint || next.data.size() > segment ||
+                      next.data.size() == 0 || total + next.data.size() > kMaxGsoSize)) {
+          break;
+        }
+
+        iovs[iov].iov_base = const_cast<uint8_t*>(next.data.data());
+        iovs[iov].iov_len = next.data.size();
+        ++iov;
+        ++n;
+        total += next.data.size();
+
+        /**
+         * @brief only the last segment may be shorter
+         */
+        if (next.data.size() < segment) {
+          break;
+        }
+      }
+      hdr.msg_iovlen = n;
+
+      if (n > 1) {
+        auto* control = controls[count].data();
+        std::memset(control, 0, controls[count].size());
+        hdr.msg_control = control;
+        hdr.msg_controllen = controls[count].size();
+
+        auto* cmsg = CMSG_FIRSTHDR(&hdr);
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        const auto size = static_cast<uint16_t>(segment);
+        std::memcpy(CMSG_DATA(cmsg), &size, sizeof(size));
+      }
+
+      covered[count] = n;
+      index += n;
+      ++count;
+    }
+
+    const int sent = ::sendmmsg(socket.native_handle(), msgs.data(),
+                                static_cast<unsigned int>(count), MSG_DONTWAIT);
+    if (sent < 0) {
+      ec = asio::error_code(errno, asio::error::get_system_category());
+
+      /**
+       * @brief the kernel or the device can not segment, send them one by one
+       */
+      if (segment_offload && (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT)) {
+        spdlog::warn("{}({}) UDP_SEGMENT: {}, turned off", Description(), fmt::ptr(q),
+                     ec.message());
+        segment_offload = false;
+        ec = asio::error::try_again;
+      }
+      return 0;
+    }
+
+    std::size_t datagrams = 0;
+    for (int i = 0; i < sent; ++i) {
+      datagrams += covered[i];
+      *bytes += msgs[i].msg_len;
+    }
+    return datagrams;
+#else
+    (void)bytes;
+    ec = asio::error::would_block;
+    return 0;
+#endif
+  }
+
   void StartRead() {
     if (stopped) {
       return;
     }
 
+    if (timestamps) {
+      StartPeekRead();
+      return;
+    }
+
+    if (batch > 1) {
+      StartBatchRead();
+      return;
+    }
+
     auto self = shared_from_this();
     socket.async_receive_from(
         asio::buffer(recv_buffer), remote,
@@ -67,6 +311,299 @@ class UdpSocket::Private : public std::enable_shared_from_this<Private> {
         Datagram(EndPointVisitor::FromAsioEndpoint(remote), recv_buffer.data(), bytes_transferred));
   }
 
+  void SetBatchReceive(std::size_t n, std::size_t max_datagram_size) {
+    batch = std::max<std::size_t>(n, 1);
+    slot_size = max_datagram_size;
+    /**
+     * @brief a pending read keeps its block alive
+     */
+    block.reset();
+    pool.clear();
+  }
+
+  /**
+   * @brief the first datagram is received by asio, which waits for it, the rest of the batch is
+   *
+   * then taken by one non blocking recvmmsg.
+   */
+  void StartBatchRead() {
+    AcquireBlock();
+
+    auto self = shared_from_this();
+    socket.async_receive_from(
+        asio::buffer(block->data(), slot_size), remote,
+        [this, self, received = block](const std::error_code& ec,
+                                       std::size_t bytes_transferred) mutable {
+          HandleBatchReceive(ec, bytes_transferred, std::move(received));
+        });
+  }
+
+  /**
+   * @brief `received` is the block which was read into, it keeps the block alive if the batch
+   *
+   * setting is changed meanwhile.
+   */
+  void HandleBatchReceive(const std::error_code& ec, std::size_t bytes_transferred,
+                          Block received) {
+    if (stopped) {
+      return;
+    }
+
+    if (ec) {
+      Stop();
+      /**
+       * @brief we use Object::Emit here, beause maybe `q` has gone.
+       */
+      Error(ec);
+      return;
+    }
+
+    datagrams.clear();
+    datagrams.push_back(Datagram(EndPointVisitor::FromAsioEndpoint(remote),
+                                 io::SharedSlice(received, received->data(), bytes_transferred)));
+    if (received == block) {
+      ReceiveMore(1);
+    }
+
+    EmitBatch(std::move(received));
+  }
+
+  /**
+   * @brief the receive time is a control message, which asio does not return. so asio only
+   *
+   * waits for a datagram, by a zero sized peek, then the whole batch is taken by recvmmsg.
+   */
+  void StartPeekRead() {
+    auto self = shared_from_this();
+    socket.async_receive_from(asio::mutable_buffer(), remote, udp::socket::message_peek,
+                              [this, self](const std::error_code& ec, std::size_t /*size*/) {
+                                HandlePeek(ec);
+                              });
+  }
+
+  void HandlePeek(const std::error_code& ec) {
+    if (stopped) {
+      return;
+    }
+
+    if (ec) {
+      Stop();
+      /**
+       * @brief we use Object::Emit here, beause maybe `q` has gone.
+       */
+      Error(ec);
+      return;
+    }
+
+    AcquireBlock();
+    datagrams.clear();
+    ReceiveMore(0);
+    EmitBatch(block);
+  }
+
+  /**
+   * @brief the slots may close, reopen or delete the socket, nothing is emitted any more then,
+   *
+   * and the reopened socket reads on its own.
+   */
+  void EmitBatch(Block received) {
+    const auto generation = opened;
+    const auto closed = [this, generation]() { return stopped || opened != generation; };
+
+    if (!datagrams.empty()) {
+      spider_emit q->DatagramBatchArrived(absl::Span<const Datagram>(datagrams));
+    }
+    for (std::size_t i = 0; i < datagrams.size() && !closed(); ++i) {
+      const auto& datagram = datagrams[i];
+      const auto  bytes = datagram.Bytes();
+      spider_emit q->DatagramArrived(
+          Datagram(datagram.endpoint_, bytes.data(), bytes.size(), datagram.timestamp_));
+    }
+
+    /**
+     * @brief read after the datagrams are released, so that the block is reused
+     */
+    datagrams.clear();
+    received.reset();
+    if (!closed()) {
+      StartRead();
+    }
+  }
+
+  /**
+   * @brief receive into the slots [first, batch) of the block by one non blocking recvmmsg
+   */
+  void ReceiveMore(std::size_t first) {
+#if defined(__linux__)
+    if (first >= batch) {
+      return;
+    }
+
+    const std::size_t count = batch - first;
+    recv_msgs.resize(std::max(recv_msgs.size(), count));
+    recv_iovs.resize(recv_msgs.size());
+    addrs.resize(recv_msgs.size());
+    if (timestamps) {
+      timestamp_controls.resize(recv_msgs.size());
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+      recv_iovs[i].iov_base = block->data() + (first + i) * slot_size;
+      recv_iovs[i].iov_len = slot_size;
+
+      auto& hdr = recv_msgs[i].msg_hdr;
+      std::memset(&hdr, 0, sizeof(hdr));
+      hdr.msg_name = &addrs[i];
+      hdr.msg_namelen = sizeof(addrs[i]);
+      hdr.msg_iov = &recv_iovs[i];
+      hdr.msg_iovlen = 1;
+      if (timestamps) {
+        hdr.msg_control = timestamp_controls[i].data();
+        hdr.msg_controllen = timestamp_controls[i].size();
+      }
+    }
+
+    /**
+     * @brief errors are left to the next async_receive_from
+     */
+    const int n = ::recvmmsg(socket.native_handle(), recv_msgs.data(),
+                             static_cast<unsigned int>(count), MSG_DONTWAIT, nullptr);
+    for (int i = 0; i < n; ++i) {
+      const auto&   hdr = recv_msgs[i].msg_hdr;
+      udp::endpoint endpoint;
+      std::memcpy(endpoint.data(), &addrs[i], hdr.msg_namelen);
+      endpoint.resize(hdr.msg_namelen);
+
+      datagrams.push_back(
+          Datagram(EndPointVisitor::FromAsioEndpoint(endpoint),
+                   io::SharedSlice(block, static_cast<const uint8_t*>(recv_iovs[i].iov_base),
+                                   std::min<std::size_t>(recv_msgs[i].msg_len, slot_size)),
+                   TimeStampOf(hdr)));
+    }
+#else
+    (void)first;
+#endif
+  }
+
+#if defined(__linux__)
+  static std::chrono::nanoseconds TimeStampOf(const msghdr& hdr) {
+    if (hdr.msg_controllen == 0) {
+      return std::chrono::nanoseconds(0);
+    }
+
+    for (auto* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(const_cast<msghdr*>(&hdr), cmsg)) {
+      if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+        timespec ts;
+        std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+        return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+      }
+    }
+    return std::chrono::nanoseconds(0);
+  }
+#endif
+
+  /**
+   * @brief join or leave a multicast group, `Option` is asio::ip::multicast::join_group or
+   *
+   * leave_group.
+   */
+  template <typename Option>
+  void SetGroupOption(const std::string& group, const std::string& local, ErrorCode& ec) {
+    const auto address = asio::ip::make_address(group, ec);
+    if (ec) {
+      return;
+    }
+
+    if (address.is_v4()) {
+      const auto local_address = MakeInterfaceAddress(local, ec);
+      if (!ec) {
+        (void)socket.set_option(Option(address.to_v4(), local_address), ec);
+      }
+      return;
+    }
+
+    const auto index = InterfaceIndex(local, ec);
+    if (!ec) {
+      (void)socket.set_option(Option(address.to_v6(), index), ec);
+    }
+  }
+
+  void SetMulticastInterface(const std::string& local, ErrorCode& ec) {
+    using asio::ip::multicast::outbound_interface;
+
+    if (socket.is_open() && protocol == Protocol::kIpv6) {
+      const auto index = InterfaceIndex(local, ec);
+      if (!ec) {
+        (void)socket.set_option(outbound_interface(static_cast<unsigned int>(index)), ec);
+      }
+      return;
+    }
+
+    const auto local_address = MakeInterfaceAddress(local, ec);
+    if (!ec) {
+      (void)socket.set_option(outbound_interface(local_address), ec);
+    }
+  }
+
+  static asio::ip::address_v4 MakeInterfaceAddress(const std::string& local, ErrorCode& ec) {
+    if (local.empty()) {
+      return asio::ip::address_v4::any();
+    }
+    return asio::ip::make_address_v4(local, ec);
+  }
+
+  static unsigned long InterfaceIndex(const std::string& local, ErrorCode& ec) {
+    if (local.empty()) {
+      return 0;
+    }
+
+    unsigned long index = 0;
+#if !defined(_WIN32)
+    index = ::if_nametoindex(local.c_str());
+#endif
+    if (index == 0) {
+      ec = InvalidArgument(fmt::format("no interface {}", local));
+    }
+    return index;
+  }
+
+  /**
+   * @brief take a block of the pool which no datagram views any more, or a new one
+   */
+  void AcquireBlock() {
+    if (block && Unshared(block)) {
+      return;
+    }
+
+    if (block && pool.size() < kMaxPoolBlocks) {
+      pool.push_back(std::move(block));
+    }
+    block.reset();
+
+    auto it = std::find_if(pool.begin(), pool.end(), [](const Block& b) { return Unshared(b); });
+    if (it != pool.end()) {
+      block = std::move(*it);
+      *it = std::move(pool.back());
+      pool.pop_back();
+      return;
+    }
+    block = std::make_shared<std::vector<uint8_t>>(batch * slot_size);
+  }
+
+  /**
+   * @brief datagrams may be copied to other threads, and released there. use_count() is a relaxed
+   *
+   * load, the fence orders their last reads of the block before we write it again.
+   */
+  static bool Unshared(const Block& b) {
+    if (b.use_count() != 1) {
+      return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+  }
+
   void HandleWrite(const asio::error_code& ec, std::size_t size) {
     if (stopped) {
       return;
@@ -106,12 +643,41 @@ class UdpSocket::Private : public std::enable_shared_from_this<Private> {
     return "UdpSocket";
   }
 
-  UdpSocket*                 q = nullptr;
-  asio::ip::udp::socket      socket;
-  std::array<uint8_t, 65535> recv_buffer;
-  asio::ip::udp::endpoint    remote;
-  bool                       stopped = true;
-  bool                       close_called = false;
+  UdpSocket*                    q = nullptr;
+  asio::ip::udp::socket         socket;
+  std::array<uint8_t, 65535>    recv_buffer;
+  asio::ip::udp::endpoint       remote;
+  bool                          stopped = true;
+  bool                          close_called = false;
+  /// counts Open, a batch being emitted stops if the socket is reopened by a slot
+  uint64_t                      opened = 0;
+  /// the protocol the socket was opened with
+  Protocol                      protocol = Protocol::kIpv4;
+  /// datagrams per batch receive, 1 means off
+  std::size_t                   batch = 1;
+  std::size_t                   slot_size = 65535;
+  /// SO_TIMESTAMPNS is on, datagrams are received by recvmmsg only
+  bool                          timestamps = false;
+  /// the block the next batch is received into, and the free or still viewed ones
+  Block                         block;
+  std::vector<Block>            pool;
+  std::vector<Datagram>         datagrams;
+  /// queue datagrams and flush them together, see QueueSend
+  bool                          batch_send = false;
+  bool                          segment_offload = false;
+  bool                          flush_scheduled = false;
+  /// the head of send_queue is being sent by asio
+  bool                          sending = false;
+  std::deque<Outgoing>          send_queue;
+#if defined(__linux__)
+  std::vector<mmsghdr>          msgs;
+  std::vector<iovec>            iovs;
+  std::vector<Control>          controls;
+  std::vector<mmsghdr>          recv_msgs;
+  std::vector<iovec>            recv_iovs;
+  std::vector<sockaddr_storage> addrs;
+  std::vector<TimestampControl> timestamp_controls;
+#endif
 };
 
 UdpSocket::UdpSocket(Object* parent) : Object(parent), d(std::make_shared<Private>(this)) {
@@ -123,10 +689,17 @@ UdpSocket::~UdpSocket() {
 }
 
 void UdpSocket::Open(spiderweb::ErrorCode& ec) {
+  Open(Protocol::kIpv4, ec);
+}
+
+void UdpSocket::Open(Protocol protocol, spiderweb::ErrorCode& ec) {
   SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::Open);
-  (void)d->socket.open(udp::v4(), ec);
+  (void)d->socket.open(protocol == Protocol::kIpv6 ? udp::v6() : udp::v4(), ec);
   if (!ec) {
+    ++d->opened;
+    d->protocol = protocol;
     d->stopped = false;
+    d->timestamps = false;
   }
 }
 
@@ -153,7 +726,124 @@ void UdpSocket::Bind(const EndPoint& endpoint, spiderweb::ErrorCode& ec) {
 
 void UdpSocket::SendTo(const EndPoint& endpoint, const uint8_t* data, std::size_t size) {
   SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::Write);
-  d->SendTo(endpoint, data, size);
+  d->SendTo(endpoint, io::SharedSlice(std::vector<uint8_t>(data, data + size)));
+}
+
+void UdpSocket::SendTo(const EndPoint& endpoint, std::vector<uint8_t>&& data) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::Write);
+  d->SendTo(endpoint, io::SharedSlice(std::move(data)));
+}
+
+void UdpSocket::SendTo(const EndPoint& endpoint, io::SharedSlice data) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::Write);
+  d->SendTo(endpoint, std::move(data));
+}
+
+void UdpSocket::SetBatchSend(bool flag) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::SetBatchSend);
+  d->batch_send = flag;
+}
+
+void UdpSocket::SetSegmentOffload(bool flag) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::SetSegmentOffload);
+  d->segment_offload = flag;
+}
+
+void UdpSocket::SetBatchReceive(std::size_t batch, std::size_t max_datagram_size) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::SetBatchReceive);
+  d->SetBatchReceive(batch, max_datagram_size);
+}
+
+void UdpSocket::SetReuseAddress(bool flag, spiderweb::ErrorCode& ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::SetReuseAddress);
+  (void)d->socket.set_option(udp::socket::reuse_address(flag), ec);
+}
+
+void UdpSocket::SetReusePort(bool flag, spiderweb::ErrorCode& ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::SetReusePort);
+#if defined(SO_REUSEPORT)
+  (void)d->socket.set_option(Private::ReusePort(flag), ec);
+#else
+  (void)flag;
+  ec = InvalidArgument("SO_REUSEPORT not supported");
+#endif
+}
+
+void UdpSocket::SetReceiveBufferSize(int size, spiderweb::ErrorCode& ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::SetReceiveBufferSize);
+  (void)d->socket.set_option(udp::socket::receive_buffer_size(size), ec);
+}
+
+int UdpSocket::ReceiveBufferSize(spiderweb::ErrorCode& ec) const {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::ReceiveBufferSize);
+  udp::socket::receive_buffer_size option;
+  (void)d->socket.get_option(option, ec);
+  return option.value();
+}
+
+void UdpSocket::SetSendBufferSize(int size, spiderweb::ErrorCode& ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::SetSendBufferSize);
+  (void)d->socket.set_option(udp::socket::send_buffer_size(size), ec);
+}
+
+int UdpSocket::SendBufferSize(spiderweb::ErrorCode& ec) const {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::SendBufferSize);
+  udp::socket::send_buffer_size option;
+  (void)d->socket.get_option(option, ec);
+  return option.value();
+}
+
+void UdpSocket::SetBusyPoll(int usec, spiderweb::ErrorCode& ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::SetBusyPoll);
+#if defined(SO_BUSY_POLL)
+  (void)d->socket.set_option(Private::BusyPoll(usec), ec);
+#else
+  (void)usec;
+  ec = InvalidArgument("SO_BUSY_POLL not supported");
+#endif
+}
+
+void UdpSocket::SetReceiveTimestamps(bool flag, spiderweb::ErrorCode& ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::SetReceiveTimestamps);
+#if defined(__linux__)
+  (void)d->socket.set_option(Private::Timestamps(flag), ec);
+  if (!ec) {
+    /**
+     * @brief a pending read completes as before, the next one is a timestamped read
+     */
+    d->timestamps = flag;
+  }
+#else
+  (void)flag;
+  ec = InvalidArgument("SO_TIMESTAMPNS not supported");
+#endif
+}
+
+void UdpSocket::JoinMulticastGroup(const std::string& group, const std::string& local,
+                                   spiderweb::ErrorCode& ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::JoinMulticastGroup);
+  d->SetGroupOption<asio::ip::multicast::join_group>(group, local, ec);
+}
+
+void UdpSocket::LeaveMulticastGroup(const std::string& group, const std::string& local,
+                                    spiderweb::ErrorCode& ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::LeaveMulticastGroup);
+  d->SetGroupOption<asio::ip::multicast::leave_group>(group, local, ec);
+}
+
+void UdpSocket::SetMulticastInterface(const std::string& local, spiderweb::ErrorCode& ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::SetMulticastInterface);
+  d->SetMulticastInterface(local, ec);
+}
+
+void UdpSocket::SetMulticastLoopback(bool flag, spiderweb::ErrorCode& ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::SetMulticastLoopback);
+  (void)d->socket.set_option(asio::ip::multicast::enable_loopback(flag), ec);
+}
+
+void UdpSocket::SetMulticastHops(int hops, spiderweb::ErrorCode& ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdpSocket::SetMulticastHops);
+  (void)d->socket.set_option(asio::ip::multicast::hops(hops), ec);
 }
 
 }  // namespace net
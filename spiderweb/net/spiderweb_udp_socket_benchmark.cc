@@ -0,0 +1,86 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "core/internal/asio_cast.h"
+#include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/net/spiderweb_udp_socket.h"
+
+/**
+ * @brief a loopback udp socket which is never read, so the datagrams sent to it are dropped
+ *
+ * once its buffer is full, the sender is not slowed down by a reader.
+ */
+static int BindSink(uint16_t port) {
+  const int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0) {
+    return -1;
+  }
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+/**
+ * @brief 64 bytes datagrams sent per second by a UdpSocket:
+ *
+ * 0: one async_send_to per datagram, 1: SetBatchSend(sendmmsg), 2: and SetSegmentOffload
+ */
+static void BM_UdpSendPps(benchmark::State& state) {
+  static constexpr uint16_t    kPort = 12420;
+  static constexpr std::size_t kBurst = 256;
+  static constexpr std::size_t kSize = 64;
+
+  const auto mode = state.range(0);
+  const int  sink = BindSink(kPort);
+  if (sink < 0) {
+    state.SkipWithError("bind failed");
+    return;
+  }
+
+  spiderweb::EventLoop      loop;
+  spiderweb::net::UdpSocket socket;
+  spiderweb::ErrorCode      ec;
+  std::size_t               written = 0;
+
+  socket.SetBatchSend(mode >= 1);
+  socket.SetSegmentOffload(mode >= 2);
+  socket.Open(ec);
+  spiderweb::Object::Connect(&socket, &spiderweb::net::UdpSocket::BytesWritten, &socket,
+                             [&](std::size_t size) { written += size; });
+  spiderweb::Object::Connect(&socket, &spiderweb::net::UdpSocket::Error, &socket,
+                             [&](const std::error_code& e) { ec.SetErrorCode(e); });
+
+  const spiderweb::net::EndPoint endpoint("127.0.0.1", kPort);
+  auto&                          io = spiderweb::AsioService(&loop);
+  std::size_t                    target = 0;
+  for (auto _ : state) {
+    for (std::size_t i = 0; i < kBurst; ++i) {
+      socket.SendTo(endpoint, std::vector<uint8_t>(kSize, 'x'));
+    }
+
+    target += kBurst * kSize;
+    while (written < target && !ec) {
+      io.run_one();
+    }
+  }
+  if (ec) {
+    state.SkipWithError(ec.message().c_str());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * kBurst));
+
+  socket.Close();
+  ::close(sink);
+}
+BENCHMARK(BM_UdpSendPps)->Arg(0)->Arg(1)->Arg(2);
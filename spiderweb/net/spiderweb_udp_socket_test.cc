@@ -4,6 +4,10 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <string>
+#include <vector>
+
 #include "spiderweb/core/spiderweb_eventloop.h"
 #include "spiderweb/core/spiderweb_notify_spy.h"
 
@@ -52,6 +56,287 @@ TEST_F(UdpTest, ClientSendServerRecv) {
   EXPECT_THAT(datagram.Data(), testing::ElementsAre('a', 'b', 'c'));
 }
 
+TEST_F(UdpTest, BatchReceive) {
+  UdpSocket receiver;
+  receiver.SetBatchReceive(8, 16);
+  receiver.Open(ec);
+  receiver.Bind(EndPoint("127.0.0.1", 9997), ec);
+  ASSERT_FALSE(ec) << ec.FormatedMessage();
+
+  NotifySpy                spy(&receiver, &UdpSocket::DatagramArrived);
+  std::vector<std::string> received;
+  std::size_t              batches = 0;
+  Object::Connect(&receiver, &UdpSocket::DatagramBatchArrived, &receiver,
+                  [&](absl::Span<const Datagram> batch) {
+                    ++batches;
+                    for (const auto& datagram : batch) {
+                      auto bytes = datagram.Bytes();
+                      received.emplace_back(bytes.begin(), bytes.end());
+                    }
+                  });
+
+  UdpSocket client;
+  client.Open(ec);
+  for (int i = 0; i < 20; ++i) {
+    const auto data = std::to_string(i);
+    client.SendTo(EndPoint("127.0.0.1", 9997), reinterpret_cast<const uint8_t*>(data.data()),
+                  data.size());
+  }
+
+  spy.Wait(3000, 20);
+  EXPECT_EQ(spy.Count(), 20);
+  ASSERT_EQ(received.size(), 20);
+  EXPECT_EQ(received.front(), "0");
+  EXPECT_EQ(received.back(), "19");
+  EXPECT_LE(batches, 20);
+}
+
+TEST_F(UdpTest, PooledDatagramData) {
+  UdpSocket receiver;
+  receiver.SetBatchReceive(4, 16);
+  receiver.Open(ec);
+  receiver.Bind(EndPoint("127.0.0.1", 9996), ec);
+  ASSERT_FALSE(ec) << ec.FormatedMessage();
+
+  NotifySpy spy(&receiver, &UdpSocket::DatagramArrived);
+  Datagram  kept;
+  Object::Connect(&receiver, &UdpSocket::DatagramBatchArrived, &receiver,
+                  [&](absl::Span<const Datagram> batch) {
+                    EXPECT_TRUE(batch[0].Data().empty());
+                    kept = batch[0];
+                  });
+
+  UdpSocket client;
+  client.Open(ec);
+  client.SendTo(EndPoint("127.0.0.1", 9996), reinterpret_cast<const uint8_t*>("abc"), 3);
+
+  spy.Wait();
+  ASSERT_EQ(spy.Count(), 1);
+
+  /**
+   * @brief the datagram of DatagramArrived owns a copy of its bytes
+   */
+  const auto datagram = std::get<0>(spy.LastResult<Datagram>());
+  EXPECT_THAT(datagram.Data(), testing::ElementsAre('a', 'b', 'c'));
+
+  /**
+   * @brief the datagram kept from the batch outlives it, and still views its block
+   */
+  EXPECT_EQ(kept.Bytes().size(), 3);
+  EXPECT_THAT(kept.Data(), testing::ElementsAre('a', 'b', 'c'));
+}
+
+TEST_F(UdpTest, DeleteInBatchSlot) {
+  auto* receiver = new UdpSocket();
+  receiver->SetBatchReceive(8, 16);
+  receiver->Open(ec);
+  receiver->Bind(EndPoint("127.0.0.1", 9995), ec);
+  ASSERT_FALSE(ec) << ec.FormatedMessage();
+
+  UdpSocket client;
+  client.Open(ec);
+  for (int i = 0; i < 4; ++i) {
+    client.SendTo(EndPoint("127.0.0.1", 9995), reinterpret_cast<const uint8_t*>("abc"), 3);
+  }
+
+  /**
+   * @brief the rest of the batch is not emitted by the deleted socket
+   */
+  NotifySpy spy(&client, &UdpSocket::Error);
+  int       arrived = 0;
+  Object::Connect(receiver, &UdpSocket::DatagramArrived, &client, [&](const Datagram&) {
+    ++arrived;
+    delete receiver;
+  });
+
+  spy.Wait(300);
+  EXPECT_EQ(arrived, 1);
+}
+
+TEST_F(UdpTest, SendOwnedData) {
+  UdpSocket client;
+  NotifySpy spy(&server.socket, &UdpSocket::DatagramArrived);
+
+  client.Open(ec);
+  client.SendTo(EndPoint("127.0.0.1", 9998), std::vector<uint8_t>{'a', 'b', 'c'});
+  client.SendTo(EndPoint("127.0.0.1", 9998), io::SharedSlice(std::vector<uint8_t>{'x', 'y'}));
+
+  spy.Wait(3000, 2);
+  ASSERT_EQ(spy.Count(), 2);
+  EXPECT_THAT(std::get<0>(spy.LastResult<Datagram>()).Data(), testing::ElementsAre('x', 'y'));
+}
+
+/**
+ * @brief sends `sizes` by a batch sending client, and returns the sizes received
+ */
+static std::vector<std::size_t> BatchSendReceive(UdpSocket* server_socket, uint16_t port,
+                                                 const std::vector<std::size_t>& sizes,
+                                                 bool segment_offload) {
+  NotifySpy                spy(server_socket, &UdpSocket::DatagramArrived);
+  std::vector<std::size_t> received;
+  Object::Connect(server_socket, &UdpSocket::DatagramArrived, server_socket,
+                  [&](const Datagram& datagram) { received.push_back(datagram.Bytes().size()); });
+
+  ErrorCode ec;
+  UdpSocket client;
+  NotifySpy written(&client, &UdpSocket::BytesWritten);
+  client.SetBatchSend(true);
+  client.SetSegmentOffload(segment_offload);
+  client.Open(ec);
+
+  std::size_t total = 0;
+  for (auto size : sizes) {
+    client.SendTo(EndPoint("127.0.0.1", port), std::vector<uint8_t>(size, 'x'));
+    total += size;
+  }
+
+  spy.Wait(3000, sizes.size());
+
+  std::size_t bytes = 0;
+  for (uint32_t i = 0; i < written.Count(); ++i) {
+    bytes += std::get<0>(written.ResultAt<std::size_t>(i));
+  }
+  EXPECT_EQ(bytes, total);
+  /**
+   * @brief all of them are queued in one loop iteration, and flushed at once
+   */
+  EXPECT_EQ(written.Count(), 1);
+  return received;
+}
+
+TEST_F(UdpTest, BatchSend) {
+  const std::vector<std::size_t> sizes{1, 20, 300, 4000, 5, 6, 7};
+  EXPECT_EQ(BatchSendReceive(&server.socket, 9998, sizes, false), sizes);
+}
+
+TEST_F(UdpTest, BatchSendSegmentOffload) {
+  /**
+   * @brief equal sizes are sent as segments, the last one may be shorter, then a new message
+   */
+  const std::vector<std::size_t> sizes{100, 100, 100, 100, 50, 100, 100, 200};
+  EXPECT_EQ(BatchSendReceive(&server.socket, 9998, sizes, true), sizes);
+}
+
+TEST_F(UdpTest, Ipv6) {
+  UdpSocket receiver;
+  receiver.Open(UdpSocket::Protocol::kIpv6, ec);
+  ASSERT_FALSE(ec) << ec.FormatedMessage();
+  receiver.Bind(EndPoint("::1", 9995), ec);
+  if (ec) {
+    GTEST_SKIP() << "no ipv6 loopback, " << ec.FormatedMessage();
+  }
+
+  NotifySpy spy(&receiver, &UdpSocket::DatagramArrived);
+  UdpSocket client;
+  client.Open(UdpSocket::Protocol::kIpv6, ec);
+
+  /**
+   * @brief an ipv6 socket takes the interface by name, even before it is bound
+   */
+  client.SetMulticastInterface("lo", ec);
+  EXPECT_FALSE(ec) << ec.FormatedMessage();
+  client.SetMulticastInterface("127.0.0.1", ec);
+  EXPECT_TRUE(ec);
+
+  client.SendTo(EndPoint("::1", 9995), reinterpret_cast<const uint8_t*>("v6"), 2);
+
+  spy.Wait();
+  ASSERT_EQ(spy.Count(), 1);
+  auto datagram = std::get<0>(spy.LastResult<Datagram>());
+  EXPECT_TRUE(datagram.GetEndPoint().IsIpv6());
+  EXPECT_THAT(datagram.Data(), testing::ElementsAre('v', '6'));
+}
+
+TEST_F(UdpTest, SocketOptions) {
+  UdpSocket socket;
+
+  socket.SetReceiveBufferSize(1 << 14, ec);
+  EXPECT_TRUE(ec) << "not opened";
+
+  socket.Open(ec);
+  socket.SetReuseAddress(true, ec);
+  EXPECT_FALSE(ec) << ec.FormatedMessage();
+  socket.SetReusePort(true, ec);
+  EXPECT_FALSE(ec) << ec.FormatedMessage();
+
+  /**
+   * @brief linux doubles the size for its bookkeeping
+   */
+  socket.SetReceiveBufferSize(1 << 14, ec);
+  EXPECT_FALSE(ec) << ec.FormatedMessage();
+  EXPECT_GE(socket.ReceiveBufferSize(ec), 1 << 14);
+  socket.SetSendBufferSize(1 << 14, ec);
+  EXPECT_FALSE(ec) << ec.FormatedMessage();
+  EXPECT_GE(socket.SendBufferSize(ec), 1 << 14);
+
+  socket.SetBusyPoll(0, ec);
+  EXPECT_FALSE(ec) << ec.FormatedMessage();
+  socket.SetMulticastLoopback(true, ec);
+  EXPECT_FALSE(ec) << ec.FormatedMessage();
+  socket.SetMulticastHops(1, ec);
+  EXPECT_FALSE(ec) << ec.FormatedMessage();
+  socket.SetMulticastInterface("no such interface", ec);
+  EXPECT_TRUE(ec);
+}
+
+TEST_F(UdpTest, Multicast) {
+  UdpSocket receiver;
+  receiver.Open(ec);
+  receiver.SetReuseAddress(true, ec);
+  receiver.Bind(EndPoint("0.0.0.0", 9994), ec);
+  ASSERT_FALSE(ec) << ec.FormatedMessage();
+
+  receiver.JoinMulticastGroup("not a group", "", ec);
+  EXPECT_TRUE(ec);
+  receiver.JoinMulticastGroup("239.255.0.17", "127.0.0.1", ec);
+  if (ec) {
+    GTEST_SKIP() << "no multicast on loopback, " << ec.FormatedMessage();
+  }
+
+  NotifySpy spy(&receiver, &UdpSocket::DatagramArrived);
+  UdpSocket client;
+  client.Open(ec);
+  client.SetMulticastLoopback(true, ec);
+  client.SetMulticastInterface("127.0.0.1", ec);
+  EXPECT_FALSE(ec) << ec.FormatedMessage();
+  client.SendTo(EndPoint("239.255.0.17", 9994), reinterpret_cast<const uint8_t*>("mc"), 2);
+
+  spy.Wait();
+  ASSERT_EQ(spy.Count(), 1);
+  EXPECT_THAT(std::get<0>(spy.LastResult<Datagram>()).Data(), testing::ElementsAre('m', 'c'));
+
+  receiver.LeaveMulticastGroup("239.255.0.17", "127.0.0.1", ec);
+  EXPECT_FALSE(ec) << ec.FormatedMessage();
+}
+
+TEST_F(UdpTest, ReceiveTimestamps) {
+  UdpSocket receiver;
+  receiver.SetBatchReceive(4, 16);
+  receiver.Open(ec);
+  receiver.SetReceiveTimestamps(true, ec);
+  ASSERT_FALSE(ec) << ec.FormatedMessage();
+  receiver.Bind(EndPoint("127.0.0.1", 9993), ec);
+  ASSERT_FALSE(ec) << ec.FormatedMessage();
+
+  NotifySpy spy(&receiver, &UdpSocket::DatagramArrived);
+  UdpSocket client;
+  client.Open(ec);
+
+  const auto before = std::chrono::system_clock::now().time_since_epoch();
+  for (int i = 0; i < 10; ++i) {
+    client.SendTo(EndPoint("127.0.0.1", 9993), reinterpret_cast<const uint8_t*>("ts"), 2);
+  }
+
+  spy.Wait(3000, 10);
+  ASSERT_EQ(spy.Count(), 10);
+  for (int i = 0; i < 10; ++i) {
+    auto datagram = std::get<0>(spy.ResultAt<Datagram>(i));
+    EXPECT_THAT(datagram.Data(), testing::ElementsAre('t', 's'));
+    EXPECT_GE(datagram.TimeStamp(), before);
+    EXPECT_LT(datagram.TimeStamp(), before + std::chrono::seconds(10));
+  }
+}
+
 TEST_F(UdpTest, OpenClose) {
   {
     UdpServer serve1(30001);
@@ -38,5 +38,16 @@ void UdsServer::Stop() {
   spider_emit Stopped(std::move(ec));
 }
 
+void UdsServer::SetEventLoopGroup(EventLoopGroup* group) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsServer::SetEventLoopGroup);
+  d->group = group;
+}
+
+void UdsServer::SetSeqPacket(bool flag, std::size_t max_message_size) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsServer::SetSeqPacket);
+  d->seqpacket = flag;
+  d->max_message_size = max_message_size;
+}
+
 }  // namespace net
 }  // namespace spiderweb
@@ -1,9 +1,17 @@
 #include "spiderweb/net/spiderweb_uds_server.h"
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <ghc/filesystem.hpp>
+#include <thread>
+#include <vector>
 
+#include "asio.hpp"
+#include "core/internal/asio_cast.h"
 #include "gtest/gtest.h"
 #include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_eventloop_group.h"
 #include "spiderweb/core/spiderweb_notify_spy.h"
 #include "spiderweb/core/spiderweb_object.h"
 #include "spiderweb/net/spiderweb_uds_socket.h"
@@ -44,6 +52,110 @@ TEST(spiderweb_uds_server, Accept) {
   loop.ExecEx();
 }
 
+/**
+ * @brief InComingConnection is only emitted in the thread of the server, the connections accepted
+ *
+ * for the group loops after it is destroyed are deleted there.
+ */
+TEST(spiderweb_uds_server, DestroyWhileAcceptingOnEventLoopGroup) {
+  EventLoop      loop;
+  EventLoopGroup group(2);
+  auto*          server = new net::UdsServer();
+
+  group.Start();
+  server->SetEventLoopGroup(&group);
+  auto ec = server->ListenAndServ(kSockPath);
+  ASSERT_FALSE(ec) << ec.FormatedMessage();
+
+  const auto       server_thread = std::this_thread::get_id();
+  std::atomic<int> incoming{0};
+  Object::Connect(server, &net::UdsServer::InComingConnection, server, [&](net::UdsSocket* s) {
+    EXPECT_EQ(std::this_thread::get_id(), server_thread);
+    incoming.fetch_add(1);
+    s->DeleteLater();
+  });
+
+  std::atomic<bool> stop{false};
+  std::thread       connector([&stop]() {
+    while (!stop.load()) {
+      asio::io_context                     io;
+      asio::local::stream_protocol::socket socket(io);
+      asio::error_code                     connect_ec;
+      socket.connect(asio::local::stream_protocol::endpoint(kSockPath), connect_ec);
+    }
+  });
+
+  auto&      io = AsioService(&loop);
+  const auto run = [&io](std::chrono::milliseconds duration, const std::function<bool()>& done) {
+    const auto deadline = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < deadline && !done()) {
+      io.run_one_for(std::chrono::milliseconds(1));
+    }
+  };
+  run(std::chrono::milliseconds(3000), [&incoming]() { return incoming.load() >= 5; });
+  delete server;
+  run(std::chrono::milliseconds(50), []() { return false; });
+
+  stop = true;
+  connector.join();
+  EXPECT_GT(incoming.load(), 0);
+}
+
+/**
+ * @brief the bytes sent right at connect time reach the slots connected from the loop of the
+ *
+ * socket, see the test of TcpServer
+ */
+TEST(spiderweb_uds_server, NoBytesLostAtAcceptOnEventLoopGroup) {
+  static constexpr int         kClients = 8;
+  static constexpr std::size_t kSize = 5;
+
+  EventLoop      loop;
+  EventLoopGroup group(2);
+  net::UdsServer server;
+
+  group.Start();
+  server.SetEventLoopGroup(&group);
+  auto ec = server.ListenAndServ(kSockPath);
+  ASSERT_FALSE(ec) << ec.FormatedMessage();
+
+  std::atomic<std::size_t>     received{0};
+  std::vector<net::UdsSocket*> accepted;
+  Object::Connect(&server, &net::UdsServer::InComingConnection, &server, [&](net::UdsSocket* s) {
+    accepted.push_back(s);
+    s->ownerEventLoop()->QueueTask([s, &received]() {
+      Object::Connect(s, &net::UdsSocket::BytesRead, s,
+                      [&received](const io::BufferReader& reader) {
+                        received += reader.Len();
+                        reader.Skip(static_cast<uint32_t>(reader.Len()));
+                      });
+    });
+  });
+
+  asio::io_context                                  io;
+  std::vector<asio::local::stream_protocol::socket> clients;
+  for (int i = 0; i < kClients; ++i) {
+    clients.emplace_back(io);
+    clients.back().connect(asio::local::stream_protocol::endpoint(kSockPath));
+    asio::write(clients.back(), asio::buffer("hello", kSize));
+  }
+
+  auto& service = AsioService(&loop);
+  for (int i = 0; i < 3000 && received.load() < kClients * kSize; ++i) {
+    service.run_one_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(received.load(), kClients * kSize);
+  EXPECT_EQ(accepted.size(), kClients);
+
+  for (auto* s : accepted) {
+    s->DeleteLater();
+  }
+  server.Stop();
+
+  loop.Quit();
+  loop.ExecEx();
+}
+
 TEST(spiderweb_uds_server, ListenAndServFailed) {
   EventLoop      loop;
   net::UdsServer server;
@@ -1,5 +1,7 @@
 #include "spiderweb/net/spiderweb_uds_socket.h"
 
+#include <algorithm>
+
 #include "io/private/spiderweb_stream_private.h"
 #include "net/private/spiderweb_uds_socket_private.h"
 #include "spiderweb/core/internal/thread_check.h"
@@ -8,6 +10,8 @@
 namespace spiderweb {
 namespace net {
 
+constexpr std::size_t UdsSocket::Private::kMaxFds;
+
 UdsSocket::UdsSocket(Object* parent)
     : Object(parent), d(std::make_shared<io::IoPrivate<Private>>(this)) {
 }
@@ -25,6 +29,18 @@ void UdsSocket::SetSendBufferSize(uint16_t size) {
   d->impl.send_buffer_size = size;
 }
 
+void UdsSocket::SetSeqPacket(bool flag, std::size_t max_message_size) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::SetSeqPacket);
+  d->impl.seqpacket = flag;
+  d->impl.max_message_size = max_message_size;
+  d->min_read_size = flag ? max_message_size : io::IoPrivate<Private>::kSpaceGrowSize;
+  d->read_size = std::max(d->read_size, d->min_read_size);
+}
+
+bool UdsSocket::IsSeqPacket() const {
+  return d->impl.seqpacket;
+}
+
 void UdsSocket::ConnectTo(const std::string& uds_address) {
   SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::ConnectTo);
 
@@ -52,14 +68,106 @@ std::string UdsSocket::StringAddress() const {
   return endpoint.path();
 }
 
+/**
+ * @brief copied writes are coalesced in the send queue, the ones of a seqpacket socket are queued
+ *
+ * as buffers of their own, every buffer is a message.
+ */
 void UdsSocket::Write(const uint8_t* data, std::size_t size) {
   SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::Write);
+  if (d->impl.seqpacket) {
+    d->StartWrite(d->impl.socket, std::vector<uint8_t>(data, data + size));
+    return;
+  }
   d->StartWrite(d->impl.socket, data, size);
 }
 
 void UdsSocket::Write(const std::vector<uint8_t>& data) {
   SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::Write);
-  d->StartWrite(d->impl.socket, data);
+  Write(data.data(), data.size());
+}
+
+void UdsSocket::Write(std::vector<uint8_t>&& data) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::Write);
+  d->StartWrite(d->impl.socket, std::move(data));
+}
+
+void UdsSocket::Write(io::SharedSlice slice) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::Write);
+  d->StartWrite(d->impl.socket, std::move(slice));
+}
+
+ErrorCode UdsSocket::WriteWithFds(std::vector<uint8_t>&& data, const std::vector<int>& fds) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::WriteWithFds);
+  if (d->stopped || data.empty() || fds.size() > Private::kMaxFds) {
+    return MakeErrorCode(ErrC::kInvalidArgument);
+  }
+
+  ErrorCode ec;
+  if (!fds.empty()) {
+    ec.SetErrorCode(d->impl.QueueFds(fds, d->send_queue.Len()));
+    if (ec) {
+      return ec;
+    }
+  }
+  d->StartWrite(d->impl.socket, std::move(data));
+  return ec;
+}
+
+std::vector<int> UdsSocket::TakeReceivedFds() {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::TakeReceivedFds);
+  return d->impl.TakeReceivedFds();
+}
+
+void UdsSocket::SetWriteBufferWatermarks(std::size_t high, std::size_t low) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::SetWriteBufferWatermarks);
+  d->SetWriteWatermarks(high, low);
+}
+
+std::size_t UdsSocket::WriteBufferSize() const {
+  return d->send_queue.Len();
+}
+
+void UdsSocket::PauseReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::PauseReading);
+  d->PauseRead();
+}
+
+void UdsSocket::ResumeReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::ResumeReading);
+  d->ResumeRead(d->impl.socket);
+}
+
+void UdsSocket::ContinueReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::ContinueReading);
+  d->RestartRead(d->impl.socket);
+}
+
+bool UdsSocket::IsReadingPaused() const {
+  return d->IsReadPaused();
+}
+
+void UdsSocket::SetMaxReadBufferSize(std::size_t size) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::SetMaxReadBufferSize);
+  d->max_read_buffer = size;
+}
+
+std::size_t UdsSocket::ReadBufferSize() const {
+  return d->recv_buffer.Len();
+}
+
+int UdsSocket::NativeHandle() const {
+  return static_cast<int>(d->impl.socket.native_handle());
+}
+
+void UdsSocket::ReleaseReading(std::function<void(const std::error_code&)> released) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::ReleaseReading);
+  d->ReleaseRead(std::move(released));
+}
+
+void UdsSocket::SetDrainReads(bool flag) {
+  SPIDERWEB_CALL_THREAD_CHECK(UdsSocket::SetDrainReads);
+  d->drain_reads = flag;
 }
 
 }  // namespace net
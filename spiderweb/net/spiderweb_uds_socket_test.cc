@@ -0,0 +1,258 @@
+#include "spiderweb/net/spiderweb_uds_socket.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "core/internal/asio_cast.h"
+#include "gtest/gtest.h"
+#include "spiderweb/core/spiderweb_eventloop.h"
+#include "spiderweb/core/spiderweb_notify_spy.h"
+#include "spiderweb/net/spiderweb_uds_server.h"
+
+namespace {
+using spiderweb::net::UdsServer;
+using spiderweb::net::UdsSocket;
+
+/**
+ * @brief the socket file of a test, unlinked when the test ends
+ */
+class SockPath {
+ public:
+  explicit SockPath(const char* name)
+      : path_(std::string("/tmp/spiderweb_uds_") + name + "_" + std::to_string(::getpid()) +
+              ".sock") {
+  }
+
+  ~SockPath() {
+    ::unlink(path_.c_str());
+  }
+
+  SockPath(const SockPath&) = delete;
+
+  SockPath& operator=(const SockPath&) = delete;
+
+  operator const std::string&() const {  // NOLINT
+    return path_;
+  }
+
+ private:
+  std::string path_;
+};
+
+/**
+ * @brief keeps the first accepted socket, what it receives, and the fds received with it
+ */
+class UdsPeer {
+ public:
+  UdsPeer() {
+    spiderweb::Object::Connect(&server, &UdsServer::InComingConnection, &server,
+                               [this](UdsSocket* s) { Watch(s); });
+  }
+
+  void Watch(UdsSocket* s) {
+    socket = s;
+    spiderweb::Object::Connect(s, &UdsSocket::BytesRead, s,
+                               [this](const spiderweb::io::BufferReader& reader) {
+                                 std::string data(reader.Len(), '\0');
+                                 reader.Read(&data[0], data.size());
+                                 received += data;
+                               });
+    spiderweb::Object::Connect(s, &UdsSocket::MessageRead, s,
+                               [this](absl::Span<const uint8_t> message) {
+                                 messages.emplace_back(message.begin(), message.end());
+                               });
+    spiderweb::Object::Connect(s, &UdsSocket::FdsReceived, s, [this, s](std::size_t) {
+      const auto taken = s->TakeReceivedFds();
+      fds.insert(fds.end(), taken.begin(), taken.end());
+      fds_at.push_back(received.size() + messages.size());
+    });
+  }
+
+  ~UdsPeer() {
+    for (const int fd : fds) {
+      ::close(fd);
+    }
+  }
+
+  UdsServer                server;
+  UdsSocket*               socket = nullptr;
+  std::string              received;
+  std::vector<std::string> messages;
+  std::vector<int>         fds;
+  /// what had been received when fds arrived
+  std::vector<std::size_t> fds_at;
+};
+
+void RunUds(spiderweb::EventLoop& loop, const std::function<bool()>& done) {
+  auto& io = spiderweb::AsioService(&loop);
+  for (int i = 0; i < 300 && !done(); ++i) {
+    io.run_one_for(std::chrono::milliseconds(10));
+  }
+}
+
+std::vector<uint8_t> Bytes(const std::string& s) {
+  return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+std::string ReadFd(int fd) {
+  char       buffer[64];
+  const auto n = ::pread(fd, buffer, sizeof(buffer), 0);
+  return n > 0 ? std::string(buffer, static_cast<std::size_t>(n)) : std::string();
+}
+}  // namespace
+
+TEST(UdsSocket, PassMemfd) {
+  const SockPath       path("memfd");
+  spiderweb::EventLoop loop;
+  UdsPeer              peer;
+  ASSERT_FALSE(peer.server.ListenAndServ(path));
+
+  UdsSocket            client;
+  spiderweb::NotifySpy connected(&client, &UdsSocket::ConnectionEstablished);
+  client.ConnectTo(path);
+  connected.Wait();
+
+  const int memfd = ::memfd_create("spiderweb_payload", MFD_CLOEXEC);
+  ASSERT_GE(memfd, 0);
+  ASSERT_EQ(::write(memfd, "payload", 7), 7);
+
+  ASSERT_FALSE(client.WriteWithFds(Bytes("m"), {memfd}));
+  /**
+   * @brief the fds are duplicated, ours can be closed at once
+   */
+  ::close(memfd);
+
+  RunUds(loop, [&]() { return peer.received == "m"; });
+  EXPECT_EQ(peer.received, "m");
+  ASSERT_EQ(peer.fds.size(), 1);
+  EXPECT_EQ(ReadFd(peer.fds[0]), "payload");
+  EXPECT_TRUE(client.TakeReceivedFds().empty());
+}
+
+TEST(UdsSocket, TooManyFds) {
+  const SockPath       path("too_many");
+  spiderweb::EventLoop loop;
+  UdsPeer              peer;
+  ASSERT_FALSE(peer.server.ListenAndServ(path));
+
+  UdsSocket            client;
+  spiderweb::NotifySpy connected(&client, &UdsSocket::ConnectionEstablished);
+  client.ConnectTo(path);
+  connected.Wait();
+
+  /**
+   * @brief more than SCM_MAX_FD descriptors can not go with one write, nothing is written
+   */
+  const std::vector<int> fds(254, STDIN_FILENO);
+  EXPECT_EQ(client.WriteWithFds(Bytes("m"), fds),
+            spiderweb::MakeErrorCode(spiderweb::ErrC::kInvalidArgument));
+  EXPECT_EQ(client.WriteBufferSize(), 0);
+}
+
+TEST(UdsSocket, FdsKeepTheirPlaceInTheStream) {
+  const SockPath       path("order");
+  spiderweb::EventLoop loop;
+  UdsPeer              peer;
+  ASSERT_FALSE(peer.server.ListenAndServ(path));
+
+  UdsSocket            client;
+  spiderweb::NotifySpy connected(&client, &UdsSocket::ConnectionEstablished);
+  client.ConnectTo(path);
+  connected.Wait();
+
+  int first[2];
+  int second[2];
+  ASSERT_EQ(::pipe(first), 0);
+  ASSERT_EQ(::pipe(second), 0);
+
+  /**
+   * @brief the fds arrive with the read which has the byte they were written with, the reads
+   *
+   * before do not carry them
+   */
+  client.Write(reinterpret_cast<const uint8_t*>("abc"), 3);
+  ASSERT_FALSE(client.WriteWithFds(Bytes("de"), {first[1]}));
+  client.Write(reinterpret_cast<const uint8_t*>("f"), 1);
+  ASSERT_FALSE(client.WriteWithFds(Bytes("g"), {second[1]}));
+  ::close(first[1]);
+  ::close(second[1]);
+
+  RunUds(loop, [&]() { return peer.received.size() == 7; });
+  EXPECT_EQ(peer.received, "abcdefg");
+  ASSERT_EQ(peer.fds.size(), 2);
+  ASSERT_EQ(peer.fds_at.size(), 2);
+  EXPECT_LE(peer.fds_at[0], 3);
+  EXPECT_LE(peer.fds_at[1], 6);
+
+  ASSERT_EQ(::write(peer.fds[0], "1", 1), 1);
+  ASSERT_EQ(::write(peer.fds[1], "2", 1), 1);
+  char c = 0;
+  ASSERT_EQ(::read(first[0], &c, 1), 1);
+  EXPECT_EQ(c, '1');
+  ASSERT_EQ(::read(second[0], &c, 1), 1);
+  EXPECT_EQ(c, '2');
+  ::close(first[0]);
+  ::close(second[0]);
+}
+
+TEST(UdsSocket, SeqPacketKeepsMessages) {
+  const SockPath       path("seqpacket");
+  spiderweb::EventLoop loop;
+  UdsPeer              peer;
+  peer.server.SetSeqPacket(true);
+  ASSERT_FALSE(peer.server.ListenAndServ(path));
+
+  UdsSocket client;
+  client.SetSeqPacket(true);
+  spiderweb::NotifySpy connected(&client, &UdsSocket::ConnectionEstablished);
+  client.ConnectTo(path);
+  connected.Wait();
+  EXPECT_TRUE(client.IsSeqPacket());
+
+  const std::string big(60 * 1024, 'b');
+  client.Write(reinterpret_cast<const uint8_t*>("one"), 3);
+  client.Write(reinterpret_cast<const uint8_t*>("two"), 3);
+  client.Write(Bytes(big));
+  ASSERT_FALSE(client.WriteWithFds(Bytes("three"), {STDIN_FILENO}));
+
+  RunUds(loop, [&]() { return peer.messages.size() == 4; });
+  ASSERT_EQ(peer.messages.size(), 4);
+  EXPECT_TRUE(peer.received.empty());
+  EXPECT_EQ(peer.messages[0], "one");
+  EXPECT_EQ(peer.messages[1], "two");
+  EXPECT_EQ(peer.messages[2], big);
+  EXPECT_EQ(peer.messages[3], "three");
+  EXPECT_EQ(peer.fds.size(), 1);
+  EXPECT_EQ(peer.fds_at, (std::vector<std::size_t>{3}));
+  ::close(peer.fds[0]);
+  peer.fds.clear();
+}
+
+TEST(UdsSocket, SeqPacketTooLong) {
+  const SockPath       path("too_long");
+  spiderweb::EventLoop loop;
+  UdsPeer              peer;
+  peer.server.SetSeqPacket(true, 16);
+  ASSERT_FALSE(peer.server.ListenAndServ(path));
+
+  UdsSocket client;
+  client.SetSeqPacket(true);
+  spiderweb::NotifySpy connected(&client, &UdsSocket::ConnectionEstablished);
+  client.ConnectTo(path);
+  connected.Wait();
+
+  RunUds(loop, [&]() { return peer.socket != nullptr; });
+  ASSERT_NE(peer.socket, nullptr);
+  std::error_code error;
+  spiderweb::Object::Connect(peer.socket, &UdsSocket::Error, peer.socket,
+                             [&error](const std::error_code& ec) { error = ec; });
+  client.Write(Bytes(std::string(17, 'x')));
+
+  RunUds(loop, [&]() { return static_cast<bool>(error); });
+  EXPECT_EQ(error, asio::error::message_size);
+  EXPECT_TRUE(peer.messages.empty());
+}
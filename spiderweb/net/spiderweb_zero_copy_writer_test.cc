@@ -0,0 +1,111 @@
+#include "spiderweb/net/private/spiderweb_zero_copy_writer.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "asio.hpp"
+#include "gtest/gtest.h"
+
+namespace {
+/**
+ * @brief a loopback connection, and a payload which tells when it is released
+ */
+class ZeroCopyWriterTest : public testing::Test {
+ public:
+  static constexpr std::size_t kSize = 256 * 1024;
+
+  void SetUp() override {
+    asio::ip::tcp::acceptor acceptor(io,
+                                     asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+    client.connect(acceptor.local_endpoint());
+    acceptor.accept(server);
+
+    asio::error_code ec;
+    if (!writer.Enable(client, ec)) {
+      GTEST_SKIP() << "no MSG_ZEROCOPY, " << ec.message();
+    }
+  }
+
+  /**
+   * @brief write a payload, only the writer keeps it, `released` is set when it is freed
+   */
+  void WritePayload(bool* released, uint64_t* completed_at_release) {
+    std::shared_ptr<const std::vector<uint8_t>> payload(
+        new std::vector<uint8_t>(kSize, 'z'), [this, released, completed_at_release](
+                                                  const std::vector<uint8_t>* p) {
+          *released = true;
+          *completed_at_release = writer.CompletedSends();
+          delete p;
+        });
+
+    std::vector<spiderweb::io::SharedSlice> owners{spiderweb::io::SharedSlice(payload)};
+    writer.Write(client, {asio::buffer(*payload)}, std::move(owners),
+                 [this](const asio::error_code& /*ec*/, std::size_t /*size*/) { ++handled; });
+  }
+
+  void RunUntil(const bool& flag) {
+    std::vector<char> sink(kSize);
+    const auto        deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+    while (!flag && std::chrono::steady_clock::now() < deadline) {
+      asio::error_code ec;
+      if (server.available(ec) > 0) {
+        server.read_some(asio::buffer(sink), ec);
+      }
+      io.run_one_for(std::chrono::milliseconds(10));
+    }
+  }
+
+  asio::io_context               io;
+  asio::ip::tcp::socket          client{io};
+  asio::ip::tcp::socket          server{io};
+  spiderweb::net::ZeroCopyWriter writer{client.get_executor()};
+  int                            handled = 0;
+};
+}  // namespace
+
+TEST(ZeroCopyWriter, DoneSendsWrapsAround) {
+  using spiderweb::net::ZeroCopyWriter;
+
+  EXPECT_EQ(ZeroCopyWriter::DoneSends(0, 3, 1, 1), 1);
+  EXPECT_EQ(ZeroCopyWriter::DoneSends(0, 3, 0, 9), 3);
+  EXPECT_EQ(ZeroCopyWriter::DoneSends(5, 3, 0, 4), 0);
+
+  /**
+   * @brief the write, the notification, or both wrap around
+   */
+  EXPECT_EQ(ZeroCopyWriter::DoneSends(UINT32_MAX - 1, 4, UINT32_MAX - 1, 1), 4);
+  EXPECT_EQ(ZeroCopyWriter::DoneSends(UINT32_MAX - 1, 4, UINT32_MAX, 0), 2);
+  EXPECT_EQ(ZeroCopyWriter::DoneSends(1, 3, UINT32_MAX, 2), 2);
+  EXPECT_EQ(ZeroCopyWriter::DoneSends(10, 2, UINT32_MAX - 3, 5), 0);
+}
+
+TEST_F(ZeroCopyWriterTest, ReleaseAfterCompletion) {
+  bool     released = false;
+  uint64_t completed = 0;
+  WritePayload(&released, &completed);
+
+  RunUntil(released);
+  EXPECT_EQ(handled, 1);
+  ASSERT_TRUE(released);
+  EXPECT_GT(completed, 0);
+  EXPECT_EQ(writer.PendingWrites(), 0);
+}
+
+TEST_F(ZeroCopyWriterTest, CloseKeepsOwnersUntilCompletion) {
+  bool     released = false;
+  uint64_t completed = 0;
+  WritePayload(&released, &completed);
+
+  /**
+   * @brief the kernel may still send from the payload, closing must not free it
+   */
+  writer.Close();
+  client.close();
+  EXPECT_FALSE(released);
+  EXPECT_EQ(writer.PendingWrites(), 0);
+
+  RunUntil(released);
+  EXPECT_TRUE(released);
+}
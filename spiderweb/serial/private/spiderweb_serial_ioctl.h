@@ -0,0 +1,27 @@
+#ifndef SPIDERWEB_SERIAL_IOCTL_H
+#define SPIDERWEB_SERIAL_IOCTL_H
+
+#include <cstdint>
+#include <system_error>
+
+#include "spiderweb/serial/spiderweb_serialport.h"
+
+namespace spiderweb {
+namespace serial {
+/**
+ * @brief the linux ioctls of SerialPort, in a file of their own: the termios2 of <asm/termbits.h>
+ *
+ * clashes with the termios of <termios.h>, which asio includes.
+ */
+void SetTermios2BaudRate(int fd, std::uint32_t baudrate, std::error_code& ec);
+
+std::uint32_t GetTermios2BaudRate(int fd, std::error_code& ec);
+
+void SetSerialLowLatency(int fd, bool flag, std::error_code& ec);
+
+void SetSerialRs485(int fd, const Rs485Options& options, std::error_code& ec);
+
+}  // namespace serial
+}  // namespace spiderweb
+
+#endif
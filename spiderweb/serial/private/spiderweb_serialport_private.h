@@ -1,6 +1,16 @@
 #ifndef SPIDERWEB_SERIALPORT_PRIVATE_H
 #define SPIDERWEB_SERIALPORT_PRIVATE_H
 
+#if !defined(_WIN32)
+#include <termios.h>
+#endif
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+#include "absl/types/optional.h"
 #include "asio.hpp"
 #include "asio/serial_port.hpp"
 #include "core/internal/asio_cast.h"
@@ -8,6 +18,10 @@
 #include "spiderweb/reflect/enum_reflect.h"
 #include "spiderweb/serial/spiderweb_serialport.h"
 
+#if defined(__linux__)
+#include "serial/private/spiderweb_serial_ioctl.h"
+#endif
+
 REFLECT_ENUM(spiderweb::serial::StopBits, asio::serial_port::stop_bits::type,
              (kOne, asio::serial_port::stop_bits::one), (kTwo, asio::serial_port::stop_bits::two))
 
@@ -94,6 +108,63 @@ class SerialPort::Private {
     return reflect::MapFrom(opt.value(), StopBits::kOne);
   }
 
+  void SetBaudRate(std::uint32_t baudrate, std::error_code& ec) {
+#if defined(__linux__)
+    SetTermios2BaudRate(serial_port.native_handle(), baudrate, ec);
+#else
+    (void)serial_port.set_option(asio::serial_port::baud_rate(baudrate), ec);
+#endif
+  }
+
+  std::uint32_t GetBaudRateValue(std::error_code& ec) {
+#if defined(__linux__)
+    return GetTermios2BaudRate(serial_port.native_handle(), ec);
+#else
+    asio::serial_port_base::baud_rate opt;
+    (void)serial_port.get_option(opt, ec);
+    return ec ? 0 : opt.value();
+#endif
+  }
+
+  void SetLowLatency(bool flag, std::error_code& ec) {
+#if defined(__linux__)
+    SetSerialLowLatency(serial_port.native_handle(), flag, ec);
+#else
+    (void)flag;
+    ec = asio::error::operation_not_supported;
+#endif
+  }
+
+  void SetVminVtime(std::uint8_t vmin, std::uint8_t vtime, std::error_code& ec) {
+#if defined(_WIN32)
+    (void)vmin;
+    (void)vtime;
+    ec = asio::error::operation_not_supported;
+#else
+    const int fd = serial_port.native_handle();
+    termios   tio;
+    if (::tcgetattr(fd, &tio) != 0) {
+      ec = asio::error_code(errno, asio::error::get_system_category());
+      return;
+    }
+
+    tio.c_cc[VMIN] = vmin;
+    tio.c_cc[VTIME] = vtime;
+    if (::tcsetattr(fd, TCSANOW, &tio) != 0) {
+      ec = asio::error_code(errno, asio::error::get_system_category());
+    }
+#endif
+  }
+
+  void SetRs485(const Rs485Options& options, std::error_code& ec) {
+#if defined(__linux__)
+    SetSerialRs485(serial_port.native_handle(), options, ec);
+#else
+    (void)options;
+    ec = asio::error::operation_not_supported;
+#endif
+  }
+
   //////////////
 
   inline const char* Description() const {
@@ -105,12 +176,33 @@ class SerialPort::Private {
     stream.async_read_some(buffer, std::forward<Handler>(handler));
   }
 
-  template <typename AsyncStream, typename Handler>
-  void Write(AsyncStream& stream, const asio::mutable_buffers_1& buffers, Handler&& handler) {
+  /**
+   * @brief serial ports are not drained, see IoPrivate::DrainRead
+   */
+  template <typename AsyncStream>
+  std::size_t TryRead(AsyncStream& /*stream*/, const asio::mutable_buffers_1& /*buffer*/,
+                      asio::error_code& ec) {
+    ec = asio::error::would_block;
+    return 0;
+  }
+
+  template <typename AsyncStream, typename ConstBufferSequence, typename Handler>
+  void Write(AsyncStream& stream, const ConstBufferSequence& buffers, Handler&& handler) {
     asio::async_write(stream, buffers, asio::transfer_all(), std::forward<Handler>(handler));
   }
 
+  /**
+   * @brief with an inter byte gap the reads are held, and emitted together once the gap passed
+   *
+   * after the last one, see ArmGap
+   */
   void Readden(const io::BufferReader& reader) {
+    if (gap.count() > 0) {
+      ArmGap(reader);
+      return;
+    }
+
+    CancelGap();
     spider_emit q->BytesRead(reader);
   }
 
@@ -118,12 +210,25 @@ class SerialPort::Private {
     spider_emit q->BytesWritten(size);
   }
 
+  void WriteBufferFull(std::size_t size) {
+    spider_emit q->WriteBufferFull(size);
+  }
+
+  void WriteBufferDrained() {
+    spider_emit q->WriteBufferDrained();
+  }
+
+  /**
+   * @brief what was received before the error is emitted first
+   */
   void Error(const asio::error_code& ec) {
+    FlushGap();
     spider_emit Object::Emit(q, &SerialPort::Error, ec);
   }
 
   template <typename AsyncStream>
   void Close(AsyncStream& stream) {
+    CancelGap();
     std::error_code ec;
     stream.close(ec);
   }
@@ -136,8 +241,61 @@ class SerialPort::Private {
     spider_emit Object::Emit(q, &SerialPort::OpenFailed, ec);
   }
 
-  SerialPort*       q = nullptr;
-  asio::serial_port serial_port;
+  SerialPort*               q = nullptr;
+  asio::serial_port         serial_port;
+  /// see SerialPort::SetInterByteGap
+  std::chrono::microseconds gap{0};
+
+ private:
+  /**
+   * @brief (re)start the gap after a read. the timer is shared, so that a handler which completed
+   *
+   * before we were destroyed sees it, and a rearmed one sees it is stale by its generation.
+   */
+  void ArmGap(const io::BufferReader& reader) {
+    if (!gap_timer) {
+      gap_timer = std::make_shared<asio::steady_timer>(AsioService(q->ownerEventLoop()));
+    }
+
+    pending.emplace(reader);
+    gap_timer->expires_after(gap);
+
+    const auto                              generation = ++gap_generation;
+    const std::weak_ptr<asio::steady_timer> alive = gap_timer;
+    gap_timer->async_wait([this, alive, generation](const asio::error_code& ec) {
+      if (ec || alive.expired() || generation != gap_generation) {
+        return;
+      }
+      FlushGap();
+    });
+  }
+
+  void FlushGap() {
+    if (!pending) {
+      return;
+    }
+
+    const io::BufferReader reader = *pending;
+    CancelGap();
+    if (q) {
+      spider_emit q->BytesRead(reader);
+    }
+  }
+
+  void CancelGap() {
+    if (!pending) {
+      return;
+    }
+
+    pending.reset();
+    ++gap_generation;
+    gap_timer->cancel();
+  }
+
+  std::shared_ptr<asio::steady_timer> gap_timer;
+  /// the receive buffer, while the gap has not passed
+  absl::optional<io::BufferReader>    pending;
+  std::uint64_t                       gap_generation = 0;
 };
 
 }  // namespace serial
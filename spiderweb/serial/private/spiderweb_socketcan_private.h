@@ -1,6 +1,21 @@
 #ifndef SPIDERWEB_SOCKETCAN_PRIVATE_H
 #define SPIDERWEB_SOCKETCAN_PRIVATE_H
 
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <linux/net_tstamp.h>
+#include <sys/socket.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include "absl/memory/memory.h"
 #include "asio.hpp"
 #include "canary/filter.hpp"
@@ -19,6 +34,20 @@ namespace spiderweb {
 namespace serial {
 class SocketCan::Private {
  public:
+  /**
+   * @brief the bytes of a classic frame on the socket(struct can_frame), the timestamps of
+   *
+   * CanFrame follow them
+   */
+  static constexpr std::size_t kFrameSize = sizeof(canary::frame_header) + 8;
+
+  /**
+   * @brief the bytes of a CAN FD frame(struct canfd_frame), its flags are in the header
+   */
+  static constexpr std::size_t kFdFrameSize = sizeof(canary::frame_header) + 64;
+
+  static constexpr std::size_t kFdFlagsOffset = offsetof(struct canfd_frame, flags);
+
   explicit Private(SocketCan* qq) : q(qq) {
   }
 
@@ -31,25 +60,125 @@ class SocketCan::Private {
     return "SocketCan";
   }
 
+  /**
+   * @brief in batched mode the frames are received into `frames` instead of the buffer of
+   *
+   * IoPrivate, the read reports 0 bytes and Readden emits them. the socket is read at once, and
+   *
+   * waited for only if it has nothing.
+   */
   template <typename AsyncStream, typename Handler>
   void Read(AsyncStream& stream, const asio::mutable_buffers_1& buffer, Handler&& handler) {
-    stream.async_receive(buffer, std::forward<Handler>(handler));
+    if (!IsBatched()) {
+      stream.async_receive(buffer, [this, handler = std::forward<Handler>(handler)](
+                                       const asio::error_code& ec, std::size_t n) mutable {
+        datagram_size = n;
+        handler(ec, n);
+      });
+      return;
+    }
+
+    asio::error_code ec;
+    ReceiveBatch(stream, ec);
+    if (IsWouldBlock(ec)) {
+      WaitBatch(stream, std::forward<Handler>(handler));
+      return;
+    }
+
+    asio::post(stream.get_executor(),
+               [handler = std::forward<Handler>(handler), ec]() mutable { handler(ec, 0); });
   }
 
-  template <typename AsyncStream, typename Handler>
-  void Write(AsyncStream& stream, const asio::mutable_buffers_1& buffers, Handler&& handler) {
-    stream.async_send(buffers, std::forward<Handler>(handler));
+  /**
+   * @brief can frames are not drained, see IoPrivate::DrainRead
+   */
+  template <typename AsyncStream>
+  std::size_t TryRead(AsyncStream& /*stream*/, const asio::mutable_buffers_1& /*buffer*/,
+                      asio::error_code& ec) {
+    ec = asio::error::would_block;
+    return 0;
+  }
+
+  /**
+   * @brief a send is one frame. the classic frames copied into the send queue are coalesced,
+   *
+   * they are sent one by one from the first buffer. a CAN FD frame, or an isotp message, is a
+   *
+   * buffer of its own, sent whole.
+   */
+  template <typename AsyncStream, typename ConstBufferSequence, typename Handler>
+  void Write(AsyncStream& stream, const ConstBufferSequence& buffers, Handler&& handler) {
+    const asio::const_buffer first = *asio::buffer_sequence_begin(buffers);
+
+    std::size_t size = first.size();
+    if (type == SocketCanType::kRaw && size != kFdFrameSize && size > kFrameSize) {
+      size = kFrameSize;
+    }
+    stream.async_send(asio::buffer(first.data(), size), std::forward<Handler>(handler));
   }
 
+  /**
+   * @brief the frames with a handler are passed to it, the others are emitted
+   */
   void Readden(const io::BufferReader& reader) {
-    if (reader.Len() < sizeof(CanFrame)) {
+    if (IsBatched()) {
+      const auto  count = received;
+      std::size_t kept = 0;
+      received = 0;
+      for (std::size_t i = 0; i < count; ++i) {
+        const auto handler = HandlerOf(frames[i]);
+        if (handler) {
+          (*handler)(frames[i]);
+          if (!q) {
+            return;
+          }
+          continue;
+        }
+
+        if (kept != i) {
+          frames[kept] = frames[i];
+        }
+        ++kept;
+      }
+
+      if (kept > 0) {
+        spider_emit q->FramesRead(absl::Span<const CanFrame>(frames.data(), kept));
+      }
+      return;
+    }
+
+    const auto size = datagram_size;
+    datagram_size = 0;
+    if (type != SocketCanType::kRaw) {
+      while (reader.Len() >= kFrameSize) {
+        CanFrame f;
+        reader.Read(reinterpret_cast<char*>(&f), kFrameSize);
+        spider_emit q->FrameRead(f);
+      }
+      return;
+    }
+
+    /**
+     * @brief a read is one datagram, a classic frame or a CAN FD one
+     */
+    if (reader.Len() < size || (size != kFrameSize && !(fd && size == kFdFrameSize))) {
+      reader.Skip(static_cast<uint32_t>(reader.Len()));
       return;
     }
 
     CanFrame f;
     auto*    p = reinterpret_cast<char*>(&f);
-    reader.Read(p, sizeof(f));
+    reader.Read(p, size);
+    if (size == kFdFrameSize) {
+      f.fd = true;
+      f.fd_flags = static_cast<uint8_t>(p[kFdFlagsOffset]);
+    }
 
+    const auto handler = HandlerOf(f);
+    if (handler) {
+      (*handler)(f);
+      return;
+    }
     spider_emit q->FrameRead(f);
   }
 
@@ -57,6 +186,15 @@ class SocketCan::Private {
     spider_emit q->BytesWritten(size);
   }
 
+  /**
+   * @brief SocketCan has no watermarks
+   */
+  void WriteBufferFull(std::size_t) {
+  }
+
+  void WriteBufferDrained() {
+  }
+
   void Error(const asio::error_code& ec) {
     spider_emit Object::Emit(q, &SocketCan::Error, ec);
   }
@@ -75,10 +213,223 @@ class SocketCan::Private {
     spider_emit Object::Emit(q, &SocketCan::OpenError, ec);
   }
 
+  /**
+   * @brief the options set before Open, on the new raw socket
+   */
+  void ApplyOptions(int sock, std::error_code& ec) {
+    SetFilterOption(sock, ec);
+    if (!ec && error_mask != 0) {
+      SetErrorMaskOption(sock, ec);
+    }
+    if (!ec && fd) {
+      const int enable = 1;
+      SetOption(sock, CAN_RAW_FD_FRAMES, &enable, sizeof(enable), ec);
+    }
+    if (!ec && batch_size > 0) {
+      EnableTimestamping(sock);
+    }
+  }
+
+  /**
+   * @brief no filter is DefaultFilter, the same at Open and later
+   */
+  void SetFilterOption(int sock, std::error_code& ec) const {
+    std::vector<struct can_filter> kernel_filters;
+    for (const auto& filter : filters) {
+      struct can_filter f;
+      f.can_id = filter.inverted ? (filter.id | CAN_INV_FILTER) : filter.id;
+      f.can_mask = filter.mask;
+      kernel_filters.push_back(f);
+    }
+    if (kernel_filters.empty()) {
+      kernel_filters.push_back(DefaultFilter());
+    }
+
+    SetOption(sock, CAN_RAW_FILTER, kernel_filters.data(),
+              kernel_filters.size() * sizeof(struct can_filter), ec);
+  }
+
+  void SetErrorMaskOption(int sock, std::error_code& ec) const {
+    const can_err_mask_t mask = error_mask;
+    SetOption(sock, CAN_RAW_ERR_FILTER, &mask, sizeof(mask), ec);
+  }
+
+  /**
+   * @brief the kernel stamps the frames it receives, and the controller too if it can
+   */
+  void EnableTimestamping(int sock) {
+    const int flags = SOF_TIMESTAMPING_RX_SOFTWARE | SOF_TIMESTAMPING_SOFTWARE |
+                      SOF_TIMESTAMPING_RX_HARDWARE | SOF_TIMESTAMPING_RAW_HARDWARE;
+    if (::setsockopt(sock, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags)) != 0) {
+      spdlog::warn("SocketCan({}) SO_TIMESTAMPING {}", fmt::ptr(q), std::strerror(errno));
+    }
+  }
+
+  bool IsRawOpen() const {
+    return type == SocketCanType::kRaw && raw_sock && raw_sock->is_open();
+  }
+
+  bool IsBatched() const {
+    return batch_size > 0 && type == SocketCanType::kRaw;
+  }
+
   SocketCan*                             q = nullptr;
   SocketCanType                          type;
   std::unique_ptr<canary::raw::socket>   raw_sock;
   std::unique_ptr<canary::isotp::socket> isotp_sock;
+  /// frames read per recvmmsg, 0 is not batched, see SocketCan::SetBatchedRead
+  std::size_t                            batch_size = 0;
+  std::vector<CanFilter>                 filters;
+  std::uint32_t                          error_mask = 0;
+  /// CAN FD frames are read and written
+  bool                                   fd = false;
+  /// shared, so that a handler may replace itself while it runs
+  std::unordered_map<std::uint32_t, std::shared_ptr<SocketCan::FrameHandler>> handlers;
+
+ private:
+  /**
+   * @brief struct scm_timestamping: software, deprecated, raw hardware
+   */
+  struct Timestamps {
+    timespec ts[3];
+  };
+
+  static constexpr std::size_t kControlSize = CMSG_SPACE(sizeof(Timestamps));
+
+  /**
+   * @brief every frame but the remote frames of extended ids, what an isotp socket is opened with
+   *
+   * too(a canary::filter of negation, remote_transmission and extended_format)
+   */
+  static can_filter DefaultFilter() {
+    can_filter filter;
+    filter.can_id = CAN_INV_FILTER | CAN_EFF_FLAG | CAN_RTR_FLAG;
+    filter.can_mask = CAN_EFF_FLAG | CAN_RTR_FLAG;
+    return filter;
+  }
+
+  static bool IsWouldBlock(const asio::error_code& ec) {
+    return ec == asio::error::would_block || ec == asio::error::try_again;
+  }
+
+  static void SetOption(int sock, int name, const void* value, std::size_t size,
+                        std::error_code& ec) {
+    if (::setsockopt(sock, SOL_CAN_RAW, name, value, static_cast<socklen_t>(size)) != 0) {
+      ec = std::error_code(errno, std::system_category());
+    }
+  }
+
+  std::shared_ptr<SocketCan::FrameHandler> HandlerOf(const CanFrame& frame) const {
+    if (handlers.empty()) {
+      return nullptr;
+    }
+    const auto it = handlers.find(frame.header.id());
+    return it == handlers.end() ? nullptr : it->second;
+  }
+
+  static std::chrono::nanoseconds ToNanoseconds(const timespec& ts) {
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+  }
+
+  template <typename AsyncStream, typename Handler>
+  void WaitBatch(AsyncStream& stream, Handler&& handler) {
+    stream.async_wait(asio::socket_base::wait_read,
+                      [this, &stream, handler = std::forward<Handler>(handler)](
+                          const asio::error_code& ec) mutable {
+                        if (ec) {
+                          handler(ec, 0);
+                          return;
+                        }
+
+                        asio::error_code read_ec;
+                        ReceiveBatch(stream, read_ec);
+                        if (IsWouldBlock(read_ec)) {
+                          WaitBatch(stream, std::move(handler));
+                          return;
+                        }
+                        handler(read_ec, 0);
+                      });
+  }
+
+  /**
+   * @brief one recvmmsg of up to batch_size frames, straight into `frames`, with their
+   *
+   * timestamps. what is not a frame is dropped.
+   */
+  template <typename AsyncStream>
+  void ReceiveBatch(AsyncStream& stream, asio::error_code& ec) {
+    frames.resize(batch_size);
+    iovecs.resize(batch_size);
+    messages.resize(batch_size);
+    control.resize(batch_size * kControlSize);
+    for (std::size_t i = 0; i < batch_size; ++i) {
+      iovecs[i].iov_base = &frames[i];
+      iovecs[i].iov_len = fd ? kFdFrameSize : kFrameSize;
+      messages[i] = mmsghdr{};
+      messages[i].msg_hdr.msg_iov = &iovecs[i];
+      messages[i].msg_hdr.msg_iovlen = 1;
+      messages[i].msg_hdr.msg_control = &control[i * kControlSize];
+      messages[i].msg_hdr.msg_controllen = kControlSize;
+    }
+
+    int n = 0;
+    do {
+      n = ::recvmmsg(stream.native_handle(), messages.data(), static_cast<unsigned>(batch_size),
+                     MSG_DONTWAIT, nullptr);
+    } while (n < 0 && errno == EINTR);
+
+    received = 0;
+    if (n < 0) {
+      ec = asio::error_code(errno, asio::error::get_system_category());
+      return;
+    }
+
+    for (int i = 0; i < n; ++i) {
+      auto&      frame = frames[i];
+      const auto size = messages[i].msg_len;
+      if (size == kFdFrameSize && fd) {
+        frame.fd = true;
+        frame.fd_flags = reinterpret_cast<const uint8_t*>(&frame)[kFdFlagsOffset];
+      } else if (size == kFrameSize) {
+        /**
+         * @brief the slot may have held a CAN FD frame
+         */
+        frame.fd = false;
+        frame.fd_flags = 0;
+        if (fd) {
+          std::fill(frame.payload.begin() + 8, frame.payload.end(), 0);
+        }
+      } else {
+        continue;
+      }
+
+      frame.timestamp = std::chrono::nanoseconds(0);
+      frame.hw_timestamp = std::chrono::nanoseconds(0);
+      auto& msg = messages[i].msg_hdr;
+      for (auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING) {
+          Timestamps stamps;
+          std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+          frame.timestamp = ToNanoseconds(stamps.ts[0]);
+          frame.hw_timestamp = ToNanoseconds(stamps.ts[2]);
+        }
+      }
+
+      if (received != static_cast<std::size_t>(i)) {
+        frames[received] = frame;
+      }
+      ++received;
+    }
+  }
+
+  std::vector<CanFrame> frames;
+  std::vector<iovec>    iovecs;
+  std::vector<mmsghdr>  messages;
+  std::vector<char>     control;
+  /// frames of the last batch in `frames`
+  std::size_t           received = 0;
+  /// the size of the last read, not batched
+  std::size_t           datagram_size = 0;
 };
 
 }  // namespace serial
@@ -0,0 +1,85 @@
+#include "private/spiderweb_serial_ioctl.h"
+
+#include <asm/termbits.h>
+#include <linux/serial.h>
+#include <sys/ioctl.h>
+
+#include <cerrno>
+#include <cstring>
+
+namespace spiderweb {
+namespace serial {
+static std::error_code LastError() {
+  return std::error_code(errno, std::system_category());
+}
+
+void SetTermios2BaudRate(int fd, std::uint32_t baudrate, std::error_code& ec) {
+  struct termios2 tio;
+  if (::ioctl(fd, TCGETS2, &tio) != 0) {
+    ec = LastError();
+    return;
+  }
+
+  /**
+   * @brief BOTHER takes the rate from c_ispeed and c_ospeed, instead of a Bxxx of c_cflag
+   */
+  tio.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+  tio.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+  tio.c_ispeed = baudrate;
+  tio.c_ospeed = baudrate;
+  if (::ioctl(fd, TCSETS2, &tio) != 0) {
+    ec = LastError();
+  }
+}
+
+std::uint32_t GetTermios2BaudRate(int fd, std::error_code& ec) {
+  struct termios2 tio;
+  if (::ioctl(fd, TCGETS2, &tio) != 0) {
+    ec = LastError();
+    return 0;
+  }
+  return tio.c_ospeed;
+}
+
+void SetSerialLowLatency(int fd, bool flag, std::error_code& ec) {
+  struct serial_struct serial;
+  if (::ioctl(fd, TIOCGSERIAL, &serial) != 0) {
+    ec = LastError();
+    return;
+  }
+
+  if (flag) {
+    serial.flags |= ASYNC_LOW_LATENCY;
+  } else {
+    serial.flags &= ~ASYNC_LOW_LATENCY;
+  }
+  if (::ioctl(fd, TIOCSSERIAL, &serial) != 0) {
+    ec = LastError();
+  }
+}
+
+void SetSerialRs485(int fd, const Rs485Options& options, std::error_code& ec) {
+  struct serial_rs485 rs485;
+  std::memset(&rs485, 0, sizeof(rs485));
+  if (options.enabled) {
+    rs485.flags |= SER_RS485_ENABLED;
+  }
+  if (options.rts_on_send) {
+    rs485.flags |= SER_RS485_RTS_ON_SEND;
+  }
+  if (options.rts_after_send) {
+    rs485.flags |= SER_RS485_RTS_AFTER_SEND;
+  }
+  if (options.receive_during_send) {
+    rs485.flags |= SER_RS485_RX_DURING_TX;
+  }
+  rs485.delay_rts_before_send = options.delay_before_send_ms;
+  rs485.delay_rts_after_send = options.delay_after_send_ms;
+
+  if (::ioctl(fd, TIOCSRS485, &rs485) != 0) {
+    ec = LastError();
+  }
+}
+
+}  // namespace serial
+}  // namespace spiderweb
@@ -51,6 +51,35 @@ spiderweb::serial::StopBits SerialPort::GetStopBits() const {
   return d->impl.GetStopBits();
 }
 
+void SerialPort::SetBaudRate(std::uint32_t baudrate, std::error_code &ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(SerialPort::SetBaudRate);
+  d->impl.SetBaudRate(baudrate, ec);
+}
+
+std::uint32_t SerialPort::GetBaudRateValue(std::error_code &ec) const {
+  return d->impl.GetBaudRateValue(ec);
+}
+
+void SerialPort::SetLowLatency(bool flag, std::error_code &ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(SerialPort::SetLowLatency);
+  d->impl.SetLowLatency(flag, ec);
+}
+
+void SerialPort::SetVminVtime(std::uint8_t vmin, std::uint8_t vtime, std::error_code &ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(SerialPort::SetVminVtime);
+  d->impl.SetVminVtime(vmin, vtime, ec);
+}
+
+void SerialPort::SetRs485(const Rs485Options &options, std::error_code &ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(SerialPort::SetRs485);
+  d->impl.SetRs485(options, ec);
+}
+
+void SerialPort::SetInterByteGap(std::chrono::microseconds gap) {
+  SPIDERWEB_CALL_THREAD_CHECK(SerialPort::SetInterByteGap);
+  d->impl.gap = gap;
+}
+
 void SerialPort::Close() {
   SPIDERWEB_CALL_THREAD_CHECK(SerialPort::Close);
   d->Close(d->impl.serial_port);
@@ -66,5 +95,42 @@ void SerialPort::Write(const std::vector<uint8_t> &data) {
   d->StartWrite(d->impl.serial_port, data);
 }
 
+void SerialPort::SetWriteBufferWatermarks(std::size_t high, std::size_t low) {
+  SPIDERWEB_CALL_THREAD_CHECK(SerialPort::SetWriteBufferWatermarks);
+  d->SetWriteWatermarks(high, low);
+}
+
+std::size_t SerialPort::WriteBufferSize() const {
+  return d->send_queue.Len();
+}
+
+void SerialPort::PauseReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(SerialPort::PauseReading);
+  d->PauseRead();
+}
+
+void SerialPort::ResumeReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(SerialPort::ResumeReading);
+  d->ResumeRead(d->impl.serial_port);
+}
+
+void SerialPort::ContinueReading() {
+  SPIDERWEB_CALL_THREAD_CHECK(SerialPort::ContinueReading);
+  d->RestartRead(d->impl.serial_port);
+}
+
+bool SerialPort::IsReadingPaused() const {
+  return d->IsReadPaused();
+}
+
+void SerialPort::SetMaxReadBufferSize(std::size_t size) {
+  SPIDERWEB_CALL_THREAD_CHECK(SerialPort::SetMaxReadBufferSize);
+  d->max_read_buffer = size;
+}
+
+std::size_t SerialPort::ReadBufferSize() const {
+  return d->recv_buffer.Len();
+}
+
 }  // namespace serial
 }  // namespace spiderweb
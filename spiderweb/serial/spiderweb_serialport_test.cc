@@ -1,5 +1,15 @@
 #include "spiderweb/serial/spiderweb_serialport.h"
 
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "core/internal/asio_cast.h"
 #include "ghc/filesystem.hpp"
 #include "gtest/gtest.h"
 #include "spdlog/spdlog.h"
@@ -26,3 +36,141 @@ TEST_F(SerialPortTest, Construct) {
     EXPECT_EQ(spy.Count(), 0);
   }
 }
+
+#if defined(__linux__)
+namespace {
+/**
+ * @brief a pseudo terminal, the SerialPort opens its slave side, the test writes the master side
+ */
+class Pty {
+ public:
+  Pty() {
+    master = ::posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (master >= 0 && ::grantpt(master) == 0 && ::unlockpt(master) == 0) {
+      slave = ::ptsname(master);
+    }
+  }
+
+  ~Pty() {
+    if (master >= 0) {
+      ::close(master);
+    }
+  }
+
+  bool Send(const std::string& data) const {
+    return ::write(master, data.data(), data.size()) == static_cast<ssize_t>(data.size());
+  }
+
+  int         master = -1;
+  std::string slave;
+};
+
+void RunSerial(spiderweb::EventLoop& loop, std::chrono::milliseconds duration,
+               const std::function<bool()>& done = nullptr) {
+  auto&      io = spiderweb::AsioService(&loop);
+  const auto deadline = std::chrono::steady_clock::now() + duration;
+  while (std::chrono::steady_clock::now() < deadline && !(done && done())) {
+    io.run_one_for(std::chrono::milliseconds(1));
+  }
+}
+
+}  // namespace
+
+TEST_F(SerialPortTest, InterByteGapCoalescesReads) {
+  Pty pty;
+  ASSERT_FALSE(pty.slave.empty());
+
+  spiderweb::EventLoop          loop;
+  spiderweb::serial::SerialPort serial;
+  spiderweb::NotifySpy          opened(&serial, &spiderweb::serial::SerialPort::OpenSuccess);
+  std::vector<std::string>      reads;
+  spiderweb::Object::Connect(&serial, &spiderweb::serial::SerialPort::BytesRead, &serial,
+                             [&reads](const spiderweb::io::BufferReader& reader) {
+                               std::string data(reader.Len(), '\0');
+                               reader.Read(&data[0], data.size());
+                               reads.push_back(data);
+                             });
+  serial.SetInterByteGap(std::chrono::milliseconds(100));
+  serial.Open(pty.slave);
+  opened.Wait();
+  ASSERT_EQ(opened.Count(), 1);
+
+  /**
+   * @brief the bytes 10ms apart are one frame, then the line is quiet
+   */
+  ASSERT_TRUE(pty.Send("ab"));
+  RunSerial(loop, std::chrono::milliseconds(10));
+  ASSERT_TRUE(pty.Send("cd"));
+  RunSerial(loop, std::chrono::milliseconds(10));
+  EXPECT_TRUE(reads.empty());
+
+  RunSerial(loop, std::chrono::milliseconds(1000), [&]() { return !reads.empty(); });
+  EXPECT_EQ(reads, std::vector<std::string>{"abcd"});
+
+  ASSERT_TRUE(pty.Send("ef"));
+  RunSerial(loop, std::chrono::milliseconds(1000), [&]() { return reads.size() == 2; });
+  EXPECT_EQ(reads, (std::vector<std::string>{"abcd", "ef"}));
+}
+
+TEST_F(SerialPortTest, VminWakesForWholeReplies) {
+  Pty pty;
+  ASSERT_FALSE(pty.slave.empty());
+
+  spiderweb::EventLoop          loop;
+  spiderweb::serial::SerialPort serial;
+  spiderweb::NotifySpy          opened(&serial, &spiderweb::serial::SerialPort::OpenSuccess);
+  std::string                   received;
+  spiderweb::Object::Connect(&serial, &spiderweb::serial::SerialPort::BytesRead, &serial,
+                             [&received](const spiderweb::io::BufferReader& reader) {
+                               std::string data(reader.Len(), '\0');
+                               reader.Read(&data[0], data.size());
+                               received += data;
+                             });
+  serial.Open(pty.slave);
+  opened.Wait();
+  ASSERT_EQ(opened.Count(), 1);
+
+  std::error_code ec;
+  serial.SetVminVtime(4, 0, ec);
+  ASSERT_FALSE(ec) << ec.message();
+
+  ASSERT_TRUE(pty.Send("ab"));
+  RunSerial(loop, std::chrono::milliseconds(50));
+  EXPECT_TRUE(received.empty());
+
+  ASSERT_TRUE(pty.Send("cd"));
+  RunSerial(loop, std::chrono::milliseconds(1000), [&]() { return received.size() == 4; });
+  EXPECT_EQ(received, "abcd");
+}
+
+TEST_F(SerialPortTest, BaudRateValueIsStored) {
+  Pty pty;
+  ASSERT_FALSE(pty.slave.empty());
+
+  spiderweb::EventLoop          loop;
+  spiderweb::serial::SerialPort serial;
+  spiderweb::NotifySpy          opened(&serial, &spiderweb::serial::SerialPort::OpenSuccess);
+  serial.Open(pty.slave);
+  opened.Wait();
+  ASSERT_EQ(opened.Count(), 1);
+
+  /**
+   * @brief a pty has no clock, it only stores the rate it is given
+   */
+  std::error_code ec;
+  serial.SetBaudRate(921600, ec);
+  ASSERT_FALSE(ec) << ec.message();
+  EXPECT_EQ(serial.GetBaudRateValue(ec), 921600);
+  EXPECT_FALSE(ec) << ec.message();
+
+  serial.SetBaudRate(spiderweb::serial::BaudRate::k9600, ec);
+  ASSERT_FALSE(ec) << ec.message();
+  EXPECT_EQ(serial.GetBaudRateValue(ec), 9600);
+  EXPECT_FALSE(ec) << ec.message();
+  EXPECT_EQ(serial.GetBaudRate(), spiderweb::serial::BaudRate::k9600);
+
+  serial.Close();
+  EXPECT_EQ(serial.GetBaudRateValue(ec), 0);
+  EXPECT_TRUE(ec);
+}
+#endif
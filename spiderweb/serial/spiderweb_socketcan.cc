@@ -1,5 +1,8 @@
 #include "spiderweb/serial/spiderweb_socketcan.h"
 
+#include <array>
+#include <cstring>
+
 #include "absl/memory/memory.h"
 #include "core/internal/asio_cast.h"
 #include "io/private/spiderweb_stream_private.h"
@@ -23,21 +26,23 @@ void SocketCan::Open(const std::string &can, SocketCanType type) {
 
   d->impl.type = type;
 
-  canary::filter filter;
-  filter.negation(true);
-  filter.remote_transmission(true);
-  filter.extended_format(true);
-
   std::error_code ec;
   const auto      idx = canary::get_interface_index(can, ec);
   switch (d->impl.type) {
     case SocketCanType::kRaw: {
       auto const ep = canary::raw::endpoint{idx};
       d->impl.raw_sock = absl::make_unique<canary::raw::socket>(AsioService(ownerEventLoop()), ep);
-      d->impl.raw_sock->set_option(canary::filter_if_any(&filter, 1));
+      if (!ec) {
+        d->impl.ApplyOptions(d->impl.raw_sock->native_handle(), ec);
+      }
       d->StartOpenEx(*d->impl.raw_sock, false, ec);
     } break;
     case SocketCanType::kIsotp: {
+      canary::filter filter;
+      filter.negation(true);
+      filter.remote_transmission(true);
+      filter.extended_format(true);
+
       auto const ep = canary::isotp::endpoint{idx};
       d->impl.isotp_sock =
           absl::make_unique<canary::isotp::socket>(AsioService(ownerEventLoop()), ep);
@@ -47,6 +52,41 @@ void SocketCan::Open(const std::string &can, SocketCanType type) {
   }
 }
 
+void SocketCan::SetBatchedRead(std::size_t max_frames) {
+  SPIDERWEB_CALL_THREAD_CHECK(SocketCan::SetBatchedRead);
+  d->impl.batch_size = max_frames;
+}
+
+void SocketCan::SetFilters(std::vector<CanFilter> filters, ErrorCode &ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(SocketCan::SetFilters);
+  d->impl.filters = std::move(filters);
+  if (d->impl.IsRawOpen()) {
+    d->impl.SetFilterOption(d->impl.raw_sock->native_handle(), ec);
+  }
+}
+
+void SocketCan::SetErrorMask(std::uint32_t mask, ErrorCode &ec) {
+  SPIDERWEB_CALL_THREAD_CHECK(SocketCan::SetErrorMask);
+  d->impl.error_mask = mask;
+  if (d->impl.IsRawOpen()) {
+    d->impl.SetErrorMaskOption(d->impl.raw_sock->native_handle(), ec);
+  }
+}
+
+void SocketCan::SetCanFd(bool flag) {
+  SPIDERWEB_CALL_THREAD_CHECK(SocketCan::SetCanFd);
+  d->impl.fd = flag;
+}
+
+void SocketCan::SetFrameHandler(std::uint32_t id, FrameHandler handler) {
+  SPIDERWEB_CALL_THREAD_CHECK(SocketCan::SetFrameHandler);
+  if (handler) {
+    d->impl.handlers[id] = std::make_shared<FrameHandler>(std::move(handler));
+  } else {
+    d->impl.handlers.erase(id);
+  }
+}
+
 void SocketCan::Close() {
   SPIDERWEB_CALL_THREAD_CHECK(SocketCan::Close);
 
@@ -63,17 +103,29 @@ void SocketCan::Close() {
 void SocketCan::Write(const CanFrame &frame) {
   SPIDERWEB_CALL_THREAD_CHECK(SocketCan::Write);
 
-  const auto b = canary::net::buffer(&frame, sizeof(frame));
-  spdlog::debug("{:n}",
-                spdlog::to_hex(static_cast<const char *>(b.begin()->data()),
-                               static_cast<const char *>(b.begin()->data()) + b.begin()->size()));
+  std::array<uint8_t, Private::kFdFrameSize> wire;
+  const std::size_t size = frame.fd ? Private::kFdFrameSize : Private::kFrameSize;
+  std::memcpy(wire.data(), &frame, size);
+  if (frame.fd) {
+    wire[Private::kFdFlagsOffset] = frame.fd_flags;
+  }
+  spdlog::debug("{:n}", spdlog::to_hex(wire.begin(), wire.begin() + size));
 
+  /**
+   * @brief classic frames are coalesced in the send queue, and sent one by one. a CAN FD frame,
+   *
+   * or an isotp message, is queued as a buffer of its own, see Private::Write
+   */
   switch (d->impl.type) {
     case SocketCanType::kRaw: {
-      d->StartWrite(*d->impl.raw_sock, static_cast<const uint8_t *>(b.data()), b.size());
+      if (frame.fd) {
+        d->StartWrite(*d->impl.raw_sock, std::vector<uint8_t>(wire.begin(), wire.begin() + size));
+      } else {
+        d->StartWrite(*d->impl.raw_sock, wire.data(), size);
+      }
     } break;
     case SocketCanType::kIsotp: {
-      d->StartWrite(*d->impl.isotp_sock, static_cast<const uint8_t *>(b.data()), b.size());
+      d->StartWrite(*d->impl.isotp_sock, std::vector<uint8_t>(wire.begin(), wire.begin() + size));
     } break;
   }
 }
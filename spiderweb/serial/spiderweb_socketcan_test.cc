@@ -1,13 +1,23 @@
 #include "spiderweb/serial/spiderweb_socketcan.h"
 
 #include <gtest/gtest.h>
+#include <linux/can.h>
 
+#include <cerrno>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <functional>
+#include <initializer_list>
+#include <memory>
 #include <spiderweb/io/spiderweb_binary_writer.hpp>
+#include <string>
+#include <vector>
 
+#include "canary/interface_index.hpp"
+#include "core/internal/asio_cast.h"
 #include "spiderweb/core/spiderweb_eventloop.h"
 #include "spiderweb/core/spiderweb_object.h"
 #include "spiderweb/ppk_assert.h"
@@ -49,4 +59,211 @@ TEST(canary, Send) {
 
   loop.Exec();
 }
+
+namespace {
+/**
+ * @brief opens `cans` as raw sockets on vcan0, e.g. after
+ *
+ * `ip link add vcan0 type vcan && ip link set up vcan0`. why it could not, empty if it could
+ */
+std::string OpenVcan(EventLoop& loop, std::initializer_list<serial::SocketCan*> cans) {
+  std::error_code ec;
+  canary::get_interface_index("vcan0", ec);
+  if (ec) {
+    return "no vcan0: " + ec.message();
+  }
+
+  struct State {
+    std::size_t     opened = 0;
+    std::error_code error;
+  };
+  auto state = std::make_shared<State>();
+  for (auto* can : cans) {
+    Object::Connect(can, &serial::SocketCan::OpenSuccess, can, [state]() { ++state->opened; });
+    Object::Connect(can, &serial::SocketCan::OpenError, can,
+                    [state](const std::error_code& e) { state->error = e; });
+    can->Open("vcan0", serial::SocketCanType::kRaw);
+  }
+
+  auto& io = AsioService(&loop);
+  for (int i = 0; i < 300 && state->opened < cans.size() && !state->error; ++i) {
+    io.run_one_for(std::chrono::milliseconds(10));
+  }
+  return state->opened == cans.size() ? std::string() : "vcan0 unusable: " + state->error.message();
+}
+
+void RunCan(EventLoop& loop, const std::function<bool()>& done) {
+  auto& io = AsioService(&loop);
+  for (int i = 0; i < 300 && !done(); ++i) {
+    io.run_one_for(std::chrono::milliseconds(10));
+  }
+}
+
+serial::CanFrame MakeFrame(uint32_t id) {
+  serial::CanFrame f;
+  f.header.id(id);
+  f.header.payload_length(8);
+  f.payload = {static_cast<uint8_t>(id), 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+  return f;
+}
+}  // namespace
+
+TEST(canary, BatchedReadWithTimestamps) {
+  static constexpr uint32_t kCount = 100;
+
+  EventLoop         loop;
+  serial::SocketCan sender;
+  serial::SocketCan receiver;
+  receiver.SetBatchedRead(32);
+
+  std::vector<serial::CanFrame> frames;
+  std::size_t                   batches = 0;
+  Object::Connect(&receiver, &serial::SocketCan::FrameRead, &receiver,
+                  [](const serial::CanFrame&) { ADD_FAILURE() << "FrameRead in batched mode"; });
+  Object::Connect(&receiver, &serial::SocketCan::FramesRead, &receiver,
+                  [&](absl::Span<const serial::CanFrame> batch) {
+                    ++batches;
+                    frames.insert(frames.end(), batch.begin(), batch.end());
+                  });
+
+  const auto why = OpenVcan(loop, {&receiver, &sender});
+  if (!why.empty()) {
+    GTEST_SKIP() << why;
+  }
+
+  for (uint32_t i = 0; i < kCount; ++i) {
+    sender.Write(MakeFrame(i));
+  }
+
+  RunCan(loop, [&]() { return frames.size() == kCount; });
+  ASSERT_EQ(frames.size(), kCount);
+  EXPECT_GE(batches, 1);
+  EXPECT_LE(batches, kCount);
+  for (uint32_t i = 0; i < kCount; ++i) {
+    EXPECT_EQ(frames[i].header.id(), i);
+    EXPECT_EQ(frames[i].payload[0], static_cast<uint8_t>(i));
+    EXPECT_GT(frames[i].timestamp.count(), 0);
+  }
+}
+
+TEST(canary, KernelFiltersAndFrameHandlers) {
+  EventLoop         loop;
+  serial::SocketCan sender;
+  serial::SocketCan receiver;
+
+  ErrorCode ec;
+  receiver.SetFilters({serial::CanFilter{0x100, 0x7f0}}, ec);
+  ASSERT_FALSE(ec);
+
+  std::vector<uint32_t> read;
+  std::vector<uint32_t> handled;
+  Object::Connect(&receiver, &serial::SocketCan::FrameRead, &receiver,
+                  [&read](const serial::CanFrame& f) { read.push_back(f.header.id()); });
+  receiver.SetFrameHandler(
+      0x101, [&handled](const serial::CanFrame& f) { handled.push_back(f.header.id()); });
+
+  const auto why = OpenVcan(loop, {&receiver, &sender});
+  if (!why.empty()) {
+    GTEST_SKIP() << why;
+  }
+
+  /**
+   * @brief the frames come in order, 0x200 would be read first if it passed
+   */
+  sender.Write(MakeFrame(0x200));
+  for (uint32_t id = 0x100; id < 0x110; ++id) {
+    sender.Write(MakeFrame(id));
+  }
+
+  RunCan(loop, [&]() { return read.size() + handled.size() == 16; });
+  ASSERT_EQ(read.size(), 15);
+  EXPECT_EQ(read.front(), 0x100);
+  EXPECT_EQ(read.back(), 0x10f);
+  EXPECT_EQ(handled, std::vector<uint32_t>{0x101});
+}
+
+TEST(canary, EmptyFiltersAreTheDefault) {
+  EventLoop         loop;
+  serial::SocketCan sender;
+  serial::SocketCan receiver;
+
+  ErrorCode ec;
+  receiver.SetFilters({serial::CanFilter{0x100, 0x7ff}}, ec);
+  ASSERT_FALSE(ec);
+
+  std::vector<uint32_t> read;
+  Object::Connect(&receiver, &serial::SocketCan::FrameRead, &receiver,
+                  [&read](const serial::CanFrame& f) { read.push_back(f.header.id()); });
+
+  const auto why = OpenVcan(loop, {&receiver, &sender});
+  if (!why.empty()) {
+    GTEST_SKIP() << why;
+  }
+
+  /**
+   * @brief no filter after Open is the filter of Open: the extended remote frame is dropped
+   */
+  receiver.SetFilters({}, ec);
+  ASSERT_FALSE(ec);
+
+  auto remote = MakeFrame(0x200);
+  remote.header.extended_format(true);
+  remote.header.remote_transmission(true);
+  remote.header.payload_length(0);
+  sender.Write(remote);
+  sender.Write(MakeFrame(0x201));
+
+  RunCan(loop, [&]() { return !read.empty(); });
+  EXPECT_EQ(read, std::vector<uint32_t>{0x201});
+}
+
+TEST(canary, CanFdRoundTrip) {
+  EventLoop         loop;
+  serial::SocketCan sender;
+  serial::SocketCan receiver;
+  sender.SetCanFd(true);
+  receiver.SetCanFd(true);
+
+  std::vector<serial::CanFrame> frames;
+  std::error_code               error;
+  Object::Connect(&receiver, &serial::SocketCan::FrameRead, &receiver,
+                  [&frames](const serial::CanFrame& f) { frames.push_back(f); });
+  Object::Connect(&sender, &serial::SocketCan::Error, &sender,
+                  [&error](const std::error_code& ec) { error = ec; });
+
+  const auto why = OpenVcan(loop, {&receiver, &sender});
+  if (!why.empty()) {
+    GTEST_SKIP() << why;
+  }
+
+  serial::CanFrame fd;
+  fd.fd = true;
+  fd.fd_flags = CANFD_BRS;
+  fd.header.id(0x123);
+  fd.header.payload_length(64);
+  for (std::size_t i = 0; i < fd.payload.size(); ++i) {
+    fd.payload[i] = static_cast<uint8_t>(i * 3);
+  }
+  sender.Write(fd);
+  sender.Write(MakeFrame(0x124));
+
+  RunCan(loop, [&]() { return frames.size() == 2 || error; });
+  if (error == std::error_code(EINVAL, std::system_category())) {
+    GTEST_SKIP() << "vcan0 is not CAN FD: ip link set vcan0 mtu 72";
+  }
+  ASSERT_FALSE(error) << error.message();
+  ASSERT_EQ(frames.size(), 2);
+
+  /**
+   * @brief a CAN FD frame and a classic one, on the same socket
+   */
+  EXPECT_TRUE(frames[0].fd);
+  EXPECT_EQ(frames[0].fd_flags & CANFD_BRS, CANFD_BRS);
+  EXPECT_EQ(frames[0].header.id(), 0x123);
+  EXPECT_EQ(frames[0].header.payload_length(), 64);
+  EXPECT_EQ(frames[0].payload, fd.payload);
+  EXPECT_FALSE(frames[1].fd);
+  EXPECT_EQ(frames[1].header.id(), 0x124);
+  EXPECT_EQ(frames[1].payload[0], 0x24);
+}
 }  // namespace spiderweb
@@ -0,0 +1,49 @@
+#include "spiderweb/test/spiderweb_allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+/**
+ * @brief kept in its own translation unit, so that the compiler can not inline the malloc() and
+ * free() below into the callers, and pair them up against new and delete expressions.
+ */
+static std::atomic<uint64_t> allocations{0};
+
+void* operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (auto* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+  return ::operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t /*size*/) noexcept {
+  std::free(p);
+}
+
+void operator delete[](void* p, std::size_t /*size*/) noexcept {
+  std::free(p);
+}
+
+namespace spiderweb {
+namespace test {
+
+uint64_t Allocations() {
+  return allocations.load(std::memory_order_relaxed);
+}
+
+}  // namespace test
+}  // namespace spiderweb
@@ -0,0 +1,20 @@
+#ifndef SPIDERWEB_TEST_ALLOCATION_COUNTER_H
+#define SPIDERWEB_TEST_ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+namespace spiderweb {
+namespace test {
+
+/**
+ * @brief number of operator new calls made by the binary so far.
+ *
+ * only available to binaries which link spiderweb_allocation_counter.cc, it replaces the global
+ * operator new/delete, so keep it out of binaries whose numbers should not pay for the counter.
+ */
+uint64_t Allocations();
+
+}  // namespace test
+}  // namespace spiderweb
+
+#endif
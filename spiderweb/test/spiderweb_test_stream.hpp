@@ -58,12 +58,28 @@ class test_stream {
   MOCK_METHOD(std::size_t, read_some, (const asio::mutable_buffers_1 &buffers));
   MOCK_METHOD(std::size_t, read_some,
               (const asio::mutable_buffers_1 &buffers, asio::error_code &ec));
+  MOCK_METHOD(bool, non_blocking, (), (const));
+  MOCK_METHOD(void, non_blocking, (bool mode, asio::error_code &ec));
   MOCK_METHOD(void, async_read_some,
               (const asio::mutable_buffers_1 &buffers, const ReadHandler &handler));
   MOCK_METHOD(void, async_connect,
               (const asio::ip::tcp::endpoint &, const ConnectHandler &handler));
   MOCK_METHOD(void, async_write_some,
               (const asio::const_buffers_1 &buffers, const WriteHandler &handler));
+  MOCK_METHOD(void, async_write_gather,
+              (const std::vector<asio::const_buffer> &buffers, const WriteHandler &handler));
+
+  /**
+   * @brief gathered writes(more than one buffer) are forwarded to async_write_gather
+   */
+  template <typename ConstBufferSequence, typename Handler,
+            typename = typename std::enable_if<
+                !std::is_convertible<ConstBufferSequence, asio::const_buffer>::value>::type>
+  void async_write_some(const ConstBufferSequence &buffers, Handler &&handler) {
+    async_write_gather(std::vector<asio::const_buffer>(asio::buffer_sequence_begin(buffers),
+                                                       asio::buffer_sequence_end(buffers)),
+                       std::forward<Handler>(handler));
+  }
 
   void close() {
   }